@@ -449,6 +449,7 @@ ComponentResult aulayer::Render(AudioUnitRenderActionFlags& ioActionFlags,
 
    unsigned int events_processed = 0;
 
+   const int blockSize = plugin_instance->getBlockSize();
    unsigned int i;
    for (i = 0; i < inNumberFrames; i++)
    {
@@ -456,7 +457,7 @@ ComponentResult aulayer::Render(AudioUnitRenderActionFlags& ioActionFlags,
       {
          // move clock
          plugin_instance->time_data.ppqPos +=
-             (double)BLOCK_SIZE * plugin_instance->time_data.tempo / (60. * sampleRate);
+             (double)blockSize * plugin_instance->time_data.tempo / (60. * sampleRate);
 
          // process events for the current block
          while (events_processed < events_this_block)
@@ -492,7 +493,7 @@ ComponentResult aulayer::Render(AudioUnitRenderActionFlags& ioActionFlags,
       }
 
       blockpos++;
-      if (blockpos >= BLOCK_SIZE)
+      if (blockpos >= blockSize)
          blockpos = 0;
    }
 
@@ -0,0 +1,99 @@
+/*
+** Surge Synthesizer is Free and Open Source Software
+**
+** Surge is made available under the Gnu General Public License, v3.0
+** https://www.gnu.org/licenses/gpl-3.0.en.html
+**
+** Copyright 2004-2020 by various individuals as described by the Git transaction log
+**
+** All source at: https://github.com/surge-synthesizer/surge.git
+**
+** Surge was a commercial product from 2004-2018, with Copyright and ownership
+** in that period held by Claes Johanson at Vember Audio. Claes made Surge
+** open source in September 2018.
+*/
+
+#include "ModulationMatrix.h"
+#include "SurgeStorage.h"
+#include <algorithm>
+
+static_assert(n_total_params <= ModulationMatrix::max_destinations,
+              "accumulate's destination array must hold every parameter");
+
+void ModulationMatrix::compile(const std::vector<ModulationRouting>& routings,
+                               std::function<bool(const ModulationRouting&)> include)
+{
+   std::vector<ModulationRouting> r;
+   r.reserve(routings.size());
+   for (auto& m : routings)
+   {
+      if (m.source_id < 0 || m.source_id >= n_modsources || m.destination_id < 0)
+         continue;
+      if (include && !include(m))
+         continue;
+      r.push_back(m);
+   }
+
+   // Keep the patch order within a destination so the sums come out the same
+   std::stable_sort(r.begin(), r.end(), [](const ModulationRouting& a, const ModulationRouting& b) {
+      return a.destination_id < b.destination_id;
+   });
+
+   count = r.size();
+   sources.clear();
+   destination.clear();
+   roundWidth.clear();
+   sourceIndex.clear();
+   depth.clear();
+
+   int slotForSource[n_modsources];
+   for (int i = 0; i < n_modsources; i++)
+      slotForSource[i] = -1;
+
+   // Each destination's run of routings in r, then the destinations with the most first
+   std::vector<std::pair<int, int>> runs;
+   for (int i = 0; i < count; i++)
+   {
+      int src = r[i].source_id;
+      if (slotForSource[src] < 0)
+      {
+         slotForSource[src] = sources.size();
+         sources.push_back(src);
+      }
+      if (runs.empty() || r[runs.back().first].destination_id != r[i].destination_id)
+         runs.push_back(std::make_pair(i, 0));
+      runs.back().second++;
+   }
+   std::stable_sort(runs.begin(), runs.end(),
+                    [](const std::pair<int, int>& a, const std::pair<int, int>& b) {
+                       return a.second > b.second;
+                    });
+
+   nDest = runs.size();
+   for (auto& run : runs)
+      destination.push_back(r[run.first].destination_id);
+
+   int padSource = sources.size();
+   for (int k = 0; nDest > 0 && k < runs[0].second; k++)
+   {
+      int w = 0;
+      while (w < nDest && runs[w].second > k)
+         w++;
+      int w4 = (w + 3) & ~3;
+      roundWidth.push_back(w4);
+      for (int j = 0; j < w4; j++)
+      {
+         if (j < w)
+         {
+            auto& m = r[runs[j].first + k];
+            sourceIndex.push_back(slotForSource[m.source_id]);
+            depth.push_back(m.depth);
+         }
+         else
+         {
+            sourceIndex.push_back(padSource);
+            depth.push_back(0.f);
+         }
+      }
+   }
+}
@@ -0,0 +1,96 @@
+/*
+** Surge Synthesizer is Free and Open Source Software
+**
+** Surge is made available under the Gnu General Public License, v3.0
+** https://www.gnu.org/licenses/gpl-3.0.en.html
+**
+** Copyright 2004-2020 by various individuals as described by the Git transaction log
+**
+** All source at: https://github.com/surge-synthesizer/surge.git
+**
+** Surge was a commercial product from 2004-2018, with Copyright and ownership
+** in that period held by Claes Johanson at Vember Audio. Claes made Surge
+** open source in September 2018.
+*/
+
+#pragma once
+
+#include "globals.h"
+#include "Parameter.h"
+#include "ModulationSource.h"
+#include <vector>
+#include <functional>
+#include <cstdint>
+
+/*
+** ModulationMatrix is a list of modulation routings compiled for evaluation. It is built when the
+** routings are published (see ModRoutingSnapshot) and never changes afterwards.
+**
+** The routings are grouped by destination, keeping the patch order within a destination, and
+** the destinations are ordered by how many routings they have, most first. Round k then holds
+** the k-th routing of every destination which has more than k, which are the first
+** roundWidth[k] destinations. accumulate() loads the modulated parameters into a contiguous
+** array, adds each round to it four destinations at a time with one SSE multiply and add, and
+** writes them back. Each destination still sums its routings in patch order, so the result is
+** the same as looping over the ModulationRouting vector.
+*/
+class ModulationMatrix
+{
+public:
+   void compile(const std::vector<ModulationRouting>& routings,
+                std::function<bool(const ModulationRouting&)> include = nullptr);
+
+   /*
+   ** target[dst].f += depth * modsources[src]->output, for every routing. Sources which are
+   ** null in modsources contribute nothing.
+   */
+   inline void accumulate(pdata* target, ModulationSource* const* modsources) const
+   {
+      if (count == 0)
+         return;
+
+      // The last slot is the source of the rounds' padding
+      float out[n_modsources + 1];
+      int ns = sources.size();
+      for (int i = 0; i < ns; i++)
+      {
+         auto* ms = modsources[sources[i]];
+         out[i] = ms ? ms->output : 0.f;
+      }
+      out[ns] = 0.f;
+
+      float acc alignas(16)[max_destinations];
+      const int* di = destination.data();
+      for (int j = 0; j < nDest; j++)
+         acc[j] = target[di[j]].f;
+
+      const int* si = sourceIndex.data();
+      const float* dp = depth.data();
+      for (auto w : roundWidth)
+      {
+         for (int j = 0; j < w; j += 4, si += 4, dp += 4)
+         {
+            __m128 o = _mm_setr_ps(out[si[0]], out[si[1]], out[si[2]], out[si[3]]);
+            __m128 a = _mm_load_ps(acc + j);
+            _mm_store_ps(acc + j, _mm_add_ps(a, _mm_mul_ps(o, _mm_loadu_ps(dp))));
+         }
+      }
+
+      for (int j = 0; j < nDest; j++)
+         target[di[j]].f = acc[j];
+   }
+
+   // Every parameter could be a destination; ModulationMatrix.cpp checks this covers them
+   static constexpr int max_destinations = 1024;
+
+   bool empty() const { return count == 0; }
+   int size() const { return count; }
+
+private:
+   int count = 0, nDest = 0;
+   std::vector<int> sources;     // distinct modsources used, indexed by sourceIndex
+   std::vector<int> destination; // distinct destinations, by number of routings
+   std::vector<int> roundWidth;  // destinations in each round, rounded up to a multiple of 4
+   std::vector<int> sourceIndex; // the rounds one after the other
+   std::vector<float> depth;
+};
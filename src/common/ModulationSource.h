@@ -441,18 +441,32 @@ public:
       output = 0.f;
       bipolar = false;
    }
+
+   void set_blocksize(int bs)
+   {
+      blockSize = bs;
+   }
+
+   /*
+   ** The smoothing rates are per block of 32 samples at 44.1k. Larger blocks take one such step
+   ** per 32 samples, and smaller ones a part step, so the glide takes the same time at any
+   ** block size.
+   */
    inline void processSmoothing( SmoothingMode mode, float sigma )
    {
       if (mode == LEGACY || mode == SLOW_EXP || mode == FAST_EXP)
       {
-         float b = fabs(target - output);
-         if (b < sigma && mode != LEGACY)
-         {
-            output = target;
-         }
-         else
+         const int steps = blockSize > 32 ? blockSize / 32 : 1;
+         const float part = blockSize < 32 ? blockSize / 32.f : 1.f;
+         for (int i = 0; i < steps; ++i)
          {
-            float a = (mode == FAST_EXP ? 0.99f : 0.9f) * 44100 * samplerate_inv * b;
+            float b = fabs(target - output);
+            if (b < sigma && mode != LEGACY)
+            {
+               output = target;
+               break;
+            }
+            float a = (mode == FAST_EXP ? 0.99f : 0.9f) * 44100 * samplerate_inv * part * b;
             output = (1 - a) * output + a * target;
          }
          return;
@@ -462,10 +476,10 @@ public:
          /*
           * Apply a constant change until we get there.
           * Rate is set so we cover the entire range (0,1)
-          * in 50 blocks at 44k
+          * in 50 blocks of 32 samples at 44k
           */
          float sampf = samplerate / 44100;
-         float da = ( target - startingpoint ) / ( 50 * sampf );
+         float da = ( target - startingpoint ) * blockSize / ( 50 * 32 * sampf );
          float b = target - output;
          if( fabs( b ) < fabs( da ) )
          {
@@ -509,6 +523,7 @@ public:
    int id; // can be used to assign the controller to a parameter id
    bool bipolar;
    bool changed;
+   int blockSize = BLOCK_SIZE_DEFAULT;
 
 
 };
@@ -1333,14 +1333,14 @@ void SurgePatch::load_xml(const void* data, int datasize, bool is_preset)
       {
          std::string mvname = "monoVoicePrority_" + std::to_string(sc);
          auto *mv1 = TINYXML_SAFE_TO_ELEMENT(nonparamconfig->FirstChild( mvname.c_str() ));
-         storage->getPatch().scene[sc].monoVoicePriorityMode = ALWAYS_LATEST;
+         scene[sc].monoVoicePriorityMode = ALWAYS_LATEST;
          if( mv1 )
          {
             // Get value
             int mvv;
             if( mv1->QueryIntAttribute("v", &mvv ) == TIXML_SUCCESS )
             {
-               storage->getPatch().scene[sc].monoVoicePriorityMode = (MonoVoicePriorityMode)mvv;
+               scene[sc].monoVoicePriorityMode = (MonoVoicePriorityMode)mvv;
             }
          }
       }
@@ -1804,6 +1804,11 @@ void SurgePatch::load_xml(const void* data, int datasize, bool is_preset)
               p->QueryIntAttribute("v",&ival) == TIXML_SUCCESS)
              dawExtraState.monoPedalMode = ival;
 
+          p = TINYXML_SAFE_TO_ELEMENT(de->FirstChild("filterQuality"));
+          if( p &&
+              p->QueryIntAttribute("v",&ival) == TIXML_SUCCESS)
+             dawExtraState.filterQuality = ival;
+
 
           p = TINYXML_SAFE_TO_ELEMENT(de->FirstChild("hasTuning"));
            if( p &&
@@ -2032,7 +2037,7 @@ unsigned int SurgePatch::save_xml(void** data) // allocates mem, must be freed b
    {
       std::string mvname = "monoVoicePrority_" + std::to_string(sc);
       TiXmlElement mvv(mvname.c_str());
-      mvv.SetAttribute("v", storage->getPatch().scene[sc].monoVoicePriorityMode);
+      mvv.SetAttribute("v", scene[sc].monoVoicePriorityMode);
       nonparamconfig.InsertEndChild(mvv);
    }
    patch.InsertEndChild(nonparamconfig);
@@ -2178,6 +2183,10 @@ unsigned int SurgePatch::save_xml(void** data) // allocates mem, must be freed b
        mpm.SetAttribute("v", dawExtraState.monoPedalMode );
        dawExtraXML.InsertEndChild(mpm);
 
+       TiXmlElement fq("filterQuality");
+       fq.SetAttribute("v", dawExtraState.filterQuality );
+       dawExtraXML.InsertEndChild(fq);
+
        TiXmlElement tun("hasTuning");
        tun.SetAttribute("v", dawExtraState.hasTuning ? 1 : 0 );
        dawExtraXML.InsertEndChild(tun);
@@ -24,6 +24,7 @@
 #include <queue>
 #include <vt_dsp/vt_dsp_endian.h>
 #include "UserDefaults.h"
+#include "util/MappedFile.h"
 #if MAC
 #include <cstdlib>
 #include <sys/stat.h>
@@ -51,6 +52,7 @@
 
 // FIXME probably remove this when we remove the hardcoded hack below
 #include "MSEGModulationHelper.h"
+#include "FilterCoefficientMemo.h"
 // FIXME
 
 #if __cplusplus < 201703L
@@ -58,11 +60,10 @@ constexpr float MSEGStorage::minimumDuration;
 #endif
 
 float sinctable alignas(16)[(FIRipol_M + 1) * FIRipol_N * 2];
+float sinctableAVX alignas(32)[(FIRipol_M + 1) * FIRipol_N * 2];
 float sinctable1X alignas(16)[(FIRipol_M + 1) * FIRipol_N];
 short sinctableI16 alignas(16)[(FIRipol_M + 1) * FIRipolI16_N];
 float table_dB alignas(16)[512],
-      table_envrate_lpf alignas(16)[512],
-      table_envrate_linear alignas(16)[512],
       table_glide_exp alignas(16)[512],
       table_glide_log alignas(16)[512];
 float waveshapers alignas(16)[n_ws_types][1024];
@@ -80,7 +81,18 @@ void dummyExportedWindowsToLookupDLL() {
 
 SurgeStorage::SurgeStorage(std::string suppliedDataPath) : otherscene_clients(0)
 {
+   setBlockSize(BLOCK_SIZE_DEFAULT);
+   table_pitch = tuningTables[0].pitch;
+   table_pitch_inv = tuningTables[0].pitchInv;
+   table_note_omega = tuningTables[0].noteOmega;
+
+   acquireWavetableMipmapWorker();
    _patch.reset(new SurgePatch(this));
+   livePatch.store(_patch.get());
+   publishModRouting();
+   for (auto& m : filterCoefficientMemo)
+      m.reset(new FilterCoefficientMemo());
+   acquireModRoutingForAudio();
 
    float cutoff = 0.455f;
    float cutoff1X = 0.85f;
@@ -107,6 +119,25 @@ SurgeStorage::SurgeStorage(std::string suppliedDataPath) : otherscene_clients(0)
       }
    }
 
+   // Each row of sinctableAVX is taps 0-7, their deltas, then taps 8-11 and their deltas, so
+   // every row starts on a 32 byte boundary and the three loads are aligned
+   static_assert(FIRipol_N == 12, "sinctableAVX assumes 12 taps");
+   for (j = 0; j < FIRipol_M + 1; j++)
+   {
+      float* row = &sinctableAVX[j * FIRipol_N * 2];
+      const float* src = &sinctable[j * FIRipol_N * 2];
+      for (int i = 0; i < 8; i++)
+      {
+         row[i] = src[i];
+         row[8 + i] = src[FIRipol_N + i];
+      }
+      for (int i = 0; i < 4; i++)
+      {
+         row[16 + i] = src[8 + i];
+         row[20 + i] = src[FIRipol_N + 8 + i];
+      }
+   }
+
    for (j = 0; j < FIRipol_M + 1; j++)
    {
       for (int i = 0; i < FIRipolI16_N; i++)
@@ -171,7 +202,7 @@ SurgeStorage::SurgeStorage(std::string suppliedDataPath) : otherscene_clients(0)
       for (int cc = 0; cc < 128; cc++)
          poly_aftertouch[s][cc] = 0.f;
 
-   memset(&audio_in[0][0], 0, 2 * BLOCK_SIZE_OS * sizeof(float));
+   memset(&audio_in[0][0], 0, 2 * BLOCK_SIZE_OS_MAX * sizeof(float));
 
    bool hasSuppliedDataPath = false;
    if(suppliedDataPath.size() != 0)
@@ -399,6 +430,15 @@ bailOnPortable:
    userFXPath = Surge::Storage::appendDirectory(userDataPath, "FXSettings");
    
    userMidiMappingsPath = Surge::Storage::appendDirectory(userDataPath, "MIDIMappings");
+
+   if (Surge::Storage::getUserDefaultValue(this, "wavetableMipmapCache", 0))
+   {
+      auto cachePath = Surge::Storage::appendDirectory(userDataPath, "WavetableCache");
+      std::error_code ec;
+      fs::create_directories(string_to_path(cachePath), ec);
+      if (!ec)
+         setWavetableMipmapCacheDirectory(cachePath);
+   }
    
 #if LINUX
    if (!snapshotloader.Parse((const char*)&configurationXmlStart, 0,
@@ -437,7 +477,12 @@ bailOnPortable:
 
    // WindowWT is a WaveTable which now has a constructor so don't do this
    // memset(&WindowWT, 0, sizeof(WindowWT));
-   if( loadWtAndPatch && ! load_wt_wt(datapath + "windows.wt", &WindowWT) )
+   if( loadWtAndPatch && load_wt_wt(datapath + "windows.wt", &WindowWT) )
+   {
+      // Every window oscillator reads these, at every level, so don't wait to be asked
+      WindowWT.completeMipmaps();
+   }
+   else if( loadWtAndPatch )
    {
       WindowWT.size = 0;
       std::ostringstream oss;
@@ -534,7 +579,7 @@ bailOnPortable:
    {
       for( int i = 0; i < n_lfos; ++i )
       {
-         auto ms = &(_patch->msegs[s][i]);
+         auto ms = &(getPatch().msegs[s][i]);
          Surge::MSEG::createInitMSEG(ms);
          Surge::MSEG::rebuildCache( ms );
       }
@@ -543,11 +588,14 @@ bailOnPortable:
    monoPedalMode = (MonoPedalMode)Surge::Storage::getUserDefaultValue(this,
                                                                       "monoPedalMode",
                                                                       MonoPedalMode::HOLD_ALL_NOTES );
+   filterQuality = (FilterQuality)Surge::Storage::getUserDefaultValue(this,
+                                                                      "filterQuality",
+                                                                      FILTER_QUALITY_STANDARD );
 }
 
 SurgePatch& SurgeStorage::getPatch()
 {
-   return *_patch.get();
+   return *livePatch.load(std::memory_order_acquire);
 }
 
 struct PEComparer
@@ -954,21 +1002,42 @@ void SurgeStorage::load_wt(string filename, Wavetable* wt, OscillatorStorage *os
    }
 }
 
+/*
+** .wt files are mapped rather than read, so a float table is used in place, and only get their
+** base level built up front; the oscillators ask for the mip levels they need as they play.
+*/
 bool SurgeStorage::load_wt_wt(string filename, Wavetable* wt)
 {
-   FILE* f = fopen(filename.c_str(), "rb");
-   if (!f)
-      return false;
+   size_t fileBytes = 0;
+   auto mapping = Surge::Util::mapFileReadOnly(filename, fileBytes);
+
+   FILE* f = nullptr;
+   if (!mapping)
+   {
+      f = fopen(filename.c_str(), "rb");
+      if (!f)
+         return false;
+   }
+
    wt_header wh;
    memset(&wh, 0, sizeof(wt_header));
 
-   size_t read = fread(&wh, sizeof(wt_header), 1, f);
+   if (mapping)
+   {
+      if (fileBytes >= sizeof(wt_header))
+         memcpy(&wh, mapping.get(), sizeof(wt_header));
+   }
+   else
+   {
+      size_t read = fread(&wh, sizeof(wt_header), 1, f);
+   }
    // I'm not sure why this ever worked but it is checking the 4 bytes against vawt so...
    // if (wh.tag != vt_read_int32BE('vawt'))
    if (!(wh.tag[0] == 'v' && wh.tag[1] == 'a' && wh.tag[2] == 'w' && wh.tag[3] == 't'))
    {
       // SOME sort of error reporting is appropriate
-      fclose(f);
+      if (f)
+         fclose(f);
       return false;
    }
 
@@ -979,14 +1048,37 @@ bool SurgeStorage::load_wt_wt(string filename, Wavetable* wt)
    else
       ds = sizeof(float) * vt_read_int16LE(wh.n_tables) * vt_read_int32LE(wh.n_samples);
 
-   data = malloc(ds);
-   read = fread(data, 1, ds, f);
-   // FIXME - error if read != ds
+   if (mapping)
+   {
+      if (fileBytes < sizeof(wt_header) + ds)
+      {
+         // A truncated file; it can't be used in place, so read what there is like we used to
+         mapping = nullptr;
+         f = fopen(filename.c_str(), "rb");
+         if (!f)
+            return false;
+         fseek(f, sizeof(wt_header), SEEK_SET);
+      }
+   }
+
+   if (mapping)
+   {
+      data = (char*)mapping.get() + sizeof(wt_header);
+   }
+   else
+   {
+      data = malloc(ds);
+      size_t read = fread(data, 1, ds, f);
+      // FIXME - error if read != ds
+   }
 
    waveTableDataMutex.lock();
-   bool wasBuilt = wt->BuildWT(data, wh, false);
+   bool wasBuilt = wt->BuildWT(data, wh, false, mapping, true);
    waveTableDataMutex.unlock();
-   free(data);
+   if (!mapping)
+      free(data);
+   if (f)
+      fclose(f);
 
    if (!wasBuilt)
    {
@@ -1000,10 +1092,8 @@ bool SurgeStorage::load_wt_wt(string filename, Wavetable* wt)
            << " https://github.com/surge-synthesizer/surge/";
        Surge::UserInteractions::promptError( oss.str(),
                                              "Wavetable Loading Error" );
-       fclose(f);
        return false;
    }
-   fclose(f);
    return true;
 }
 int SurgeStorage::get_clipboard_type()
@@ -1277,6 +1367,7 @@ void SurgeStorage::clipboard_paste(int type, int scene, int entry)
       }
    }
 
+   publishModRouting();
    modRoutingMutex.unlock();
 }
 
@@ -1369,32 +1460,160 @@ void SurgeStorage::load_midi_controllers()
 }
 
 SurgeStorage::~SurgeStorage()
-{}
+{
+   delete modRoutingCurrent.load();
+   delete stagedModRouting;
+   for (auto r : modRoutingRetired)
+      delete r;
+   releaseWavetableMipmapWorker();
+}
+
+ModRoutingSnapshot* SurgeStorage::buildModRouting(SurgePatch& patch)
+{
+   auto snap = new ModRoutingSnapshot();
+   for (int sc = 0; sc < n_scenes; sc++)
+   {
+      snap->scene[sc] = patch.scene[sc].modulation_scene;
+      snap->voice[sc] = patch.scene[sc].modulation_voice;
+   }
+   snap->global = patch.modulation_global;
+   snap->compile();
+   return snap;
+}
+
+void SurgeStorage::publishModRouting()
+{
+   std::lock_guard<std::recursive_mutex> mg(modRoutingMutex);
+
+   reclaimCommittedModRouting();
+
+   auto prior = modRoutingCurrent.exchange(buildModRouting(getPatch()));
+   if (prior)
+      modRoutingRetired.push_back(prior);
+
+   freeRetiredModRouting();
+}
+
+void SurgeStorage::reclaimCommittedModRouting()
+{
+   // A commit leaves the routings it replaced in stagedModRouting for us to retire
+   if (patchStageState.load() == ps_committed && stagedModRouting)
+   {
+      modRoutingRetired.push_back(stagedModRouting);
+      stagedModRouting = nullptr;
+   }
+}
+
+void SurgeStorage::freeRetiredModRouting()
+{
+   /*
+   ** Anything retired is unreachable from modRoutingCurrent, so the audio thread can only still
+   ** be using the one it has announced in modRoutingInUse. acquireModRoutingForAudio() checks
+   ** modRoutingCurrent again after announcing, so it can't announce one we have already freed.
+   */
+   auto inUse = modRoutingInUse.load();
+   auto it = modRoutingRetired.begin();
+   while (it != modRoutingRetired.end())
+   {
+      if (*it != inUse)
+      {
+         delete *it;
+         it = modRoutingRetired.erase(it);
+      }
+      else
+         it++;
+   }
+}
+
+void SurgeStorage::stagePatch(std::unique_ptr<SurgePatch> p)
+{
+   auto snap = buildModRouting(*p);
+
+   std::lock_guard<std::recursive_mutex> mg(modRoutingMutex);
+
+   // The last staged patch has been committed, so what we hold is the patch it replaced
+   reclaimCommittedModRouting();
+   stagedModRouting = snap;
+   stagedPatchStorage = std::move(p);
+   patchStageState.store(ps_staged);
+
+   freeRetiredModRouting();
+}
+
+bool SurgeStorage::commitStagedPatch()
+{
+   if (patchStageState.load() != ps_staged)
+      return false;
+
+   _patch.swap(stagedPatchStorage);
+   livePatch.store(_patch.get(), std::memory_order_release);
+   stagedModRouting = modRoutingCurrent.exchange(stagedModRouting);
+   patchStageState.store(ps_outgoing);
+   return true;
+}
+
+void SurgeStorage::releaseOutgoingPatch()
+{
+   int expected = ps_outgoing;
+   patchStageState.compare_exchange_strong(expected, ps_committed);
+}
+
+void ModRoutingSnapshot::compile()
+{
+   for (int sc = 0; sc < n_scenes; sc++)
+   {
+      sceneMatrix[sc].compile(scene[sc]);
+      voiceMatrix[sc].compile(voice[sc]);
+      mpeAftertouchMatrix[sc].compile(scene[sc], [](const ModulationRouting& r) {
+         return r.source_id == ms_aftertouch && r.destination_id < n_scene_params;
+      });
+   }
+   globalMatrix.compile(global);
+}
+
+const ModRoutingSnapshot* SurgeStorage::acquireModRoutingForAudio()
+{
+   auto snap = modRoutingCurrent.load();
+   while (true)
+   {
+      modRoutingInUse.store(snap);
+      auto check = modRoutingCurrent.load();
+      if (check == snap)
+         return snap;
+      snap = check;
+   }
+}
 
 double shafted_tanh(double x)
 {
    return (exp(x) - exp(-x * 1.2)) / (exp(x) + exp(-x));
 }
 
+void SurgeStorage::setBlockSize(int bs)
+{
+   blockSize = bs;
+   blockSizeOS = bs * OSC_OVERSAMPLING;
+   blockSizeQuad = blockSize >> 2;
+   blockSizeOSQuad = blockSizeOS >> 2;
+   blockSizeInv = 1.f / blockSize;
+   blockSizeOSInv = 1.f / blockSizeOS;
+}
+
 void SurgeStorage::init_tables()
 {
    isStandardTuning = true;
+   tablesGeneration++;
+   fillTuningTables(tuningTables[liveTuningTables], nullptr);
    float db60 = powf(10.f, 0.05f * -60.f);
    float _512th = 1.f / 512.f;
    for (int i = 0; i < 512; i++)
    {
       table_dB[i] = powf(10.f, 0.05f * ((float)i - 384.f));
-      table_pitch[i] = powf(2.f, ((float)i - 256.f) * (1.f / 12.f));
       table_pitch_ignoring_tuning[i] = table_pitch[i];
-      table_pitch_inv[i] = 1.f / table_pitch[i];
       table_pitch_inv_ignoring_tuning[i] = table_pitch_inv[i];
-      table_note_omega[0][i] =
-          (float)sin(2 * M_PI * min(0.5, 440 * table_pitch[i] * dsamplerate_os_inv));
-      table_note_omega[1][i] =
-          (float)cos(2 * M_PI * min(0.5, 440 * table_pitch[i] * dsamplerate_os_inv));
       table_note_omega_ignoring_tuning[0][i] = table_note_omega[0][i];
       table_note_omega_ignoring_tuning[1][i] = table_note_omega[1][i];
-      double k = dsamplerate_os * pow(2.0, (((double)i - 256.0) / 16.0)) / (double)BLOCK_SIZE_OS;
+      double k = dsamplerate_os * pow(2.0, (((double)i - 256.0) / 16.0)) / (double)blockSizeOS;
       table_envrate_linear[i] = (float)(1.f / k);
       table_envrate_lpf[i] = (float)(1.f - exp(log(db60) / k));
       table_glide_log[i] = log2(1.0 + (i * _512th * 10.f)) / log2(1.f + 10.f);
@@ -1420,7 +1639,8 @@ void SurgeStorage::init_tables()
    // filter clamping)
    // 1.3
    nyquist_pitch = (float)12.f * log((0.75 * M_PI) / (dsamplerate_os_inv * 2 * M_PI * 440.0)) / log(2.0); // include some margin for error (and to avoid denormals in IIR filter clamping)
-   vu_falloff = 0.997f; // TODO should be sample rate-dependent (this is per 32-sample block at 44.1k)
+   // TODO should be sample rate-dependent (this is per 32-sample block at 44.1k)
+   vu_falloff = powf(0.997f, blockSize / 32.f);
 }
 
 float SurgeStorage::note_to_pitch(float x)
@@ -1536,7 +1756,7 @@ float lookup_waveshape_warp(int entry, float x)
    return (1 - a) * waveshapers[entry][e & 0x3ff] + a * waveshapers[entry][(e + 1) & 0x3ff];
 }
 
-float envelope_rate_lpf(float x)
+float SurgeStorage::envelope_rate_lpf(float x)
 {
    x *= 16.f;
    x += 256.f;
@@ -1546,7 +1766,7 @@ float envelope_rate_lpf(float x)
    return (1 - a) * table_envrate_lpf[e & 0x1ff] + a * table_envrate_lpf[(e + 1) & 0x1ff];
 }
 
-float envelope_rate_linear(float x)
+float SurgeStorage::envelope_rate_linear(float x)
 {
    x *= 16.f;
    x += 256.f;
@@ -1556,7 +1776,7 @@ float envelope_rate_linear(float x)
    return (1 - a) * table_envrate_linear[e & 0x1ff] + a * table_envrate_linear[(e + 1) & 0x1ff];
 }
 
-float envelope_rate_linear_nowrap(float x)
+float SurgeStorage::envelope_rate_linear_nowrap(float x)
 {
    x *= 16.f;
    x += 256.f;
@@ -1590,21 +1810,68 @@ bool SurgeStorage::retuneToScale(const Tunings::Scale& s)
 {
    currentScale = s;
    isStandardTuning = false;
+   tablesGeneration++;
 
    Tunings::Tuning t(currentScale, currentMapping);
+   fillTuningTables(tuningTables[liveTuningTables], &t);
    
-   for( int i=0; i<512; ++i )
+   return true;
+}
+
+// With no tuning, the standard tuning init_tables has always made
+void SurgeStorage::fillTuningTables(TuningTables& t, const Tunings::Tuning* tuning)
+{
+   for (int i = 0; i < 512; i++)
+   {
+      if (tuning)
+         t.pitch[i] = tuning->frequencyForMidiNoteScaledByMidi0(i - 256);
+      else
+         t.pitch[i] = powf(2.f, ((float)i - 256.f) * (1.f / 12.f));
+      t.pitchInv[i] = 1.f / t.pitch[i];
+      t.noteOmega[0][i] = (float)sin(2 * M_PI * min(0.5, 440 * t.pitch[i] * dsamplerate_os_inv));
+      t.noteOmega[1][i] = (float)cos(2 * M_PI * min(0.5, 440 * t.pitch[i] * dsamplerate_os_inv));
+   }
+}
+
+void SurgeStorage::stageTuningTables(const Tunings::Scale* s, const Tunings::KeyboardMapping* k)
+{
+   auto& t = tuningTables[1 - liveTuningTables];
+   stagedTuningIsStandard = !s;
+   if (!s)
    {
-      table_pitch[i] = t.frequencyForMidiNoteScaledByMidi0( i - 256 );
-      table_pitch_inv[i] = 1.f / table_pitch[i];
-      table_note_omega[0][i] =
-          (float)sin(2 * M_PI * min(0.5, 440 * table_pitch[i] * dsamplerate_os_inv));
-      table_note_omega[1][i] =
-          (float)cos(2 * M_PI * min(0.5, 440 * table_pitch[i] * dsamplerate_os_inv));
+      fillTuningTables(t, nullptr);
+      return;
+   }
+
+   Tunings::Tuning tuning(*s, k ? *k : currentMapping);
+   fillTuningTables(t, &tuning);
+}
+
+void SurgeStorage::commitStagedTuning(Tunings::Scale* s, Tunings::KeyboardMapping* k)
+{
+   liveTuningTables = 1 - liveTuningTables;
+   table_pitch = tuningTables[liveTuningTables].pitch;
+   table_pitch_inv = tuningTables[liveTuningTables].pitchInv;
+   table_note_omega = tuningTables[liveTuningTables].noteOmega;
+   tablesGeneration++;
 
+   if (stagedTuningIsStandard)
+   {
+      // As retuneToStandardTuning, which leaves the scale and mapping alone
+      isStandardTuning = true;
+      return;
+   }
+
+   // Swapping these only moves their strings' and vectors' buffers
+   std::swap(currentScale, *s);
+   isStandardTuning = false;
+   if (k)
+   {
+      std::swap(currentMapping, *k);
+      isStandardMapping = false;
+      tuningPitch = currentMapping.tuningFrequency / Tunings::MIDI_0_FREQ;
+      tuningPitchInv = 1.0 / tuningPitch;
    }
-   
-   return true;
 }
 
 bool SurgeStorage::remapToStandardKeyboard()
@@ -17,6 +17,7 @@
 #include "globals.h"
 #include "Parameter.h"
 #include "ModulationSource.h"
+#include "ModulationMatrix.h"
 #include "Wavetable.h"
 #include <vector>
 #include <memory>
@@ -84,11 +85,11 @@ const int FIRoffsetI16 = FIRipolI16_N >> 1;
 const int ff_revision = 15;
 
 extern float sinctable alignas(16)[(FIRipol_M + 1) * FIRipol_N * 2];
+// sinctable rearranged for 8 wide loads; see AbstractBlitOscillator::flush_impulses
+extern float sinctableAVX alignas(32)[(FIRipol_M + 1) * FIRipol_N * 2];
 extern float sinctable1X alignas(16)[(FIRipol_M + 1) * FIRipol_N];
 extern short sinctableI16 alignas(16)[(FIRipol_M + 1) * FIRipolI16_N];
-extern float table_envrate_lpf alignas(16)[512],
-             table_envrate_linear alignas(16)[512],
-             table_glide_exp alignas(16)[512],
+extern float table_glide_exp alignas(16)[512],
              table_glide_log alignas(16)[512];
 extern float table_note_omega alignas(16)[2][512];
 extern float samplerate, samplerate_inv;
@@ -456,6 +457,20 @@ enum MonoPedalMode {
    RELEASE_IF_OTHERS_HELD
 };
 
+/*
+ * How much the nonlinear filters (the vintage ladders, K35, diode ladder and OB-Xd 24 dB)
+ * spend on each sample; see GetQFPtrFilterUnit.
+ *
+ * FILTER_QUALITY_STANDARD (the default) runs them as designed.
+ *
+ * FILTER_QUALITY_ECONOMY swaps in cheaper rational saturators and takes fewer solver steps,
+ * for a response within a fraction of a dB of the standard one.
+ */
+enum FilterQuality {
+   FILTER_QUALITY_STANDARD,
+   FILTER_QUALITY_ECONOMY
+};
+
 enum MonoVoicePriorityMode {
    NOTE_ON_LATEST_RETRIGGER_HIGHEST, // The legacy mode for 1.7.1 and earlier
    ALWAYS_LATEST, // Could also be called "NOTE_ON_LATEST_RETRIGGER_LATEST"
@@ -702,6 +717,7 @@ struct DAWExtraStateStorage
    std::unordered_map<int, int> customcontrol_map; // custom controller number -> midicontrol
 
    int monoPedalMode = 0;
+   int filterQuality = 0;
 };
 
 
@@ -712,7 +728,28 @@ struct PatchTuningStorage
    std::string mappingContents = "";
 };
 
+/*
+** An immutable copy of every modulation routing in the patch, which is what the audio thread
+** reads. The editable vectors in SurgePatch and SurgeSceneStorage belong to the UI, host and
+** patch loading code; they change them under modRoutingMutex and then call
+** SurgeStorage::publishModRouting() which builds a new snapshot and swaps it in atomically.
+**
+** Along with the routings themselves a snapshot carries them compiled into ModulationMatrix form,
+** which is what the per block evaluation in processControl and SurgeVoice uses.
+*/
+struct ModRoutingSnapshot
+{
+   std::vector<ModulationRouting> scene[n_scenes], voice[n_scenes], global;
+
+   ModulationMatrix sceneMatrix[n_scenes], voiceMatrix[n_scenes], globalMatrix;
+   // Scene level channel aftertouch routings, which voices apply themselves in MPE mode
+   ModulationMatrix mpeAftertouchMatrix[n_scenes];
+
+   void compile();
+};
+
 class SurgeStorage;
+class FilterCoefficientMemo;
 
 class SurgePatch
 {
@@ -828,16 +865,28 @@ enum surge_copysource
 class alignas(16) SurgeStorage
 {
 public:
-   float audio_in alignas(16)[2][BLOCK_SIZE_OS];
-   float audio_in_nonOS alignas(16)[2][BLOCK_SIZE];
-   float audio_otherscene alignas(16)[2][BLOCK_SIZE_OS]; // this will be a pointer to an aligned 2 x BLOCK_SIZE_OS array
+   float audio_in alignas(16)[2][BLOCK_SIZE_OS_MAX];
+   float audio_in_nonOS alignas(16)[2][BLOCK_SIZE_MAX];
+   float audio_otherscene alignas(16)[2][BLOCK_SIZE_OS_MAX]; // this will be a pointer to an aligned 2 x BLOCK_SIZE_OS array
    //	float sincoffset alignas(16)[(FIRipol_M)*FIRipol_N];	// deprecated
 
 
    SurgeStorage(std::string suppliedDataPath="");
-   float table_pitch alignas(16)[512];
-   float table_pitch_inv alignas(16)[512];
-   float table_note_omega alignas(16)[2][512];
+
+   /*
+   ** The tuned pitch and omega tables. They point into one of tuningTables; a gapless patch
+   ** switch builds the incoming patch's tuning into the other on the staging thread
+   ** (stageTuningTables) and the commit just points these at it (commitStagedTuning).
+   */
+   struct TuningTables
+   {
+      float pitch alignas(16)[512];
+      float pitchInv alignas(16)[512];
+      float noteOmega alignas(16)[2][512];
+   };
+   float* table_pitch;
+   float* table_pitch_inv;
+   float (*table_note_omega)[512];
    float table_pitch_ignoring_tuning alignas(16)[512];
    float table_pitch_inv_ignoring_tuning alignas(16)[512];
    float table_note_omega_ignoring_tuning alignas(16)[2][512];
@@ -850,10 +899,22 @@ public:
 
    float pitch_bend;
 
+   /*
+   ** This instance's block size, from BLOCK_SIZE_MIN to BLOCK_SIZE_MAX (see globals.h), and the
+   ** sizes derived from it. SurgeSynthesizer::setBlockSize sets it through setBlockSize, which
+   ** init_tables has to follow since the envelope rate tables are per block.
+   */
+   int blockSize, blockSizeOS, blockSizeQuad, blockSizeOSQuad;
+   float blockSizeInv, blockSizeOSInv;
+   void setBlockSize(int bs);
+
    float vu_falloff;
    float temposyncratio, temposyncratio_inv; // 1.f is 120 BPM
    double songpos;
    void init_tables();
+   float envelope_rate_lpf(float);
+   float envelope_rate_linear(float);
+   float envelope_rate_linear_nowrap(float);
    float nyquist_pitch;
    int last_key[2]; // TODO: FIX SCENE ASSUMPTION?
    TiXmlElement* getSnapshotSection(const char* name);
@@ -918,7 +979,50 @@ public:
 
    // float table_sin[512],table_sin_offset[512];
    std::mutex waveTableDataMutex;
+   // Serializes edits of the routing vectors. The audio thread never takes it; see ModRoutingSnapshot
    std::recursive_mutex modRoutingMutex;
+
+   /*
+   ** Publish the current routing vectors as a new snapshot. Old snapshots are freed here (never
+   ** on the audio thread) once the audio thread has moved off them.
+   */
+   void publishModRouting();
+
+   /*
+   ** Called by the audio thread once per block. The returned snapshot, which is also what
+   ** audioModRouting() returns until the next call, stays alive until the audio thread acquires
+   ** again. Only one thread may read routings this way.
+   */
+   const ModRoutingSnapshot* acquireModRoutingForAudio();
+   const ModRoutingSnapshot* audioModRouting() const
+   {
+      return modRoutingInUse.load(std::memory_order_relaxed);
+   }
+
+   /*
+   ** Gapless patch switching. A loading thread builds a complete SurgePatch and hands it over with
+   ** stagePatch(), which also compiles its routings. The audio thread swaps it in at a block
+   ** boundary with commitStagedPatch(), which neither allocates nor frees, and getPatch() returns
+   ** it from then on. The patch it replaces, and its routings, stay with the voices still playing
+   ** it (outgoingPatch()) until the audio thread calls releaseOutgoingPatch(), and after that are
+   ** kept until the next stagePatch() since the UI may still be looking at them. Only one patch
+   ** may be staged at a time; wait for the outgoing one to be released before staging the next.
+   */
+   void stagePatch(std::unique_ptr<SurgePatch> p);
+   SurgePatch* stagedPatch()
+   {
+      return patchStageState.load() == ps_staged ? stagedPatchStorage.get() : nullptr;
+   }
+   bool commitStagedPatch();
+   SurgePatch* outgoingPatch()
+   {
+      return patchStageState.load() == ps_outgoing ? stagedPatchStorage.get() : nullptr;
+   }
+   const ModRoutingSnapshot* outgoingModRouting()
+   {
+      return patchStageState.load() == ps_outgoing ? stagedModRouting : nullptr;
+   }
+   void releaseOutgoingPatch();
    Wavetable WindowWT;
 
    float note_to_pitch(float x);
@@ -940,6 +1044,15 @@ public:
    bool retuneToScale(const Tunings::Scale& s);
    bool retuneToStandardTuning() { init_tables(); return true; }
 
+   /*
+   ** Build the tables for a scale (and a mapping, or the current one when that's null), or for
+   ** standard tuning when the scale is null, into the tuning tables which aren't live. Then
+   ** commitStagedTuning makes them live, swapping the scale and mapping in from the same
+   ** pointers; it doesn't allocate, so it can run on the audio thread.
+   */
+   void stageTuningTables(const Tunings::Scale* s, const Tunings::KeyboardMapping* k);
+   void commitStagedTuning(Tunings::Scale* s, Tunings::KeyboardMapping* k);
+
    bool remapToKeyboard(const Tunings::KeyboardMapping &k);
    bool remapToStandardKeyboard();
    inline int scaleConstantNote() { return currentMapping.tuningConstantNote; }
@@ -958,6 +1071,45 @@ public:
        ControllerModulationSource::SmoothingMode::LEGACY;
    float mpePitchBendRange = -1.0f;
 
+   /*
+   ** Lets the sine oscillator run its unison voices four at a time, the wavetable one batch its
+   ** voices' impulses and the window one render its grains four at a time. Off, each runs one
+   ** voice at a time. Set with SurgeSynthesizer::setBatchOscillatorUnison.
+   */
+   bool batchOscillatorUnison = true;
+
+   /*
+   ** Lets the voices skip the oscillators which can't be heard in a block (see
+   ** SurgeVoice::update_osc_activity). Set with SurgeSynthesizer::setSkipSilentOscillators.
+   */
+   bool skipSilentOscillators = true;
+
+   /*
+   ** Make the voices' filter coefficients four voices at a time once a scene's voices have
+   ** been processed (see SurgeVoice::makeQuadFilterCoefficients) rather than in each voice.
+   ** Set with SurgeSynthesizer::setQuadFilterCoefficients.
+   */
+   bool quadFilterCoefficients = true;
+
+   /*
+   ** Each scene's memo of the coefficients of the expensive filter types (see
+   ** FilterCoefficientMemo.h), used by its voices when memoizeFilterCoefficients is set. Set
+   ** with SurgeSynthesizer::setMemoizeFilterCoefficients.
+   */
+   bool memoizeFilterCoefficients = true;
+   std::unique_ptr<FilterCoefficientMemo> filterCoefficientMemo[n_scenes];
+
+   /*
+   ** Leave the voices' filter registers in their quad lanes between blocks, rather than copying
+   ** them out and back in every block (see FilterLaneScheduler.h). Set with
+   ** SurgeSynthesizer::setKeepFilterStateInLanes.
+   */
+   bool keepFilterStateInLanes = true;
+
+   // Bumped whenever init_tables, retuneToScale or commitStagedTuning change the pitch and omega
+   // tables
+   int tablesGeneration = 0;
+
    std::atomic<int> otherscene_clients;
 
    std::unordered_map<int, std::string> helpURL_controlgroup;
@@ -968,8 +1120,16 @@ public:
 
    int subtypeMemory[n_scenes][n_filterunits_per_scene][n_fu_types];
    MonoPedalMode monoPedalMode = HOLD_ALL_NOTES;
+   FilterQuality filterQuality = FILTER_QUALITY_STANDARD;
 
 private:
+   float table_envrate_lpf alignas(16)[512], table_envrate_linear alignas(16)[512];
+
+   TuningTables tuningTables[2];
+   int liveTuningTables = 0;
+   bool stagedTuningIsStandard = false;
+   void fillTuningTables(TuningTables& t, const Tunings::Tuning* tuning);
+
    TiXmlDocument snapshotloader;
    std::vector<Parameter> clipboard_p;
    int clipboard_type;
@@ -978,6 +1138,27 @@ private:
    std::vector<ModulationRouting> clipboard_modulation_scene, clipboard_modulation_voice;
    Wavetable clipboard_wt[n_oscs];
 
+   // The published routings, and the one the audio thread holds (its hazard pointer)
+   std::atomic<ModRoutingSnapshot*> modRoutingCurrent{nullptr}, modRoutingInUse{nullptr};
+   std::vector<ModRoutingSnapshot*> modRoutingRetired; // guarded by modRoutingMutex
+   ModRoutingSnapshot* buildModRouting(SurgePatch& patch);
+   void reclaimCommittedModRouting();
+   void freeRetiredModRouting();
+
+   // The staged patch and its routings or, once committed, the ones they replaced
+   enum PatchStageState
+   {
+      ps_idle = 0,
+      ps_staged,
+      ps_outgoing,
+      ps_committed,
+   };
+   std::atomic<int> patchStageState{ps_idle};
+   std::unique_ptr<SurgePatch> stagedPatchStorage;
+   ModRoutingSnapshot* stagedModRouting = nullptr;
+   // What getPatch() returns. _patch owns it, but is swapped by the audio thread at a commit
+   std::atomic<SurgePatch*> livePatch{nullptr};
+
 public:
    // whether to skip loading, desired while exporting manifests. Only used by LV2 currently.
    static bool skipLoadWtAndPatch;
@@ -986,9 +1167,6 @@ public:
 float db_to_linear(float);
 float lookup_waveshape(int, float);
 float lookup_waveshape_warp(int, float);
-float envelope_rate_lpf(float);
-float envelope_rate_linear(float);
-float envelope_rate_linear_nowrap(float);
 float glide_log(float);
 float glide_exp(float);
 
@@ -51,6 +51,9 @@
 #include "SurgeParamConfig.h"
 
 #include "UserDefaults.h"
+#include "util/RealtimeWorker.h"
+#include "util/WorkerSemaphore.h"
+#include "util/AllocationCheck.h"
 #include "filesystem/import.h"
 #include "effect/Effect.h"
 
@@ -84,6 +87,7 @@ SurgeSynthesizer::SurgeSynthesizer(PluginLayer* parent, std::string suppliedData
    // TODO: FIX NUMBER OF FX ASSUMPTION
    memset(fx, 0, sizeof(void*) * 8);
    srand((unsigned)time(nullptr));
+   seedSceneRandom((unsigned)rand());
    // TODO: FIX SCENE ASSUMPTION
    memset(storage.getPatch().scenedata[0], 0, sizeof(pdata) * n_scene_params);  
    memset(storage.getPatch().scenedata[1], 0, sizeof(pdata) * n_scene_params);
@@ -97,21 +101,23 @@ SurgeSynthesizer::SurgeSynthesizer(PluginLayer* parent, std::string suppliedData
       fx_reload[i] = false;
    }
 
-   allNotesOff();
-
-   for (int i = 0; i < MAX_VOICES; i++)
+   for (int sc = 0; sc < n_scenes; sc++)
    {
-      voices_usedby[0][i] = 0;
-      voices_usedby[1][i] = 0;
+      voices[sc].assignSlots(voices_array[sc].data());
+      outgoingVoices[sc].assignSlots(voices_array[sc].data());
    }
 
+   allNotesOff();
+
    for (int sc = 0; sc < n_scenes; sc++)
    {
       FBQ[sc] = (QuadFilterChainState*)_aligned_malloc((MAX_VOICES >> 2) * sizeof(QuadFilterChainState), 16);
+      outgoingFBQ[sc] = (QuadFilterChainState*)_aligned_malloc((MAX_VOICES >> 2) * sizeof(QuadFilterChainState), 16);
 
       for (int i = 0; i < (MAX_VOICES >> 2); ++i)
       {
           InitQuadFilterChainStateToZero(&(FBQ[sc][i]));
+          InitQuadFilterChainStateToZero(&(outgoingFBQ[sc][i]));
       }
    }
 
@@ -124,6 +130,19 @@ SurgeSynthesizer::SurgeSynthesizer(PluginLayer* parent, std::string suppliedData
 
    patch.polylimit.val.i = 16;
 
+   setParallelSceneProcessing(Surge::Storage::getUserDefaultValue(&storage, "parallelSceneProcessing", 0) != 0);
+   setGaplessPatchSwitching(Surge::Storage::getUserDefaultValue(&storage, "gaplessPatchSwitching", 0) != 0);
+   setOctFilterChains(Surge::Storage::getUserDefaultValue(&storage, "octFilterChains", 1) != 0);
+   setIdleFastPath(Surge::Storage::getUserDefaultValue(&storage, "idleFastPath", 1) != 0);
+   setBatchOscillatorUnison(Surge::Storage::getUserDefaultValue(&storage, "batchOscillatorUnison", 1) != 0);
+   setFMOperatorQuad(Surge::Storage::getUserDefaultValue(&storage, "fmOperatorQuad", 0) != 0);
+   setBatchVoiceModulators(Surge::Storage::getUserDefaultValue(&storage, "batchVoiceModulators", 1) != 0);
+   setSkipSilentOscillators(Surge::Storage::getUserDefaultValue(&storage, "skipSilentOscillators", 1) != 0);
+   setQuadFilterCoefficients(Surge::Storage::getUserDefaultValue(&storage, "quadFilterCoefficients", 1) != 0);
+   setMemoizeFilterCoefficients(Surge::Storage::getUserDefaultValue(&storage, "memoizeFilterCoefficients", 1) != 0);
+   setKeepFilterStateInLanes(Surge::Storage::getUserDefaultValue(&storage, "keepFilterStateInLanes", 1) != 0);
+   setCoPackSceneFilters(Surge::Storage::getUserDefaultValue(&storage, "coPackSceneFilters", 1) != 0);
+
    for (int sc = 0; sc < n_scenes; sc++)
    {
       SurgeSceneStorage& scene = patch.scene[sc];
@@ -156,12 +175,6 @@ SurgeSynthesizer::SurgeSynthesizer(PluginLayer* parent, std::string suppliedData
       for (int l = 0; l < n_lfos_scene; l++)
       {
          scene.modsources[ms_slfo1 + l] = new LfoModulationSource();
-         ((LfoModulationSource*)scene.modsources[ms_slfo1 + l])->assign(&storage, &scene.lfo[n_lfos_voice + l],
-                                                                                  storage.getPatch().scenedata[sc], 0,
-                                                                                  &patch.stepsequences[sc][n_lfos_voice + l],
-                                                                                  &patch.msegs[sc][n_lfos_voice + l],
-                                                                                  &patch.formulamods[sc][n_lfos_voice + l]
-                                                                                  );
       }
    }
    
@@ -175,14 +188,9 @@ SurgeSynthesizer::SurgeSynthesizer(PluginLayer* parent, std::string suppliedData
       }
    }
 
-   amp.set_blocksize(BLOCK_SIZE);
-   // TODO: FIX SCENE ASSUMPTION
-   FX1.set_blocksize(BLOCK_SIZE);
-   FX2.set_blocksize(BLOCK_SIZE);
-   send[0][0].set_blocksize(BLOCK_SIZE);
-   send[0][1].set_blocksize(BLOCK_SIZE);
-   send[1][0].set_blocksize(BLOCK_SIZE);
-   send[1][1].set_blocksize(BLOCK_SIZE);
+   bindSceneModulatorsToPatch(patch);
+
+   setMixerBlockSize();
 
    polydisplay = 0;
    refresh_editor = false;
@@ -193,7 +201,7 @@ SurgeSynthesizer::SurgeSynthesizer(PluginLayer* parent, std::string suppliedData
    storage.getPatch().author = "";
    midiprogramshavechanged = false;
 
-   for (int i = 0; i < BLOCK_SIZE; i++)
+   for (int i = 0; i < BLOCK_SIZE_MAX; i++)
    {
       input[0][i] = 0.f;
       input[1][i] = 0.f;
@@ -255,11 +263,31 @@ SurgeSynthesizer::SurgeSynthesizer(PluginLayer* parent, std::string suppliedData
 
 SurgeSynthesizer::~SurgeSynthesizer()
 {
+   if (patchStagingThread.joinable())
+   {
+      patchStagingRunning = false;
+      patchStagingWakeup->signal();
+      patchStagingThread.join();
+   }
+
    allNotesOff();
 
    for (int sc = 0; sc < n_scenes; sc++)
    {
       _aligned_free(FBQ[sc]);
+      _aligned_free(outgoingFBQ[sc]);
+   }
+
+   // The scene LFOs of patches which went out, and of one which was staged but never went in
+   SurgePatch* staged = storage.stagedPatch();
+   for (int sc = 0; sc < n_scenes; sc++)
+   {
+      for (int l = 0; l < n_lfos_scene; l++)
+      {
+         delete retiredSceneLfos[sc][l];
+         if (staged)
+            delete staged->scene[sc].modsources[ms_slfo1 + l];
+      }
    }
 
    for (int sc = 0; sc < n_scenes; sc++)
@@ -342,6 +370,8 @@ int SurgeSynthesizer::calculateChannelMask(int channel, int key)
 
 void SurgeSynthesizer::playNote(char channel, char key, char velocity, char detune)
 {
+   Surge::Debug::NoAllocationScope noAllocation;
+   wakeFromIdle();
    if (halt_engine)
       return;
 
@@ -399,7 +429,7 @@ void SurgeSynthesizer::playNote(char channel, char key, char velocity, char detu
 
 void SurgeSynthesizer::softkillVoice(int s)
 {
-   list<SurgeVoice*>::iterator iter, max_playing, max_released;
+   SurgeVoiceTable::iterator iter, max_playing, max_released;
    int max_age = 0, max_age_release = 0;
    iter = voices[s].begin();
 
@@ -426,15 +456,15 @@ void SurgeSynthesizer::softkillVoice(int s)
       iter++;
    }
    if (max_age_release)
-      (*max_released)->uber_release();
+      voices[s].uberRelease(*max_released);
    else if (max_age)
-      (*max_playing)->uber_release();
+      voices[s].uberRelease(*max_playing);
 }
 
 // only allow 'margin' number of voices to be softkilled simultaneously
 void SurgeSynthesizer::enforcePolyphonyLimit(int s, int margin)
 {
-   list<SurgeVoice*>::iterator iter;
+   SurgeVoiceTable::iterator iter;
 
    if (voices[s].size() > (storage.getPatch().polylimit.val.i + margin))
    {
@@ -461,67 +491,24 @@ void SurgeSynthesizer::enforcePolyphonyLimit(int s, int margin)
 
 int SurgeSynthesizer::getNonUltrareleaseVoices(int s)
 {
-   int count = 0;
-
-   list<SurgeVoice*>::iterator iter;
-   iter = voices[s].begin();
-   while (iter != voices[s].end())
-   {
-      SurgeVoice* v = *iter;
-      assert(v);
-      if (!v->state.uberrelease)
-         count++;
-      iter++;
-   }
-
-   return count;
+   return voices[s].nonUberReleasedCount();
 }
 
 int SurgeSynthesizer::getNonReleasedVoices(int s)
 {
-   int count = 0;
-
-   list<SurgeVoice*>::iterator iter;
-   iter = voices[s].begin();
-   while (iter != voices[s].end())
-   {
-      SurgeVoice* v = *iter;
-      assert(v);
-      if (v->state.gate)
-         count++;
-      iter++;
-   }
-
-   return count;
+   return voices[s].nonReleasedCount();
 }
 
-SurgeVoice* SurgeSynthesizer::getUnusedVoice(int scene)
+void SurgeSynthesizer::freeVoice(SurgeVoice* v)
 {
-   for (int i = 0; i < MAX_VOICES; i++)
-   {
-      if (!voices_usedby[scene][i])
-      {
-         voices_usedby[scene][i] = scene + 1;
-         return &voices_array[scene][i];
-      }
-   }
-   return 0;
+   // The slot itself is returned when the voice is erased from (or the scene's) voice table
+   v->freeAllocatedElements();
 }
 
-void SurgeSynthesizer::freeVoice(SurgeVoice* v)
+FilterCoefficientMemoStats SurgeSynthesizer::getFilterCoefficientMemoStats(int scene)
 {
-   for (int i = 0; i < MAX_VOICES; i++)
-   {
-      if (voices_usedby[0][i] && (v == &voices_array[0][i]))
-      {
-         voices_usedby[0][i] = 0;
-      }
-      if (voices_usedby[1][i] && (v == &voices_array[1][i]))
-      {
-         voices_usedby[1][i] = 0;
-      }
-   }
-   v->freeAllocatedElements();
+   // Counted on the audio thread without a lock, so a read while it runs may be a block behind
+   return storage.filterCoefficientMemo[scene]->stats;
 }
 
 int SurgeSynthesizer::getMpeMainChannel(int voiceChannel, int key)
@@ -584,12 +571,11 @@ void SurgeSynthesizer::playVoice(int scene, char channel, char key, char velocit
    {
    case pm_poly:
    {
-      SurgeVoice* nvoice = getUnusedVoice(scene);
+      SurgeVoice* nvoice = voices[scene].allocate(voiceCounter);
       if (nvoice)
       {
          int mpeMainChannel = getMpeMainChannel(channel, key);
 
-         voices[scene].push_back(nvoice);
          new (nvoice) SurgeVoice(&storage, &storage.getPatch().scene[scene],
                                  storage.getPatch().scenedata[scene], key, velocity, channel, scene,
                                  detune, &channelState[channel].keyState[key],
@@ -602,7 +588,7 @@ void SurgeSynthesizer::playVoice(int scene, char channel, char key, char velocit
    case pm_mono_fp:
    case pm_latch:
    {
-      list<SurgeVoice*>::const_iterator iter;
+      SurgeVoiceTable::const_iterator iter;
       bool glide = false;
 
       int primode = storage.getPatch().scene[scene].monoVoicePriorityMode;
@@ -652,15 +638,14 @@ void SurgeSynthesizer::playVoice(int scene, char channel, char key, char velocit
                {
                   glide = true;
                }
-               v->uber_release();
+               voices[scene].uberRelease(v);
             }
          }
-         SurgeVoice* nvoice = getUnusedVoice(scene);
+         SurgeVoice* nvoice = voices[scene].allocate(voiceCounter);
          if (nvoice)
          {
             int mpeMainChannel = getMpeMainChannel(channel, key);
 
-            voices[scene].push_back(nvoice);
             if ((storage.getPatch().scene[scene].polymode.val.i == pm_mono_fp) && !glide)
                storage.last_key[scene] = key;
             new (nvoice) SurgeVoice(
@@ -720,7 +705,7 @@ void SurgeSynthesizer::playVoice(int scene, char channel, char key, char velocit
 
       if( createVoice )
       {
-         list<SurgeVoice*>::const_iterator iter;
+         SurgeVoiceTable::const_iterator iter;
          for (iter = voices[scene].begin(); iter != voices[scene].end(); iter++)
          {
             SurgeVoice* v = *iter;
@@ -743,17 +728,16 @@ void SurgeSynthesizer::playVoice(int scene, char channel, char key, char velocit
             else
             {
                if (v->state.scene_id == scene)
-                  v->uber_release(); // make this optional for poly legato
+                  voices[scene].uberRelease(v); // make this optional for poly legato
             }
          }
          if (!found_one)
          {
             int mpeMainChannel = getMpeMainChannel(channel, key);
 
-            SurgeVoice* nvoice = getUnusedVoice(scene);
+            SurgeVoice* nvoice = voices[scene].allocate(voiceCounter);
             if (nvoice)
             {
-               voices[scene].push_back(nvoice);
                new (nvoice) SurgeVoice(&storage, &storage.getPatch().scene[scene],
                                        storage.getPatch().scenedata[scene], key, velocity, channel,
                                        scene, detune, &channelState[channel].keyState[key],
@@ -790,7 +774,7 @@ void SurgeSynthesizer::playVoice(int scene, char channel, char key, char velocit
 
 void SurgeSynthesizer::releaseScene(int s)
 {
-   list<SurgeVoice*>::const_iterator iter;
+   SurgeVoiceTable::const_iterator iter;
    for (iter = voices[s].begin(); iter != voices[s].end(); iter++)
    {
       freeVoice(*iter);
@@ -800,6 +784,7 @@ void SurgeSynthesizer::releaseScene(int s)
 
 void SurgeSynthesizer::releaseNote(char channel, char key, char velocity)
 {
+   wakeFromIdle();
    for (int sc = 0; sc < n_scenes; ++sc)
    {
       for( auto *v : voices[sc] )
@@ -844,7 +829,7 @@ void SurgeSynthesizer::releaseNote(char channel, char key, char velocity)
 void SurgeSynthesizer::releaseNotePostHoldCheck(int scene, char channel, char key, char velocity)
 {
    channelState[channel].keyState[key].keystate = 0;
-   list<SurgeVoice*>::const_iterator iter;
+   SurgeVoiceTable::const_iterator iter;
    for (int s = 0; s < n_scenes; s++)
    {
       bool do_switch = false;
@@ -880,7 +865,7 @@ void SurgeSynthesizer::releaseNotePostHoldCheck(int scene, char channel, char ke
          {
          case pm_poly:
             if ((v->state.key == key) && (v->state.channel == channel))
-               v->release();
+               voices[scene].release(v);
             break;
          case pm_mono:
          case pm_mono_fp:
@@ -1009,12 +994,12 @@ void SurgeSynthesizer::releaseNotePostHoldCheck(int scene, char channel, char ke
                if (!do_switch)
                {
                   if (storage.getPatch().scene[v->state.scene_id].polymode.val.i != pm_latch)
-                     v->release();
+                     voices[scene].release(v);
                }
                else
                {
                   // confirm that no notes are active
-                  v->uber_release();
+                  voices[scene].uberRelease(v);
                   if (getNonUltrareleaseVoices(scene) == 0)
                   {
                      playVoice(scene, activateVoiceChannel, activateVoiceKey, velocity,
@@ -1141,7 +1126,7 @@ void SurgeSynthesizer::releaseNotePostHoldCheck(int scene, char channel, char ke
                }
 
                if (do_release)
-                  v->release();
+                  voices[scene].release(v);
             }
          }
          break;
@@ -1276,6 +1261,7 @@ void SurgeSynthesizer::updateHighLowKeys(int scene)
 
 void SurgeSynthesizer::pitchBend(char channel, int value)
 {
+   wakeFromIdle();
    if (mpeEnabled && channel != 0)
    {
       channelState[channel].pitchBend = value;
@@ -1309,6 +1295,7 @@ void SurgeSynthesizer::pitchBend(char channel, int value)
 }
 void SurgeSynthesizer::channelAftertouch(char channel, int value)
 {
+   wakeFromIdle();
    float fval = (float)value / 127.f;
 
    channelState[channel].pressure = fval;
@@ -1324,6 +1311,7 @@ void SurgeSynthesizer::channelAftertouch(char channel, int value)
 
 void SurgeSynthesizer::polyAftertouch(char channel, int key, int value)
 {
+   wakeFromIdle();
    float fval = (float)value / 127.f;
    storage.poly_aftertouch[0][key & 127] = fval;
    storage.poly_aftertouch[1][key & 127] = fval;
@@ -1331,6 +1319,7 @@ void SurgeSynthesizer::polyAftertouch(char channel, int key, int value)
 
 void SurgeSynthesizer::programChange(char channel, int value)
 {
+   wakeFromIdle();
    PCH = value;
    // load_patch((CC0<<7) + PCH);
    patchid_queue = (CC0 << 7) + PCH;
@@ -1449,6 +1438,7 @@ float int7ToBipolarFloat(int x)
 
 void SurgeSynthesizer::channelController(char channel, int cc, int value)
 {
+   wakeFromIdle();
    float fval = (float)value * (1.f / 127.f);
 
    // store all possible NRPN & RPNs in a short array... amounts to 128 KB or thereabouts
@@ -1714,7 +1704,7 @@ void SurgeSynthesizer::allNotesOff()
 
    for (int s = 0; s < n_scenes; s++)
    {
-      list<SurgeVoice*>::const_iterator iter;
+      SurgeVoiceTable::const_iterator iter;
       for (iter = voices[s].begin(); iter != voices[s].end(); iter++)
       {
          //_aligned_free(*iter);
@@ -1722,6 +1712,7 @@ void SurgeSynthesizer::allNotesOff()
       }
       voices[s].clear();
    }
+   releaseOutgoingVoices();
    holdbuffer[0].clear();
    holdbuffer[1].clear();
    halfbandA.reset();
@@ -1764,6 +1755,60 @@ void SurgeSynthesizer::setSamplerate(float sr)
    }
 }
 
+bool SurgeSynthesizer::setBlockSize(int bs)
+{
+   if (bs < BLOCK_SIZE_MIN || bs > BLOCK_SIZE_MAX || (bs & (bs - 1)))
+      return false;
+   if (bs == storage.blockSize)
+      return true;
+
+   allNotesOff();
+   storage.setBlockSize(bs);
+   // The envelope rate tables are per block
+   setSamplerate(samplerate);
+   setMixerBlockSize();
+
+   // Controller smoothing steps once per block, so it needs to know how long a block is
+   for (int sc = 0; sc < n_scenes; ++sc)
+   {
+      for (int q = 0; q < n_modsources; ++q)
+      {
+         auto cms = dynamic_cast<ControllerModulationSource*>(storage.getPatch().scene[sc].modsources[q]);
+         if (cms)
+            cms->set_blocksize(bs);
+      }
+   }
+   for (int i = 0; i < num_controlinterpolators; i++)
+      mControlInterpolator[i].set_blocksize(bs);
+
+   // The effects set their smoothers up for the block size as they're made
+   for (int i = 0; i < n_fx_slots; i++)
+      memcpy((void*)&fxsync[i], (void*)&storage.getPatch().fx[i], sizeof(FxStorage));
+   loadFx(false, true);
+   return true;
+}
+
+void SurgeSynthesizer::setMixerBlockSize()
+{
+   amp.set_blocksize(storage.blockSize);
+   outgoingAmp.set_blocksize(storage.blockSize);
+   // TODO: FIX SCENE ASSUMPTION
+   FX1.set_blocksize(storage.blockSize);
+   FX2.set_blocksize(storage.blockSize);
+   send[0][0].set_blocksize(storage.blockSize);
+   send[0][1].set_blocksize(storage.blockSize);
+   send[1][0].set_blocksize(storage.blockSize);
+   send[1][1].set_blocksize(storage.blockSize);
+   amp.set_smoothing_blocksize(storage.blockSize);
+   FX1.set_smoothing_blocksize(storage.blockSize);
+   FX2.set_smoothing_blocksize(storage.blockSize);
+   for (int i = 0; i < 2; i++)
+      for (int j = 0; j < 2; j++)
+         send[i][j].set_smoothing_blocksize(storage.blockSize);
+   // amp_mute has always kept the default of 64, so a block ramps half way at 32
+   amp_mute.set_blocksize(storage.blockSizeOS);
+}
+
 //-------------------------------------------------------------------------------------------------
 
 int SurgeSynthesizer::GetFreeControlInterpolatorIndex()
@@ -1851,6 +1896,7 @@ ControllerModulationSource* SurgeSynthesizer::AddControlInterpolator(int Id, boo
 
 void SurgeSynthesizer::setParameterSmoothed(long index, float value)
 {
+   wakeFromIdle();
    bool AlreadyExisted;
    ControllerModulationSource* mc = AddControlInterpolator(index, AlreadyExisted);
 
@@ -1873,6 +1919,7 @@ void SurgeSynthesizer::setParameterSmoothed(long index, float value)
 
 bool SurgeSynthesizer::setParameter01(long index, float value, bool external, bool force_integer)
 {
+   wakeFromIdle();
    // does the parameter exist in the interpolator array? If it does, delete it
    ReleaseControlInterpolator(index);
 
@@ -2084,7 +2131,7 @@ void SurgeSynthesizer::switch_toggled()
 {
    for (int s = 0; s < n_scenes; s++)
    {
-      list<SurgeVoice*>::iterator iter;
+      SurgeVoiceTable::iterator iter;
       for (iter = voices[s].begin(); iter != voices[s].end(); iter++)
       {
          SurgeVoice* v = *iter;
@@ -2093,6 +2140,39 @@ void SurgeSynthesizer::switch_toggled()
    }
 }
 
+static void clampFxParamsToRange(FxStorage& fxs)
+{
+   for (int j = 0; j < n_fx_params; j++)
+   {
+      auto p = &(fxs.p[j]);
+      if (p->ctrltype != ct_none)
+      {
+         if (p->valtype == vt_float)
+         {
+            if (p->val.f < p->val_min.f)
+            {
+               p->val.f = p->val_min.f;
+            }
+            if (p->val.f > p->val_max.f)
+            {
+               p->val.f = p->val_max.f;
+            }
+         }
+         else if (p->valtype == vt_int)
+         {
+            if (p->val.i < p->val_min.i)
+            {
+               p->val.i = p->val_min.i;
+            }
+            if (p->val.i > p->val_max.i)
+            {
+               p->val.i = p->val_max.i;
+            }
+         }
+      }
+   }
+}
+
 bool SurgeSynthesizer::loadFx(bool initp, bool force_reload_all)
 {
    load_fx_needed = false;
@@ -2130,38 +2210,7 @@ bool SurgeSynthesizer::loadFx(bool initp, bool force_reload_all)
             if (initp)
                fx[s]->init_default_values();
             else
-            {
-               for(int j=0; j<n_fx_params; j++)
-               {
-                  auto p = &( storage.getPatch().fx[s].p[j] );
-                  if( p->ctrltype != ct_none )
-                  {
-                     if (p->valtype == vt_float)
-                     {
-                        if (p->val.f < p->val_min.f)
-                        {
-                           p->val.f = p->val_min.f;
-                        }
-                        if (p->val.f > p->val_max.f)
-                        {
-                           p->val.f = p->val_max.f;
-                        }
-                     }
-                     else if (p->valtype == vt_int)
-                     {
-                        if (p->val.i < p->val_min.i)
-                        {
-                           p->val.i = p->val_min.i;
-                        }
-                        if (p->val.i > p->val_max.i)
-                        {
-                           p->val.i = p->val_max.i;
-                        }
-                     }
-                  }
-               }
-
-            }
+               clampFxParamsToRange(storage.getPatch().fx[s]);
             /*for(int j=0; j<n_fx_params; j++)
             {
                 storage.getPatch().globaldata[storage.getPatch().fx[s].p[j].id].f =
@@ -2479,6 +2528,8 @@ void SurgeSynthesizer::updateUsedState()
 
 void SurgeSynthesizer::prepareModsourceDoProcess(int scenemask)
 {
+   const ModRoutingSnapshot* routing = storage.audioModRouting();
+
    for (int scene = 0; scene < n_scenes; scene++)
    {
       if ((1 << scene) & scenemask)
@@ -2490,18 +2541,18 @@ void SurgeSynthesizer::prepareModsourceDoProcess(int scenemask)
 
          for (int j = 0; j < 3; j++)
          {
-            vector<ModulationRouting>* modlist;
+            const vector<ModulationRouting>* modlist;
 
             switch (j)
             {
             case 0:
-               modlist = &storage.getPatch().modulation_global;
+               modlist = &routing->global;
                break;
             case 1:
-               modlist = &storage.getPatch().scene[scene].modulation_scene;
+               modlist = &routing->scene[scene];
                break;
             case 2:
-               modlist = &storage.getPatch().scene[scene].modulation_voice;
+               modlist = &routing->voice[scene];
                break;
             }
 
@@ -2561,11 +2612,13 @@ void SurgeSynthesizer::clear_osc_modulation(int scene, int entry)
       else
          iter++;
    }
+   storage.publishModRouting();
    storage.modRoutingMutex.unlock();
 }
 
 void SurgeSynthesizer::clearModulation(long ptag, modsources modsource, bool clearEvenIfInvalid)
 {
+   wakeFromIdle();
    if (!isValidModulation(ptag, modsource) && ! clearEvenIfInvalid )
       return;
    
@@ -2596,6 +2649,7 @@ void SurgeSynthesizer::clearModulation(long ptag, modsources modsource, bool cle
       {
          storage.modRoutingMutex.lock();
          modlist->erase(modlist->begin() + i);
+         storage.publishModRouting();
          storage.modRoutingMutex.unlock();
          return;
       }
@@ -2604,6 +2658,7 @@ void SurgeSynthesizer::clearModulation(long ptag, modsources modsource, bool cle
 
 bool SurgeSynthesizer::setModulation(long ptag, modsources modsource, float val)
 {
+   wakeFromIdle();
    if (!isValidModulation(ptag, modsource))
       return false;
    float value = storage.getPatch().param_ptr[ptag]->set_modulation_f01(val);
@@ -2661,6 +2716,7 @@ bool SurgeSynthesizer::setModulation(long ptag, modsources modsource, float val)
          modlist->at(found_id).depth = value;
       }
    }
+   storage.publishModRouting();
    storage.modRoutingMutex.unlock();
 
    return true;
@@ -2977,111 +3033,439 @@ void SurgeSynthesizer::processThreadunsafeOperations()
    }
 }
 
-void SurgeSynthesizer::resetStateFromTimeData()
+void SurgeSynthesizer::bindSceneModulatorsToPatch(SurgePatch& patch)
 {
-   storage.songpos = time_data.ppqPos;
-   if( time_data.tempo > 0 )
+   for (int sc = 0; sc < n_scenes; sc++)
    {
-      storage.temposyncratio = time_data.tempo / 120.f;
-      storage.temposyncratio_inv = 1.f / storage.temposyncratio;
+      for (int l = 0; l < n_lfos_scene; l++)
+      {
+         ((LfoModulationSource*)patch.scene[sc].modsources[ms_slfo1 + l])
+             ->assign(&storage, &patch.scene[sc].lfo[n_lfos_voice + l], patch.scenedata[sc], 0,
+                      &patch.stepsequences[sc][n_lfos_voice + l],
+                      &patch.msegs[sc][n_lfos_voice + l],
+                      &patch.formulamods[sc][n_lfos_voice + l]);
+      }
    }
-   else
+}
+
+/*
+** Build the effects for a patch which isn't live yet, the way loadFx(false, true) builds them
+** for the live one.
+*/
+void SurgeSynthesizer::spawnEffectsForPatch(SurgePatch& patch, std::unique_ptr<Effect>* into)
+{
+   for (int s = 0; s < n_fx_slots; s++)
    {
-      storage.temposyncratio = 1.f;
-      storage.temposyncratio_inv = 1.f;
+      auto& fxs = patch.fx[s];
+      if (fxs.type.val.i == fxt_off)
+      {
+         for (int j = 0; j < n_fx_params; j++)
+         {
+            fxs.p[j].set_type(ct_none);
+            std::string n = "Param ";
+            n += std::to_string(j + 1);
+            fxs.p[j].set_name(n.c_str());
+            fxs.p[j].val.i = 0;
+            patch.globaldata[fxs.p[j].id].i = 0;
+         }
+      }
+
+      into[s].reset(spawn_effect(fxs.type.val.i, &storage, &fxs, patch.globaldata));
+      if (into[s])
+      {
+         into[s]->init_ctrltypes();
+         clampFxParamsToRange(fxs);
+         into[s]->init();
+         into[s]->updateAfterReload();
+      }
    }
 }
-void SurgeSynthesizer::processControl()
+
+void SurgeSynthesizer::stagePatchInBackground()
 {
-   storage.perform_queued_wtloads();
-   int sm = storage.getPatch().scenemode.val.i;
-   // TODO: FIX SCENE ASSUMPTION
-   bool playA = (sm == sm_split) || (sm == sm_dual) || (sm == sm_chsplit) || (storage.getPatch().scene_active.val.i == 0);
-   bool playB = (sm == sm_split) || (sm == sm_dual) || (sm == sm_chsplit) || (storage.getPatch().scene_active.val.i == 1);
+   bool staged = false;
+   if (patchid_queue >= 0)
+   {
+      int id = patchid_queue;
+      patchid_queue = -1;
+      if (id >= (int)storage.patch_list.size())
+         id = id % storage.patch_list.size();
 
-   storage.songpos = time_data.ppqPos;
-   storage.temposyncratio = time_data.tempo / 120.f;
-   storage.temposyncratio_inv = 1.f / storage.temposyncratio;
+      Patch e = storage.patch_list[id];
+      staged = stagePatchByPath(path_to_string(e.path).c_str(), e.category, e.name.c_str(), id);
+   }
+   else if (has_patchid_file)
+   {
+      auto p(string_to_path(patchid_file));
+      auto s = path_to_string(p.stem());
+      has_patchid_file = false;
+      staged = stagePatchByPath(patchid_file, -1, s.c_str());
+   }
 
-   // TODO: FIX SCENE ASSUMPTION
-   if (release_if_latched[0])
+   // Otherwise process() commits it, and clears this once the patch it replaces has faded out
+   if (!staged)
+      patchStagingInFlight = false;
+}
+
+/*
+** Runs on the audio thread at a block boundary, and mustn't allocate. The sounding voices stay
+** bound to the patch they were started on, which plays on through renderOutgoingPatch() with its
+** own scene LFOs, routings and effects; everything else moves across to the staged patch as it
+** goes live.
+*/
+bool SurgeSynthesizer::commitStagedPatch()
+{
+   SurgePatch* staged = storage.stagedPatch();
+   if (!staged)
+      return false;
+
+   // A crossfade still running from the last switch is cut short
+   releaseOutgoingVoices();
+
+   SurgePatch& live = storage.getPatch();
+
+   // What a load keeps from the patch it replaces: see init_default_values, and MIDI learn
+   staged->volume.val = live.volume.val;
+   staged->fx_bypass.val = live.fx_bypass.val;
+   staged->polylimit.val = live.polylimit.val;
+   for (int i = 0; i < (int)staged->param_ptr.size(); i++)
+      staged->param_ptr[i]->midictrl = live.param_ptr[i]->midictrl;
+
+   // Give the live controllers the state the patch load left in the stand-ins
+   for (int i = 0; i < n_customcontrollers; i++)
    {
-      if (!playA || release_anyway[0])
-         releaseScene(0);
-      release_if_latched[0] = false;
-      release_anyway[0] = false;
+      auto cms = (ControllerModulationSource*)live.scene[0].modsources[ms_ctrl1 + i];
+      cms->reset();
+      cms->set_bipolar(stagedControllers[i].is_bipolar());
+      cms->set_target(stagedControllers[i].target);
    }
-   if (release_if_latched[1])
+
+   // The staged patch shares the live modulation sources, except for the scene LFOs it brought
+   for (int s = 0; s < n_scenes; s++)
    {
-      if (!playB || release_anyway[1])
-         releaseScene(1);
-      release_if_latched[1] = false;
-      release_anyway[1] = false;
+      for (int i = 0; i < n_modsources; i++)
+      {
+         if (i >= ms_slfo1 && i < ms_slfo1 + n_lfos_scene)
+            retiredSceneLfos[s][i - ms_slfo1] = live.scene[s].modsources[i];
+         else
+            staged->scene[s].modsources[i] = live.scene[s].modsources[i];
+      }
    }
 
-   // TODO: FIX SCENE ASSUMPTION
-   if (playA && (storage.getPatch().scene[0].polymode.val.i == pm_latch) && voices[0].empty())
-      playNote(1, 60, 100, 0);
-   if (playB && (storage.getPatch().scene[1].polymode.val.i == pm_latch) && voices[1].empty())
-      playNote(2, 60, 100, 0);
+   storage.commitStagedPatch();
 
-   // interpolate MIDI controllers
-   for (int i = 0; i < num_controlinterpolators; i++)
+   for (int s = 0; s < n_scenes; s++)
    {
-      if (mControlInterpolatorUsed[i])
+      for (auto v : voices[s])
       {
-         ControllerModulationSource* mc = &mControlInterpolator[i];
-         bool cont = mc->process_block_until_close(0.001f);
-         int id = mc->id;
-         storage.getPatch().param_ptr[id]->set_value_f01(mc->output);
-         if (!cont)
-         {
-            mControlInterpolatorUsed[i] = false;
-         }
+         if (v->filterStateInLane())
+            v->GetQFB();
+         v->outgoingRouting = storage.outgoingModRouting();
       }
+      outgoingVoices[s] = voices[s];
+      voices[s].clear();
+      voices[s].reservedMask = outgoingVoices[s].activeMask;
    }
+   outgoingHalfbandA = halfbandA;
+   outgoingHalfbandB = halfbandB;
+   outgoingLowcutA = hpA;
+   outgoingLowcutB = hpB;
+   halfbandA.reset();
+   halfbandB.reset();
+   hpA.suspend();
+   hpB.suspend();
+   outgoingFade = 1.f;
+   outgoingFadeStep = storage.blockSize / (gaplessCrossfadeTime * samplerate);
+   outgoingAmp.set_target_instantize(1.f);
 
-   storage.getPatch().copy_globaldata(storage.getPatch().globaldata); // Drains a great deal of CPU while in Debug mode.. optimize?
+   for (int i = 0; i < n_fx_slots; i++)
+   {
+      fx[i].swap(stagedFx[i]);
+      memcpy((void*)&fxsync[i], (void*)&storage.getPatch().fx[i], sizeof(FxStorage));
+      fx_reload[i] = false;
+   }
+   load_fx_needed = false;
 
-   // TODO: FIX SCENE ASSUMPTION
-   if (playA)
-      storage.getPatch().copy_scenedata(storage.getPatch().scenedata[0], 0); // -""-
-   if (playB)
-      storage.getPatch().copy_scenedata(storage.getPatch().scenedata[1], 1);
+   commitStagedTuning();
 
-   //	if(sm == sm_morph) storage.getPatch().do_morph();
+   current_category_id = stagedCategoryId;
+   if (stagedPatchId >= 0)
+      patchid = stagedPatchId;
+   patch_loaded = true;
 
-   prepareModsourceDoProcess((playA ? 1 : 0) | (playB ? 2 : 0));
+   // The editor and the host hear about it from the staging thread
+   patchCommitNotifyPending = true;
+   patchStagingWakeup->signal();
+   return true;
+}
+
+/*
+** The patch a gapless switch replaced, mixed into the output at the fade. This is the scene and
+** effect chain of process() cut down to what the voices already sounding need: no new voices,
+** no routable scene outputs, and parameters which hold their values.
+*/
+void SurgeSynthesizer::renderOutgoingPatch(float* outL, float* outR)
+{
+   SurgePatch* patch = storage.outgoingPatch();
+   if (!patch)
+      return;
+
+   const ModRoutingSnapshot* routing = storage.outgoingModRouting();
+   int fx_bypass = patch->fx_bypass.val.i;
+   float sceneOut alignas(16)[n_scenes][2][BLOCK_SIZE_OS_MAX];
+   float mix alignas(16)[2][BLOCK_SIZE_MAX];
 
+   outgoingLanes.schedule(outgoingVoices, outgoingFBQ, false);
+
+   clear_block(mix[0], storage.blockSizeQuad);
+   clear_block(mix[1], storage.blockSizeQuad);
    for (int s = 0; s < n_scenes; s++)
    {
-      if (((s == 0) && playA) || ((s == 1) && playB))
+      SurgeSceneStorage& scene = patch->scene[s];
+      bool played = !outgoingVoices[s].empty();
+      clear_block_antidenormalnoise(sceneOut[s][0], storage.blockSizeOSQuad);
+      clear_block_antidenormalnoise(sceneOut[s][1], storage.blockSizeOSQuad);
+
+      if (played)
       {
-         if (storage.getPatch().scene[s].modsource_doprocess[ms_modwheel])
-            storage.getPatch().scene[s].modsources[ms_modwheel]->process_block();
-         if (storage.getPatch().scene[s].modsource_doprocess[ms_breath])
-            storage.getPatch().scene[s].modsources[ms_breath]->process_block();
-         if (storage.getPatch().scene[s].modsource_doprocess[ms_expression])
-            storage.getPatch().scene[s].modsources[ms_expression]->process_block();
-         if (storage.getPatch().scene[s].modsource_doprocess[ms_sustain])
-            storage.getPatch().scene[s].modsources[ms_sustain]->process_block();
-         if (storage.getPatch().scene[s].modsource_doprocess[ms_aftertouch])
-            storage.getPatch().scene[s].modsources[ms_aftertouch]->process_block(); 
-         if (storage.getPatch().scene[s].modsource_doprocess[ms_lowest_key])
-            storage.getPatch().scene[s].modsources[ms_lowest_key]->process_block();
-         if (storage.getPatch().scene[s].modsource_doprocess[ms_highest_key])
-            storage.getPatch().scene[s].modsources[ms_highest_key]->process_block();
-         if (storage.getPatch().scene[s].modsource_doprocess[ms_latest_key])
-            storage.getPatch().scene[s].modsources[ms_latest_key]->process_block();
+         patch->copy_scenedata(patch->scenedata[s], s);
+         routing->sceneMatrix[s].accumulate(patch->scenedata[s], scene.modsources.data());
+         for (int i = 0; i < n_lfos_scene; i++)
+            scene.modsources[ms_slfo1 + i]->process_block();
 
-         if (storage.getPatch().scene[s].modsource_doprocess[ms_random_unipolar])
-            storage.getPatch().scene[s].modsources[ms_random_unipolar]->process_block();
-         if (storage.getPatch().scene[s].modsource_doprocess[ms_random_bipolar])
-            storage.getPatch().scene[s].modsources[ms_random_bipolar]->process_block();
-         if (storage.getPatch().scene[s].modsource_doprocess[ms_alternate_bipolar])
-            storage.getPatch().scene[s].modsources[ms_alternate_bipolar]->process_block();
-         if (storage.getPatch().scene[s].modsource_doprocess[ms_alternate_unipolar])
-            storage.getPatch().scene[s].modsources[ms_alternate_unipolar]->process_block();
+         int q = outgoingLanes.quadsOf(s);
+         QuadFilterChainState* Q = outgoingFBQ[q];
+         auto iter = outgoingVoices[s].begin();
+         while (iter != outgoingVoices[s].end())
+         {
+            SurgeVoice* v = *iter;
+            int lane = outgoingLanes.laneOf(s, outgoingVoices[s], v);
+            if (!v->process_block(Q[lane >> 2], lane & 3))
+            {
+               freeVoice(v);
+               iter = outgoingVoices[s].erase(iter);
+            }
+            else
+               iter++;
+         }
+         makeFilterCoefficients(outgoingLanes, Q, q);
+         runFilterQuads(scene, Q, 0, outgoingLanes.lanesUsed[q], sceneOut[s][0], sceneOut[s][1]);
+         for (auto v : outgoingVoices[s])
+            v->GetQFB(storage.keepFilterStateInLanes);
+
+         if (hardclipEnabled)
+         {
+            hardclip_block8(sceneOut[s][0], storage.blockSizeOSQuad);
+            hardclip_block8(sceneOut[s][1], storage.blockSizeOSQuad);
+         }
+         HalfRateFilter& halfband = (s == 0) ? outgoingHalfbandA : outgoingHalfbandB;
+         halfband.process_block_D2(sceneOut[s][0], sceneOut[s][1], storage.blockSizeOS);
+      }
+
+      BiquadFilter& lowcut = (s == 0) ? outgoingLowcutA : outgoingLowcutB;
+      if (!scene.lowcut.deactivated)
+      {
+         lowcut.coeff_HP(lowcut.calc_omega(patch->scenedata[s][scene.lowcut.param_id_in_scene].f / 12.0), 0.4);
+         lowcut.process_block(sceneOut[s][0], sceneOut[s][1]);
+      }
+
+      bool sc_state = played;
+      if (fx_bypass != fxb_no_fx)
+      {
+         for (int i = 2 * s; i < 2 * s + 2; i++)
+         {
+            if (stagedFx[i] && !(patch->fx_disable.val.i & (1 << i)))
+               sc_state = stagedFx[i]->process_ringout(sceneOut[s][0], sceneOut[s][1], sc_state);
+         }
+      }
+
+      accumulate_block(sceneOut[s][0], mix[0], storage.blockSizeQuad);
+      accumulate_block(sceneOut[s][1], mix[1], storage.blockSizeQuad);
+   }
+
+   if (fx_bypass == fxb_all_fx)
+   {
+      for (int n = 0; n < 2; n++) // send FX 1 and 2
+      {
+         int slot = 4 + n;
+         if (!stagedFx[slot] || (patch->fx_disable.val.i & (1 << slot)))
+            continue;
+
+         float send alignas(16)[2][BLOCK_SIZE_MAX];
+         clear_block(send[0], storage.blockSizeQuad);
+         clear_block(send[1], storage.blockSizeQuad);
+         for (int s = 0; s < n_scenes; s++)
+         {
+            lipol_ps level;
+            level.set_blocksize(storage.blockSize);
+            level.set_target_instantize(amp_to_linear(
+                patch->scenedata[s][patch->scene[s].send_level[n].param_id_in_scene].f));
+            level.MAC_2_blocks_to(sceneOut[s][0], sceneOut[s][1], send[0], send[1],
+                                  storage.blockSizeQuad);
+         }
+         stagedFx[slot]->process_ringout(send[0], send[1], true);
+
+         lipol_ps ret;
+         ret.set_blocksize(storage.blockSize);
+         ret.set_target_instantize(amp_to_linear(patch->globaldata[patch->fx[slot].return_level.id].f));
+         ret.MAC_2_blocks_to(send[0], send[1], mix[0], mix[1], storage.blockSizeQuad);
+      }
+   }
+
+   if (fx_bypass == fxb_all_fx || fx_bypass == fxb_no_sends)
+   {
+      for (int slot = 6; slot < 8; slot++)
+      {
+         if (stagedFx[slot] && !(patch->fx_disable.val.i & (1 << slot)))
+            stagedFx[slot]->process_ringout(mix[0], mix[1], true);
+      }
+   }
+
+   outgoingFade = max(0.f, outgoingFade - outgoingFadeStep);
+   outgoingAmp.set_target(outgoingFade * outgoingFade);
+   outgoingAmp.MAC_2_blocks_to(mix[0], mix[1], outL, outR, storage.blockSizeQuad);
+
+   if (outgoingFade <= 0.f)
+   {
+      releaseOutgoingVoices();
+   }
+   else
+   {
+      for (int s = 0; s < n_scenes; s++)
+         voices[s].reservedMask = outgoingVoices[s].activeMask;
+   }
+}
+
+/*
+** Ends a crossfade: frees the outgoing voices and lets the staging thread have the outgoing patch,
+** its effects and its scene LFOs for the next switch.
+*/
+void SurgeSynthesizer::releaseOutgoingVoices()
+{
+   for (int s = 0; s < n_scenes; s++)
+   {
+      for (auto v : outgoingVoices[s])
+         freeVoice(v);
+      outgoingVoices[s].clear();
+      voices[s].reservedMask = 0;
+   }
+
+   if (storage.outgoingPatch())
+   {
+      storage.releaseOutgoingPatch();
+      patchStagingInFlight = false;
+   }
+}
+
+void SurgeSynthesizer::resetStateFromTimeData()
+{
+   storage.songpos = time_data.ppqPos;
+   if( time_data.tempo > 0 )
+   {
+      storage.temposyncratio = time_data.tempo / 120.f;
+      storage.temposyncratio_inv = 1.f / storage.temposyncratio;
+   }
+   else
+   {
+      storage.temposyncratio = 1.f;
+      storage.temposyncratio_inv = 1.f;
+   }
+}
+void SurgeSynthesizer::processControl()
+{
+   {
+      Surge::Debug::AllowAllocationScope loadingWavetables;
+      storage.perform_queued_wtloads();
+   }
+   const ModRoutingSnapshot* routing = storage.acquireModRoutingForAudio();
+   int sm = storage.getPatch().scenemode.val.i;
+   // TODO: FIX SCENE ASSUMPTION
+   bool playA = (sm == sm_split) || (sm == sm_dual) || (sm == sm_chsplit) || (storage.getPatch().scene_active.val.i == 0);
+   bool playB = (sm == sm_split) || (sm == sm_dual) || (sm == sm_chsplit) || (storage.getPatch().scene_active.val.i == 1);
+
+   storage.songpos = time_data.ppqPos;
+   storage.temposyncratio = time_data.tempo / 120.f;
+   storage.temposyncratio_inv = 1.f / storage.temposyncratio;
+
+   // TODO: FIX SCENE ASSUMPTION
+   if (release_if_latched[0])
+   {
+      if (!playA || release_anyway[0])
+         releaseScene(0);
+      release_if_latched[0] = false;
+      release_anyway[0] = false;
+   }
+   if (release_if_latched[1])
+   {
+      if (!playB || release_anyway[1])
+         releaseScene(1);
+      release_if_latched[1] = false;
+      release_anyway[1] = false;
+   }
+
+   // TODO: FIX SCENE ASSUMPTION
+   if (playA && (storage.getPatch().scene[0].polymode.val.i == pm_latch) && voices[0].empty())
+      playNote(1, 60, 100, 0);
+   if (playB && (storage.getPatch().scene[1].polymode.val.i == pm_latch) && voices[1].empty())
+      playNote(2, 60, 100, 0);
+
+   // interpolate MIDI controllers
+   for (int i = 0; i < num_controlinterpolators; i++)
+   {
+      if (mControlInterpolatorUsed[i])
+      {
+         ControllerModulationSource* mc = &mControlInterpolator[i];
+         bool cont = mc->process_block_until_close(0.001f);
+         int id = mc->id;
+         storage.getPatch().param_ptr[id]->set_value_f01(mc->output);
+         if (!cont)
+         {
+            mControlInterpolatorUsed[i] = false;
+         }
+      }
+   }
+
+   storage.getPatch().copy_globaldata(storage.getPatch().globaldata); // Drains a great deal of CPU while in Debug mode.. optimize?
+
+   // TODO: FIX SCENE ASSUMPTION
+   if (playA)
+      storage.getPatch().copy_scenedata(storage.getPatch().scenedata[0], 0); // -""-
+   if (playB)
+      storage.getPatch().copy_scenedata(storage.getPatch().scenedata[1], 1);
+
+   //	if(sm == sm_morph) storage.getPatch().do_morph();
+
+   prepareModsourceDoProcess((playA ? 1 : 0) | (playB ? 2 : 0));
+
+   for (int s = 0; s < n_scenes; s++)
+   {
+      if (((s == 0) && playA) || ((s == 1) && playB))
+      {
+         if (storage.getPatch().scene[s].modsource_doprocess[ms_modwheel])
+            storage.getPatch().scene[s].modsources[ms_modwheel]->process_block();
+         if (storage.getPatch().scene[s].modsource_doprocess[ms_breath])
+            storage.getPatch().scene[s].modsources[ms_breath]->process_block();
+         if (storage.getPatch().scene[s].modsource_doprocess[ms_expression])
+            storage.getPatch().scene[s].modsources[ms_expression]->process_block();
+         if (storage.getPatch().scene[s].modsource_doprocess[ms_sustain])
+            storage.getPatch().scene[s].modsources[ms_sustain]->process_block();
+         if (storage.getPatch().scene[s].modsource_doprocess[ms_aftertouch])
+            storage.getPatch().scene[s].modsources[ms_aftertouch]->process_block(); 
+         if (storage.getPatch().scene[s].modsource_doprocess[ms_lowest_key])
+            storage.getPatch().scene[s].modsources[ms_lowest_key]->process_block();
+         if (storage.getPatch().scene[s].modsource_doprocess[ms_highest_key])
+            storage.getPatch().scene[s].modsources[ms_highest_key]->process_block();
+         if (storage.getPatch().scene[s].modsource_doprocess[ms_latest_key])
+            storage.getPatch().scene[s].modsources[ms_latest_key]->process_block();
+
+         if (storage.getPatch().scene[s].modsource_doprocess[ms_random_unipolar])
+            storage.getPatch().scene[s].modsources[ms_random_unipolar]->process_block();
+         if (storage.getPatch().scene[s].modsource_doprocess[ms_random_bipolar])
+            storage.getPatch().scene[s].modsources[ms_random_bipolar]->process_block();
+         if (storage.getPatch().scene[s].modsource_doprocess[ms_alternate_bipolar])
+            storage.getPatch().scene[s].modsources[ms_alternate_bipolar]->process_block();
+         if (storage.getPatch().scene[s].modsource_doprocess[ms_alternate_unipolar])
+            storage.getPatch().scene[s].modsources[ms_alternate_unipolar]->process_block();
 
          storage.getPatch().scene[s].modsources[ms_pitchbend]->process_block();
 
@@ -3091,18 +3475,8 @@ void SurgeSynthesizer::processControl()
          // for(int i=0; i<n_lfos_scene; i++)
          // storage.getPatch().scene[s].modsources[ms_slfo1+i]->process_block();
 
-         int n = storage.getPatch().scene[s].modulation_scene.size();
-         for (int i = 0; i < n; i++)
-         {
-            int src_id = storage.getPatch().scene[s].modulation_scene[i].source_id;
-            if (storage.getPatch().scene[s].modsources[src_id])
-            {
-               int dst_id = storage.getPatch().scene[s].modulation_scene[i].destination_id;
-               float depth = storage.getPatch().scene[s].modulation_scene[i].depth;
-               storage.getPatch().scenedata[s][dst_id].f +=
-                   depth * storage.getPatch().scene[s].modsources[src_id]->output;
-            }
-         }
+         routing->sceneMatrix[s].accumulate(storage.getPatch().scenedata[s],
+                                            storage.getPatch().scene[s].modsources.data());
 
          for (int i = 0; i < n_lfos_scene; i++)
             storage.getPatch().scene[s].modsources[ms_slfo1 + i]->process_block();
@@ -3111,14 +3485,8 @@ void SurgeSynthesizer::processControl()
 
    loadOscalgos();
 
-   int n = storage.getPatch().modulation_global.size();
-   for (int i = 0; i < n; i++)
-   {
-      int src_id = storage.getPatch().modulation_global[i].source_id;
-      int dst_id = storage.getPatch().modulation_global[i].destination_id;
-      float depth = storage.getPatch().modulation_global[i].depth;
-      storage.getPatch().globaldata[dst_id].f += depth * storage.getPatch().scene[0].modsources[src_id]->output;
-   }
+   routing->globalMatrix.accumulate(storage.getPatch().globaldata,
+                                    storage.getPatch().scene[0].modsources.data());
 
    if (switch_toggled_queued)
    {
@@ -3127,7 +3495,11 @@ void SurgeSynthesizer::processControl()
    }
 
    if (load_fx_needed)
+   {
+      // Effect changes construct the new effect here on the audio thread
+      Surge::Debug::AllowAllocationScope loadingFX;
       loadFx(false, false);
+   }
 
    if (fx_suspend_bitmask)
    {
@@ -3144,16 +3516,405 @@ void SurgeSynthesizer::processControl()
          refresh_editor |= fx[i]->checkHasInvalidatedUI();
 }
 
+void SurgeSynthesizer::renderScene(int s, int fx_bypass)
+{
+   /*
+   ** Everything in here only touches scene s state (its voices, FBQ, halfband, lowcut and
+   ** insert FX) so it is safe to run for scene B on the scene worker. Both scenes read the
+   ** routing snapshot processControl() acquired for this block, and draw their random numbers
+   ** from their own generators.
+   */
+   Surge::SceneRandom::Scope random(sceneRandom[s]);
+   int vcount = renderSceneVoices(s);
+
+   int q = filterLanes.quadsOf(s);
+   makeFilterCoefficients(filterLanes, FBQ[q], q);
+   runFilterQuads(storage.getPatch().scene[s], FBQ[q], 0, filterLanes.lanesUsed[q], sceneout[s][0], sceneout[s][1]);
+
+   if (s == 0 && storage.otherscene_clients > 0)
+   {
+      // Make available for scene B
+      copy_block(sceneout[0][0], storage.audio_otherscene[0], storage.blockSizeOSQuad);
+      copy_block(sceneout[0][1], storage.audio_otherscene[1], storage.blockSizeOSQuad);
+   }
+
+   finishScene(s, fx_bypass, vcount);
+}
+
+/*
+** Both scenes' voices are in FBQ[0], scene B's after scene A's, and the quad where they meet
+** is run once with its scene B lanes split off into scene B's output.
+*/
+void SurgeSynthesizer::renderCoPackedScenes(int fx_bypass)
+{
+   int vcount[n_scenes];
+   for (int s = 0; s < n_scenes; s++)
+   {
+      Surge::SceneRandom::Scope random(sceneRandom[s]);
+      vcount[s] = renderSceneVoices(s);
+   }
+
+   makeFilterCoefficients(filterLanes, FBQ[0], 0);
+
+   int splitLane = filterLanes.firstLaneOf(1);
+   int sharedLane = splitLane & ~3;
+   int lastLane = filterLanes.lanesUsed[0];
+
+   runFilterQuads(storage.getPatch().scene[0], FBQ[0], 0, sharedLane, sceneout[0][0], sceneout[0][1]);
+
+   fbq_global g;
+   g.FU1ptr = GetQFPtrFilterUnit(storage.getPatch().scene[0].filterunit[0].type.val.i, storage.getPatch().scene[0].filterunit[0].subtype.val.i, storage.filterQuality);
+   g.FU2ptr = GetQFPtrFilterUnit(storage.getPatch().scene[0].filterunit[1].type.val.i, storage.getPatch().scene[0].filterunit[1].subtype.val.i, storage.filterQuality);
+   g.WSptr = GetQFPtrWaveshaper(storage.getPatch().scene[0].wsunit.type.val.i);
+   g.BlockSize = storage.blockSizeOS;
+   g.SplitL = sceneout[1][0];
+   g.SplitR = sceneout[1][1];
+
+   uint32_t splitMask alignas(16)[4];
+   for (int i = 0; i < 4; i++)
+   {
+      splitMask[i] = (sharedLane + i >= splitLane) ? 0xffffffff : 0;
+      if (sharedLane + i >= lastLane)
+      {
+         for (int u = 0; u < 4; u++)
+            FBQ[0][sharedLane >> 2].FU[u].active[i] = 0;
+      }
+   }
+   g.SplitMask = _mm_load_ps((float*)splitMask);
+
+   int fbConfig = storage.getPatch().scene[0].filterblock_configuration.val.i;
+   FBQFPtr ProcessSplitFB = GetFBQPointer(fbConfig, g.FU1ptr != 0, g.WSptr != 0, g.FU2ptr != 0, true);
+   ProcessSplitFB(FBQ[0][sharedLane >> 2], g, sceneout[0][0], sceneout[0][1]);
+
+   runFilterQuads(storage.getPatch().scene[1], FBQ[0], sharedLane + 4, lastLane, sceneout[1][0], sceneout[1][1]);
+
+   for (int s = 0; s < n_scenes; s++)
+   {
+      Surge::SceneRandom::Scope random(sceneRandom[s]);
+      finishScene(s, fx_bypass, vcount[s]);
+   }
+}
+
+/*
+** Are the scenes' filter blocks the same, and do their voices need fewer quads together than
+** apart? Co-packing puts scene B after scene A, so it can't be done when scene B listens to
+** scene A's output.
+*/
+bool SurgeSynthesizer::canCoPackScenes()
+{
+   if (!coPackSceneFilters || storage.otherscene_clients > 0)
+      return false;
+
+   int nA = voices[0].size(), nB = voices[1].size();
+   if (nA + nB > MAX_VOICES || ((nA + 3) >> 2) + ((nB + 3) >> 2) <= ((nA + nB + 3) >> 2))
+      return false;
+
+   auto& a = storage.getPatch().scene[0];
+   auto& b = storage.getPatch().scene[1];
+   if (a.filterblock_configuration.val.i != b.filterblock_configuration.val.i ||
+       a.wsunit.type.val.i != b.wsunit.type.val.i)
+      return false;
+
+   for (int u = 0; u < n_filterunits_per_scene; u++)
+   {
+      if (a.filterunit[u].type.val.i != b.filterunit[u].type.val.i ||
+          a.filterunit[u].subtype.val.i != b.filterunit[u].subtype.val.i)
+         return false;
+   }
+   return true;
+}
+
+/*
+** Run scene s's voices into the lanes filterLanes gave them. Returns how many there were.
+*/
+int SurgeSynthesizer::renderSceneVoices(int s)
+{
+   SurgeVoiceTable::iterator iter;
+   QuadFilterChainState* Q = FBQ[filterLanes.quadsOf(s)];
+   int vcount = 0;
+
+   bool prerender = false;
+   if (fmOperatorQuad && voices[s].size() > 1)
+   {
+      for (int i = 0; i < n_oscs; i++)
+      {
+         int ot = storage.getPatch().scene[s].osc[i].type.val.i;
+         prerender |= (ot == ot_FM2 || ot == ot_FM3);
+      }
+   }
+
+   SurgeVoice* vlist[MAX_VOICES];
+   int nv = 0;
+   if (prerender || (batchVoiceModulators && voices[s].size() > 1))
+   {
+      for (auto v : voices[s])
+         vlist[nv++] = v;
+   }
+
+   if (batchVoiceModulators && nv > 1)
+      SurgeVoice::prerenderModulators(vlist, nv);
+
+   if (prerender)
+   {
+      for (int i = 0; i < nv; i++)
+      {
+         int lane = filterLanes.laneOf(s, voices[s], vlist[i]);
+         vlist[i]->prepare_block(Q[lane >> 2], lane & 3);
+      }
+      SurgeVoice::prerenderFMOscillators(vlist, nv);
+   }
+
+   // A voice which finishes this block keeps its lane, and its slot isn't reused before the
+   // next note, so its coefficients can still be made from filterLanes.laneVoice
+   iter = voices[s].begin();
+   while (iter != voices[s].end())
+   {
+      SurgeVoice* v = *iter;
+      assert(v);
+      int lane = filterLanes.laneOf(s, voices[s], v);
+      bool resume = prerender ? v->render_block(Q[lane >> 2], lane & 3)
+                              : v->process_block(Q[lane >> 2], lane & 3);
+
+      vcount++;
+
+      if (!resume)
+      {
+         //_aligned_free(v);
+         freeVoice(v);
+         iter = voices[s].erase(iter);
+      }
+      else
+         iter++;
+   }
+
+   return vcount;
+}
+
+void SurgeSynthesizer::makeFilterCoefficients(FilterLaneScheduler& lanes, QuadFilterChainState* Q,
+                                              int quads)
+{
+   if (!storage.quadFilterCoefficients)
+      return;
+
+   int n = lanes.lanesUsed[quads];
+   for (int e = 0; e < n; e += 4)
+      SurgeVoice::makeQuadFilterCoefficients(Q[e >> 2], &lanes.laneVoice[quads][e],
+                                             std::min(4, n - e));
+}
+
+/*
+** Run the quads holding lanes firstLane (a multiple of 4) up to lastLane through scene s's filter
+** block into outL and outR. The lanes past lastLane in the last quad are switched off.
+*/
+void SurgeSynthesizer::runFilterQuads(SurgeSceneStorage& scene, QuadFilterChainState* Q,
+                                      int firstLane, int lastLane, float* outL, float* outR)
+{
+   if (lastLane <= firstLane)
+      return;
+
+   fbq_global g;
+   g.FU1ptr = GetQFPtrFilterUnit(scene.filterunit[0].type.val.i, scene.filterunit[0].subtype.val.i, storage.filterQuality);
+   g.FU2ptr = GetQFPtrFilterUnit(scene.filterunit[1].type.val.i, scene.filterunit[1].subtype.val.i, storage.filterQuality);
+   g.WSptr = GetQFPtrWaveshaper(scene.wsunit.type.val.i);
+   g.BlockSize = storage.blockSizeOS;
+
+   int fbConfig = scene.filterblock_configuration.val.i;
+   FBQFPtr ProcessQuadFB = GetFBQPointer(fbConfig, g.FU1ptr != 0, g.WSptr != 0, g.FU2ptr != 0);
+
+   auto clearUnusedLanes = [&](int e) {
+      int units = lastLane - e;
+      for (int i = units; i < 4; i++)
+      {
+         Q[e >> 2].FU[0].active[i] = 0;
+         Q[e >> 2].FU[1].active[i] = 0;
+         Q[e >> 2].FU[2].active[i] = 0;
+         Q[e >> 2].FU[3].active[i] = 0;
+      }
+   };
+
+   int e = firstLane;
+   if (octFilterChains && lastLane - firstLane > 4)
+   {
+      // Pairs of quads through the 8 lane chain, then any quad left over through the 4 lane one
+      fbo_global og;
+      FBOFPtr ProcessOctFB = GetFBOctPointer(fbConfig, g, og);
+      if (ProcessOctFB)
+      {
+         for (; e + 4 < lastLane; e += 8)
+         {
+            clearUnusedLanes(e + 4);
+            ProcessOctFB(Q[e >> 2], Q[(e >> 2) + 1], og, outL, outR);
+         }
+      }
+   }
+
+   for (; e < lastLane; e += 4)
+   {
+      clearUnusedLanes(e);
+      ProcessQuadFB(Q[e >> 2], g, outL, outR);
+   }
+}
+
+/*
+** Once scene s's quads have run: keep the voices' filter state, then downsample, lowcut and run
+** the insert effects.
+*/
+void SurgeSynthesizer::finishScene(int s, int fx_bypass, int vcount)
+{
+   bool play_scene = vcount > 0;
+
+   for (auto v : voices[s])
+      v->GetQFB(storage.keepFilterStateInLanes); // save filter state in voices after quad processing is done
+
+   // TODO: FIX SCENE ASSUMPTION
+   HalfRateFilter& halfband = (s == 0) ? halfbandA : halfbandB;
+   BiquadFilter& hp = (s == 0) ? hpA : hpB;
+
+   if (play_scene)
+   {
+      if (hardclipEnabled){
+         hardclip_block8(sceneout[s][0], storage.blockSizeOSQuad);
+         hardclip_block8(sceneout[s][1], storage.blockSizeOSQuad);
+      }
+      halfband.process_block_D2(sceneout[s][0], sceneout[s][1], storage.blockSizeOS);
+   }
+
+   if (storage.getPatch().scene[s].lowcut.deactivated == false)
+   {
+      hp.coeff_HP(hp.calc_omega(storage.getPatch().scenedata[s][storage.getPatch().scene[s].lowcut.param_id_in_scene].f / 12.0), 0.4); // var 0.707
+      hp.process_block(sceneout[s][0], sceneout[s][1]); // TODO: quadify
+   }
+
+   // apply insert effects
+   bool sc_state = play_scene;
+
+   if (fx_bypass != fxb_no_fx)
+   {
+      for (int i = 2 * s; i < 2 * s + 2; i++)
+      {
+         if (fx[i] && !(storage.getPatch().fx_disable.val.i & (1 << i)))
+            sc_state = fx[i]->process_ringout(sceneout[s][0], sceneout[s][1], sc_state);
+      }
+   }
+
+   sceneVoiceCount[s] = vcount;
+   sceneFXState[s] = sc_state;
+}
+
+void SurgeSynthesizer::setGaplessPatchSwitching(bool b)
+{
+   // As with the scene worker, the thread is made here, off the audio thread, and kept
+   if (b && !patchStagingThread.joinable())
+   {
+      patchStagingWakeup = std::make_unique<WorkerSemaphore>();
+      patchStagingRunning = true;
+      patchStagingThread = std::thread([this]() { runPatchStaging(); });
+   }
+   gaplessPatchSwitching = b;
+}
+
+void SurgeSynthesizer::runPatchStaging()
+{
+   while (true)
+   {
+      patchStagingWakeup->wait();
+      if (!patchStagingRunning)
+         break;
+
+      if (patchStageRequested.exchange(false))
+         stagePatchInBackground();
+
+      if (patchCommitNotifyPending.exchange(false))
+      {
+         updateDisplay();
+#if TARGET_LV2
+         getParent()->patchChanged();
+#endif
+      }
+   }
+}
+
+void SurgeSynthesizer::seedSceneRandom(unsigned int seed)
+{
+   for (int s = 0; s < n_scenes; s++)
+      sceneRandom[s].seed(seed + s);
+}
+
+void SurgeSynthesizer::setParallelSceneProcessing(bool b)
+{
+   // The worker is created here, off the audio thread, and lives until we are destroyed so
+   // toggling the mode never races a block which is mid-dispatch.
+   if (b && !sceneWorker)
+   {
+      sceneWorker = std::make_unique<RealtimeWorker>([this]() {
+         Surge::Debug::NoAllocationScope noAllocation;
+         renderScene(1, sceneWorkerFXBypass);
+      });
+   }
+   parallelSceneProcessing = b;
+}
+
 void SurgeSynthesizer::process()
 {
+   Surge::Debug::NoAllocationScope noAllocation;
    float mfade = 1.f;
 
    if (halt_engine)
    {
-      clear_block(output[0], BLOCK_SIZE_QUAD);
-      clear_block(output[1], BLOCK_SIZE_QUAD);
+      clear_block(output[0], storage.blockSizeQuad);
+      clear_block(output[1], storage.blockSizeQuad);
       return;
    }
+
+   /*
+   ** The previous block ended with nothing sounding. Unless something has happened since, this
+   ** one is silent too, so skip the controls, scenes and effects. The scene and effect state
+   ** simply stays where it was until we wake up.
+   */
+   if (idleCandidate)
+   {
+      if (idleFastPath && engineActivity == idleActivitySeen && voices[0].empty() &&
+          voices[1].empty() && patchid_queue < 0 && !has_patchid_file && !patchStagingInFlight &&
+          !load_fx_needed && !switch_toggled_queued && inputIsSilent())
+      {
+         if (!engineIdle)
+         {
+            for (int sc = 0; sc < n_scenes; ++sc)
+            {
+               clear_block(sceneout[sc][0], storage.blockSizeQuad);
+               clear_block(sceneout[sc][1], storage.blockSizeQuad);
+            }
+            engineIdle = true;
+         }
+         clear_block(output[0], storage.blockSizeQuad);
+         clear_block(output[1], storage.blockSizeQuad);
+         vu_peak[0] *= storage.vu_falloff;
+         vu_peak[1] *= storage.vu_falloff;
+         return;
+      }
+      idleCandidate = false;
+      engineIdle = false;
+   }
+   uint32_t activityAtBlockStart = engineActivity;
+
+   if (gaplessPatchSwitching || patchStagingInFlight)
+   {
+      if (!patchStagingInFlight && (patchid_queue >= 0 || has_patchid_file))
+      {
+         patchStagingInFlight = true;
+         patchStageRequested = true;
+         patchStagingWakeup->signal();
+      }
+
+      // Keep playing the current patch until the next one is ready, then swap it in; the voices
+      // already sounding fade out with the old one (renderOutgoingPatch)
+      if (storage.stagedPatch())
+         commitStagedPatch();
+
+      // Only a halting load dips the output, but one may have been cut short by switching to this
+      masterfade = min(1.f, masterfade + 0.025f);
+      mfade = masterfade * masterfade;
+   }
    else if (patchid_queue >= 0 || has_patchid_file)
    {
       masterfade = max(0.f, masterfade - 0.025f);
@@ -3162,6 +3923,7 @@ void SurgeSynthesizer::process()
       {
          // spawn patch-loading thread
          halt_engine = true;
+         Surge::Debug::AllowAllocationScope spawningThread;
 
 #if MAC || LINUX
          pthread_t thread;
@@ -3194,8 +3956,8 @@ void SurgeSynthesizer::process()
          SetThreadPriority(hThread, THREAD_PRIORITY_NORMAL);
 #endif
 
-         clear_block(output[0], BLOCK_SIZE_QUAD);
-         clear_block(output[1], BLOCK_SIZE_QUAD);
+         clear_block(output[0], storage.blockSizeQuad);
+         clear_block(output[1], storage.blockSizeQuad);
          return;
       }
    }
@@ -3203,37 +3965,36 @@ void SurgeSynthesizer::process()
    // process inputs (upsample & halfrate)
    if (process_input)
    {
-      hardclip_block8(input[0], BLOCK_SIZE_QUAD);
-      hardclip_block8(input[1], BLOCK_SIZE_QUAD);
-      copy_block(input[0], storage.audio_in_nonOS[0], BLOCK_SIZE_QUAD);
-      copy_block(input[1], storage.audio_in_nonOS[1], BLOCK_SIZE_QUAD);
-      halfbandIN.process_block_U2(input[0], input[1], storage.audio_in[0], storage.audio_in[1]);
+      hardclip_block8(input[0], storage.blockSizeQuad);
+      hardclip_block8(input[1], storage.blockSizeQuad);
+      copy_block(input[0], storage.audio_in_nonOS[0], storage.blockSizeQuad);
+      copy_block(input[1], storage.audio_in_nonOS[1], storage.blockSizeQuad);
+      halfbandIN.process_block_U2(input[0], input[1], storage.audio_in[0], storage.audio_in[1],
+                                storage.blockSizeOS);
    }
    else
    {
-      clear_block_antidenormalnoise(storage.audio_in[0], BLOCK_SIZE_OS_QUAD);
-      clear_block_antidenormalnoise(storage.audio_in[1], BLOCK_SIZE_OS_QUAD);
-      clear_block_antidenormalnoise(storage.audio_in_nonOS[1], BLOCK_SIZE_QUAD);
-      clear_block_antidenormalnoise(storage.audio_in_nonOS[1], BLOCK_SIZE_QUAD);
+      clear_block_antidenormalnoise(storage.audio_in[0], storage.blockSizeOSQuad);
+      clear_block_antidenormalnoise(storage.audio_in[1], storage.blockSizeOSQuad);
+      clear_block_antidenormalnoise(storage.audio_in_nonOS[1], storage.blockSizeQuad);
+      clear_block_antidenormalnoise(storage.audio_in_nonOS[1], storage.blockSizeQuad);
    }
 
    // TODO: FIX SCENE ASSUMPTION
-   float fxsendout alignas(16)[2][2][BLOCK_SIZE];
-   bool play_scene[n_scenes];
+   float fxsendout alignas(16)[2][2][BLOCK_SIZE_MAX];
 
    {
-      clear_block_antidenormalnoise(sceneout[0][0], BLOCK_SIZE_OS_QUAD);
-      clear_block_antidenormalnoise(sceneout[0][1], BLOCK_SIZE_OS_QUAD);
-      clear_block_antidenormalnoise(sceneout[1][0], BLOCK_SIZE_OS_QUAD);
-      clear_block_antidenormalnoise(sceneout[1][1], BLOCK_SIZE_OS_QUAD);
+      clear_block_antidenormalnoise(sceneout[0][0], storage.blockSizeOSQuad);
+      clear_block_antidenormalnoise(sceneout[0][1], storage.blockSizeOSQuad);
+      clear_block_antidenormalnoise(sceneout[1][0], storage.blockSizeOSQuad);
+      clear_block_antidenormalnoise(sceneout[1][1], storage.blockSizeOSQuad);
 
-      clear_block_antidenormalnoise(fxsendout[0][0], BLOCK_SIZE_QUAD);
-      clear_block_antidenormalnoise(fxsendout[0][1], BLOCK_SIZE_QUAD);
-      clear_block_antidenormalnoise(fxsendout[1][0], BLOCK_SIZE_QUAD);
-      clear_block_antidenormalnoise(fxsendout[1][1], BLOCK_SIZE_QUAD);
+      clear_block_antidenormalnoise(fxsendout[0][0], storage.blockSizeQuad);
+      clear_block_antidenormalnoise(fxsendout[0][1], storage.blockSizeQuad);
+      clear_block_antidenormalnoise(fxsendout[1][0], storage.blockSizeQuad);
+      clear_block_antidenormalnoise(fxsendout[1][1], storage.blockSizeQuad);
    }
 
-   storage.modRoutingMutex.lock();
    processControl();
 
    amp.set_target_smoothed(db_to_linear(storage.getPatch().volume.val.f));
@@ -3257,140 +4018,50 @@ void SurgeSynthesizer::process()
       }
    }
 
-   list<SurgeVoice*>::iterator iter;
-   
-   for (int sc = 0; sc < n_scenes; sc++)
-   {
-      play_scene[sc] = (!voices[sc].empty());
-   }
+   /*
+   ** Scene B can be rendered on the scene worker while we render scene A. The one
+   ** dependency between them is the scene A audio input of scene B oscillators
+   ** (otherscene_clients), in which case we stay serial so B sees this block of A.
+   */
+   bool renderSceneBOnWorker = parallelSceneProcessing && sceneWorker &&
+                               storage.otherscene_clients == 0 && !voices[1].empty();
+   bool coPack = !renderSceneBOnWorker && canCoPackScenes();
 
-   int FBentry[n_scenes];
-   int vcount = 0;
+   filterLanes.schedule(voices, FBQ, coPack);
 
-   for (int s = 0; s < n_scenes; s++)
+   if (coPack)
    {
-      FBentry[s] = 0;
-      iter = voices[s].begin();
-      while (iter != voices[s].end())
-      {
-         SurgeVoice* v = *iter;
-         assert(v);
-         bool resume = v->process_block(FBQ[s][FBentry[s] >> 2], FBentry[s] & 3);
-         FBentry[s]++;
-
-         vcount++;
-
-         if (!resume)
-         {
-            //_aligned_free(v);
-            freeVoice(v);
-            iter = voices[s].erase(iter);
-         }
-         else
-            iter++;
-      }
-
-      storage.modRoutingMutex.unlock();
-
-      fbq_global g;
-      g.FU1ptr = GetQFPtrFilterUnit(storage.getPatch().scene[s].filterunit[0].type.val.i, storage.getPatch().scene[s].filterunit[0].subtype.val.i);
-      g.FU2ptr = GetQFPtrFilterUnit(storage.getPatch().scene[s].filterunit[1].type.val.i, storage.getPatch().scene[s].filterunit[1].subtype.val.i);
-      g.WSptr = GetQFPtrWaveshaper(storage.getPatch().scene[s].wsunit.type.val.i);
-
-      FBQFPtr ProcessQuadFB = GetFBQPointer(storage.getPatch().scene[s].filterblock_configuration.val.i, g.FU1ptr != 0, g.WSptr != 0, g.FU2ptr != 0);
-
-      for (int e = 0; e < FBentry[s]; e += 4)
-      {
-         int units = FBentry[s] - e;
-         for (int i = units; i < 4; i++)
-         {
-            FBQ[s][e >> 2].FU[0].active[i] = 0;
-            FBQ[s][e >> 2].FU[1].active[i] = 0;
-            FBQ[s][e >> 2].FU[2].active[i] = 0;
-            FBQ[s][e >> 2].FU[3].active[i] = 0;
-         }
-         ProcessQuadFB(FBQ[s][e >> 2], g, sceneout[s][0], sceneout[s][1]);
-      }
-
-      if (s == 0 && storage.otherscene_clients > 0)
-      {
-         // Make available for scene B
-         copy_block(sceneout[0][0], storage.audio_otherscene[0], BLOCK_SIZE_OS_QUAD);
-         copy_block(sceneout[0][1], storage.audio_otherscene[1], BLOCK_SIZE_OS_QUAD);
-      }
-
-      iter = voices[s].begin();
-      while (iter != voices[s].end())
-      {
-         SurgeVoice* v = *iter;
-         assert(v);
-         v->GetQFB(); // save filter state in voices after quad processing is done
-         iter++;
-      }
-      storage.modRoutingMutex.lock();
+      renderCoPackedScenes(fx_bypass);
    }
-
-   storage.modRoutingMutex.unlock();
-   polydisplay = vcount;
-
-   // TODO: FIX SCENE ASSUMPTION
-   if (play_scene[0])
+   else if (renderSceneBOnWorker)
    {
-      if (hardclipEnabled){ 
-         hardclip_block8(sceneout[0][0], BLOCK_SIZE_OS_QUAD);
-         hardclip_block8(sceneout[0][1], BLOCK_SIZE_OS_QUAD);
-      }
-      halfbandA.process_block_D2(sceneout[0][0], sceneout[0][1]);
+      sceneWorkerFXBypass = fx_bypass;
+      sceneWorker->dispatch();
+      renderScene(0, fx_bypass);
+      sceneWorker->join();
    }
-
-   if (play_scene[1])
+   else
    {
-      if (hardclipEnabled){
-         hardclip_block8(sceneout[1][0], BLOCK_SIZE_OS_QUAD);
-         hardclip_block8(sceneout[1][1], BLOCK_SIZE_OS_QUAD);
-      }
-      halfbandB.process_block_D2(sceneout[1][0], sceneout[1][1]);
+      for (int s = 0; s < n_scenes; s++)
+         renderScene(s, fx_bypass);
    }
 
-   // TODO: FIX SCENE ASSUMPTION
-   if (storage.getPatch().scene[0].lowcut.deactivated == false)
-   {
-      hpA.coeff_HP(hpA.calc_omega(storage.getPatch().scenedata[0][storage.getPatch().scene[0].lowcut.param_id_in_scene].f / 12.0), 0.4); // var 0.707
-      hpA.process_block(sceneout[0][0], sceneout[0][1]); // TODO: quadify
-   }
-   if (storage.getPatch().scene[1].lowcut.deactivated == false)
-   {
-      hpB.coeff_HP(hpB.calc_omega(storage.getPatch().scenedata[1][storage.getPatch().scene[1].lowcut.param_id_in_scene].f / 12.0), 0.4);
-      hpB.process_block(sceneout[1][0], sceneout[1][1]);
-   }
+   polydisplay = sceneVoiceCount[0] + sceneVoiceCount[1];
 
    // TODO: FIX SCENE ASSUMPTION
    bool sc_state[n_scenes];
-   
-   for (int i = 0; i < n_scenes; i++)
-   {
-      sc_state[i] = play_scene[i];
-   }
 
-   // apply insert effects
-   if (fx_bypass != fxb_no_fx)
+   for (int i = 0; i < n_scenes; i++)
    {
-      if (fx[0] && !(storage.getPatch().fx_disable.val.i & (1 << 0)))
-         sc_state[0] = fx[0]->process_ringout(sceneout[0][0], sceneout[0][1], sc_state[0]);
-      if (fx[1] && !(storage.getPatch().fx_disable.val.i & (1 << 1)))
-         sc_state[0] = fx[1]->process_ringout(sceneout[0][0], sceneout[0][1], sc_state[0]);
-      if (fx[2] && !(storage.getPatch().fx_disable.val.i & (1 << 2)))
-         sc_state[1] = fx[2]->process_ringout(sceneout[1][0], sceneout[1][1], sc_state[1]);
-      if (fx[3] && !(storage.getPatch().fx_disable.val.i & (1 << 3)))
-         sc_state[1] = fx[3]->process_ringout(sceneout[1][0], sceneout[1][1], sc_state[1]);
+      sc_state[i] = sceneFXState[i];
    }
 
    // sum scenes
    // TODO: FIX SCENE ASSUMPTION
-   copy_block(sceneout[0][0], output[0], BLOCK_SIZE_QUAD);
-   copy_block(sceneout[0][1], output[1], BLOCK_SIZE_QUAD);
-   accumulate_block(sceneout[1][0], output[0], BLOCK_SIZE_QUAD);
-   accumulate_block(sceneout[1][1], output[1], BLOCK_SIZE_QUAD);
+   copy_block(sceneout[0][0], output[0], storage.blockSizeQuad);
+   copy_block(sceneout[0][1], output[1], storage.blockSizeQuad);
+   accumulate_block(sceneout[1][0], output[0], storage.blockSizeQuad);
+   accumulate_block(sceneout[1][1], output[1], storage.blockSizeQuad);
 
    bool send1 = false, send2 = false;
    // add send effects
@@ -3400,57 +4071,78 @@ void SurgeSynthesizer::process()
       if (fx[4] && !(storage.getPatch().fx_disable.val.i & (1 << 4)))
       {
          send[0][0].MAC_2_blocks_to(sceneout[0][0], sceneout[0][1], fxsendout[0][0],
-                                    fxsendout[0][1], BLOCK_SIZE_QUAD);
+                                    fxsendout[0][1], storage.blockSizeQuad);
          send[0][1].MAC_2_blocks_to(sceneout[1][0], sceneout[1][1], fxsendout[0][0],
-                                    fxsendout[0][1], BLOCK_SIZE_QUAD);
+                                    fxsendout[0][1], storage.blockSizeQuad);
          send1 = fx[4]->process_ringout(fxsendout[0][0], fxsendout[0][1], sc_state[0] || sc_state[1]);
          FX1.MAC_2_blocks_to(fxsendout[0][0], fxsendout[0][1], output[0], output[1],
-                             BLOCK_SIZE_QUAD);
+                             storage.blockSizeQuad);
       }
       if (fx[5] && !(storage.getPatch().fx_disable.val.i & (1 << 5)))
       {
          send[1][0].MAC_2_blocks_to(sceneout[0][0], sceneout[0][1], fxsendout[1][0],
-                                    fxsendout[1][1], BLOCK_SIZE_QUAD);
+                                    fxsendout[1][1], storage.blockSizeQuad);
          send[1][1].MAC_2_blocks_to(sceneout[1][0], sceneout[1][1], fxsendout[1][0],
-                                    fxsendout[1][1], BLOCK_SIZE_QUAD);
+                                    fxsendout[1][1], storage.blockSizeQuad);
          send2 = fx[5]->process_ringout(fxsendout[1][0], fxsendout[1][1], sc_state[0] || sc_state[1]);
          FX2.MAC_2_blocks_to(fxsendout[1][0], fxsendout[1][1], output[0], output[1],
-                             BLOCK_SIZE_QUAD);
+                             storage.blockSizeQuad);
       }
    }
 
    // apply global effects
+   bool glob = sc_state[0] || sc_state[1] || send1 || send2;
    if ((fx_bypass == fxb_all_fx) || (fx_bypass == fxb_no_sends))
    {
-      bool glob = sc_state[0] || sc_state[1] || send1 || send2;
       if (fx[6] && !(storage.getPatch().fx_disable.val.i & (1 << 6)))
          glob = fx[6]->process_ringout(output[0], output[1], glob);
       if (fx[7] && !(storage.getPatch().fx_disable.val.i & (1 << 7)))
          glob = fx[7]->process_ringout(output[0], output[1], glob);
    }
 
-   amp.multiply_2_blocks(output[0], output[1], BLOCK_SIZE_QUAD);
-   amp_mute.multiply_2_blocks(output[0], output[1], BLOCK_SIZE_QUAD);
+   if (storage.outgoingPatch())
+   {
+      renderOutgoingPatch(output[0], output[1]);
+      glob = true;
+   }
+
+   amp.multiply_2_blocks(output[0], output[1], storage.blockSizeQuad);
+   amp_mute.multiply_2_blocks(output[0], output[1], storage.blockSizeQuad);
 
    // VU
    // falloff
    float a = storage.vu_falloff;
    vu_peak[0] = min(2.f, a * vu_peak[0]);
    vu_peak[1] = min(2.f, a * vu_peak[1]);
-   vu_peak[0] = max(vu_peak[0], get_absmax(output[0], BLOCK_SIZE_QUAD));
-   vu_peak[1] = max(vu_peak[1], get_absmax(output[1], BLOCK_SIZE_QUAD));
+   float outmax[2] = {get_absmax(output[0], storage.blockSizeQuad), get_absmax(output[1], storage.blockSizeQuad)};
+   vu_peak[0] = max(vu_peak[0], outmax[0]);
+   vu_peak[1] = max(vu_peak[1], outmax[1]);
 
-   hardclip_block8(output[0], BLOCK_SIZE_QUAD);
-   hardclip_block8(output[1], BLOCK_SIZE_QUAD);
+   hardclip_block8(output[0], storage.blockSizeQuad);
+   hardclip_block8(output[1], storage.blockSizeQuad);
 
    // since the sceneout is now routable we also need to mute and clip it
    for (int sc = 0; sc < n_scenes; ++sc)
    {
-      amp.multiply_2_blocks(sceneout[sc][0], sceneout[sc][1], BLOCK_SIZE_QUAD);
-      amp_mute.multiply_2_blocks(sceneout[sc][0], sceneout[sc][1], BLOCK_SIZE_QUAD);
-      hardclip_block8(sceneout[sc][0], BLOCK_SIZE_QUAD);
-      hardclip_block8(sceneout[sc][1], BLOCK_SIZE_QUAD);
+      amp.multiply_2_blocks(sceneout[sc][0], sceneout[sc][1], storage.blockSizeQuad);
+      amp_mute.multiply_2_blocks(sceneout[sc][0], sceneout[sc][1], storage.blockSizeQuad);
+      hardclip_block8(sceneout[sc][0], storage.blockSizeQuad);
+      hardclip_block8(sceneout[sc][1], storage.blockSizeQuad);
    }
+
+   // Can the next block idle? Effects which never ring out (decay < 0) keep glob set for good.
+   idleCandidate = idleFastPath && !glob && mfade == 1.f && voices[0].empty() &&
+                   voices[1].empty() && outmax[0] < idleSilenceThreshold &&
+                   outmax[1] < idleSilenceThreshold && inputIsSilent();
+   for (int i = 0; idleCandidate && i < num_controlinterpolators; i++)
+      idleCandidate = !mControlInterpolatorUsed[i];
+   idleActivitySeen = activityAtBlockStart;
+}
+
+bool SurgeSynthesizer::inputIsSilent()
+{
+   return !process_input || (get_absmax(input[0], storage.blockSizeQuad) < idleSilenceThreshold &&
+                             get_absmax(input[1], storage.blockSizeQuad) < idleSilenceThreshold);
 }
 
 PluginLayer* SurgeSynthesizer::getParent()
@@ -3492,6 +4184,7 @@ void SurgeSynthesizer::populateDawExtraState() {
    }
 
    storage.getPatch().dawExtraState.monoPedalMode = storage.monoPedalMode;
+   storage.getPatch().dawExtraState.filterQuality = storage.filterQuality;
 }
 
 void SurgeSynthesizer::loadFromDawExtraState() {
@@ -3502,6 +4195,7 @@ void SurgeSynthesizer::loadFromDawExtraState() {
       storage.mpePitchBendRange = storage.getPatch().dawExtraState.mpePitchBendRange;
 
    storage.monoPedalMode = (MonoPedalMode)storage.getPatch().dawExtraState.monoPedalMode;
+   storage.filterQuality = (FilterQuality)storage.getPatch().dawExtraState.filterQuality;
 
    if( storage.getPatch().dawExtraState.hasTuning )
    {
@@ -3630,6 +4324,7 @@ void SurgeSynthesizer::swapMetaControllers( int c1, int c2 )
       }
    }
 
+   storage.publishModRouting();
    storage.modRoutingMutex.unlock();
 
    refresh_editor = true;
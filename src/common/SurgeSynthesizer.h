@@ -16,15 +16,23 @@
 #pragma once
 #include "SurgeStorage.h"
 #include "SurgeVoice.h"
+#include "SurgeVoiceTable.h"
 #include "effect/Effect.h"
 #include "BiquadFilter.h"
+#include "OctFilterChain.h"
+#include "FilterCoefficientMemo.h"
+#include "FilterLaneScheduler.h"
 #include "UserInteractions.h"
+#include "util/SceneRandom.h"
 
 struct QuadFilterChainState;
+class RealtimeWorker;
+class WorkerSemaphore;
 
 #include <list>
 #include <utility>
 #include <atomic>
+#include <thread>
 #include <cstdio>
 
 #if TARGET_AUDIOUNIT
@@ -65,10 +73,10 @@ struct parametermeta
 class alignas(16) SurgeSynthesizer
 {
 public:
-   float output alignas(16)[N_OUTPUTS][BLOCK_SIZE];
-   float sceneout alignas(16)[n_scenes][N_OUTPUTS][BLOCK_SIZE_OS]; // this is blocksize_os but has been downsampled by the end of process into block_size
+   float output alignas(16)[N_OUTPUTS][BLOCK_SIZE_MAX];
+   float sceneout alignas(16)[n_scenes][N_OUTPUTS][BLOCK_SIZE_OS_MAX]; // this is blocksize_os but has been downsampled by the end of process into block_size
 
-   float input alignas(16)[N_INPUTS][BLOCK_SIZE];
+   float input alignas(16)[N_INPUTS][BLOCK_SIZE_MAX];
    timedata time_data;
    bool audio_processing_active;
 
@@ -105,11 +113,137 @@ public:
    }
    int getBlockSize()
    {
-      return BLOCK_SIZE;
+      return storage.blockSize;
    }
+   /*
+   ** Choose this instance's block size: a power of two from BLOCK_SIZE_MIN to BLOCK_SIZE_MAX
+   ** (see globals.h). Like setSamplerate, call it while process() isn't running. It stops every
+   ** voice and respawns the effects. Other sizes return false and change nothing.
+   */
+   bool setBlockSize(int bs);
    int getMpeMainChannel(int voiceChannel, int key);
    void process();
 
+   /*
+   ** When enabled, scene B (voices, filter block, downsampling, lowcut and insert FX 3/4)
+   ** renders on a pre-spawned worker thread while scene A renders on the audio thread.
+   ** Call this from a non-audio thread; the worker is created on first enable.
+   */
+   void setParallelSceneProcessing(bool b);
+   bool getParallelSceneProcessing() { return parallelSceneProcessing; }
+
+   /*
+   ** Each scene draws its drift, noise and other render-time random numbers from its own
+   ** generator (see util/SceneRandom.h), so it renders the same on the scene worker as inline.
+   ** They're seeded from rand() at construction; seed them to get a repeatable render.
+   */
+   void seedSceneRandom(unsigned int seed);
+
+   /*
+   ** When enabled, queued patch changes don't halt the engine. The patch is parsed, its
+   ** wavetables built and its effects constructed on a background thread while the current patch
+   ** keeps playing; then process() swaps the new patch in at a block boundary. The voices which
+   ** were sounding carry on with the old patch, its scene LFOs and its effects, fading out over
+   ** gaplessCrossfadeTime under the new one. See stagePatchByPath(), commitStagedPatch() and
+   ** renderOutgoingPatch(). Call this from a non-audio thread; the staging thread is created on
+   ** first enable.
+   */
+   void setGaplessPatchSwitching(bool b);
+   bool getGaplessPatchSwitching() { return gaplessPatchSwitching; }
+   bool isPatchStagingInFlight() { return patchStagingInFlight; }
+
+   /*
+   ** Run the scene filter blocks eight voices at a time with AVX2 where the filter and
+   ** waveshaper types allow it (see OctFilterChain.h). On by default when the CPU supports it;
+   ** asking for it on a CPU which doesn't leaves it off. The 8 lane units don't round quite
+   ** like the quad ones, so with it on the output can differ from the quad path's by up to
+   ** 1e-5; turn it off where renders must match older builds exactly.
+   */
+   void setOctFilterChains(bool b) { octFilterChains = b && OctFilterChainSupported(); }
+   bool getOctFilterChains() { return octFilterChains; }
+
+   /*
+   ** Render the unison voices of the sine, wavetable and window oscillators together
+   ** (see SurgeStorage::batchOscillatorUnison). Turning it off runs them one voice at a time,
+   ** which is the reference the batched paths are tested against.
+   */
+   void setBatchOscillatorUnison(bool b) { storage.batchOscillatorUnison = b; }
+   bool getBatchOscillatorUnison() { return storage.batchOscillatorUnison; }
+
+   /*
+   ** Render the FM2 and FM3 oscillators of a scene's voices four at a time, one voice per SSE
+   ** lane, with a polynomial sine in place of libm's (see FMOperatorQuad.h). The sine differs
+   ** from libm's by less than 3e-7, but with operator feedback that is enough for the output to
+   ** drift away from the scalar path's over time, so this is off by default.
+   */
+   void setFMOperatorQuad(bool b) { fmOperatorQuad = b; }
+   bool getFMOperatorQuad() { return fmOperatorQuad; }
+
+   /*
+   ** Don't run the oscillators whose output can't be heard in a block: those at zero level which
+   ** neither ring modulation nor FM uses, and the FM and ring modulation sources of those. A
+   ** skipped oscillator is moved along to where it would have been, so bringing its level back
+   ** up picks it up in phase.
+   */
+   void setSkipSilentOscillators(bool b) { storage.skipSilentOscillators = b; }
+   bool getSkipSilentOscillators() { return storage.skipSilentOscillators; }
+
+   /*
+   ** Step the LFOs and envelopes of a scene's voices in one pass ahead of the voices, the
+   ** envelopes four voices at a time (see SurgeVoice::prerenderModulators). The digital
+   ** envelopes match the scalar path except for the cubic decay shape; the analog ones and that
+   ** shape differ by around 1e-7.
+   */
+   void setBatchVoiceModulators(bool b) { batchVoiceModulators = b; }
+   bool getBatchVoiceModulators() { return batchVoiceModulators; }
+
+   /*
+   ** Make the filter coefficients of a scene's voices four at a time, one voice per SSE lane,
+   ** and write each quad's coefficients whole rather than lane by lane. The biquads are the
+   ** same as the scalar path's; the SVF's use a polynomial sine so differ by around 1e-7.
+   */
+   void setQuadFilterCoefficients(bool b) { storage.quadFilterCoefficients = b; }
+   bool getQuadFilterCoefficients() { return storage.quadFilterCoefficients; }
+
+   /*
+   ** Share the coefficients of the expensive filter types between a scene's voices and
+   ** blocks, at cutoffs rounded to 1/65536 of a semitone (see FilterCoefficientMemo.h). The
+   ** stats count a scene's lookups since it started.
+   */
+   void setMemoizeFilterCoefficients(bool b) { storage.memoizeFilterCoefficients = b; }
+   bool getMemoizeFilterCoefficients() { return storage.memoizeFilterCoefficients; }
+   FilterCoefficientMemoStats getFilterCoefficientMemoStats(int scene);
+
+   /*
+   ** Leave each voice's filter registers in its quad lane from block to block, and keep voices in
+   ** the lane they had, so only the voices which start or move copy their state (see
+   ** FilterLaneScheduler.h).
+   */
+   void setKeepFilterStateInLanes(bool b) { storage.keepFilterStateInLanes = b; }
+   bool getKeepFilterStateInLanes() { return storage.keepFilterStateInLanes; }
+
+   /*
+   ** When both scenes' filter blocks are set up the same (configuration, filter and waveshaper
+   ** types) and running them together needs fewer quads than running them apart, run them
+   ** together with scene B's voices after scene A's. Scene B then doesn't go to the scene worker
+   ** that block. The stats count the lanes used and run since the synth started.
+   */
+   void setCoPackSceneFilters(bool b) { coPackSceneFilters = b; }
+   bool getCoPackSceneFilters() { return coPackSceneFilters; }
+   FilterLaneStats getFilterLaneStats() { return filterLanes.stats; }
+
+   /*
+   ** Once nothing can sound - no voices, every effect has rung out and the input is silent -
+   ** process() stops rendering and just writes silence, until a note, input audio or a parameter
+   ** change arrives. isEngineIdle() tells whether the last block took that path. Anything which
+   ** changes the synth's state without going through the methods here (playNote, setParameter01
+   ** and friends) should call wakeFromIdle(); it is safe to call from any thread.
+   */
+   void setIdleFastPath(bool b) { idleFastPath = b; }
+   bool getIdleFastPath() { return idleFastPath; }
+   bool isEngineIdle() { return engineIdle; }
+   void wakeFromIdle() { engineActivity++; }
+
    PluginLayer* getParent();
 
    // protected:
@@ -136,10 +270,8 @@ public:
    int getNonUltrareleaseVoices(int scene);
    int getNonReleasedVoices(int scene);
 
-   SurgeVoice* getUnusedVoice(int scene);
    void freeVoice(SurgeVoice*);
    std::array<std::array<SurgeVoice, MAX_VOICES>, 2> voices_array;
-   unsigned int voices_usedby[2][MAX_VOICES]; // 0 indicates no user, 1 is scene A & 2 is scene B   // TODO: FIX SCENE ASSUMPTION!
    int64_t voiceCounter = 1L;
 
 public:
@@ -310,6 +442,9 @@ public:
    void loadRaw(const void* data, int size, bool preset = false);
    void loadPatch(int id);
    bool loadPatchByPath(const char* fxpPath, int categoryId, const char* name );
+   // patchId is the patch's index in patch_list, if it came from there
+   bool stagePatchByPath(const char* fxpPath, int categoryId, const char* name,
+                         int patchId = -1);
    void incrementPatch(bool nextPrev);
    void incrementCategory(bool nextPrev);
 
@@ -343,10 +478,11 @@ public:
    void loadFromDawExtraState();
    
 public:
-   int CC0, CC32, PCH, patchid;
+   int CC0, CC32, PCH;
+   std::atomic<int> patchid{-1}; // set by the audio thread at a gapless commit, read by the UI
    float masterfade = 0;
    HalfRateFilter halfbandA, halfbandB, halfbandIN; // TODO: FIX SCENE ASSUMPTION (for halfbandA/B - use std::array)
-   std::list<SurgeVoice*> voices[n_scenes];
+   SurgeVoiceTable voices[n_scenes]; // backed by voices_array; see SurgeVoiceTable.h
    std::unique_ptr<Effect> fx[n_fx_slots];
    bool halt_engine = false;
    MidiChannelState channelState[16];
@@ -356,7 +492,7 @@ public:
 
    bool hardclipEnabled = true;
 
-   int current_category_id = 0;
+   std::atomic<int> current_category_id{0};
    bool modsourceused[n_modsources];
    bool midiprogramshavechanged = false;
 
@@ -389,6 +525,92 @@ private:
    PluginLayer* _parent = nullptr;
 
    void switch_toggled();
+   void setMixerBlockSize();
+
+   void renderScene(int s, int fx_bypass);
+   void renderCoPackedScenes(int fx_bypass);
+   int renderSceneVoices(int s);
+   void makeFilterCoefficients(FilterLaneScheduler& lanes, QuadFilterChainState* Q, int quads);
+   void runFilterQuads(SurgeSceneStorage& scene, QuadFilterChainState* Q, int firstLane, int lastLane,
+                       float* outL, float* outR);
+   void finishScene(int s, int fx_bypass, int vcount);
+   bool canCoPackScenes();
+   std::unique_ptr<RealtimeWorker> sceneWorker;
+   std::atomic<bool> parallelSceneProcessing{false};
+   std::atomic<bool> coPackSceneFilters{true};
+   FilterLaneScheduler filterLanes;
+   std::atomic<bool> octFilterChains{false};
+   std::atomic<bool> fmOperatorQuad{false};
+   std::atomic<bool> batchVoiceModulators{true};
+   int sceneWorkerFXBypass = 0;
+   Surge::SceneRandom::Generator sceneRandom[n_scenes];
+   int sceneVoiceCount[n_scenes] = {0};
+   bool sceneFXState[n_scenes] = {false};
+
+   void bindSceneModulatorsToPatch(SurgePatch& patch);
+   void spawnEffectsForPatch(SurgePatch& patch, std::unique_ptr<Effect>* into);
+   void stagePatchInBackground();
+   bool commitStagedPatch();
+   void renderOutgoingPatch(float* outL, float* outR);
+   void releaseOutgoingVoices();
+   void afterPatchLoad();
+   void applyPatchTuning();
+   void stagePatchTuning(SurgePatch& patch);
+   void applyStagedTuning();
+   void commitStagedTuning();
+   /*
+   ** The staging thread lives from the first enable until we are destroyed. process() wakes it
+   ** to stage a queued patch, and a commit wakes it to tell the editor and host (which isn't
+   ** done on the audio thread).
+   */
+   void runPatchStaging();
+   std::thread patchStagingThread;
+   std::unique_ptr<WorkerSemaphore> patchStagingWakeup;
+   std::atomic<bool> patchStagingRunning{false}, patchStageRequested{false},
+       patchCommitNotifyPending{false};
+   // patchStagingInFlight holds from process() waking the staging thread until the patch it
+   // replaced has faded out
+   std::atomic<bool> gaplessPatchSwitching{false}, patchStagingInFlight{false};
+   // The staged patch's effects; after a commit, the outgoing patch's, until it has faded out
+   std::unique_ptr<Effect> stagedFx[n_fx_slots];
+   // Stand-ins for the live controller sources, which load_xml sets up on the staged patch
+   ControllerModulationSource stagedControllers[n_customcontrollers], stagedModwheel[n_scenes];
+   // The scene LFOs belong to their patch; these are the ones of the last patch to go out
+   ModulationSource* retiredSceneLfos[n_scenes][n_lfos_scene] = {};
+   // What the commit sets the patch browser to
+   int stagedPatchId = -1, stagedCategoryId = -1;
+   // The patch's tuning, parsed where the user can be asked about it and applied at the commit
+   struct StagedTuning
+   {
+      enum Action
+      {
+         keep,
+         retune,
+         standard,
+      } action = keep;
+      Tunings::Scale scale;
+      Tunings::KeyboardMapping mapping;
+      bool remap = false;
+   } stagedTuning;
+
+   // The voices of the patch a gapless switch replaced, and their scene rendering state
+   SurgeVoiceTable outgoingVoices[n_scenes];
+   QuadFilterChainState* outgoingFBQ[n_scenes];
+   FilterLaneScheduler outgoingLanes;
+   HalfRateFilter outgoingHalfbandA{6, true}, outgoingHalfbandB{6, true};
+   BiquadFilter outgoingLowcutA{&storage}, outgoingLowcutB{&storage};
+   lipol_ps outgoingAmp;
+   float outgoingFade = 0.f, outgoingFadeStep = 1.f;
+   static constexpr float gaplessCrossfadeTime = 0.05f; // seconds
+
+   // Idle fast path. The block after one which ends silent (idleCandidate) takes the idle path
+   // unless engineActivity has moved since that block started.
+   std::atomic<bool> idleFastPath{true};
+   std::atomic<uint32_t> engineActivity{0};
+   uint32_t idleActivitySeen = 0;
+   bool idleCandidate = false, engineIdle = false;
+   static constexpr float idleSilenceThreshold = 1e-6f;
+   bool inputIsSilent();
 
    // midicontrol-interpolators
    static const int num_controlinterpolators = 128;
@@ -158,11 +158,14 @@ void SurgeSynthesizer::loadPatch(int id)
    loadPatchByPath(path_to_string(e.path).c_str(), e.category, e.name.c_str());
 }
 
-bool SurgeSynthesizer::loadPatchByPath( const char* fxpPath, int categoryId, const char* patchName )
+/*
+** Read the chunk out of an .fxp. Returns the malloc()ed chunk, or nullptr with the user told why.
+*/
+static void* readPatchChunk(const char* fxpPath, const char* patchName, int& cs)
 {
    FILE* f = fopen(fxpPath, "rb");
    if (!f)
-      return false;
+      return nullptr;
    fxChunkSetCustom fxp;
    auto read = fread(&fxp, sizeof(fxChunkSetCustom), 1, f);
    // FIXME - error if read != chunk size
@@ -195,10 +198,10 @@ bool SurgeSynthesizer::loadPatchByPath( const char* fxpPath, int categoryId, con
       //}
       oss << "This error usually occurs when you attempt to load an .fxp that belongs to another plugin into Surge.";
       Surge::UserInteractions::promptError( oss.str(), "Unknown FXP File" );
-      return false;
+      return nullptr;
    }
 
-   int cs = vt_read_int32BE(fxp.chunkSize);
+   cs = vt_read_int32BE(fxp.chunkSize);
    void* data = malloc(cs);
    assert(data);
    size_t actual_cs = fread(data, 1, cs, f);
@@ -207,6 +210,16 @@ bool SurgeSynthesizer::loadPatchByPath( const char* fxpPath, int categoryId, con
       perror("Error while loading patch!");
    fclose(f);
 
+   return data;
+}
+
+bool SurgeSynthesizer::loadPatchByPath( const char* fxpPath, int categoryId, const char* patchName )
+{
+   int cs;
+   void* data = readPatchChunk(fxpPath, patchName, cs);
+   if (!data)
+      return false;
+
    storage.getPatch().comment = "";
    storage.getPatch().author = "";
    if( categoryId >= 0 )
@@ -223,51 +236,8 @@ bool SurgeSynthesizer::loadPatchByPath( const char* fxpPath, int categoryId, con
    loadRaw(data, cs, true);
    free(data);
 
-   /*
-   ** OK so at this point we may have loaded a patch with a tuning override
-   */
-   if( storage.getPatch().patchTuning.tuningStoredInPatch )
-   {
-       if( storage.isStandardTuning )
-       {
-          try {
-             storage.retuneToScale(Tunings::parseSCLData(storage.getPatch().patchTuning.tuningContents ));
-             if( storage.getPatch().patchTuning.mappingContents.size() > 1 )
-             {
-                storage.remapToKeyboard(Tunings::parseKBMData(storage.getPatch().patchTuning.mappingContents ) );
-             }
-          }
-          catch( Tunings::TuningError &e )
-          {
-             Surge::UserInteractions::promptError( e.what(), "Error restoring tuning!" );
-             storage.retuneToStandardTuning();
-          }
-       }
-       else
-       {
-           auto okc = Surge::UserInteractions::promptOKCancel(std::string("Loaded patch contains a custom tuning, but there is ") +
-                                                              "already a user-selected tuning in place. Do you want to replace the currently loaded tuning " +
-                                                              "with the tuning stored in the patch? (The rest of the patch will load normally.)",
-                                                              "Replace Tuning");
-           if( okc == Surge::UserInteractions::MessageResult::OK )
-           {
-              try {
-                 storage.retuneToScale(Tunings::parseSCLData(storage.getPatch().patchTuning.tuningContents));
-                 if( storage.getPatch().patchTuning.mappingContents.size() > 1 )
-                 {
-                    storage.remapToKeyboard(Tunings::parseKBMData(storage.getPatch().patchTuning.mappingContents ) );
-                 }
-              }
-              catch( Tunings::TuningError &e )
-              {
-                 Surge::UserInteractions::promptError( e.what(), "Error Restoring Tuning" );
-                 storage.retuneToStandardTuning();
-              }
-           }
-       }
-                                 
-   }
-   
+   applyPatchTuning();
+
    masterfade = 1.f;
    /*
    ** Notify the host display that the patch name has changed
@@ -276,9 +246,184 @@ bool SurgeSynthesizer::loadPatchByPath( const char* fxpPath, int categoryId, con
    return true;
 }
 
+bool SurgeSynthesizer::stagePatchByPath(const char* fxpPath, int categoryId, const char* patchName,
+                                        int patchId)
+{
+   int cs;
+   void* data = readPatchChunk(fxpPath, patchName, cs);
+   if (!data)
+      return false;
+
+   // The patch the last switch replaced has faded out, and its scene LFOs with it
+   for (auto& lfos : retiredSceneLfos)
+   {
+      for (auto& lfo : lfos)
+      {
+         delete lfo;
+         lfo = nullptr;
+      }
+   }
+
+   std::unique_ptr<SurgePatch> patch(new SurgePatch(&storage));
+
+   memset(patch->scenedata, 0, sizeof(patch->scenedata));
+   memset(patch->globaldata, 0, sizeof(patch->globaldata));
+   for (int sc = 0; sc < n_scenes; sc++)
+      for (int i = 0; i < n_filterunits_per_scene; i++)
+         patch->scene[sc].filterunit[i].type.set_user_data(&patch->patchFilterSelectorMapper);
+
+   // The rest of the modulation sources are filled in from the live patch at the commit
+   for (int sc = 0; sc < n_scenes; sc++)
+   {
+      patch->scene[sc].modsources.resize(n_modsources);
+      patch->scene[sc].modsources[ms_modwheel] = &stagedModwheel[sc];
+      for (int i = 0; i < n_customcontrollers; i++)
+         patch->scene[sc].modsources[ms_ctrl1 + i] = &stagedControllers[i];
+      for (int l = 0; l < n_lfos_scene; l++)
+         patch->scene[sc].modsources[ms_slfo1 + l] = new LfoModulationSource();
+   }
+
+   patch->comment = "";
+   patch->author = "";
+   if (categoryId >= 0)
+      patch->category = storage.patch_category[categoryId].name;
+   else
+      patch->category = "Drag & Drop";
+   patch->name = patchName;
+
+   patch->init_default_values();
+   patch->load_patch(data, cs, true);
+   free(data);
+   patch->update_controls(false, nullptr, true);
+
+   // What setParameter01 sets up for filter 2 in offset mode
+   for (int sc = 0; sc < n_scenes; sc++)
+   {
+      auto& cutoff = patch->scene[sc].filterunit[1].cutoff;
+      if (patch->scene[sc].f2_cutoff_is_offset.val.b)
+      {
+         cutoff.set_type(ct_freq_mod);
+         cutoff.set_name("Offset");
+      }
+      else
+      {
+         cutoff.set_type(ct_freq_audible);
+         cutoff.set_name("Cutoff");
+      }
+   }
+   bindSceneModulatorsToPatch(*patch);
+
+   // What afterPatchLoad would find for the patch browser
+   stagedPatchId = patchId;
+   stagedCategoryId = categoryId;
+   if (patchId < 0 && patchid < 0)
+   {
+      for (int p = 0; p < (int)storage.patch_list.size(); ++p)
+      {
+         if (storage.patch_list[p].name == patch->name &&
+             storage.patch_category[storage.patch_list[p].category].name == patch->category)
+         {
+            stagedCategoryId = storage.patch_list[p].category;
+            stagedPatchId = p;
+            break;
+         }
+      }
+   }
+
+   stagePatchTuning(*patch);
+   if (stagedTuning.action == StagedTuning::retune)
+      storage.stageTuningTables(&stagedTuning.scale,
+                                stagedTuning.remap ? &stagedTuning.mapping : nullptr);
+   else if (stagedTuning.action == StagedTuning::standard)
+      storage.stageTuningTables(nullptr, nullptr);
+   spawnEffectsForPatch(*patch, stagedFx);
+   storage.stagePatch(std::move(patch));
+   return true;
+}
+
+void SurgeSynthesizer::applyPatchTuning()
+{
+   stagePatchTuning(storage.getPatch());
+   applyStagedTuning();
+}
+
+/*
+** OK so at this point we may have loaded a patch with a tuning override. Work out what to do
+** about it, asking the user if need be, into stagedTuning.
+*/
+void SurgeSynthesizer::stagePatchTuning(SurgePatch& patch)
+{
+   stagedTuning.action = StagedTuning::keep;
+   if (!patch.patchTuning.tuningStoredInPatch)
+      return;
+
+   const char* errorTitle = "Error restoring tuning!";
+   if (!storage.isStandardTuning)
+   {
+      auto okc = Surge::UserInteractions::promptOKCancel(std::string("Loaded patch contains a custom tuning, but there is ") +
+                                                         "already a user-selected tuning in place. Do you want to replace the currently loaded tuning " +
+                                                         "with the tuning stored in the patch? (The rest of the patch will load normally.)",
+                                                         "Replace Tuning");
+      if (okc != Surge::UserInteractions::MessageResult::OK)
+         return;
+      errorTitle = "Error Restoring Tuning";
+   }
+
+   try
+   {
+      stagedTuning.scale = Tunings::parseSCLData(patch.patchTuning.tuningContents);
+      stagedTuning.remap = patch.patchTuning.mappingContents.size() > 1;
+      if (stagedTuning.remap)
+         stagedTuning.mapping = Tunings::parseKBMData(patch.patchTuning.mappingContents);
+      stagedTuning.action = StagedTuning::retune;
+   }
+   catch (Tunings::TuningError& e)
+   {
+      Surge::UserInteractions::promptError(e.what(), errorTitle);
+      stagedTuning.action = StagedTuning::standard;
+   }
+}
+
+void SurgeSynthesizer::applyStagedTuning()
+{
+   switch (stagedTuning.action)
+   {
+   case StagedTuning::retune:
+      storage.retuneToScale(stagedTuning.scale);
+      if (stagedTuning.remap)
+         storage.remapToKeyboard(stagedTuning.mapping);
+      break;
+   case StagedTuning::standard:
+      storage.retuneToStandardTuning();
+      break;
+   case StagedTuning::keep:
+      break;
+   }
+   stagedTuning.action = StagedTuning::keep;
+}
+
+// The audio thread's half of applyStagedTuning; stagePatchByPath has built the tables
+void SurgeSynthesizer::commitStagedTuning()
+{
+   switch (stagedTuning.action)
+   {
+   case StagedTuning::retune:
+      storage.commitStagedTuning(&stagedTuning.scale,
+                                 stagedTuning.remap ? &stagedTuning.mapping : nullptr);
+      break;
+   case StagedTuning::standard:
+      storage.commitStagedTuning(nullptr, nullptr);
+      break;
+   case StagedTuning::keep:
+      break;
+   }
+   stagedTuning.action = StagedTuning::keep;
+}
+
 void SurgeSynthesizer::loadRaw(const void* data, int size, bool preset)
 {
    halt_engine = true;
+   wakeFromIdle();
    allNotesOff();
    for (int s = 0; s < n_scenes; s++)
       for (int i = 0; i < n_customcontrollers; i++)
@@ -286,6 +431,7 @@ void SurgeSynthesizer::loadRaw(const void* data, int size, bool preset)
 
    storage.getPatch().init_default_values();
    storage.getPatch().load_patch(data, size, preset);
+   storage.publishModRouting();
    storage.getPatch().update_controls(false, nullptr, true);
    for (int i = 0; i < n_fx_slots; i++)
    {
@@ -301,6 +447,11 @@ void SurgeSynthesizer::loadRaw(const void* data, int size, bool preset)
    }
 
    halt_engine = false;
+   afterPatchLoad();
+}
+
+void SurgeSynthesizer::afterPatchLoad()
+{
    patch_loaded = true;
    refresh_editor = true;
 
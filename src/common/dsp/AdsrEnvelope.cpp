@@ -14,3 +14,264 @@
 */
 
 #include "AdsrEnvelope.h"
+#include "FastMath.h"
+
+void AdsrEnvelope::process_block_quad(AdsrEnvelope** env, int n)
+{
+   AdsrEnvelope* e0 = env[0];
+   bool analog = e0->lc[e0->mode].b;
+   bool same = true;
+   for (int i = 1; i < n; i++)
+      same = same && env[i]->adsr == e0->adsr && env[i]->storage == e0->storage &&
+             env[i]->lc[env[i]->mode].b == analog;
+
+   if (n < 2 || !same)
+   {
+      for (int i = 0; i < n; i++)
+         env[i]->process_block();
+      return;
+   }
+
+   ADSRStorage* adsr = e0->adsr;
+   SurgeStorage* storage = e0->storage;
+
+   // The lanes past n run a copy of the first envelope and aren't written back
+   AdsrEnvelope* lane[4];
+   for (int i = 0; i < 4; i++)
+      lane[i] = env[i < n ? i : 0];
+
+   auto sel = [](__m128 m, __m128 a, __m128 b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); };
+   auto isState = [](__m128i st, int s) { return _mm_castsi128_ps(_mm_cmpeq_epi32(st, _mm_set1_epi32(s))); };
+
+   float sparm alignas(16)[4], outv alignas(16)[4];
+   int32_t state alignas(16)[4];
+   for (int i = 0; i < 4; i++)
+      state[i] = lane[i]->envstate;
+   __m128i st = _mm_load_si128((__m128i*)state);
+   const __m128 zero4 = _mm_setzero_ps(), one4 = _mm_set1_ps(1.f);
+
+   if (analog)
+   {
+      // The four lane form of the analog branch of process_block
+      const float v_cc = 1.5f;
+      float v_c1f alignas(16)[4], v_c1_delayedf alignas(16)[4], dischargef alignas(16)[4];
+      float xA alignas(16)[4], xD alignas(16)[4], xR alignas(16)[4];
+
+      const float coeff_offset = 2.f - log(samplerate / storage->blockSize) / log(2.f);
+      float tsA = adsr->a.temposync ? storage->temposyncratio : 1.f;
+      float tsD = adsr->d.temposync ? storage->temposyncratio : 1.f;
+      float tsR = adsr->r.temposync ? storage->temposyncratio : 1.f;
+
+      for (int i = 0; i < 4; i++)
+      {
+         auto e = lane[i];
+         v_c1f[i] = e->_v_c1;
+         v_c1_delayedf[i] = e->_v_c1_delayed;
+         dischargef[i] = e->_discharge;
+         sparm[i] = limit_range(e->lc[e->s].f, 0.f, 1.f);
+         xA[i] = std::min(0.f, coeff_offset - e->lc[e->a].f * tsA);
+         xD[i] = std::min(0.f, coeff_offset - e->lc[e->d].f * tsD);
+         xR[i] = std::min(0.f, coeff_offset - e->lc[e->r].f * tsR);
+      }
+
+      __m128 v_c1 = _mm_load_ps(v_c1f);
+      __m128 v_c1_delayed = _mm_load_ps(v_c1_delayedf);
+      __m128 discharge = _mm_load_ps(dischargef);
+      const __m128 v_cc_vec = _mm_set1_ps(v_cc);
+
+      __m128 gate = _mm_or_ps(isState(st, s_attack), isState(st, s_decay));
+      __m128 v_gate = _mm_and_ps(gate, v_cc_vec);
+      __m128 v_is_gate = _mm_cmpgt_ps(v_gate, zero4);
+
+      discharge = _mm_and_ps(_mm_or_ps(_mm_cmpgt_ps(v_c1_delayed, one4), discharge), v_is_gate);
+      v_c1_delayed = v_c1;
+
+      __m128 S = _mm_load_ps(sparm);
+      S = _mm_mul_ps(S, S);
+      __m128 v_attack = _mm_andnot_ps(discharge, v_gate);
+      __m128 v_decay = _mm_or_ps(_mm_andnot_ps(discharge, v_cc_vec), _mm_and_ps(discharge, S));
+      __m128 v_release = v_gate;
+
+      __m128 diff_v_a = _mm_max_ps(zero4, _mm_sub_ps(v_attack, v_c1));
+
+      __m128 diff_vd_kernel = _mm_sub_ps(v_decay, v_c1);
+      __m128 diff_vd_kernel_min = _mm_min_ps(zero4, diff_vd_kernel);
+      __m128 dis_and_gate = _mm_and_ps(discharge, v_is_gate);
+      __m128 diff_v_d = sel(dis_and_gate, diff_vd_kernel, diff_vd_kernel_min);
+
+      __m128 diff_v_r = _mm_min_ps(zero4, _mm_sub_ps(v_release, v_c1));
+
+      __m128 coef_A = Surge::DSP::pow2SSE(_mm_load_ps(xA));
+      __m128 coef_D = Surge::DSP::pow2SSE(_mm_load_ps(xD));
+      __m128 coef_R = sel(isState(st, s_uberrelease), _mm_set1_ps(6.f),
+                          Surge::DSP::pow2SSE(_mm_load_ps(xR)));
+
+      v_c1 = _mm_add_ps(v_c1, _mm_mul_ps(diff_v_a, coef_A));
+      v_c1 = _mm_add_ps(v_c1, _mm_mul_ps(diff_v_d, coef_D));
+      v_c1 = _mm_add_ps(v_c1, _mm_mul_ps(diff_v_r, coef_R));
+
+      _mm_store_ps(v_c1f, v_c1);
+      _mm_store_ps(v_c1_delayedf, v_c1_delayed);
+      _mm_store_ps(dischargef, discharge);
+
+      const float SILENCE_THRESHOLD = 1e-6;
+
+      for (int i = 0; i < n; i++)
+      {
+         auto e = env[i];
+         bool g = (e->envstate == s_attack) || (e->envstate == s_decay);
+         e->_v_c1 = v_c1f[i];
+         e->_v_c1_delayed = v_c1_delayedf[i];
+         e->_discharge = dischargef[i];
+         e->output = v_c1f[i];
+
+         if (!g && e->_discharge == 0.f && e->_v_c1 < SILENCE_THRESHOLD)
+         {
+            e->envstate = s_idle;
+            e->output = 0;
+            e->idlecount++;
+         }
+      }
+      return;
+   }
+
+   /*
+   ** The digital mode. Each lane looks up the rate of the stage it is in, then every stage's
+   ** step is made for all four and each lane keeps its own.
+   */
+   float phasef alignas(16)[4], ratef alignas(16)[4], scalef alignas(16)[4], decayf alignas(16)[4];
+   int32_t a_s alignas(16)[4], d_s alignas(16)[4], r_s alignas(16)[4];
+   float tsA = adsr->a.temposync ? storage->temposyncratio : 1.f;
+   float tsD = adsr->d.temposync ? storage->temposyncratio : 1.f;
+   float tsR = adsr->r.temposync ? storage->temposyncratio : 1.f;
+   int max_r_s = 0;
+
+   for (int i = 0; i < 4; i++)
+   {
+      auto e = lane[i];
+      phasef[i] = e->phase;
+      outv[i] = e->output;
+      scalef[i] = e->scalestage;
+      sparm[i] = e->lc[e->s].f;
+      decayf[i] = e->lc[e->d].f;
+      a_s[i] = e->lc[e->a_s].i;
+      d_s[i] = e->lc[e->d_s].i;
+      r_s[i] = e->lc[e->r_s].i;
+      max_r_s = std::max(max_r_s, r_s[i]);
+
+      switch (e->envstate)
+      {
+      case s_attack:
+         ratef[i] = storage->envelope_rate_linear_nowrap(e->lc[e->a].f) * tsA;
+         break;
+      case s_decay:
+         ratef[i] = storage->envelope_rate_linear_nowrap(e->lc[e->d].f) * tsD;
+         break;
+      case s_release:
+         ratef[i] = storage->envelope_rate_linear_nowrap(e->lc[e->r].f) * tsR;
+         break;
+      case s_uberrelease:
+         ratef[i] = storage->envelope_rate_linear_nowrap(-6.5);
+         break;
+      default:
+         ratef[i] = 0.f;
+         break;
+      }
+   }
+
+   __m128 phase = _mm_load_ps(phasef);
+   __m128 rate = _mm_load_ps(ratef);
+   __m128 output = _mm_load_ps(outv);
+   __m128 sus = _mm_load_ps(sparm);
+   __m128i as = _mm_load_si128((__m128i*)a_s), ds = _mm_load_si128((__m128i*)d_s),
+           rs = _mm_load_si128((__m128i*)r_s);
+
+   // attack
+   __m128 inAttack = isState(st, s_attack);
+   __m128 pa = _mm_add_ps(phase, rate);
+   __m128 reached = _mm_and_ps(inAttack, _mm_cmpge_ps(pa, one4));
+   pa = sel(reached, one4, pa);
+   __m128 oa = sel(isState(as, 0), _mm_sqrt_ps(pa), output);
+   oa = sel(isState(as, 1), pa, oa);
+   oa = sel(isState(as, 2), _mm_mul_ps(pa, pa), oa);
+
+   // decay, with the shapes' bounds on where this block can move the level to
+   __m128 inDecay = isState(st, s_decay);
+   __m128 rr = _mm_mul_ps(rate, rate);
+   __m128 l_lo = _mm_sub_ps(phase, rate), l_hi = _mm_add_ps(phase, rate);
+
+   __m128 quad = isState(ds, 1);
+   if (_mm_movemask_ps(_mm_and_ps(inDecay, quad)))
+   {
+      __m128 sx2r = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(2.f), _mm_sqrt_ps(phase)), rate);
+      __m128 lo = _mm_add_ps(_mm_sub_ps(phase, sx2r), rr);
+      __m128 hi = _mm_add_ps(_mm_add_ps(phase, sx2r), rr);
+
+      // process_block compares these in double; (float)1e-4 is just under 1e-4, hence the <=
+      const double bs32 = storage->blockSize / 32.0;
+      __m128 dec = _mm_load_ps(decayf);
+      __m128 lowSus = _mm_or_ps(
+          _mm_and_ps(_mm_cmplt_ps(sus, _mm_set1_ps(1e-3f)),
+                     _mm_cmple_ps(phase, _mm_set1_ps((float)(1e-4 * bs32 * bs32)))),
+          _mm_and_ps(_mm_cmpeq_ps(sus, zero4), _mm_cmplt_ps(dec, _mm_set1_ps(-7.f))));
+      lo = _mm_andnot_ps(lowSus, lo);
+      __m128 fast = _mm_and_ps(_mm_cmpgt_ps(rate, one4), _mm_cmpgt_ps(lo, sus));
+      lo = sel(fast, sus, lo);
+
+      l_lo = sel(quad, lo, l_lo);
+      l_hi = sel(quad, hi, l_hi);
+   }
+
+   __m128 cubic = isState(ds, 2);
+   if (_mm_movemask_ps(_mm_and_ps(inDecay, cubic)))
+   {
+      __m128 sx = Surge::DSP::cbrtSSE(phase);
+      __m128 three_sx = _mm_mul_ps(_mm_set1_ps(3.f), sx);
+      __m128 t1 = _mm_mul_ps(_mm_mul_ps(three_sx, sx), rate);
+      __m128 t2 = _mm_mul_ps(_mm_mul_ps(three_sx, rate), rate);
+      __m128 t3 = _mm_mul_ps(rr, rate);
+      __m128 lo = _mm_sub_ps(_mm_add_ps(_mm_sub_ps(phase, t1), t2), t3);
+      __m128 hi = _mm_add_ps(_mm_add_ps(_mm_add_ps(phase, t1), t2), t3);
+
+      l_lo = sel(cubic, lo, l_lo);
+      l_hi = sel(cubic, hi, l_hi);
+   }
+   __m128 pd = _mm_min_ps(_mm_max_ps(sus, l_lo), l_hi);
+
+   // release and uber release
+   __m128 inRelease = _mm_or_ps(isState(st, s_release), isState(st, s_uberrelease));
+   __m128 pr = _mm_sub_ps(phase, rate);
+   __m128 orl = pr;
+   for (int k = 0; k < max_r_s; k++)
+      orl = sel(_mm_castsi128_ps(_mm_cmpgt_epi32(rs, _mm_set1_epi32(k))), _mm_mul_ps(orl, pr), orl);
+   __m128 ended = _mm_and_ps(inRelease, _mm_cmplt_ps(pr, zero4));
+   orl = _mm_mul_ps(_mm_andnot_ps(ended, orl), _mm_load_ps(scalef));
+
+   phase = sel(inAttack, pa, sel(inDecay, pd, sel(inRelease, pr, phase)));
+   output = sel(inAttack, oa, sel(inDecay, pd, sel(inRelease, orl, output)));
+   output = _mm_min_ps(_mm_max_ps(output, zero4), one4);
+
+   int reachedMask = _mm_movemask_ps(reached), endedMask = _mm_movemask_ps(ended);
+   _mm_store_ps(phasef, phase);
+   _mm_store_ps(outv, output);
+
+   for (int i = 0; i < n; i++)
+   {
+      auto e = env[i];
+      e->phase = phasef[i];
+      e->output = outv[i];
+      if (reachedMask & (1 << i))
+      {
+         e->envstate = s_decay;
+         e->sustain = sparm[i];
+      }
+      else if (endedMask & (1 << i))
+      {
+         e->envstate = s_idle;
+      }
+      else if (e->envstate == s_idle)
+      {
+         e->idlecount++;
+      }
+   }
+}
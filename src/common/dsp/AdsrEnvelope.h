@@ -206,7 +206,7 @@ public:
          // calculate coefficients for envelope
          const float shortest = 6.f;
          const float longest = -2.f;
-         const float coeff_offset = 2.f - log(samplerate / BLOCK_SIZE) / log(2.f);
+         const float coeff_offset = 2.f - log(samplerate / storage->blockSize) / log(2.f);
 
          float coef_A =
              powf(2.f, std::min(0.f, coeff_offset -
@@ -247,7 +247,7 @@ public:
          case (s_attack):
          {
             phase +=
-                envelope_rate_linear_nowrap(lc[a].f) * (adsr->a.temposync ? storage->temposyncratio : 1.f);
+                storage->envelope_rate_linear_nowrap(lc[a].f) * (adsr->a.temposync ? storage->temposyncratio : 1.f);
             if (phase >= 1)
             {
                phase = 1;
@@ -278,7 +278,7 @@ public:
             phase = sustain;
             }*/
             float rate =
-               envelope_rate_linear_nowrap(lc[d].f) * (adsr->d.temposync ? storage->temposyncratio : 1.f);
+               storage->envelope_rate_linear_nowrap(lc[d].f) * (adsr->d.temposync ? storage->temposyncratio : 1.f);
 
             float l_lo, l_hi;
 
@@ -294,9 +294,11 @@ public:
                ** That + rate * rate in both means at low sustain ( < 1e-3 or so) you end up with
                ** lo and hi both pushing us up off sustain. Unfortunatley we ned to handle that case
                ** specially by pushing lo down. These limits are pretty empirical. Git blame to see
-               ** the various issues around here which show the test cases.
+               ** the various issues around here which show the test cases. The rate is per block,
+               ** so the phase limit was found at 32 samples and goes with the square of the block size.
                */
-               if( ( lc[s].f < 1e-3 && phase < 1e-4 ) || ( lc[s].f == 0 && lc[d].f < -7 ) )
+               const double bs32 = storage->blockSize / 32.0;
+               if( ( lc[s].f < 1e-3 && phase < 1e-4 * bs32 * bs32 ) || ( lc[s].f == 0 && lc[d].f < -7 ) )
                   l_lo = 0;
                /*
                ** Similarly if the rate is very high - larger than one - we can push l_lo well above the
@@ -329,7 +331,7 @@ public:
          case (s_release):
          {
             phase -=
-                envelope_rate_linear_nowrap(lc[r].f) * (adsr->r.temposync ? storage->temposyncratio : 1.f);
+                storage->envelope_rate_linear_nowrap(lc[r].f) * (adsr->r.temposync ? storage->temposyncratio : 1.f);
             output = phase;
             for (int i = 0; i < lc[r_s].i; i++)
                output *= phase;
@@ -344,7 +346,7 @@ public:
          break;
          case (s_uberrelease):
          {
-            phase -= envelope_rate_linear_nowrap(-6.5);
+            phase -= storage->envelope_rate_linear_nowrap(-6.5);
             output = phase;
             for (int i = 0; i < lc[r_s].i; i++)
                output *= phase;
@@ -366,7 +368,16 @@ public:
    }
 
    int getEnvState() { return envstate; }
-   
+
+   /*
+   ** Step n (up to four) envelopes of the same ADSRStorage together, one per SSE lane: their
+   ** state is gathered into vectors, run through both modes' stages at once and written back.
+   ** The digital mode matches process_block exactly except for the cubic decay shape, whose cube
+   ** root is done by Newton's method; the analog mode's 2^x coefficients are a polynomial, within
+   ** 2e-7 of powf's. Envelopes of different storages or modes are just processed one by one.
+   */
+   static void process_block_quad(AdsrEnvelope** env, int n);
+
 private:
    ADSRStorage* adsr = nullptr;
    SurgeVoiceState* state = nullptr;
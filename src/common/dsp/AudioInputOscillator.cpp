@@ -109,7 +109,7 @@ void AudioInputOscillator::process_block(
 
    if (stereo)
    {
-      for (int k = 0; k < BLOCK_SIZE_OS; k++)
+      for (int k = 0; k < storage->blockSizeOS; k++)
       {
          if( useOtherScene )
          {
@@ -125,7 +125,7 @@ void AudioInputOscillator::process_block(
    }
    else
    {
-      for (int k = 0; k < BLOCK_SIZE_OS; k++)
+      for (int k = 0; k < storage->blockSizeOS; k++)
       {
          if( useOtherScene )
          {
@@ -158,7 +158,7 @@ void AudioInputOscillator::applyFilter()
       lp.coeff_LP2B(lp.calc_omega(pv / 12.0) / OSC_OVERSAMPLING, 0.707);
    }
 
-   for (int k = 0; k < BLOCK_SIZE_OS; k += BLOCK_SIZE)
+   for (int k = 0; k < storage->blockSizeOS; k += storage->blockSize)
    {
       if (!oscdata->p[audioin_lowcut].deactivated)
          hp.process_block(&(output[k]), &(outputR[k]));
@@ -43,6 +43,14 @@ public:
    virtual void init(float pitch, bool is_display = false) override;
    virtual void process_block(
        float pitch, float drift = 0.f, bool stereo = false, bool FM = false, float FMdepth = 0.f) override;
+   // The input is all there is to it, so there's nothing to move along
+   virtual void skip_block(
+       float pitch, float drift = 0.f, bool stereo = false, bool FM = false, float FMdepth = 0.f) override
+   {}
+   virtual bool skip_needs_fm() override
+   {
+      return false;
+   }
    virtual ~AudioInputOscillator();
    virtual void init_ctrltypes(int scene, int osc) override;
    virtual void init_default_values() override;
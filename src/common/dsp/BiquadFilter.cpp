@@ -287,7 +287,7 @@ void BiquadFilter::process_block(float* data)
    else*/
    {
       int k;
-      for (k = 0; k < BLOCK_SIZE; k++)
+      for (k = 0; k < storage->blockSize; k++)
       {
          a1.process();
          a2.process();
@@ -315,7 +315,7 @@ void BiquadFilter::process_block_to(float* __restrict data, float* __restrict da
    else*/
    {
       int k;
-      for (k = 0; k < BLOCK_SIZE; k++)
+      for (k = 0; k < storage->blockSize; k++)
       {
          a1.process();
          a2.process();
@@ -349,7 +349,7 @@ void BiquadFilter::process_block_slowlag(float* __restrict dataL, float* __restr
       b2.process();
 
       int k;
-      for (k = 0; k < BLOCK_SIZE; k++)
+      for (k = 0; k < storage->blockSize; k++)
       {
          double input = dataL[k];
          double op;
@@ -380,7 +380,7 @@ void BiquadFilter::process_block(float* dataL, float* dataR)
    else*/
    {
       int k;
-      for (k = 0; k < BLOCK_SIZE; k++)
+      for (k = 0; k < storage->blockSize; k++)
       {
          a1.process();
          a2.process();
@@ -417,7 +417,7 @@ void BiquadFilter::process_block_to(float* dataL, float* dataR, float* dstL, flo
    else*/
    {
       int k;
-      for (k = 0; k < BLOCK_SIZE; k++)
+      for (k = 0; k < storage->blockSize; k++)
       {
          a1.process();
          a2.process();
@@ -454,7 +454,7 @@ void BiquadFilter::process_block(double* data)
    else*/
    {
       int k;
-      for (k = 0; k < BLOCK_SIZE; k++)
+      for (k = 0; k < storage->blockSize; k++)
       {
          a1.process();
          a2.process();
@@ -53,6 +53,17 @@ public:
       r = dr * lr - di * li;
       i = dr * li + di * lr;
    }
+   // n calls to process() in one rotation
+   inline void advance(int n)
+   {
+      double w = n * atan2((double)di, (double)dr);
+      float cr = cos(w), ci = sin(w), lr = r, li = i;
+      r = cr * lr - ci * li;
+      i = cr * li + ci * lr;
+   }
+   // The per sample rotation, for code which runs several of these in SIMD lanes
+   inline float get_dr() const { return dr; }
+   inline float get_di() const { return di; }
 
 public:
    float r, i;
@@ -67,6 +78,7 @@ public:
    lipol()
    {
       reset();
+      setBlockSize(BLOCK_SIZE_DEFAULT);
    }
    void reset()
    {
@@ -75,7 +87,6 @@ public:
       new_v = 0;
       v = 0;
       dv = 0;
-      setBlockSize(BLOCK_SIZE);
    }
    inline void newValue(T f)
    {
@@ -171,6 +182,10 @@ public:
    {
       v = v * lpinv + target_v * lp;
    }
+   inline T getRate() const
+   {
+      return lp;
+   }
    // void setBlockSize(int n){ bs_inv = 1/(T)n; }
    T v;
    T target_v;
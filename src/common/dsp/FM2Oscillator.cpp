@@ -46,12 +46,12 @@ void FM2Oscillator::init(float pitch, bool is_display)
 FM2Oscillator::~FM2Oscillator()
 {}
 
-void FM2Oscillator::process_block(float pitch, float drift, bool stereo, bool FM, float fmdepth)
+void FM2Oscillator::setup_block(float pitch, float drift, bool FM, float fmdepth)
 {
    driftlfo = drift_noise(driftlfo2) * drift;
    fb_val = oscdata->p[fm2_feedback].get_extended(localcopy[oscdata->p[fm2_feedback].param_id_in_scene].f);
 
-   double omega = min(M_PI, (double)pitch_to_omega(pitch + driftlfo));
+   omega = min(M_PI, (double)pitch_to_omega(pitch + driftlfo));
    double shift = localcopy[oscdata->p[fm2_m12offset].param_id_in_scene].f * dsamplerate_inv;
 
    RM1.set_rate(min(M_PI, (double)pitch_to_omega(pitch + driftlfo) *
@@ -70,8 +70,34 @@ void FM2Oscillator::process_block(float pitch, float drift, bool stereo, bool FM
 
    FeedbackDepth.newValue(abs(fb_val));
    PhaseOffset.newValue(2.0 * M_PI * localcopy[oscdata->p[fm2_m12phase].param_id_in_scene].f);
+}
+
+FMOperatorStack FM2Oscillator::operator_stack(float pitch, float drift, bool stereo)
+{
+   setup_block(pitch, drift, false, 0.f);
+
+   FMOperatorStack s;
+   s.nmods = 2;
+   s.mod[0] = &RM1;
+   s.mod[1] = &RM2;
+   s.depth[0] = &RelModDepth1;
+   s.depth[1] = &RelModDepth2;
+   s.phaseOffset = &PhaseOffset;
+   s.feedback = &FeedbackDepth;
+   s.squaredFeedback = fb_val < 0;
+   s.phase = &phase;
+   s.lastoutput = &lastoutput;
+   s.omega = omega;
+   s.output = output;
+   s.outputR = stereo ? outputR : nullptr;
+   return s;
+}
 
-   for (int k = 0; k < BLOCK_SIZE_OS; k++)
+void FM2Oscillator::process_block(float pitch, float drift, bool stereo, bool FM, float fmdepth)
+{
+   setup_block(pitch, drift, FM, fmdepth);
+
+   for (int k = 0; k < storage->blockSizeOS; k++)
    {
       RM1.process();
       RM2.process();
@@ -95,9 +121,35 @@ void FM2Oscillator::process_block(float pitch, float drift, bool stereo, bool FM
    }
    if (stereo)
    {
-      memcpy(outputR, output, sizeof(float) * BLOCK_SIZE_OS);
+      memcpy(outputR, output, sizeof(float) * storage->blockSizeOS);
+   }
+}
+void FM2Oscillator::skip_block(float pitch, float drift, bool stereo, bool FM, float fmdepth)
+{
+   setup_block(pitch, drift, FM, fmdepth);
+
+   // The modulators and the carrier phase move on by a block at once
+   RM1.advance(storage->blockSizeOS);
+   RM2.advance(storage->blockSizeOS);
+   phase += storage->blockSizeOS * omega;
+   if (phase > 2.0 * M_PI)
+      phase = fmod(phase, 2.0 * M_PI);
+
+   for (int k = 0; k < storage->blockSizeOS; k++)
+   {
+      RelModDepth1.process();
+      RelModDepth2.process();
+      FeedbackDepth.process();
+      PhaseOffset.process();
+      if (FM)
+         FMdepth.process();
    }
+
+   // The feedback carries on from an estimate of the block's last sample
+   double out = sin(phase - omega + RelModDepth1.v * RM1.r + RelModDepth2.v * RM2.r + lastoutput + PhaseOffset.v);
+   lastoutput = (fb_val < 0) ? out * out * FeedbackDepth.v : out * FeedbackDepth.v;
 }
+
 void FM2Oscillator::init_ctrltypes()
 {
    oscdata->p[fm2_m1amount].set_name("M1 Amount");
@@ -39,12 +39,12 @@ void FM3Oscillator::init(float pitch, bool is_display)
 FM3Oscillator::~FM3Oscillator()
 {}
 
-void FM3Oscillator::process_block(float pitch, float drift, bool stereo, bool FM, float fmdepth)
+void FM3Oscillator::setup_block(float pitch, float drift, bool FM, float fmdepth)
 {
    driftlfo = drift_noise(driftlfo2) * drift;
    fb_val = oscdata->p[fm3_feedback].get_extended(localcopy[oscdata->p[fm3_feedback].param_id_in_scene].f);
 
-   double omega = min(M_PI, (double)pitch_to_omega(pitch + driftlfo));
+   omega = min(M_PI, (double)pitch_to_omega(pitch + driftlfo));
 
    auto m1 = oscdata->p[fm3_m1ratio].get_extended(localcopy[oscdata->p[fm3_m1ratio].param_id_in_scene].f);
    if (m1 < 0)
@@ -92,8 +92,35 @@ void FM3Oscillator::process_block(float pitch, float drift, bool stereo, bool FM
       FMdepth.newValue(32.0 * M_PI * fmdepth * fmdepth * fmdepth);
 
    FeedbackDepth.newValue(abs(fb_val));
+}
+
+FMOperatorStack FM3Oscillator::operator_stack(float pitch, float drift, bool stereo)
+{
+   setup_block(pitch, drift, false, 0.f);
+
+   FMOperatorStack s;
+   s.nmods = 3;
+   s.mod[0] = &RM1;
+   s.mod[1] = &RM2;
+   s.mod[2] = &AM;
+   s.depth[0] = &RelModDepth1;
+   s.depth[1] = &RelModDepth2;
+   s.depth[2] = &AbsModDepth;
+   s.feedback = &FeedbackDepth;
+   s.squaredFeedback = fb_val < 0;
+   s.phase = &phase;
+   s.lastoutput = &lastoutput;
+   s.omega = omega;
+   s.output = output;
+   s.outputR = stereo ? outputR : nullptr;
+   return s;
+}
 
-   for (int k = 0; k < BLOCK_SIZE_OS; k++)
+void FM3Oscillator::process_block(float pitch, float drift, bool stereo, bool FM, float fmdepth)
+{
+   setup_block(pitch, drift, FM, fmdepth);
+
+   for (int k = 0; k < storage->blockSizeOS; k++)
    {
       RM1.process();
       RM2.process();
@@ -120,8 +147,35 @@ void FM3Oscillator::process_block(float pitch, float drift, bool stereo, bool FM
    }
    if (stereo)
    {
-      memcpy(outputR, output, sizeof(float) * BLOCK_SIZE_OS);
+      memcpy(outputR, output, sizeof(float) * storage->blockSizeOS);
+   }
+}
+
+void FM3Oscillator::skip_block(float pitch, float drift, bool stereo, bool FM, float fmdepth)
+{
+   setup_block(pitch, drift, FM, fmdepth);
+
+   // The modulators and the carrier phase move on by a block at once
+   RM1.advance(storage->blockSizeOS);
+   RM2.advance(storage->blockSizeOS);
+   AM.advance(storage->blockSizeOS);
+   phase += storage->blockSizeOS * omega;
+   if (phase > 2.0 * M_PI)
+      phase = fmod(phase, 2.0 * M_PI);
+
+   for (int k = 0; k < storage->blockSizeOS; k++)
+   {
+      RelModDepth1.process();
+      RelModDepth2.process();
+      AbsModDepth.process();
+      FeedbackDepth.process();
+      if (FM)
+         FMdepth.process();
    }
+
+   // The feedback carries on from an estimate of the block's last sample
+   double out = sin(phase - omega + RelModDepth1.v * RM1.r + RelModDepth2.v * RM2.r + AbsModDepth.v * AM.r + lastoutput);
+   lastoutput = (fb_val < 0) ? out * out * FeedbackDepth.v : out * FeedbackDepth.v;
 }
 
 void FM3Oscillator::init_ctrltypes()
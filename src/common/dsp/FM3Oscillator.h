@@ -19,6 +19,7 @@
 #include "DspUtilities.h"
 #include <vt_dsp/lipol.h>
 #include "BiquadFilter.h"
+#include "FMOperatorQuad.h"
 
 class FM3Oscillator : public Oscillator
 {
@@ -38,10 +39,22 @@ public:
    virtual void init(float pitch, bool is_display = false) override;
    virtual void process_block(
        float pitch, float drift = 0.f, bool stereo = false, bool FM = false, float FMdepth = 0.f) override;
+   /*
+   ** Set up the block as process_block does (without FM) and describe the oscillator for
+   ** processFMOperatorStacksQuad, which then renders the block in place of process_block.
+   */
+   FMOperatorStack operator_stack(float pitch, float drift, bool stereo);
+   void setup_block(float pitch, float drift, bool FM, float fmdepth);
+   virtual void skip_block(
+       float pitch, float drift = 0.f, bool stereo = false, bool FM = false, float FMdepth = 0.f) override;
+   virtual bool skip_needs_fm() override
+   {
+      return false;
+   }
    virtual ~FM3Oscillator();
    virtual void init_ctrltypes() override;
    virtual void init_default_values() override;
-   double phase, lastoutput;
+   double phase, lastoutput, omega;
    quadr_osc RM1, RM2, AM;
    float driftlfo, driftlfo2;
    float fb_val;
@@ -0,0 +1,167 @@
+/*
+** Surge Synthesizer is Free and Open Source Software
+**
+** Surge is made available under the Gnu General Public License, v3.0
+** https://www.gnu.org/licenses/gpl-3.0.en.html
+**
+** Copyright 2004-2020 by various individuals as described by the Git transaction log
+**
+** All source at: https://github.com/surge-synthesizer/surge.git
+**
+** Surge was a commercial product from 2004-2018, with Copyright and ownership
+** in that period held by Claes Johanson at Vember Audio. Claes made Surge
+** open source in September 2018.
+*/
+
+#include "FMOperatorQuad.h"
+#include "FastMath.h"
+#include <cassert>
+#include <cstring>
+
+namespace
+{
+template <int nmods> void processStacks(FMOperatorStack* st, int n, int blockSizeOS)
+{
+   float lanes alignas(16)[4];
+   auto gather = [&](auto f) {
+      for (int l = 0; l < 4; l++)
+         lanes[l] = (l < n) ? (float)f(st[l]) : 0.f;
+      return _mm_load_ps(lanes);
+   };
+   auto scatter = [&](__m128 v, auto f) {
+      _mm_store_ps(lanes, v);
+      for (int l = 0; l < n; l++)
+         f(st[l], lanes[l]);
+   };
+
+   __m128 mr[nmods], mi[nmods], mdr[nmods], mdi[nmods], depth[nmods], depthT[nmods],
+       depthLp[nmods];
+   for (int m = 0; m < nmods; m++)
+   {
+      mr[m] = gather([m](FMOperatorStack& s) { return s.mod[m]->r; });
+      mi[m] = gather([m](FMOperatorStack& s) { return s.mod[m]->i; });
+      mdr[m] = gather([m](FMOperatorStack& s) { return s.mod[m]->get_dr(); });
+      mdi[m] = gather([m](FMOperatorStack& s) { return s.mod[m]->get_di(); });
+      depth[m] = gather([m](FMOperatorStack& s) { return s.depth[m]->v; });
+      depthT[m] = gather([m](FMOperatorStack& s) { return s.depth[m]->target_v; });
+      depthLp[m] = gather([m](FMOperatorStack& s) { return s.depth[m]->getRate(); });
+   }
+
+   bool hasOffset = st[0].phaseOffset != nullptr;
+   auto offset = _mm_setzero_ps(), offsetT = _mm_setzero_ps(), offsetLp = _mm_setzero_ps();
+   if (hasOffset)
+   {
+      offset = gather([](FMOperatorStack& s) { return s.phaseOffset->v; });
+      offsetT = gather([](FMOperatorStack& s) { return s.phaseOffset->target_v; });
+      offsetLp = gather([](FMOperatorStack& s) { return s.phaseOffset->getRate(); });
+   }
+
+   auto fb = gather([](FMOperatorStack& s) { return s.feedback->v; });
+   auto fbT = gather([](FMOperatorStack& s) { return s.feedback->target_v; });
+   auto fbLp = gather([](FMOperatorStack& s) { return s.feedback->getRate(); });
+   auto squared = _mm_cmpneq_ps(
+       gather([](FMOperatorStack& s) { return s.squaredFeedback ? 1.f : 0.f; }), _mm_setzero_ps());
+
+   /*
+   ** The carrier phase runs for the length of the note, so it is stepped in double (lanes 0-1
+   ** and 2-3) exactly as process_block steps it; in float it would wander off over a long
+   ** note. Only the sine's argument is rounded to float.
+   */
+   double dlanes alignas(16)[4];
+   auto gatherd = [&](auto f, __m128d& lo, __m128d& hi) {
+      for (int l = 0; l < 4; l++)
+         dlanes[l] = (l < n) ? f(st[l]) : 0.0;
+      lo = _mm_load_pd(dlanes);
+      hi = _mm_load_pd(dlanes + 2);
+   };
+   __m128d phaseLo, phaseHi, omegaLo, omegaHi;
+   gatherd([](FMOperatorStack& s) { return *s.phase; }, phaseLo, phaseHi);
+   gatherd([](FMOperatorStack& s) { return s.omega; }, omegaLo, omegaHi);
+
+   // The feedback is made in float, so it goes back to lastoutput and returns unchanged
+   auto last = gather([](FMOperatorStack& s) { return *s.lastoutput; });
+
+   const auto one = _mm_set_ps1(1.f);
+   const auto twopi = _mm_set1_pd(2.0 * M_PI);
+   auto lag = [one](__m128 v, __m128 t, __m128 lp) {
+      return _mm_add_ps(_mm_mul_ps(v, _mm_sub_ps(one, lp)), _mm_mul_ps(t, lp));
+   };
+
+   __m128 out[BLOCK_SIZE_OS_MAX];
+   for (int k = 0; k < blockSizeOS; k++)
+   {
+      auto x = _mm_movelh_ps(_mm_cvtpd_ps(phaseLo), _mm_cvtpd_ps(phaseHi));
+      for (int m = 0; m < nmods; m++)
+      {
+         auto lr = mr[m], li = mi[m];
+         mr[m] = _mm_sub_ps(_mm_mul_ps(mdr[m], lr), _mm_mul_ps(mdi[m], li));
+         mi[m] = _mm_add_ps(_mm_mul_ps(mdr[m], li), _mm_mul_ps(mdi[m], lr));
+         x = _mm_add_ps(x, _mm_mul_ps(depth[m], mr[m]));
+      }
+      x = _mm_add_ps(_mm_add_ps(x, last), offset);
+
+      auto y = Surge::DSP::sinpolySSE(x);
+      out[k] = y;
+
+      auto fbMul = _mm_or_ps(_mm_and_ps(squared, y), _mm_andnot_ps(squared, one));
+      last = _mm_mul_ps(_mm_mul_ps(y, fbMul), fb);
+
+      phaseLo = _mm_add_pd(phaseLo, omegaLo);
+      phaseLo = _mm_sub_pd(phaseLo, _mm_and_pd(_mm_cmpgt_pd(phaseLo, twopi), twopi));
+      phaseHi = _mm_add_pd(phaseHi, omegaHi);
+      phaseHi = _mm_sub_pd(phaseHi, _mm_and_pd(_mm_cmpgt_pd(phaseHi, twopi), twopi));
+
+      for (int m = 0; m < nmods; m++)
+         depth[m] = lag(depth[m], depthT[m], depthLp[m]);
+      if (hasOffset)
+         offset = lag(offset, offsetT, offsetLp);
+      fb = lag(fb, fbT, fbLp);
+   }
+
+   for (int m = 0; m < nmods; m++)
+   {
+      scatter(mr[m], [m](FMOperatorStack& s, float f) { s.mod[m]->r = f; });
+      scatter(mi[m], [m](FMOperatorStack& s, float f) { s.mod[m]->i = f; });
+      scatter(depth[m], [m](FMOperatorStack& s, float f) { s.depth[m]->v = f; });
+   }
+   if (hasOffset)
+      scatter(offset, [](FMOperatorStack& s, float f) { s.phaseOffset->v = f; });
+   scatter(fb, [](FMOperatorStack& s, float f) { s.feedback->v = f; });
+   _mm_store_pd(dlanes, phaseLo);
+   _mm_store_pd(dlanes + 2, phaseHi);
+   for (int l = 0; l < n; l++)
+      *st[l].phase = dlanes[l];
+   scatter(last, [](FMOperatorStack& s, float f) { *s.lastoutput = f; });
+
+   // Four samples of four lanes at a time back into each oscillator's output
+   for (int k = 0; k < blockSizeOS; k += 4)
+   {
+      auto t0 = out[k], t1 = out[k + 1], t2 = out[k + 2], t3 = out[k + 3];
+      _MM_TRANSPOSE4_PS(t0, t1, t2, t3);
+      __m128 t[4] = {t0, t1, t2, t3};
+      for (int l = 0; l < n; l++)
+         _mm_store_ps(st[l].output + k, t[l]);
+   }
+
+   for (int l = 0; l < n; l++)
+      if (st[l].outputR)
+         memcpy(st[l].outputR, st[l].output, sizeof(float) * blockSizeOS);
+}
+} // namespace
+
+void processFMOperatorStacksQuad(FMOperatorStack* stacks, int n, int blockSizeOS)
+{
+   assert(n >= 1 && n <= 4);
+   switch (stacks[0].nmods)
+   {
+   case 2:
+      processStacks<2>(stacks, n, blockSizeOS);
+      break;
+   case 3:
+      processStacks<3>(stacks, n, blockSizeOS);
+      break;
+   default:
+      assert(false);
+      break;
+   }
+}
@@ -0,0 +1,49 @@
+/*
+** Surge Synthesizer is Free and Open Source Software
+**
+** Surge is made available under the Gnu General Public License, v3.0
+** https://www.gnu.org/licenses/gpl-3.0.en.html
+**
+** Copyright 2004-2020 by various individuals as described by the Git transaction log
+**
+** All source at: https://github.com/surge-synthesizer/surge.git
+**
+** Surge was a commercial product from 2004-2018, with Copyright and ownership
+** in that period held by Claes Johanson at Vember Audio. Claes made Surge
+** open source in September 2018.
+*/
+
+#pragma once
+
+#include "DspUtilities.h"
+
+/*
+** The FM2 and FM3 oscillators are a carrier phase, two or three quadrature modulators each
+** with a smoothed depth, an optional smoothed phase offset and smoothed feedback, turned into
+** output with sin(). Feedback means a single oscillator can't be vectorized across samples,
+** but the same oscillator in different voices is independent.
+**
+** FMOperatorStack points at one oscillator's copy of that state once it has set up the block
+** (see FM3Oscillator::operator_stack), and processFMOperatorStacksQuad runs up to four of them
+** (all with the same number of modulators) in SSE lanes, much as QuadFilterChain packs voices.
+** It uses sinpolySSE in place of libm sin and runs in float where the oscillators' own
+** process_block uses double, so the two differ by float rounding. The carrier phase is the
+** exception: it stays in double, so it tracks process_block's exactly however long the note.
+** blockSizeOS is the synth's oversampled block size (SurgeStorage::blockSizeOS).
+*/
+struct FMOperatorStack
+{
+   int nmods = 0;
+   quadr_osc* mod[3];
+   lag<double>* depth[3];
+   lag<double>* phaseOffset = nullptr; // optional
+   lag<double>* feedback;
+   bool squaredFeedback;
+   double* phase;
+   double* lastoutput;
+   double omega;
+   float* output;
+   float* outputR; // the output is copied here when not null
+};
+
+void processFMOperatorStacksQuad(FMOperatorStack* stacks, int n, int blockSizeOS);
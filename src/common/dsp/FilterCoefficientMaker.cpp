@@ -1,6 +1,8 @@
 #include "FilterCoefficientMaker.h"
+#include "FilterCoefficientMemo.h"
 #include "SurgeStorage.h"
 #include <vt_dsp/basic_dsp.h>
+#include "FastMath.h"
 
 #include "filters/VintageLadders.h"
 #include "filters/Obxd.h"
@@ -19,10 +21,18 @@ FilterCoefficientMaker::FilterCoefficientMaker()
 }
 
 void FilterCoefficientMaker::MakeCoeffs(
-    float Freq, float Reso, int Type, int SubType, SurgeStorage* storageI)
+    float Freq, float Reso, int Type, int SubType, SurgeStorage* storageI, FilterCoefficientMemo* memo)
 {
    storage = storageI;
 
+   if (memo && FilterCoefficientMemo::memoizes(Type))
+   {
+      float N[n_cm_coeffs];
+      memcpy(N, memo->find(Type, SubType, Freq, Reso, storageI), sizeof(N));
+      FromDirect(N);
+      return;
+   }
+
    // Force compiler to error out if I miss one
    fu_type fType = (fu_type)Type;
 
@@ -601,7 +611,7 @@ void FilterCoefficientMaker::FromDirect(float N[n_cm_coeffs])
       for (int i = 0; i < n_cm_coeffs; i++)
       {
          tC[i] = (1.f - smooth) * tC[i] + smooth * N[i];
-         dC[i] = (tC[i] - C[i]) * BLOCK_SIZE_OS_INV;
+         dC[i] = (tC[i] - C[i]) * storage->blockSizeOSInv;
       }
    }
 }
@@ -688,3 +698,510 @@ void FilterCoefficientMaker::Reset()
 
    storage = nullptr;
 }
+
+/*
+** The four lane version. The table lookups are done four at a time in float as in the scalar
+** code; everything after them is done in double, two lanes at a time, in the same order as the
+** scalar functions above, so the biquads come out the same as MakeCoeffs to the bit.
+*/
+namespace
+{
+enum QuadBiquad
+{
+   qb_lp,
+   qb_hp,
+   qb_bp,
+   qb_notch,
+   qb_apf,
+};
+
+inline __m128d lo_pd(__m128 x)
+{
+   return _mm_cvtps_pd(x);
+}
+
+inline __m128d hi_pd(__m128 x)
+{
+   return _mm_cvtps_pd(_mm_movehl_ps(x, x));
+}
+
+// double(float(x)), as when a double is assigned to a float
+inline __m128d round_pd(__m128d x)
+{
+   return _mm_cvtps_pd(_mm_cvtpd_ps(x));
+}
+
+inline __m128d set_pd(double x)
+{
+   return _mm_set1_pd(x);
+}
+
+// limit_range(double), which tests the top first
+inline __m128d limit_pd(__m128d x, double low, double high)
+{
+   return _mm_max_pd(_mm_min_pd(x, set_pd(high)), set_pd(low));
+}
+
+// The table lookups of note_to_omega_ignoring_tuning
+void quadNoteToOmega(__m128 x, SurgeStorage* storage, __m128& sinu, __m128& cosi)
+{
+   x = _mm_add_ps(x, _mm_set1_ps(256.f));
+   __m128i ei = _mm_cvttps_epi32(x);
+   __m128 a = _mm_sub_ps(x, _mm_cvtepi32_ps(ei));
+
+   int e alignas(16)[4];
+   float s0 alignas(16)[4], s1 alignas(16)[4], c0 alignas(16)[4], c1 alignas(16)[4];
+   _mm_store_si128((__m128i*)e, ei);
+   for (int i = 0; i < 4; i++)
+   {
+      int ee = limit_range(e[i], 0, 0x1fe);
+      s0[i] = storage->table_note_omega_ignoring_tuning[0][ee & 0x1ff];
+      s1[i] = storage->table_note_omega_ignoring_tuning[0][(ee + 1) & 0x1ff];
+      c0[i] = storage->table_note_omega_ignoring_tuning[1][ee & 0x1ff];
+      c1[i] = storage->table_note_omega_ignoring_tuning[1][(ee + 1) & 0x1ff];
+   }
+
+   __m128 oma = _mm_sub_ps(_mm_set1_ps(1.f), a);
+   sinu = _mm_add_ps(_mm_mul_ps(oma, _mm_load_ps(s0)), _mm_mul_ps(a, _mm_load_ps(s1)));
+   cosi = _mm_add_ps(_mm_mul_ps(oma, _mm_load_ps(c0)), _mm_mul_ps(a, _mm_load_ps(c1)));
+}
+
+__m128d quadResonanceBoost(__m128d reso, __m128d freq, int subtype)
+{
+   if (subtype == st_Medium || subtype == st_Rough)
+   {
+      __m128d zero = _mm_setzero_pd();
+      reso = _mm_mul_pd(
+          reso, _mm_max_pd(_mm_sub_pd(set_pd(1.0),
+                                      _mm_max_pd(_mm_mul_pd(_mm_sub_pd(freq, set_pd(58)), set_pd(0.05)),
+                                                 zero)),
+                           zero));
+   }
+   return reso;
+}
+
+__m128d quadMap2PoleResonance(__m128d reso, __m128d freq, int subtype)
+{
+   reso = quadResonanceBoost(reso, freq, subtype);
+   __m128d r1 = _mm_sub_pd(set_pd(1.0), reso);
+   __m128d r = _mm_sub_pd(set_pd(1.0), _mm_mul_pd(r1, r1));
+
+   switch (subtype)
+   {
+   case st_Medium:
+      return _mm_sub_pd(set_pd(0.99), _mm_mul_pd(set_pd(1.0), limit_pd(r, 0.0, 1.0)));
+   case st_Rough:
+      return _mm_sub_pd(set_pd(1.0), _mm_mul_pd(set_pd(1.05), limit_pd(r, 0.001, 1.0)));
+   default:
+      return _mm_sub_pd(set_pd(2.5), _mm_mul_pd(set_pd(2.45), limit_pd(r, 0.0, 1.0)));
+   }
+}
+
+__m128d quadMap4PoleResonance(__m128d reso, __m128d freq, int subtype)
+{
+   reso = quadResonanceBoost(reso, freq, subtype);
+
+   switch (subtype)
+   {
+   case st_Medium:
+      return _mm_sub_pd(set_pd(0.99), _mm_mul_pd(set_pd(0.9949), limit_pd(reso, 0.0, 1.0)));
+   case st_Rough:
+      return _mm_sub_pd(set_pd(1.0), _mm_mul_pd(set_pd(1.05), limit_pd(reso, 0.001, 1.0)));
+   default:
+      return _mm_sub_pd(set_pd(2.5), _mm_mul_pd(set_pd(2.3), limit_pd(reso, 0.0, 1.0)));
+   }
+}
+
+__m128d quadResoscale(__m128d reso, int subtype)
+{
+   double k;
+   switch (subtype)
+   {
+   case st_Medium:
+      k = 0.75;
+      break;
+   case st_Rough:
+      k = 0.5;
+      break;
+   case st_Smooth:
+      k = 0.25;
+      break;
+   default:
+      return set_pd(1.0);
+   }
+   return _mm_sub_pd(set_pd(1.0), _mm_mul_pd(_mm_mul_pd(set_pd(k), reso), reso));
+}
+
+void quadToNormalizedLattice(__m128d a0inv, __m128d a1, __m128d a2, __m128d b0, __m128d b1,
+                             __m128d b2, __m128d g, __m128d N[n_cm_coeffs])
+{
+   b0 = _mm_mul_pd(b0, a0inv);
+   b1 = _mm_mul_pd(b1, a0inv);
+   b2 = _mm_mul_pd(b2, a0inv);
+   a1 = _mm_mul_pd(a1, a0inv);
+   a2 = _mm_mul_pd(a2, a0inv);
+
+   __m128d one = set_pd(1.0);
+   __m128d absmask = _mm_castsi128_pd(_mm_set1_epi64x(0x7fffffffffffffffLL));
+
+   __m128d k1 = _mm_div_pd(a1, _mm_add_pd(one, a2));
+   __m128d k2 = a2;
+
+   __m128d q1 = _mm_sqrt_pd(_mm_and_pd(_mm_sub_pd(one, _mm_mul_pd(k1, k1)), absmask));
+   __m128d q2 = _mm_sqrt_pd(_mm_and_pd(_mm_sub_pd(one, _mm_mul_pd(k2, k2)), absmask));
+
+   __m128d v3 = b2;
+   __m128d v2 = _mm_div_pd(_mm_sub_pd(b1, _mm_mul_pd(a1, v3)), q2);
+   __m128d v1 = _mm_div_pd(
+       _mm_sub_pd(_mm_sub_pd(b0, _mm_mul_pd(_mm_mul_pd(k1, v2), q2)), _mm_mul_pd(k2, v3)),
+       _mm_mul_pd(q1, q2));
+
+   N[0] = k1;
+   N[1] = k2;
+   N[2] = q1;
+   N[3] = q2;
+   N[4] = v1;
+   N[5] = v2;
+   N[6] = v3;
+   N[7] = g;
+}
+
+void quadToCoupledForm(__m128d a0inv, __m128d a1, __m128d a2, __m128d b0, __m128d b1, __m128d b2,
+                       __m128d g, __m128d N[n_cm_coeffs])
+{
+   b0 = _mm_mul_pd(b0, a0inv);
+   b1 = _mm_mul_pd(b1, a0inv);
+   b2 = _mm_mul_pd(b2, a0inv);
+   a1 = _mm_mul_pd(a1, a0inv);
+   a2 = _mm_mul_pd(a2, a0inv);
+
+   __m128d zero = _mm_setzero_pd(), sign = set_pd(-0.0);
+
+   __m128d sq = _mm_sub_pd(_mm_mul_pd(a1, a1), _mm_mul_pd(set_pd(4.0), a2));
+   __m128d ar = _mm_mul_pd(set_pd(0.5), _mm_xor_pd(a1, sign));
+   sq = _mm_min_pd(sq, zero);
+   __m128d ai = _mm_mul_pd(set_pd(0.5), _mm_sqrt_pd(_mm_xor_pd(sq, sign)));
+   ai = _mm_max_pd(ai, set_pd(8.0 * 1.192092896e-07F));
+
+   __m128d bb1 = _mm_sub_pd(b1, _mm_mul_pd(a1, b0));
+   __m128d bb2 = _mm_sub_pd(b2, _mm_mul_pd(a2, b0));
+
+   N[0] = ar;
+   N[1] = ai;
+   N[2] = set_pd(1.0);
+   N[3] = zero;
+   N[4] = bb1;
+   N[5] = _mm_div_pd(_mm_add_pd(_mm_mul_pd(bb1, ar), bb2), ai);
+   N[6] = b0;
+   N[7] = g;
+}
+
+void quadBiquad(QuadBiquad kind, bool fourPole, int subtype, __m128 freq, __m128 reso,
+                SurgeStorage* storage, __m128 N[n_cm_coeffs])
+{
+   __m128 one = _mm_set1_ps(1.f);
+
+   freq = _mm_max_ps(_mm_min_ps(freq, _mm_set1_ps(75.f)), _mm_set1_ps(-55.f));
+
+   __m128 sinu, cosi;
+   quadNoteToOmega(freq, storage, sinu, cosi);
+
+   // The scalar code does these in float
+   __m128 cc = _mm_mul_ps(cosi, cosi);
+   __m128 omc = _mm_sub_ps(one, cosi);
+   __m128 opc = _mm_add_ps(one, cosi);
+   __m128 m2c = _mm_mul_ps(_mm_set1_ps(-2.f), cosi);
+   __m128 r1 = _mm_sub_ps(one, reso);
+   __m128 rr = _mm_sub_ps(one, _mm_mul_ps(r1, r1));
+
+   float clip alignas(16)[4] = {0.f, 0.f, 0.f, 0.f};
+   if (subtype == st_Rough)
+   {
+      float f alignas(16)[4];
+      _mm_store_ps(f, freq);
+      for (int i = 0; i < 4; i++)
+         clip[i] = (1.0f / 64.0f) * db_to_linear(f[i] * 0.55f);
+   }
+   else if (subtype == st_Smooth)
+   {
+      for (int i = 0; i < 4; i++)
+         clip[i] = 1.0f / 1024.0f;
+   }
+
+   bool filtered = (kind == qb_lp || kind == qb_hp || kind == qb_bp);
+   bool lattice = !filtered || subtype == st_Smooth;
+   // Coeff_LP12 and Coeff_LP24 test for st_Smooth, the others for 0
+   bool clampAlpha = (kind == qb_lp) ? subtype != st_Smooth : filtered && subtype != 0;
+
+   __m128d Nd[2][n_cm_coeffs];
+   for (int h = 0; h < 2; h++)
+   {
+      auto cv = [h](__m128 x) { return h ? hi_pd(x) : lo_pd(x); };
+      __m128d one_d = set_pd(1.0), sign = set_pd(-0.0);
+
+      __m128d Q2inv;
+      switch (kind)
+      {
+      case qb_notch:
+         Q2inv = (subtype == st_NotchMild)
+                     ? _mm_sub_pd(set_pd(1.00), _mm_mul_pd(set_pd(0.99), limit_pd(cv(rr), 0.0, 1.0)))
+                     : _mm_sub_pd(set_pd(2.5), _mm_mul_pd(set_pd(2.49), limit_pd(cv(rr), 0.0, 1.0)));
+         break;
+      case qb_apf:
+         Q2inv = _mm_sub_pd(set_pd(2.5), _mm_mul_pd(set_pd(2.49), limit_pd(cv(rr), 0.0, 1.0)));
+         break;
+      default:
+         Q2inv = fourPole ? quadMap4PoleResonance(cv(reso), cv(freq), subtype)
+                          : quadMap2PoleResonance(cv(reso), cv(freq), subtype);
+         break;
+      }
+
+      __m128d alpha = _mm_mul_pd(cv(sinu), Q2inv);
+      if (clampAlpha)
+         alpha = _mm_min_pd(alpha, _mm_sub_pd(_mm_sqrt_pd(_mm_sub_pd(one_d, cv(cc))), set_pd(0.0001)));
+
+      __m128d a0inv = _mm_div_pd(one_d, _mm_add_pd(one_d, alpha));
+      __m128d a1 = cv(m2c);
+      __m128d a2 = _mm_sub_pd(one_d, alpha);
+      __m128d b0, b1, b2;
+
+      switch (kind)
+      {
+      case qb_lp:
+         b0 = _mm_mul_pd(cv(omc), set_pd(0.5));
+         b1 = cv(omc);
+         b2 = b0;
+         break;
+      case qb_hp:
+         b0 = _mm_mul_pd(cv(opc), set_pd(0.5));
+         b1 = _mm_xor_pd(cv(opc), sign);
+         b2 = b0;
+         break;
+      case qb_bp:
+      {
+         __m128d Q = _mm_div_pd(set_pd(0.5), Q2inv);
+         b0 = _mm_mul_pd(Q, alpha);
+         b1 = _mm_setzero_pd();
+         b2 = _mm_mul_pd(_mm_xor_pd(Q, sign), alpha);
+         break;
+      }
+      case qb_notch:
+         b0 = one_d;
+         b1 = a1;
+         b2 = one_d;
+         break;
+      case qb_apf:
+         b0 = _mm_sub_pd(one_d, alpha);
+         b1 = a1;
+         b2 = _mm_add_pd(one_d, alpha);
+         break;
+      }
+
+      __m128d g = set_pd(0.005);
+      if (filtered)
+      {
+         // float gain = resoscale(reso, subtype)
+         __m128d gain = round_pd(quadResoscale(cv(reso), subtype));
+         if (kind == qb_bp && subtype == st_Rough)
+            gain = _mm_mul_pd(gain, set_pd(2.0));
+         b0 = _mm_mul_pd(b0, gain);
+         b1 = _mm_mul_pd(b1, gain);
+         b2 = _mm_mul_pd(b2, gain);
+         g = cv(_mm_load_ps(clip));
+      }
+
+      if (lattice)
+         quadToNormalizedLattice(a0inv, a1, a2, b0, b1, b2, g, Nd[h]);
+      else
+         quadToCoupledForm(a0inv, a1, a2, b0, b1, b2, g, Nd[h]);
+   }
+
+   for (int i = 0; i < n_cm_coeffs; i++)
+      N[i] = _mm_movelh_ps(_mm_cvtpd_ps(Nd[0][i]), _mm_cvtpd_ps(Nd[1][i]));
+}
+
+// Coeff_SVF in float, with a polynomial sine
+void quadSVF(__m128 freq, __m128 reso, bool fourPole, SurgeStorage* storage,
+             __m128 N[n_cm_coeffs])
+{
+   __m128 one = _mm_set1_ps(1.f), two = _mm_set1_ps(2.f);
+
+   // note_to_pitch_ignoring_tuning
+   __m128 x = _mm_add_ps(freq, _mm_set1_ps(256.f));
+   __m128i ei = _mm_cvttps_epi32(x);
+   __m128 a = _mm_sub_ps(x, _mm_cvtepi32_ps(ei));
+   int e alignas(16)[4];
+   float p0 alignas(16)[4], p1 alignas(16)[4];
+   _mm_store_si128((__m128i*)e, ei);
+   for (int i = 0; i < 4; i++)
+   {
+      int ee = min(e[i], 0x1fe);
+      p0[i] = storage->table_pitch_ignoring_tuning[ee & 0x1ff];
+      p1[i] = storage->table_pitch_ignoring_tuning[(ee + 1) & 0x1ff];
+   }
+   __m128 f = _mm_mul_ps(_mm_set1_ps(440.f),
+                         _mm_add_ps(_mm_mul_ps(_mm_sub_ps(one, a), _mm_load_ps(p0)),
+                                    _mm_mul_ps(a, _mm_load_ps(p1))));
+
+   __m128 w = _mm_min_ps(_mm_set1_ps(0.11f), _mm_mul_ps(f, _mm_set1_ps(0.25f * samplerate_inv)));
+   __m128 F1 = _mm_mul_ps(two, Surge::DSP::sinpolySSE(_mm_mul_ps(_mm_set1_ps(M_PI), w)));
+
+   reso = _mm_sqrt_ps(_mm_min_ps(_mm_max_ps(reso, _mm_setzero_ps()), one));
+
+   float overshoot = fourPole ? 0.1f : 0.15f;
+   __m128 Q1 = _mm_add_ps(
+       _mm_sub_ps(two, _mm_mul_ps(reso, _mm_set1_ps(2.f + overshoot))),
+       _mm_mul_ps(_mm_mul_ps(F1, F1), _mm_set1_ps(overshoot * 0.9f)));
+   Q1 = _mm_min_ps(Q1, _mm_min_ps(two, _mm_sub_ps(two, _mm_mul_ps(_mm_set1_ps(1.52f), F1))));
+
+   N[0] = F1;
+   N[1] = Q1;
+   N[2] = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.1f), reso), F1);
+   N[3] = _mm_sub_ps(one, _mm_mul_ps(_mm_set1_ps(0.65f), reso));
+   for (int i = 4; i < n_cm_coeffs; i++)
+      N[i] = _mm_setzero_ps();
+}
+} // namespace
+
+void FilterCoefficientMaker::MakeQuadCoeffs(FilterCoefficientMaker* cm[4], int n, __m128 Freq,
+                                            __m128 Reso, int Type, int SubType,
+                                            SurgeStorage* storage, __m128 C[n_cm_coeffs],
+                                            __m128 dC[n_cm_coeffs], FilterCoefficientMemo* memo)
+{
+   static const float unused alignas(16)[n_cm_coeffs] = {0, 0, 0, 0, 0, 0, 0, 0};
+
+   // Four makers' coefficients to and from a quad, a transpose at a time
+   auto gather = [&](float (FilterCoefficientMaker::*member)[n_cm_coeffs], __m128* to) {
+      for (int j = 0; j < n_cm_coeffs; j += 4)
+      {
+         __m128 r[4];
+         for (int v = 0; v < 4; v++)
+            r[v] = _mm_loadu_ps((v < n && cm[v] ? cm[v]->*member : unused) + j);
+         _MM_TRANSPOSE4_PS(r[0], r[1], r[2], r[3]);
+         for (int v = 0; v < 4; v++)
+            to[j + v] = r[v];
+      }
+   };
+   auto scatter = [&](const __m128* from, float (FilterCoefficientMaker::*member)[n_cm_coeffs]) {
+      for (int j = 0; j < n_cm_coeffs; j += 4)
+      {
+         __m128 r[4] = {from[j], from[j + 1], from[j + 2], from[j + 3]};
+         _MM_TRANSPOSE4_PS(r[0], r[1], r[2], r[3]);
+         for (int v = 0; v < n; v++)
+            if (cm[v])
+               _mm_storeu_ps(cm[v]->*member + j, r[v]);
+      }
+   };
+
+   __m128 N[n_cm_coeffs];
+   __m128 tC[n_cm_coeffs];
+   int first = 0;
+
+   gather(&FilterCoefficientMaker::C, C);
+   gather(&FilterCoefficientMaker::tC, tC);
+   for (int v = 0; v < n; v++)
+   {
+      if (!cm[v])
+         continue;
+      cm[v]->storage = storage;
+      if (cm[v]->FirstRun)
+         first |= 1 << v;
+   }
+
+   // FromDirect, four lanes at a time
+   auto fromDirect = [&]() {
+      static const int lanes[16][4] = {
+          {0, 0, 0, 0},   {-1, 0, 0, 0},   {0, -1, 0, 0},   {-1, -1, 0, 0},
+          {0, 0, -1, 0},  {-1, 0, -1, 0},  {0, -1, -1, 0},  {-1, -1, -1, 0},
+          {0, 0, 0, -1},  {-1, 0, 0, -1},  {0, -1, 0, -1},  {-1, -1, 0, -1},
+          {0, 0, -1, -1}, {-1, 0, -1, -1}, {0, -1, -1, -1}, {-1, -1, -1, -1}};
+      __m128 isFirst = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)lanes[first]));
+      __m128 keep = _mm_set1_ps(1.f - smooth), take = _mm_set1_ps(smooth);
+
+      for (int i = 0; i < n_cm_coeffs; i++)
+      {
+         __m128 t = _mm_add_ps(_mm_mul_ps(keep, tC[i]), _mm_mul_ps(take, N[i]));
+         tC[i] = _mm_or_ps(_mm_and_ps(isFirst, N[i]), _mm_andnot_ps(isFirst, t));
+         C[i] = _mm_or_ps(_mm_and_ps(isFirst, N[i]), _mm_andnot_ps(isFirst, C[i]));
+         dC[i] = _mm_andnot_ps(isFirst,
+                               _mm_mul_ps(_mm_sub_ps(tC[i], C[i]), _mm_set1_ps(storage->blockSizeOSInv)));
+      }
+      first = 0;
+   };
+
+   auto biquad = [&](QuadBiquad kind, bool fourPole) {
+      quadBiquad(kind, fourPole, SubType, Freq, Reso, storage, N);
+      fromDirect();
+   };
+   auto svf = [&](bool fourPole) {
+      quadSVF(Freq, Reso, fourPole, storage, N);
+      fromDirect();
+   };
+
+   switch (Type)
+   {
+   case fut_lp12:
+      if (SubType == st_SVF)
+         svf(false);
+      else
+         biquad(qb_lp, false);
+      break;
+   case fut_hp12:
+      if (SubType == st_SVF)
+         svf(false);
+      else
+         biquad(qb_hp, false);
+      break;
+   case fut_bp12:
+      // Falls through to fut_bp24, as MakeCoeffs does
+      if (SubType == st_SVF)
+         svf(false);
+      else
+         biquad(qb_bp, false);
+   case fut_bp24:
+      if (SubType == st_SVF)
+         svf(false);
+      else
+         biquad(qb_bp, true);
+      break;
+   case fut_notch12:
+   case fut_notch24:
+      biquad(qb_notch, false);
+      break;
+   case fut_apf:
+      biquad(qb_apf, false);
+      break;
+   case fut_lp24:
+      if (SubType == st_SVF)
+         svf(true);
+      else
+         biquad(qb_lp, true);
+      break;
+   case fut_hp24:
+      if (SubType == st_SVF)
+         svf(true);
+      else
+         biquad(qb_hp, true);
+      break;
+   default:
+   {
+      // No four lane version; make them one voice at a time
+      float f alignas(16)[4], r alignas(16)[4];
+      _mm_store_ps(f, Freq);
+      _mm_store_ps(r, Reso);
+      for (int v = 0; v < n; v++)
+         if (cm[v])
+            cm[v]->MakeCoeffs(f[v], r[v], Type, SubType, storage, memo);
+      gather(&FilterCoefficientMaker::C, C);
+      gather(&FilterCoefficientMaker::dC, dC);
+      return;
+   }
+   }
+
+   for (int v = 0; v < n; v++)
+      if (cm[v])
+         cm[v]->FirstRun = false;
+   scatter(C, &FilterCoefficientMaker::C);
+   scatter(tC, &FilterCoefficientMaker::tC);
+   scatter(dC, &FilterCoefficientMaker::dC);
+}
@@ -3,14 +3,31 @@
 
 const int n_cm_coeffs = 8;
 
+class FilterCoefficientMemo;
+
 class FilterCoefficientMaker
 {
 public:
-   void MakeCoeffs(float Freq, float Reso, int Type, int SubType, SurgeStorage* storage);
+   // With a memo, the types it memoizes take their coefficients from it (see FilterCoefficientMemo.h)
+   void MakeCoeffs(float Freq, float Reso, int Type, int SubType, SurgeStorage* storage,
+                   FilterCoefficientMemo* memo = nullptr);
    void Reset();
    FilterCoefficientMaker();
    float C[n_cm_coeffs], dC[n_cm_coeffs], tC[n_cm_coeffs]; // K1,K2,Q1,Q2,V1,V2,V3,etc
    void FromDirect(float N[n_cm_coeffs]);
+
+   /*
+   ** Make the coefficients of up to four voices' filter units of the same type at once, one
+   ** voice per SSE lane, and write them to a quad's C and dC. cm[0..n-1] are the voices' makers,
+   ** which keep the smoothing state between blocks just as with MakeCoeffs; lanes from n on, and
+   ** those whose maker is null, are made but not stored. The biquad types come out bit for bit
+   ** the same as MakeCoeffs, the SVF uses a polynomial sine, and the other types are made lane
+   ** by lane.
+   */
+   static void MakeQuadCoeffs(FilterCoefficientMaker* cm[4], int n, __m128 Freq, __m128 Reso,
+                              int Type, int SubType, SurgeStorage* storage,
+                              __m128 C[n_cm_coeffs], __m128 dC[n_cm_coeffs],
+                              FilterCoefficientMemo* memo = nullptr);
 private:
    void
    ToCoupledForm(double A0inv, double A1, double A2, double B0, double B1, double B2, double G);
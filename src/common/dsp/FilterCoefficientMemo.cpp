@@ -0,0 +1,117 @@
+/*
+** Surge Synthesizer is Free and Open Source Software
+**
+** Surge is made available under the Gnu General Public License, v3.0
+** https://www.gnu.org/licenses/gpl-3.0.en.html
+**
+** Copyright 2004-2020 by various individuals as described by the Git transaction log
+**
+** All source at: https://github.com/surge-synthesizer/surge.git
+**
+** Surge was a commercial product from 2004-2018, with Copyright and ownership
+** in that period held by Claes Johanson at Vember Audio. Claes made Surge
+** open source in September 2018.
+*/
+
+#include "FilterCoefficientMemo.h"
+#include <cmath>
+#include <cstring>
+
+FilterCoefficientMemo::FilterCoefficientMemo()
+{
+   clear();
+}
+
+void FilterCoefficientMemo::clear()
+{
+   for (auto& e : entries)
+      e.valid = false;
+}
+
+bool FilterCoefficientMemo::memoizes(int type)
+{
+   switch (type)
+   {
+   case fut_lpmoog:
+   case fut_comb_pos:
+   case fut_comb_neg:
+   case fut_vintageladder:
+   case fut_obxd_2pole_lp:
+   case fut_obxd_2pole_bp:
+   case fut_obxd_2pole_hp:
+   case fut_obxd_2pole_n:
+   case fut_obxd_4pole:
+   case fut_k35_lp:
+   case fut_k35_hp:
+   case fut_diode:
+   case fut_cutoffwarp_lp:
+   case fut_cutoffwarp_hp:
+   case fut_cutoffwarp_n:
+   case fut_cutoffwarp_bp:
+   case fut_cutoffwarp_ap:
+   case fut_resonancewarp_lp:
+   case fut_resonancewarp_hp:
+   case fut_resonancewarp_n:
+   case fut_resonancewarp_bp:
+   case fut_resonancewarp_ap:
+      return true;
+   default:
+      return false;
+   }
+}
+
+const float* FilterCoefficientMemo::find(int type, int subtype, float freq, float reso,
+                                         SurgeStorage* storage)
+{
+   if (tablesGeneration != storage->tablesGeneration)
+   {
+      clear();
+      tablesGeneration = storage->tablesGeneration;
+   }
+
+   // The combs' delay also depends on a patch setting
+   if (type == fut_comb_pos || type == fut_comb_neg)
+      subtype |= storage->getPatch().correctlyTuneCombFilter ? 0x100 : 0;
+
+   int qf = (int)std::floor(freq * freq_steps + 0.5f);
+   int qr = (int)std::floor(reso * reso_steps + 0.5f);
+
+   unsigned int h = (unsigned int)type * 0x9e3779b1u ^ (unsigned int)subtype * 0x85ebca6bu ^
+                    (unsigned int)qf * 0xc2b2ae35u ^ (unsigned int)qr * 0x27d4eb2fu;
+   h ^= h >> 15;
+   int set = (h % (n_entries / n_ways)) * n_ways;
+
+   for (int w = 0; w < n_ways; w++)
+   {
+      auto& e = entries[set + w];
+      if (e.valid && e.type == type && e.subtype == subtype && e.freq == qf && e.reso == qr)
+      {
+         stats.hits++;
+         return e.N;
+      }
+   }
+
+   stats.misses++;
+
+   Entry* e = nullptr;
+   for (int w = 0; w < n_ways && !e; w++)
+      if (!entries[set + w].valid)
+         e = &entries[set + w];
+   if (!e)
+   {
+      e = &entries[set + victim];
+      victim = (victim + 1) % n_ways;
+   }
+
+   // A maker on its first run sets C to the N it's given
+   FilterCoefficientMaker cm;
+   cm.MakeCoeffs(qf * (1.f / freq_steps), qr * (1.f / reso_steps), type, subtype & 0xff, storage);
+
+   e->type = type;
+   e->subtype = subtype;
+   e->freq = qf;
+   e->reso = qr;
+   e->valid = true;
+   memcpy(e->N, cm.C, sizeof(e->N));
+   return e->N;
+}
@@ -0,0 +1,70 @@
+/*
+** Surge Synthesizer is Free and Open Source Software
+**
+** Surge is made available under the Gnu General Public License, v3.0
+** https://www.gnu.org/licenses/gpl-3.0.en.html
+**
+** Copyright 2004-2020 by various individuals as described by the Git transaction log
+**
+** All source at: https://github.com/surge-synthesizer/surge.git
+**
+** Surge was a commercial product from 2004-2018, with Copyright and ownership
+** in that period held by Claes Johanson at Vember Audio. Claes made Surge
+** open source in September 2018.
+*/
+
+#pragma once
+
+#include "FilterCoefficientMaker.h"
+#include <stdint.h>
+
+struct FilterCoefficientMemoStats
+{
+   uint64_t hits = 0, misses = 0;
+};
+
+/*
+** A small memo, one per scene, of the coefficients of the filter types which are expensive to
+** make (the ladders, OB-Xd, K35, the cutoff and resonance warps, LP4L and the combs). When the
+** cutoff and resonance aren't modulated, each voice asks for the same coefficients every block,
+** and voices playing the same key ask for each other's.
+**
+** The cutoff is rounded to 1/65536 of a semitone and the resonance to 1/2^20. Held notes ask
+** for exactly the same values every block, so the steps only need to be fine enough not to be
+** heard: with 1/1024 and 1/4096 a resonant ladder rendered only 40 dB above its difference from
+** the exact coefficients, as close to self-oscillation the output follows the resonance
+** closely. The memo forgets everything when the samplerate or tuning changes the storage's
+** tables.
+*/
+class FilterCoefficientMemo
+{
+public:
+   FilterCoefficientMemo();
+
+   static bool memoizes(int type);
+
+   /*
+   ** The target coefficients (the N of FilterCoefficientMaker::FromDirect) of freq and reso
+   ** rounded to the memo's steps, made and remembered if they aren't in the memo already.
+   */
+   const float* find(int type, int subtype, float freq, float reso, SurgeStorage* storage);
+
+   void clear();
+
+   FilterCoefficientMemoStats stats;
+
+   static constexpr float freq_steps = 65536.f, reso_steps = 1048576.f; // 2^16 and 2^20
+
+private:
+   static constexpr int n_entries = 64, n_ways = 4;
+
+   struct Entry
+   {
+      int type, subtype, freq, reso;
+      bool valid;
+      float N[n_cm_coeffs];
+   } entries[n_entries];
+
+   int tablesGeneration = -1;
+   int victim = 0;
+};
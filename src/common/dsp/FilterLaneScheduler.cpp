@@ -0,0 +1,115 @@
+/*
+** Surge Synthesizer is Free and Open Source Software
+**
+** Surge is made available under the Gnu General Public License, v3.0
+** https://www.gnu.org/licenses/gpl-3.0.en.html
+**
+** Copyright 2004-2020 by various individuals as described by the Git transaction log
+**
+** All source at: https://github.com/surge-synthesizer/surge.git
+**
+** Surge was a commercial product from 2004-2018, with Copyright and ownership
+** in that period held by Claes Johanson at Vember Audio. Claes made Surge
+** open source in September 2018.
+*/
+
+#include "FilterLaneScheduler.h"
+#include <cstring>
+
+FilterLaneScheduler::FilterLaneScheduler()
+{
+   memset(laneVoice, 0, sizeof(laneVoice));
+   memset(slotLane, 0, sizeof(slotLane));
+   for (int s = 0; s < n_scenes; ++s)
+   {
+      lanesUsed[s] = 0;
+      sceneQuads[s] = s;
+      sceneFirstLane[s] = 0;
+   }
+}
+
+void FilterLaneScheduler::schedule(SurgeVoiceTable* voices, QuadFilterChainState** FBQ,
+                                   bool coPack)
+{
+   int separateQuads = 0;
+   for (int s = 0; s < n_scenes; ++s)
+   {
+      lanesUsed[s] = 0;
+      separateQuads += (voices[s].size() + 3) >> 2;
+   }
+
+   coPacked = coPack;
+   for (int s = 0; s < n_scenes; ++s)
+   {
+      int q = coPack ? 0 : s;
+      pack(s, voices[s], q, FBQ[q], lanesUsed[q]);
+   }
+
+   int quads = 0;
+   for (int q = 0; q < n_scenes; ++q)
+      quads += (lanesUsed[q] + 3) >> 2;
+
+   stats.blocks++;
+   stats.quadLanes += quads * 4;
+   if (coPack)
+   {
+      stats.coPackedBlocks++;
+      stats.quadsSaved += separateQuads - quads;
+   }
+}
+
+void FilterLaneScheduler::pack(int s, SurgeVoiceTable& voices, int quads,
+                               QuadFilterChainState* Q, int firstLane)
+{
+   int lastLane = firstLane + voices.size();
+   uint64_t taken = 0;
+   SurgeVoice* moving[MAX_VOICES];
+   int nMoving = 0;
+
+   sceneQuads[s] = quads;
+   sceneFirstLane[s] = firstLane;
+
+   // Voices whose registers are in a lane of this scene's range stay there
+   auto base = (uintptr_t)Q, end = (uintptr_t)(Q + (MAX_VOICES >> 2));
+   for (auto v : voices)
+   {
+      int lane = -1;
+      auto at = (uintptr_t)v->filterLaneQuad();
+      if (v->filterStateInLane() && at >= base && at < end)
+         lane = (int)((at - base) / sizeof(QuadFilterChainState)) * 4 + v->filterLaneIndex();
+
+      uint64_t bit = (uint64_t)1 << (lane & 63);
+      if (lane >= firstLane && lane < lastLane && !(taken & bit))
+      {
+         taken |= bit;
+         slotLane[s][voices.slotOf(v)] = lane;
+         laneVoice[quads][lane] = v;
+      }
+      else
+      {
+         moving[nMoving++] = v;
+      }
+   }
+
+   // and the rest fill the free ones in voice order
+   int lane = firstLane;
+   for (int i = 0; i < nMoving; ++i)
+   {
+      SurgeVoice* v = moving[i];
+      while (taken & ((uint64_t)1 << lane))
+         lane++;
+      taken |= (uint64_t)1 << lane;
+      slotLane[s][voices.slotOf(v)] = lane;
+      laneVoice[quads][lane] = v;
+
+      if (v->filterStateInLane())
+      {
+         v->GetQFB();
+         stats.stateMoves++;
+      }
+      stats.stateLoads++;
+   }
+
+   lanesUsed[quads] = lastLane;
+   stats.voiceLanes += voices.size();
+}
@@ -0,0 +1,77 @@
+/*
+** Surge Synthesizer is Free and Open Source Software
+**
+** Surge is made available under the Gnu General Public License, v3.0
+** https://www.gnu.org/licenses/gpl-3.0.en.html
+**
+** Copyright 2004-2020 by various individuals as described by the Git transaction log
+**
+** All source at: https://github.com/surge-synthesizer/surge.git
+**
+** Surge was a commercial product from 2004-2018, with Copyright and ownership
+** in that period held by Claes Johanson at Vember Audio. Claes made Surge
+** open source in September 2018.
+*/
+
+#pragma once
+
+#include "globals.h"
+#include "SurgeVoiceTable.h"
+#include "QuadFilterChain.h"
+#include <stdint.h>
+
+struct FilterLaneStats
+{
+   uint64_t blocks = 0;
+   uint64_t voiceLanes = 0; // lanes with a voice in them, summed over the blocks
+   uint64_t quadLanes = 0;  // lanes of the quads which were run, summed over the blocks
+   uint64_t coPackedBlocks = 0, quadsSaved = 0;
+   uint64_t stateLoads = 0; // voices whose filter state had to be copied into their lane
+   uint64_t stateMoves = 0; // voices whose state was left in a lane and had to come out of it
+
+   float utilization() const { return quadLanes ? (float)voiceLanes / quadLanes : 1.f; }
+};
+
+/*
+** Decides which quad filter lane each voice runs in. The voices of a scene always fill the lanes
+** from the first one up, so n voices run in (n + 3) / 4 quads, but a voice keeps the lane it had
+** last block whenever that lane is still in its range. With SurgeStorage::keepFilterStateInLanes
+** that voice's registers are still in the lane (see SurgeVoice::GetQFB) and nothing is copied.
+** When a voice ends, only the voices above the new top of the range move down into the holes.
+**
+** With coPack, every scene's voices go into the first scene's quads one after the other, so a
+** scene's last part-full quad can be shared with the next scene's first. The synth only asks for
+** that when the scenes' filter blocks are set up the same, and runs the shared quad split (see
+** GetFBQPointer).
+**
+** Call schedule once per block, before any scene is rendered: the voices which move have their
+** state copied out of their old lane there, and another scene's voice may be about to write it.
+*/
+class FilterLaneScheduler
+{
+public:
+   FilterLaneScheduler();
+
+   void schedule(SurgeVoiceTable* voices, QuadFilterChainState** FBQ, bool coPack);
+
+   // Which quad array (FBQ[quadsOf(s)]) the voices of scene s use this block, and from which lane
+   int quadsOf(int s) const { return sceneQuads[s]; }
+   int firstLaneOf(int s) const { return sceneFirstLane[s]; }
+   int laneOf(int s, const SurgeVoiceTable& voices, const SurgeVoice* v) const
+   {
+      return slotLane[s][voices.slotOf(v)];
+   }
+
+   bool coPacked = false;
+   // By quad array: the voice in each lane, and how many lanes are in use
+   SurgeVoice* laneVoice[n_scenes][MAX_VOICES];
+   int lanesUsed[n_scenes];
+
+   FilterLaneStats stats;
+
+private:
+   void pack(int s, SurgeVoiceTable& voices, int quads, QuadFilterChainState* Q, int firstLane);
+
+   int sceneQuads[n_scenes], sceneFirstLane[n_scenes];
+   int8_t slotLane[n_scenes][MAX_VOICES];
+};
@@ -2,6 +2,7 @@
 #include <cmath>
 #include "DebugHelpers.h"
 #include "MSEGModulationHelper.h"
+#include "util/SceneRandom.h"
 
 using namespace std;
 
@@ -190,11 +191,11 @@ void LfoModulationSource::attack()
          step = 0;
          break;
       case lm_random:
-         phase = (float)rand() / (float)RAND_MAX;
+         phase = (float)Surge::SceneRandom::rand() / (float)RAND_MAX;
          if( ss->loop_end == 0 )
             step = 0;
          else
-            step = (rand() % ss->loop_end) & (n_stepseqsteps - 1);
+            step = (Surge::SceneRandom::rand() % ss->loop_end) & (n_stepseqsteps - 1);
          break;
       case lm_freerun:
       {
@@ -337,7 +338,7 @@ void LfoModulationSource::process_block()
 
    if( ! lfo->rate.temposync)
    {
-      frate = envelope_rate_linear_nowrap(-localcopy[rate].f);
+      frate = storage->envelope_rate_linear_nowrap(-localcopy[rate].f);
    }
    else
    {
@@ -348,7 +349,7 @@ void LfoModulationSource::process_block()
       ** envrate is blocksize / samplerate 2^-x
       ** so lets just do that
       */
-      frate = (double)BLOCK_SIZE_OS * dsamplerate_os_inv * pow( 2.0, localcopy[rate].f ); // since x = -localcopy, -x == localcopy
+      frate = (double)storage->blockSizeOS * dsamplerate_os_inv * pow( 2.0, localcopy[rate].f ); // since x = -localcopy, -x == localcopy
    }
 
 
@@ -371,27 +372,27 @@ void LfoModulationSource::process_block()
       switch (env_state)
       {
       case lenv_delay:
-         envrate = envelope_rate_linear_nowrap(localcopy[idelay].f);
+         envrate = storage->envelope_rate_linear_nowrap(localcopy[idelay].f);
          if (lfo->delay.temposync)
             envrate *= storage->temposyncratio;
          break;
       case lenv_attack:
-         envrate = envelope_rate_linear_nowrap(localcopy[iattack].f);
+         envrate = storage->envelope_rate_linear_nowrap(localcopy[iattack].f);
          if (lfo->attack.temposync)
             envrate *= storage->temposyncratio;
          break;
       case lenv_hold:
-         envrate = envelope_rate_linear_nowrap(localcopy[ihold].f);
+         envrate = storage->envelope_rate_linear_nowrap(localcopy[ihold].f);
          if (lfo->hold.temposync)
             envrate *= storage->temposyncratio;
          break;
       case lenv_decay:
-         envrate = envelope_rate_linear_nowrap(localcopy[idecay].f);
+         envrate = storage->envelope_rate_linear_nowrap(localcopy[idecay].f);
          if (lfo->decay.temposync)
             envrate *= storage->temposyncratio;
          break;
       case lenv_release:
-         envrate = envelope_rate_linear_nowrap(localcopy[irelease].f);
+         envrate = storage->envelope_rate_linear_nowrap(localcopy[irelease].f);
          if (lfo->release.temposync)
             envrate *= storage->temposyncratio;
          break;
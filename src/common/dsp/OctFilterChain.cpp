@@ -0,0 +1,1035 @@
+/*
+** Surge Synthesizer is Free and Open Source Software
+**
+** Surge is made available under the Gnu General Public License, v3.0
+** https://www.gnu.org/licenses/gpl-3.0.en.html
+**
+** Copyright 2004-2020 by various individuals as described by the Git transaction log
+**
+** All source at: https://github.com/surge-synthesizer/surge.git
+**
+** Surge was a commercial product from 2004-2018, with Copyright and ownership
+** in that period held by Claes Johanson at Vember Audio. Claes made Surge
+** open source in September 2018.
+*/
+
+/*
+** The 8 lane filter chains; see OctFilterChain.h. The unit, waveshaper and chain bodies are the
+** ones in QuadFilterUnit.cpp and QuadFilterChain.cpp with the __m128s widened and the operations
+** kept in the same order, so the two paths agree to rounding.
+**
+** Everything which touches an __m256 is marked SURGE_AVX2_TARGET rather than building the file
+** with -mavx2. That way the inline functions this file picks up from the headers are still
+** compiled for the baseline, and the linker can't hand the SSE2 path an AVX2 copy of one of them.
+*/
+
+#include "OctFilterChain.h"
+#include "SurgeStorage.h"
+#include <vt_dsp/basic_dsp.h>
+
+#if SURGE_OCT_FILTER_CHAIN
+#include <immintrin.h>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define SURGE_AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define SURGE_AVX2_TARGET
+#endif
+
+struct OctFilterUnitState
+{
+   __m256 C[n_cm_coeffs], dC[n_cm_coeffs]; // coefficients
+   __m256 R[n_filter_registers];           // registers
+};
+
+struct OctFilterChainState
+{
+   OctFilterUnitState FU[4];
+
+   __m256 Gain, FB, Mix1, Mix2, Drive;
+   __m256 dGain, dFB, dMix1, dMix2, dDrive;
+
+   __m256 wsLPF, FBlineL, FBlineR;
+
+   __m256 OutL, OutR, dOutL, dOutR;
+   __m256 Out2L, Out2R, dOut2L, dOut2R;
+
+   __m256 mask;
+};
+
+typedef __m256 (*FilterUnitOFPtr)(OctFilterUnitState* __restrict, __m256 in);
+typedef __m256 (*WaveshaperOFPtr)(__m256 in, __m256 drive);
+
+SURGE_AVX2_TARGET static inline __m256 lanes8(__m128 lo, __m128 hi)
+{
+   return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+}
+
+SURGE_AVX2_TARGET static inline __m128 lo4(__m256 x)
+{
+   return _mm256_castps256_ps128(x);
+}
+
+SURGE_AVX2_TARGET static inline __m128 hi4(__m256 x)
+{
+   return _mm256_extractf128_ps(x, 1);
+}
+
+SURGE_AVX2_TARGET static inline __m256 softclip8_ps(__m256 in)
+{
+   // y = x - (4/27)*x^3,  x € [-1.5 .. 1.5]
+   const __m256 a = _mm256_set1_ps(-4.f / 27.f);
+
+   const __m256 x_min = _mm256_set1_ps(-1.5f);
+   const __m256 x_max = _mm256_set1_ps(1.5f);
+
+   __m256 x = _mm256_max_ps(_mm256_min_ps(in, x_max), x_min);
+   __m256 xx = _mm256_mul_ps(x, x);
+   __m256 t = _mm256_mul_ps(x, a);
+   t = _mm256_mul_ps(t, xx);
+   t = _mm256_add_ps(t, x);
+
+   return t;
+}
+
+/*
+** Units
+*/
+
+SURGE_AVX2_TARGET static __m256 SVFLP12Aoct(OctFilterUnitState* __restrict f, __m256 in)
+{
+   f->C[0] = _mm256_add_ps(f->C[0], f->dC[0]); // F1
+   f->C[1] = _mm256_add_ps(f->C[1], f->dC[1]); // Q1
+
+   __m256 L = _mm256_add_ps(f->R[1], _mm256_mul_ps(f->C[0], f->R[0]));
+   __m256 H = _mm256_sub_ps(_mm256_sub_ps(in, L), _mm256_mul_ps(f->C[1], f->R[0]));
+   __m256 B = _mm256_add_ps(f->R[0], _mm256_mul_ps(f->C[0], H));
+
+   __m256 L2 = _mm256_add_ps(L, _mm256_mul_ps(f->C[0], B));
+   __m256 H2 = _mm256_sub_ps(_mm256_sub_ps(in, L2), _mm256_mul_ps(f->C[1], B));
+   __m256 B2 = _mm256_add_ps(B, _mm256_mul_ps(f->C[0], H2));
+
+   f->R[0] = _mm256_mul_ps(B2, f->R[2]);
+   f->R[1] = _mm256_mul_ps(L2, f->R[2]);
+
+   f->C[2] = _mm256_add_ps(f->C[2], f->dC[2]);
+   const __m256 m01 = _mm256_set1_ps(0.1f);
+   const __m256 m1 = _mm256_set1_ps(1.0f);
+   f->R[2] = _mm256_max_ps(m01, _mm256_sub_ps(m1, _mm256_mul_ps(f->C[2], _mm256_mul_ps(B, B))));
+
+   f->C[3] = _mm256_add_ps(f->C[3], f->dC[3]); // Gain
+   return _mm256_mul_ps(L2, f->C[3]);
+}
+
+SURGE_AVX2_TARGET static __m256 SVFLP24Aoct(OctFilterUnitState* __restrict f, __m256 in)
+{
+   f->C[0] = _mm256_add_ps(f->C[0], f->dC[0]); // F1
+   f->C[1] = _mm256_add_ps(f->C[1], f->dC[1]); // Q1
+
+   __m256 L = _mm256_add_ps(f->R[1], _mm256_mul_ps(f->C[0], f->R[0]));
+   __m256 H = _mm256_sub_ps(_mm256_sub_ps(in, L), _mm256_mul_ps(f->C[1], f->R[0]));
+   __m256 B = _mm256_add_ps(f->R[0], _mm256_mul_ps(f->C[0], H));
+
+   L = _mm256_add_ps(L, _mm256_mul_ps(f->C[0], B));
+   H = _mm256_sub_ps(_mm256_sub_ps(in, L), _mm256_mul_ps(f->C[1], B));
+   B = _mm256_add_ps(B, _mm256_mul_ps(f->C[0], H));
+
+   f->R[0] = _mm256_mul_ps(B, f->R[2]);
+   f->R[1] = _mm256_mul_ps(L, f->R[2]);
+
+   in = L;
+
+   L = _mm256_add_ps(f->R[4], _mm256_mul_ps(f->C[0], f->R[3]));
+   H = _mm256_sub_ps(_mm256_sub_ps(in, L), _mm256_mul_ps(f->C[1], f->R[3]));
+   B = _mm256_add_ps(f->R[3], _mm256_mul_ps(f->C[0], H));
+
+   L = _mm256_add_ps(L, _mm256_mul_ps(f->C[0], B));
+   H = _mm256_sub_ps(_mm256_sub_ps(in, L), _mm256_mul_ps(f->C[1], B));
+   B = _mm256_add_ps(B, _mm256_mul_ps(f->C[0], H));
+
+   f->R[3] = _mm256_mul_ps(B, f->R[2]);
+   f->R[4] = _mm256_mul_ps(L, f->R[2]);
+
+   f->C[2] = _mm256_add_ps(f->C[2], f->dC[2]);
+   const __m256 m01 = _mm256_set1_ps(0.1f);
+   const __m256 m1 = _mm256_set1_ps(1.0f);
+   f->R[2] = _mm256_max_ps(m01, _mm256_sub_ps(m1, _mm256_mul_ps(f->C[2], _mm256_mul_ps(B, B))));
+
+   f->C[3] = _mm256_add_ps(f->C[3], f->dC[3]); // Gain
+   return _mm256_mul_ps(L, f->C[3]);
+}
+
+SURGE_AVX2_TARGET static __m256 SVFHP24Aoct(OctFilterUnitState* __restrict f, __m256 in)
+{
+   f->C[0] = _mm256_add_ps(f->C[0], f->dC[0]); // F1
+   f->C[1] = _mm256_add_ps(f->C[1], f->dC[1]); // Q1
+
+   __m256 L = _mm256_add_ps(f->R[1], _mm256_mul_ps(f->C[0], f->R[0]));
+   __m256 H = _mm256_sub_ps(_mm256_sub_ps(in, L), _mm256_mul_ps(f->C[1], f->R[0]));
+   __m256 B = _mm256_add_ps(f->R[0], _mm256_mul_ps(f->C[0], H));
+
+   L = _mm256_add_ps(L, _mm256_mul_ps(f->C[0], B));
+   H = _mm256_sub_ps(_mm256_sub_ps(in, L), _mm256_mul_ps(f->C[1], B));
+   B = _mm256_add_ps(B, _mm256_mul_ps(f->C[0], H));
+
+   f->R[0] = _mm256_mul_ps(B, f->R[2]);
+   f->R[1] = _mm256_mul_ps(L, f->R[2]);
+
+   in = H;
+
+   L = _mm256_add_ps(f->R[4], _mm256_mul_ps(f->C[0], f->R[3]));
+   H = _mm256_sub_ps(_mm256_sub_ps(in, L), _mm256_mul_ps(f->C[1], f->R[3]));
+   B = _mm256_add_ps(f->R[3], _mm256_mul_ps(f->C[0], H));
+
+   L = _mm256_add_ps(L, _mm256_mul_ps(f->C[0], B));
+   H = _mm256_sub_ps(_mm256_sub_ps(in, L), _mm256_mul_ps(f->C[1], B));
+   B = _mm256_add_ps(B, _mm256_mul_ps(f->C[0], H));
+
+   f->R[3] = _mm256_mul_ps(B, f->R[2]);
+   f->R[4] = _mm256_mul_ps(L, f->R[2]);
+
+   f->C[2] = _mm256_add_ps(f->C[2], f->dC[2]);
+   const __m256 m01 = _mm256_set1_ps(0.1f);
+   const __m256 m1 = _mm256_set1_ps(1.0f);
+   f->R[2] = _mm256_max_ps(m01, _mm256_sub_ps(m1, _mm256_mul_ps(f->C[2], _mm256_mul_ps(B, B))));
+
+   f->C[3] = _mm256_add_ps(f->C[3], f->dC[3]); // Gain
+   return _mm256_mul_ps(H, f->C[3]);
+}
+
+SURGE_AVX2_TARGET static __m256 SVFBP24Aoct(OctFilterUnitState* __restrict f, __m256 in)
+{
+   f->C[0] = _mm256_add_ps(f->C[0], f->dC[0]); // F1
+   f->C[1] = _mm256_add_ps(f->C[1], f->dC[1]); // Q1
+
+   __m256 L = _mm256_add_ps(f->R[1], _mm256_mul_ps(f->C[0], f->R[0]));
+   __m256 H = _mm256_sub_ps(_mm256_sub_ps(in, L), _mm256_mul_ps(f->C[1], f->R[0]));
+   __m256 B = _mm256_add_ps(f->R[0], _mm256_mul_ps(f->C[0], H));
+
+   L = _mm256_add_ps(L, _mm256_mul_ps(f->C[0], B));
+   H = _mm256_sub_ps(_mm256_sub_ps(in, L), _mm256_mul_ps(f->C[1], B));
+   B = _mm256_add_ps(B, _mm256_mul_ps(f->C[0], H));
+
+   f->R[0] = _mm256_mul_ps(B, f->R[2]);
+   f->R[1] = _mm256_mul_ps(L, f->R[2]);
+
+   in = B;
+
+   L = _mm256_add_ps(f->R[4], _mm256_mul_ps(f->C[0], f->R[3]));
+   H = _mm256_sub_ps(_mm256_sub_ps(in, L), _mm256_mul_ps(f->C[1], f->R[3]));
+   B = _mm256_add_ps(f->R[3], _mm256_mul_ps(f->C[0], H));
+
+   L = _mm256_add_ps(L, _mm256_mul_ps(f->C[0], B));
+   H = _mm256_sub_ps(_mm256_sub_ps(in, L), _mm256_mul_ps(f->C[1], B));
+   B = _mm256_add_ps(B, _mm256_mul_ps(f->C[0], H));
+
+   f->R[3] = _mm256_mul_ps(B, f->R[2]);
+   f->R[4] = _mm256_mul_ps(L, f->R[2]);
+
+   f->C[2] = _mm256_add_ps(f->C[2], f->dC[2]);
+   const __m256 m01 = _mm256_set1_ps(0.1f);
+   const __m256 m1 = _mm256_set1_ps(1.0f);
+   f->R[2] = _mm256_max_ps(m01, _mm256_sub_ps(m1, _mm256_mul_ps(f->C[2], _mm256_mul_ps(B, B))));
+
+   f->C[3] = _mm256_add_ps(f->C[3], f->dC[3]); // Gain
+   return _mm256_mul_ps(B, f->C[3]);
+}
+
+SURGE_AVX2_TARGET static __m256 SVFHP12Aoct(OctFilterUnitState* __restrict f, __m256 in)
+{
+   f->C[0] = _mm256_add_ps(f->C[0], f->dC[0]); // F1
+   f->C[1] = _mm256_add_ps(f->C[1], f->dC[1]); // Q1
+
+   __m256 L = _mm256_add_ps(f->R[1], _mm256_mul_ps(f->C[0], f->R[0]));
+   __m256 H = _mm256_sub_ps(_mm256_sub_ps(in, L), _mm256_mul_ps(f->C[1], f->R[0]));
+   __m256 B = _mm256_add_ps(f->R[0], _mm256_mul_ps(f->C[0], H));
+
+   __m256 L2 = _mm256_add_ps(L, _mm256_mul_ps(f->C[0], B));
+   __m256 H2 = _mm256_sub_ps(_mm256_sub_ps(in, L2), _mm256_mul_ps(f->C[1], B));
+   __m256 B2 = _mm256_add_ps(B, _mm256_mul_ps(f->C[0], H2));
+
+   f->R[0] = _mm256_mul_ps(B2, f->R[2]);
+   f->R[1] = _mm256_mul_ps(L2, f->R[2]);
+
+   f->C[2] = _mm256_add_ps(f->C[2], f->dC[2]);
+   const __m256 m01 = _mm256_set1_ps(0.1f);
+   const __m256 m1 = _mm256_set1_ps(1.0f);
+   f->R[2] = _mm256_max_ps(m01, _mm256_sub_ps(m1, _mm256_mul_ps(f->C[2], _mm256_mul_ps(B, B))));
+
+   f->C[3] = _mm256_add_ps(f->C[3], f->dC[3]); // Gain
+   return _mm256_mul_ps(H2, f->C[3]);
+}
+
+SURGE_AVX2_TARGET static __m256 SVFBP12Aoct(OctFilterUnitState* __restrict f, __m256 in)
+{
+   f->C[0] = _mm256_add_ps(f->C[0], f->dC[0]); // F1
+   f->C[1] = _mm256_add_ps(f->C[1], f->dC[1]); // Q1
+
+   __m256 L = _mm256_add_ps(f->R[1], _mm256_mul_ps(f->C[0], f->R[0]));
+   __m256 H = _mm256_sub_ps(_mm256_sub_ps(in, L), _mm256_mul_ps(f->C[1], f->R[0]));
+   __m256 B = _mm256_add_ps(f->R[0], _mm256_mul_ps(f->C[0], H));
+
+   __m256 L2 = _mm256_add_ps(L, _mm256_mul_ps(f->C[0], B));
+   __m256 H2 = _mm256_sub_ps(_mm256_sub_ps(in, L2), _mm256_mul_ps(f->C[1], B));
+   __m256 B2 = _mm256_add_ps(B, _mm256_mul_ps(f->C[0], H2));
+
+   f->R[0] = _mm256_mul_ps(B2, f->R[2]);
+   f->R[1] = _mm256_mul_ps(L2, f->R[2]);
+
+   f->C[2] = _mm256_add_ps(f->C[2], f->dC[2]);
+   const __m256 m01 = _mm256_set1_ps(0.1f);
+   const __m256 m1 = _mm256_set1_ps(1.0f);
+   f->R[2] = _mm256_max_ps(m01, _mm256_sub_ps(m1, _mm256_mul_ps(f->C[2], _mm256_mul_ps(B, B))));
+
+   f->C[3] = _mm256_add_ps(f->C[3], f->dC[3]); // Gain
+   return _mm256_mul_ps(B2, f->C[3]);
+}
+
+SURGE_AVX2_TARGET static __m256 IIR12Boct(OctFilterUnitState* __restrict f, __m256 in)
+{
+   // Q2*in - K2*R1
+   __m256 f2 = _mm256_sub_ps(_mm256_mul_ps(f->C[3], in), _mm256_mul_ps(f->C[1], f->R[1]));
+   f->C[1] = _mm256_add_ps(f->C[1], f->dC[1]);                                       // K2
+   f->C[3] = _mm256_add_ps(f->C[3], f->dC[3]);                                       // Q2
+   // K2*in + Q2*R1
+   __m256 g2 = _mm256_add_ps(_mm256_mul_ps(f->C[1], in), _mm256_mul_ps(f->C[3], f->R[1]));
+
+   // Q1*f2 - K1*R0
+   __m256 f1 = _mm256_sub_ps(_mm256_mul_ps(f->C[2], f2), _mm256_mul_ps(f->C[0], f->R[0]));
+   f->C[0] = _mm256_add_ps(f->C[0], f->dC[0]);                                       // K1
+   f->C[2] = _mm256_add_ps(f->C[2], f->dC[2]);                                       // Q1
+   // K1*f2 + Q1*R0
+   __m256 g1 = _mm256_add_ps(_mm256_mul_ps(f->C[0], f2), _mm256_mul_ps(f->C[2], f->R[0]));
+
+   f->C[4] = _mm256_add_ps(f->C[4], f->dC[4]); // V1
+   f->C[5] = _mm256_add_ps(f->C[5], f->dC[5]); // V2
+   f->C[6] = _mm256_add_ps(f->C[6], f->dC[6]); // V3
+   __m256 y = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(f->C[6], g2), _mm256_mul_ps(f->C[5], g1)),
+                         _mm256_mul_ps(f->C[4], f1));
+
+   f->R[0] = _mm256_mul_ps(f1, f->R[2]);
+   f->R[1] = _mm256_mul_ps(g1, f->R[2]);
+
+   f->C[7] = _mm256_add_ps(f->C[7], f->dC[7]); // Clipgain
+   const __m256 m01 = _mm256_set1_ps(0.1f);
+   const __m256 m1 = _mm256_set1_ps(1.0f);
+
+   f->R[2] = _mm256_max_ps(m01, _mm256_sub_ps(m1, _mm256_mul_ps(f->C[7], _mm256_mul_ps(y, y))));
+
+   return y;
+}
+
+SURGE_AVX2_TARGET static __m256 IIR12CFCoct(OctFilterUnitState* __restrict f, __m256 in)
+{
+   // State-space with clipgain (2nd order, limit within register)
+
+   f->C[0] = _mm256_add_ps(f->C[0], f->dC[0]); // ar
+   f->C[1] = _mm256_add_ps(f->C[1], f->dC[1]); // ai
+   f->C[2] = _mm256_add_ps(f->C[2], f->dC[2]); // b1
+   f->C[4] = _mm256_add_ps(f->C[4], f->dC[4]); // c1
+   f->C[5] = _mm256_add_ps(f->C[5], f->dC[5]); // c2
+   f->C[6] = _mm256_add_ps(f->C[6], f->dC[6]); // d
+
+   // y(i) = c1.*s(1) + c2.*s(2) + d.*x(i);
+   // s1 = ar.*s(1) - ai.*s(2) + x(i);
+   // s2 = ai.*s(1) + ar.*s(2);
+
+   __m256 y = _mm256_add_ps(
+       _mm256_add_ps(_mm256_mul_ps(f->C[4], f->R[0]), _mm256_mul_ps(f->C[6], in)),
+       _mm256_mul_ps(f->C[5], f->R[1]));
+   __m256 s1 = _mm256_add_ps(_mm256_mul_ps(in, f->C[2]),
+                          _mm256_sub_ps(_mm256_mul_ps(f->C[0], f->R[0]),
+                                        _mm256_mul_ps(f->C[1], f->R[1])));
+   __m256 s2 = _mm256_add_ps(_mm256_mul_ps(f->C[1], f->R[0]), _mm256_mul_ps(f->C[0], f->R[1]));
+
+   f->R[0] = _mm256_mul_ps(s1, f->R[2]);
+   f->R[1] = _mm256_mul_ps(s2, f->R[2]);
+
+   f->C[7] = _mm256_add_ps(f->C[7], f->dC[7]); // Clipgain
+   const __m256 m01 = _mm256_set1_ps(0.1f);
+   const __m256 m1 = _mm256_set1_ps(1.0f);
+   f->R[2] = _mm256_max_ps(m01, _mm256_sub_ps(m1, _mm256_mul_ps(f->C[7], _mm256_mul_ps(y, y))));
+
+   return y;
+}
+
+SURGE_AVX2_TARGET static __m256 IIR24CFCoct(OctFilterUnitState* __restrict f, __m256 in)
+{
+   // State-space with clipgain (2nd order, limit within register)
+
+   f->C[0] = _mm256_add_ps(f->C[0], f->dC[0]); // ar
+   f->C[1] = _mm256_add_ps(f->C[1], f->dC[1]); // ai
+   f->C[2] = _mm256_add_ps(f->C[2], f->dC[2]); // b1
+
+   f->C[4] = _mm256_add_ps(f->C[4], f->dC[4]); // c1
+   f->C[5] = _mm256_add_ps(f->C[5], f->dC[5]); // c2
+   f->C[6] = _mm256_add_ps(f->C[6], f->dC[6]); // d
+
+   __m256 y = _mm256_add_ps(
+       _mm256_add_ps(_mm256_mul_ps(f->C[4], f->R[0]), _mm256_mul_ps(f->C[6], in)),
+       _mm256_mul_ps(f->C[5], f->R[1]));
+   __m256 s1 = _mm256_add_ps(_mm256_mul_ps(in, f->C[2]),
+                          _mm256_sub_ps(_mm256_mul_ps(f->C[0], f->R[0]),
+                                        _mm256_mul_ps(f->C[1], f->R[1])));
+   __m256 s2 = _mm256_add_ps(_mm256_mul_ps(f->C[1], f->R[0]), _mm256_mul_ps(f->C[0], f->R[1]));
+
+   f->R[0] = _mm256_mul_ps(s1, f->R[2]);
+   f->R[1] = _mm256_mul_ps(s2, f->R[2]);
+
+   __m256 y2 = _mm256_add_ps(
+       _mm256_add_ps(_mm256_mul_ps(f->C[4], f->R[3]), _mm256_mul_ps(f->C[6], y)),
+       _mm256_mul_ps(f->C[5], f->R[4]));
+   __m256 s3 = _mm256_add_ps(_mm256_mul_ps(y, f->C[2]),
+                          _mm256_sub_ps(_mm256_mul_ps(f->C[0], f->R[3]),
+                                        _mm256_mul_ps(f->C[1], f->R[4])));
+   __m256 s4 = _mm256_add_ps(_mm256_mul_ps(f->C[1], f->R[3]), _mm256_mul_ps(f->C[0], f->R[4]));
+
+   f->R[3] = _mm256_mul_ps(s3, f->R[2]);
+   f->R[4] = _mm256_mul_ps(s4, f->R[2]);
+
+   f->C[7] = _mm256_add_ps(f->C[7], f->dC[7]); // Clipgain
+   const __m256 m01 = _mm256_set1_ps(0.1f);
+   const __m256 m1 = _mm256_set1_ps(1.0f);
+   f->R[2] = _mm256_max_ps(m01, _mm256_sub_ps(m1, _mm256_mul_ps(f->C[7], _mm256_mul_ps(y2, y2))));
+
+   return y2;
+}
+
+SURGE_AVX2_TARGET static __m256 IIR24Boct(OctFilterUnitState* __restrict f, __m256 in)
+{
+   f->C[1] = _mm256_add_ps(f->C[1], f->dC[1]); // K2
+   f->C[3] = _mm256_add_ps(f->C[3], f->dC[3]); // Q2
+   f->C[0] = _mm256_add_ps(f->C[0], f->dC[0]); // K1
+   f->C[2] = _mm256_add_ps(f->C[2], f->dC[2]); // Q1
+   f->C[4] = _mm256_add_ps(f->C[4], f->dC[4]); // V1
+   f->C[5] = _mm256_add_ps(f->C[5], f->dC[5]); // V2
+   f->C[6] = _mm256_add_ps(f->C[6], f->dC[6]); // V3
+
+   // Q2*in - K2*R1
+   __m256 f2 = _mm256_sub_ps(_mm256_mul_ps(f->C[3], in), _mm256_mul_ps(f->C[1], f->R[1]));
+   // K2*in + Q2*R1
+   __m256 g2 = _mm256_add_ps(_mm256_mul_ps(f->C[1], in), _mm256_mul_ps(f->C[3], f->R[1]));
+   // Q1*f2 - K1*R0
+   __m256 f1 = _mm256_sub_ps(_mm256_mul_ps(f->C[2], f2), _mm256_mul_ps(f->C[0], f->R[0]));
+   // K1*f2 + Q1*R0
+   __m256 g1 = _mm256_add_ps(_mm256_mul_ps(f->C[0], f2), _mm256_mul_ps(f->C[2], f->R[0]));
+   f->R[0] = _mm256_mul_ps(f1, f->R[4]);
+   f->R[1] = _mm256_mul_ps(g1, f->R[4]);
+   __m256 y1 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(f->C[6], g2), _mm256_mul_ps(f->C[5], g1)),
+                          _mm256_mul_ps(f->C[4], f1));
+
+   f2 = _mm256_sub_ps(_mm256_mul_ps(f->C[3], y1), _mm256_mul_ps(f->C[1], f->R[3])); // Q2*in - K2*R1
+   g2 = _mm256_add_ps(_mm256_mul_ps(f->C[1], y1), _mm256_mul_ps(f->C[3], f->R[3])); // K2*in + Q2*R1
+   f1 = _mm256_sub_ps(_mm256_mul_ps(f->C[2], f2), _mm256_mul_ps(f->C[0], f->R[2])); // Q1*f2 - K1*R0
+   g1 = _mm256_add_ps(_mm256_mul_ps(f->C[0], f2), _mm256_mul_ps(f->C[2], f->R[2])); // K1*f2 + Q1*R0
+   f->R[2] = _mm256_mul_ps(f1, f->R[4]);
+   f->R[3] = _mm256_mul_ps(g1, f->R[4]);
+   __m256 y2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(f->C[6], g2), _mm256_mul_ps(f->C[5], g1)),
+                          _mm256_mul_ps(f->C[4], f1));
+
+   f->C[7] = _mm256_add_ps(f->C[7], f->dC[7]); // Clipgain
+   const __m256 m01 = _mm256_set1_ps(0.1f);
+   const __m256 m1 = _mm256_set1_ps(1.0f);
+   f->R[4] = _mm256_max_ps(m01, _mm256_sub_ps(m1, _mm256_mul_ps(f->C[7], _mm256_mul_ps(y2, y2))));
+
+   return y2;
+}
+
+/*
+** Waveshapers. The table lookups in asym and sine are AVX2 gathers.
+*/
+
+SURGE_AVX2_TARGET static __m256 CLIPoct(__m256 in, __m256 drive)
+{
+   const __m256 x_min = _mm256_set1_ps(-1.0f);
+   const __m256 x_max = _mm256_set1_ps(1.0f);
+   return _mm256_max_ps(_mm256_min_ps(_mm256_mul_ps(in, drive), x_max), x_min);
+}
+
+SURGE_AVX2_TARGET static __m256 DIGIoct(__m256 in, __m256 drive)
+{
+   const __m256 m16 = _mm256_set1_ps(16.f);
+   const __m256 m16inv = _mm256_set1_ps(0.0625f);
+   const __m256 mofs = _mm256_set1_ps(0.5f);
+
+   __m256 invdrive = _mm256_rcp_ps(drive);
+   __m256i a =
+       _mm256_cvtps_epi32(_mm256_add_ps(mofs, _mm256_mul_ps(invdrive, _mm256_mul_ps(m16, in))));
+
+   return _mm256_mul_ps(drive, _mm256_mul_ps(m16inv, _mm256_sub_ps(_mm256_cvtepi32_ps(a), mofs)));
+}
+
+SURGE_AVX2_TARGET static __m256 TANHoct(__m256 in, __m256 drive)
+{
+   const __m256 m9 = _mm256_set1_ps(9.f);
+   const __m256 m27 = _mm256_set1_ps(27.f);
+
+   __m256 x = _mm256_mul_ps(in, drive);
+   __m256 xx = _mm256_mul_ps(x, x);
+   __m256 denom = _mm256_add_ps(m27, _mm256_mul_ps(m9, xx));
+   __m256 y = _mm256_mul_ps(x, _mm256_add_ps(m27, xx));
+   y = _mm256_mul_ps(y, _mm256_rcp_ps(denom));
+
+   const __m256 y_min = _mm256_set1_ps(-1.0f);
+   const __m256 y_max = _mm256_set1_ps(1.0f);
+   return _mm256_max_ps(_mm256_min_ps(y, y_max), y_min);
+}
+
+// Linear interpolation in a 1024 entry waveshaper table, x already scaled to the table
+SURGE_AVX2_TARGET static inline __m256 tableLookup8(const float* table, __m256 x)
+{
+   const __m256 one = _mm256_set1_ps(1.f);
+   const __m256i UB = _mm256_set1_epi32(0x3fe);
+
+   __m256i e = _mm256_cvtps_epi32(x);
+   __m256 a = _mm256_sub_ps(x, _mm256_cvtepi32_ps(e));
+   e = _mm256_max_epi32(_mm256_min_epi32(e, UB), _mm256_setzero_si256());
+
+   __m256 ws = _mm256_i32gather_ps(table, e, 4);
+   __m256 wsn = _mm256_i32gather_ps(table, _mm256_add_epi32(e, _mm256_set1_epi32(1)), 4);
+
+   return _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(one, a), ws), _mm256_mul_ps(a, wsn));
+}
+
+SURGE_AVX2_TARGET static __m256 SINUSoct(__m256 in, __m256 drive)
+{
+   const __m256 m256 = _mm256_set1_ps(256.f);
+   const __m256 m512 = _mm256_set1_ps(512.f);
+
+   __m256 x = _mm256_mul_ps(in, drive);
+   x = _mm256_add_ps(_mm256_mul_ps(x, m256), m512);
+   return tableLookup8(waveshapers[wst_sine], x);
+}
+
+SURGE_AVX2_TARGET static __m256 ASYMoct(__m256 in, __m256 drive)
+{
+   const __m256 m32 = _mm256_set1_ps(32.f);
+   const __m256 m512 = _mm256_set1_ps(512.f);
+
+   __m256 x = _mm256_mul_ps(in, drive);
+   x = _mm256_add_ps(_mm256_mul_ps(x, m32), m512);
+   return tableLookup8(waveshapers[wst_asym], x);
+}
+
+/*
+** The 4 lane kernels these stand in for, so we can pick ours by matching what
+** GetQFPtrFilterUnit and GetQFPtrWaveshaper chose.
+*/
+__m128 SVFLP12Aquad(QuadFilterUnitState* __restrict f, __m128 in);
+__m128 SVFLP24Aquad(QuadFilterUnitState* __restrict f, __m128 in);
+__m128 SVFHP24Aquad(QuadFilterUnitState* __restrict f, __m128 in);
+__m128 SVFBP24Aquad(QuadFilterUnitState* __restrict f, __m128 in);
+__m128 SVFHP12Aquad(QuadFilterUnitState* __restrict f, __m128 in);
+__m128 SVFBP12Aquad(QuadFilterUnitState* __restrict f, __m128 in);
+__m128 IIR12Bquad(QuadFilterUnitState* __restrict f, __m128 in);
+__m128 IIR12CFCquad(QuadFilterUnitState* __restrict f, __m128 in);
+__m128 IIR24CFCquad(QuadFilterUnitState* __restrict f, __m128 in);
+__m128 IIR24Bquad(QuadFilterUnitState* __restrict f, __m128 in);
+__m128 CLIP(__m128 in, __m128 drive);
+__m128 DIGI_SSE2(__m128 in, __m128 drive);
+__m128 TANH(__m128 in, __m128 drive);
+__m128 SINUS_SSE2(__m128 in, __m128 drive);
+__m128 ASYM_SSE2(__m128 in, __m128 drive);
+
+static const struct
+{
+   FilterUnitQFPtr quad;
+   FilterUnitOFPtr oct;
+} filterUnits[] = {
+    {SVFLP12Aquad, SVFLP12Aoct}, {SVFLP24Aquad, SVFLP24Aoct}, {SVFHP24Aquad, SVFHP24Aoct},
+    {SVFBP24Aquad, SVFBP24Aoct}, {SVFHP12Aquad, SVFHP12Aoct}, {SVFBP12Aquad, SVFBP12Aoct},
+    {IIR12Bquad, IIR12Boct},     {IIR12CFCquad, IIR12CFCoct}, {IIR24CFCquad, IIR24CFCoct},
+    {IIR24Bquad, IIR24Boct},
+};
+
+static const struct
+{
+   WaveshaperQFPtr quad;
+   WaveshaperOFPtr oct;
+} waveshaperUnits[] = {
+    {CLIP, CLIPoct},         {DIGI_SSE2, DIGIoct}, {TANH, TANHoct},
+    {SINUS_SSE2, SINUSoct}, {ASYM_SSE2, ASYMoct},
+};
+
+static const int n_oct_filter_units = sizeof(filterUnits) / sizeof(filterUnits[0]);
+static const int n_oct_waveshapers = sizeof(waveshaperUnits) / sizeof(waveshaperUnits[0]);
+
+/*
+** Chains
+*/
+
+SURGE_AVX2_TARGET static inline void loadUnit(OctFilterUnitState& o, const QuadFilterUnitState& lo,
+                            const QuadFilterUnitState& hi)
+{
+   for (int i = 0; i < n_cm_coeffs; i++)
+   {
+      o.C[i] = lanes8(lo.C[i], hi.C[i]);
+      o.dC[i] = lanes8(lo.dC[i], hi.dC[i]);
+   }
+   for (int i = 0; i < n_filter_registers; i++)
+      o.R[i] = lanes8(lo.R[i], hi.R[i]);
+}
+
+SURGE_AVX2_TARGET static inline void storeUnit(const OctFilterUnitState& o, QuadFilterUnitState& lo,
+                             QuadFilterUnitState& hi)
+{
+   for (int i = 0; i < n_cm_coeffs; i++)
+   {
+      lo.C[i] = lo4(o.C[i]);
+      hi.C[i] = hi4(o.C[i]);
+   }
+   for (int i = 0; i < n_filter_registers; i++)
+   {
+      lo.R[i] = lo4(o.R[i]);
+      hi.R[i] = hi4(o.R[i]);
+   }
+}
+
+#define OCT_CHAIN_FIELDS(M)                                                                        \
+   M(Gain) M(FB) M(Mix1) M(Mix2) M(Drive) M(dGain) M(dFB) M(dMix1) M(dMix2) M(dDrive) M(wsLPF)     \
+       M(FBlineL) M(FBlineR) M(OutL) M(OutR) M(dOutL) M(dOutR) M(Out2L) M(Out2R) M(dOut2L)         \
+           M(dOut2R)
+
+/*
+** Add the lanes of each half into the output separately, low half first, which is the order
+** the two 4 lane chains would have added them in.
+*/
+#define MWriteOutputs8(x)                                                                          \
+   d.OutL = _mm256_add_ps(d.OutL, d.dOutL);                                                        \
+   d.OutR = _mm256_add_ps(d.OutR, d.dOutR);                                                        \
+   __m256 outL = _mm256_mul_ps(x, d.OutL);                                                         \
+   __m256 outR = _mm256_mul_ps(x, d.OutR);                                                         \
+   _mm_store_ss(&OutL[k], _mm_add_ss(_mm_load_ss(&OutL[k]), sum_ps_to_ss(lo4(outL))));             \
+   _mm_store_ss(&OutL[k], _mm_add_ss(_mm_load_ss(&OutL[k]), sum_ps_to_ss(hi4(outL))));             \
+   _mm_store_ss(&OutR[k], _mm_add_ss(_mm_load_ss(&OutR[k]), sum_ps_to_ss(lo4(outR))));             \
+   _mm_store_ss(&OutR[k], _mm_add_ss(_mm_load_ss(&OutR[k]), sum_ps_to_ss(hi4(outR))));
+
+#define MWriteOutputsDual8(x, y)                                                                   \
+   d.OutL = _mm256_add_ps(d.OutL, d.dOutL);                                                        \
+   d.OutR = _mm256_add_ps(d.OutR, d.dOutR);                                                        \
+   d.Out2L = _mm256_add_ps(d.Out2L, d.dOut2L);                                                     \
+   d.Out2R = _mm256_add_ps(d.Out2R, d.dOut2R);                                                     \
+   __m256 outL = _mm256_add_ps(_mm256_mul_ps(x, d.OutL), _mm256_mul_ps(y, d.Out2L));               \
+   __m256 outR = _mm256_add_ps(_mm256_mul_ps(x, d.OutR), _mm256_mul_ps(y, d.Out2R));               \
+   _mm_store_ss(&OutL[k], _mm_add_ss(_mm_load_ss(&OutL[k]), sum_ps_to_ss(lo4(outL))));             \
+   _mm_store_ss(&OutL[k], _mm_add_ss(_mm_load_ss(&OutL[k]), sum_ps_to_ss(hi4(outL))));             \
+   _mm_store_ss(&OutR[k], _mm_add_ss(_mm_load_ss(&OutR[k]), sum_ps_to_ss(lo4(outR))));             \
+   _mm_store_ss(&OutR[k], _mm_add_ss(_mm_load_ss(&OutR[k]), sum_ps_to_ss(hi4(outR))));
+
+template <int config, bool A, bool WS, bool B>
+SURGE_AVX2_TARGET void ProcessFBOct(QuadFilterChainState& lo,
+                                    QuadFilterChainState& hi,
+                                    fbo_global& g,
+                                    float* OutL,
+                                    float* OutR)
+{
+   OctFilterChainState d;
+   const int blockSize = g.BlockSize;
+   const int units = (config == fc_wide) ? 4 : 2;
+
+#define M(f) d.f = lanes8(lo.f, hi.f);
+   OCT_CHAIN_FIELDS(M)
+#undef M
+   for (int u = 0; u < units; u++)
+      loadUnit(d.FU[u], lo.FU[u], hi.FU[u]);
+   d.mask = lanes8(_mm_load_ps((float*)&lo.FU[0].active), _mm_load_ps((float*)&hi.FU[0].active));
+
+   FilterUnitOFPtr fu1 = A ? filterUnits[g.FU1].oct : nullptr;
+   FilterUnitOFPtr fu2 = B ? filterUnits[g.FU2].oct : nullptr;
+   WaveshaperOFPtr ws = WS ? waveshaperUnits[g.WS].oct : nullptr;
+
+   const __m256 hb_c = _mm256_set1_ps(0.5f);
+   const __m256 one = _mm256_set1_ps(1.0f);
+
+   switch (config)
+   {
+   case fc_serial1: // no feedback at all  (saves CPU)
+      for (int k = 0; k < blockSize; k++)
+      {
+         __m256 input = lanes8(lo.DL[k], hi.DL[k]);
+         __m256 x = input, y = lanes8(lo.DR[k], hi.DR[k]);
+         __m256 mask = d.mask;
+
+         if (A)
+            x = fu1(&d.FU[0], x);
+         if (WS)
+         {
+            d.wsLPF = _mm256_mul_ps(hb_c, _mm256_add_ps(d.wsLPF, _mm256_and_ps(mask, x)));
+            d.Drive = _mm256_add_ps(d.Drive, d.dDrive);
+            x = ws(d.wsLPF, d.Drive);
+         }
+
+         if (A || WS)
+         {
+            d.Mix1 = _mm256_add_ps(d.Mix1, d.dMix1);
+            x = _mm256_add_ps(_mm256_mul_ps(input, _mm256_sub_ps(one, d.Mix1)),
+                              _mm256_mul_ps(x, d.Mix1));
+         }
+
+         y = _mm256_add_ps(x, y);
+
+         if (B)
+            y = fu2(&d.FU[1], y);
+
+         d.Mix2 = _mm256_add_ps(d.Mix2, d.dMix2);
+         x = _mm256_add_ps(_mm256_mul_ps(x, _mm256_sub_ps(one, d.Mix2)), _mm256_mul_ps(y, d.Mix2));
+         d.Gain = _mm256_add_ps(d.Gain, d.dGain);
+         __m256 out = _mm256_and_ps(mask, _mm256_mul_ps(x, d.Gain));
+
+         // output stage
+         MWriteOutputs8(out)
+      }
+      break;
+   case fc_serial2:
+      for (int k = 0; k < blockSize; k++)
+      {
+         d.FB = _mm256_add_ps(d.FB, d.dFB);
+         __m256 input = _mm256_mul_ps(d.FB, d.FBlineL);
+         input = _mm256_add_ps(lanes8(lo.DL[k], hi.DL[k]), softclip8_ps(input));
+         __m256 mask = d.mask;
+         __m256 x = input, y = lanes8(lo.DR[k], hi.DR[k]);
+
+         if (A)
+            x = fu1(&d.FU[0], x);
+         if (WS)
+         {
+            d.wsLPF = _mm256_mul_ps(hb_c, _mm256_add_ps(d.wsLPF, _mm256_and_ps(mask, x)));
+            d.Drive = _mm256_add_ps(d.Drive, d.dDrive);
+            x = ws(d.wsLPF, d.Drive);
+         }
+
+         if (A || WS)
+         {
+            d.Mix1 = _mm256_add_ps(d.Mix1, d.dMix1);
+            x = _mm256_add_ps(_mm256_mul_ps(input, _mm256_sub_ps(one, d.Mix1)),
+                              _mm256_mul_ps(x, d.Mix1));
+         }
+
+         y = _mm256_add_ps(x, y);
+
+         if (B)
+            y = fu2(&d.FU[1], y);
+
+         d.Mix2 = _mm256_add_ps(d.Mix2, d.dMix2);
+         x = _mm256_add_ps(_mm256_mul_ps(x, _mm256_sub_ps(one, d.Mix2)), _mm256_mul_ps(y, d.Mix2));
+         d.Gain = _mm256_add_ps(d.Gain, d.dGain);
+         __m256 out = _mm256_and_ps(mask, _mm256_mul_ps(x, d.Gain));
+         d.FBlineL = out;
+
+         // output stage
+         MWriteOutputs8(out)
+      }
+      break;
+   case fc_serial3: // filter 2 is only heard in the feedback path, good for physical modelling with
+                    // comb as f2
+      for (int k = 0; k < blockSize; k++)
+      {
+         d.FB = _mm256_add_ps(d.FB, d.dFB);
+         __m256 input = _mm256_mul_ps(d.FB, d.FBlineL);
+         input = _mm256_add_ps(lanes8(lo.DL[k], hi.DL[k]), softclip8_ps(input));
+         __m256 x = input, y = lanes8(lo.DR[k], hi.DR[k]);
+         __m256 mask = d.mask;
+
+         if (A)
+            x = fu1(&d.FU[0], x);
+         if (WS)
+         {
+            d.wsLPF = _mm256_mul_ps(hb_c, _mm256_add_ps(d.wsLPF, _mm256_and_ps(mask, x)));
+            d.Drive = _mm256_add_ps(d.Drive, d.dDrive);
+            x = ws(d.wsLPF, d.Drive);
+         }
+
+         if (A || WS)
+         {
+            d.Mix1 = _mm256_add_ps(d.Mix1, d.dMix1);
+            x = _mm256_add_ps(_mm256_mul_ps(input, _mm256_sub_ps(one, d.Mix1)),
+                              _mm256_mul_ps(x, d.Mix1));
+         }
+
+         // output stage
+         d.Gain = _mm256_add_ps(d.Gain, d.dGain);
+         x = _mm256_and_ps(mask, _mm256_mul_ps(x, d.Gain));
+
+         MWriteOutputs8(x)
+
+         y = _mm256_add_ps(x, y);
+
+         if (B)
+            y = fu2(&d.FU[1], y);
+
+         d.Mix2 = _mm256_add_ps(d.Mix2, d.dMix2);
+         x = _mm256_add_ps(_mm256_mul_ps(x, _mm256_sub_ps(one, d.Mix2)), _mm256_mul_ps(y, d.Mix2));
+
+         d.FBlineL = y;
+      }
+      break;
+   case fc_dual1:
+      for (int k = 0; k < blockSize; k++)
+      {
+         d.FB = _mm256_add_ps(d.FB, d.dFB);
+         __m256 fb = _mm256_mul_ps(d.FB, d.FBlineL);
+         fb = softclip8_ps(fb);
+         __m256 x = _mm256_add_ps(lanes8(lo.DL[k], hi.DL[k]), fb);
+         __m256 y = _mm256_add_ps(lanes8(lo.DR[k], hi.DR[k]), fb);
+         __m256 mask = d.mask;
+
+         if (A)
+            x = fu1(&d.FU[0], x);
+         if (B)
+            y = fu2(&d.FU[1], y);
+
+         d.Mix1 = _mm256_add_ps(d.Mix1, d.dMix1);
+         d.Mix2 = _mm256_add_ps(d.Mix2, d.dMix2);
+         x = _mm256_add_ps(_mm256_mul_ps(x, d.Mix1), _mm256_mul_ps(y, d.Mix2));
+
+         if (WS)
+         {
+            d.wsLPF = _mm256_mul_ps(hb_c, _mm256_add_ps(d.wsLPF, _mm256_and_ps(mask, x)));
+            d.Drive = _mm256_add_ps(d.Drive, d.dDrive);
+            x = ws(d.wsLPF, d.Drive);
+         }
+
+         d.Gain = _mm256_add_ps(d.Gain, d.dGain);
+         __m256 out = _mm256_and_ps(mask, _mm256_mul_ps(x, d.Gain));
+         d.FBlineL = out;
+         // output stage
+         MWriteOutputs8(out)
+      }
+      break;
+   case fc_dual2:
+      for (int k = 0; k < blockSize; k++)
+      {
+         d.FB = _mm256_add_ps(d.FB, d.dFB);
+         __m256 fb = _mm256_mul_ps(d.FB, d.FBlineL);
+         fb = softclip8_ps(fb);
+         __m256 x = _mm256_add_ps(lanes8(lo.DL[k], hi.DL[k]), fb);
+         __m256 y = _mm256_add_ps(lanes8(lo.DR[k], hi.DR[k]), fb);
+         __m256 mask = d.mask;
+
+         if (A)
+            x = fu1(&d.FU[0], x);
+         if (WS)
+         {
+            d.wsLPF = _mm256_mul_ps(hb_c, _mm256_add_ps(d.wsLPF, _mm256_and_ps(mask, x)));
+            d.Drive = _mm256_add_ps(d.Drive, d.dDrive);
+            x = ws(d.wsLPF, d.Drive);
+         }
+
+         if (B)
+            y = fu2(&d.FU[1], y);
+
+         d.Mix1 = _mm256_add_ps(d.Mix1, d.dMix1);
+         d.Mix2 = _mm256_add_ps(d.Mix2, d.dMix2);
+         x = _mm256_add_ps(_mm256_mul_ps(x, d.Mix1), _mm256_mul_ps(y, d.Mix2));
+
+         d.Gain = _mm256_add_ps(d.Gain, d.dGain);
+         __m256 out = _mm256_and_ps(mask, _mm256_mul_ps(x, d.Gain));
+         d.FBlineL = out;
+         // output stage
+         MWriteOutputs8(out)
+      }
+      break;
+   case fc_ring:
+      for (int k = 0; k < blockSize; k++)
+      {
+         d.FB = _mm256_add_ps(d.FB, d.dFB);
+         __m256 fb = _mm256_mul_ps(d.FB, d.FBlineL);
+         fb = softclip8_ps(fb);
+         __m256 x = _mm256_add_ps(lanes8(lo.DL[k], hi.DL[k]), fb);
+         __m256 y = _mm256_add_ps(lanes8(lo.DR[k], hi.DR[k]), fb);
+         __m256 mask = d.mask;
+
+         if (A)
+            x = fu1(&d.FU[0], x);
+         if (B)
+            y = fu2(&d.FU[1], y);
+
+         d.Mix1 = _mm256_add_ps(d.Mix1, d.dMix1);
+         d.Mix2 = _mm256_add_ps(d.Mix2, d.dMix2);
+
+         x = _mm256_mul_ps(
+             _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(one, d.Mix1), y), _mm256_mul_ps(x, d.Mix1)),
+             _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(one, d.Mix2), x), _mm256_mul_ps(y, d.Mix2)));
+
+         if (WS)
+         {
+            d.wsLPF = _mm256_mul_ps(hb_c, _mm256_add_ps(d.wsLPF, x));
+            d.Drive = _mm256_add_ps(d.Drive, d.dDrive);
+            x = ws(_mm256_and_ps(mask,d.wsLPF), d.Drive);
+         }
+
+         d.Gain = _mm256_add_ps(d.Gain, d.dGain);
+         __m256 out = _mm256_and_ps(mask, _mm256_mul_ps(x, d.Gain));
+         d.FBlineL = out;
+         // output stage
+         MWriteOutputs8(out)
+      }
+      break;
+   case fc_stereo:
+      for (int k = 0; k < blockSize; k++)
+      {
+         d.FB = _mm256_add_ps(d.FB, d.dFB);
+         __m256 fb = _mm256_mul_ps(d.FB, d.FBlineL);
+         fb = softclip8_ps(fb);
+         __m256 x = _mm256_add_ps(lanes8(lo.DL[k], hi.DL[k]), fb);
+         __m256 y = _mm256_add_ps(lanes8(lo.DR[k], hi.DR[k]), fb);
+         __m256 mask = d.mask;
+
+         if (A)
+            x = fu1(&d.FU[0], x);
+         if (B)
+            y = fu2(&d.FU[1], y);
+
+         if (WS)
+         {
+            d.Drive = _mm256_add_ps(d.Drive, d.dDrive);
+            x = ws(_mm256_and_ps(mask, x), d.Drive);
+            y = ws(_mm256_and_ps(mask,y), d.Drive);
+         }
+
+         d.Mix1 = _mm256_add_ps(d.Mix1, d.dMix1);
+         d.Mix2 = _mm256_add_ps(d.Mix2, d.dMix2);
+         x = _mm256_mul_ps(x, d.Mix1);
+         y = _mm256_mul_ps(y, d.Mix2);
+
+         d.Gain = _mm256_add_ps(d.Gain, d.dGain);
+         x = _mm256_and_ps(mask, _mm256_mul_ps(x, d.Gain));
+         y = _mm256_and_ps(mask, _mm256_mul_ps(y, d.Gain));
+         d.FBlineL = _mm256_add_ps(x, y);
+
+         // output stage
+         MWriteOutputsDual8(x, y)
+      }
+      break;
+   case fc_wide:
+      for (int k = 0; k < blockSize; k++)
+      {
+         d.FB = _mm256_add_ps(d.FB, d.dFB);
+         __m256 fbL = _mm256_mul_ps(d.FB, d.FBlineL);
+         __m256 fbR = _mm256_mul_ps(d.FB, d.FBlineR);
+         __m256 xin = _mm256_add_ps(lanes8(lo.DL[k], hi.DL[k]), softclip8_ps(fbL));
+         __m256 yin = _mm256_add_ps(lanes8(lo.DR[k], hi.DR[k]), softclip8_ps(fbR));
+         __m256 x = xin;
+         __m256 y = yin;
+
+         __m256 mask = d.mask;
+
+         if (A)
+         {
+            x = fu1(&d.FU[0], x);
+            y = fu1(&d.FU[2], y);
+         }
+
+         if (WS)
+         {
+            d.Drive = _mm256_add_ps(d.Drive, d.dDrive);
+            x = ws(_mm256_and_ps(mask, x), d.Drive);
+            y = ws(_mm256_and_ps(mask, y), d.Drive);
+         }
+
+         if (A || WS)
+         {
+            d.Mix1 = _mm256_add_ps(d.Mix1, d.dMix1);
+            __m256 t = _mm256_sub_ps(one, d.Mix1);
+            x = _mm256_add_ps(_mm256_mul_ps(xin, t), _mm256_mul_ps(x, d.Mix1));
+            y = _mm256_add_ps(_mm256_mul_ps(yin, t), _mm256_mul_ps(y, d.Mix1));
+         }
+
+         if (B)
+         {
+            __m256 z = fu2(&d.FU[1], x);
+            __m256 w = fu2(&d.FU[3], y);
+
+            d.Mix2 = _mm256_add_ps(d.Mix2, d.dMix2);
+            __m256 t = _mm256_sub_ps(one, d.Mix2);
+            x = _mm256_add_ps(_mm256_mul_ps(x, t), _mm256_mul_ps(z, d.Mix2));
+            y = _mm256_add_ps(_mm256_mul_ps(y, t), _mm256_mul_ps(w, d.Mix2));
+         }
+
+         d.Gain = _mm256_add_ps(d.Gain, d.dGain);
+         x = _mm256_and_ps(mask, _mm256_mul_ps(x, d.Gain));
+         y = _mm256_and_ps(mask, _mm256_mul_ps(y, d.Gain));
+         d.FBlineL = x;
+         d.FBlineR = y;
+
+         // output stage
+         MWriteOutputsDual8(x, y)
+      }
+      break;
+   }
+
+#define M(f)                                                                                       \
+   lo.f = lo4(d.f);                                                                                \
+   hi.f = hi4(d.f);
+   OCT_CHAIN_FIELDS(M)
+#undef M
+   for (int u = 0; u < units; u++)
+      storeUnit(d.FU[u], lo.FU[u], hi.FU[u]);
+
+   _mm256_zeroupper();
+}
+
+template <int config> FBOFPtr GetFBOctPointer2(bool A, bool WS, bool B)
+{
+   if (A)
+   {
+      if (B)
+         return WS ? ProcessFBOct<config, 1, 1, 1> : ProcessFBOct<config, 1, 0, 1>;
+      return WS ? ProcessFBOct<config, 1, 1, 0> : ProcessFBOct<config, 1, 0, 0>;
+   }
+   if (B)
+      return WS ? ProcessFBOct<config, 0, 1, 1> : ProcessFBOct<config, 0, 0, 1>;
+   return WS ? ProcessFBOct<config, 0, 1, 0> : ProcessFBOct<config, 0, 0, 0>;
+}
+
+FBOFPtr GetFBOctPointer(int config, const fbq_global& quad, fbo_global& g)
+{
+   g.FU1 = g.FU2 = g.WS = -1;
+   g.BlockSize = quad.BlockSize;
+   for (int i = 0; i < n_oct_filter_units; i++)
+   {
+      if (quad.FU1ptr == filterUnits[i].quad)
+         g.FU1 = i;
+      if (quad.FU2ptr == filterUnits[i].quad)
+         g.FU2 = i;
+   }
+   for (int i = 0; i < n_oct_waveshapers; i++)
+   {
+      if (quad.WSptr == waveshaperUnits[i].quad)
+         g.WS = i;
+   }
+
+   if ((quad.FU1ptr && g.FU1 < 0) || (quad.FU2ptr && g.FU2 < 0) || (quad.WSptr && g.WS < 0))
+      return nullptr;
+
+   bool A = quad.FU1ptr != 0, WS = quad.WSptr != 0, B = quad.FU2ptr != 0;
+   switch (config)
+   {
+   case fc_serial1:
+      return GetFBOctPointer2<fc_serial1>(A, WS, B);
+   case fc_serial2:
+      return GetFBOctPointer2<fc_serial2>(A, WS, B);
+   case fc_serial3:
+      return GetFBOctPointer2<fc_serial3>(A, WS, B);
+   case fc_dual1:
+      return GetFBOctPointer2<fc_dual1>(A, WS, B);
+   case fc_dual2:
+      return GetFBOctPointer2<fc_dual2>(A, WS, B);
+   case fc_ring:
+      return GetFBOctPointer2<fc_ring>(A, WS, B);
+   case fc_stereo:
+      return GetFBOctPointer2<fc_stereo>(A, WS, B);
+   case fc_wide:
+      return GetFBOctPointer2<fc_wide>(A, WS, B);
+   }
+   return nullptr;
+}
+
+#else
+
+FBOFPtr GetFBOctPointer(int config, const fbq_global& quad, fbo_global& g)
+{
+   return nullptr;
+}
+
+#endif
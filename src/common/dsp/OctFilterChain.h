@@ -0,0 +1,55 @@
+/*
+** Surge Synthesizer is Free and Open Source Software
+**
+** Surge is made available under the Gnu General Public License, v3.0
+** https://www.gnu.org/licenses/gpl-3.0.en.html
+**
+** Copyright 2004-2020 by various individuals as described by the Git transaction log
+**
+** All source at: https://github.com/surge-synthesizer/surge.git
+**
+** Surge was a commercial product from 2004-2018, with Copyright and ownership
+** in that period held by Claes Johanson at Vember Audio. Claes made Surge
+** open source in September 2018.
+*/
+
+#pragma once
+
+#include "QuadFilterChain.h"
+
+/*
+** OctFilterChain runs two QuadFilterChainStates through the filter block at once with AVX2, so
+** eight voices share each instruction instead of four.
+**
+** Voices and the FilterCoefficientMaker still fill QuadFilterChainStates as before; the 8 lane
+** chain loads a pair of them at the start of the block and stores the registers and
+** interpolated values back at the end, so a scene can move between the two paths from one
+** block to the next.
+**
+** Only some units have 8 lane versions: the state variable and IIR filters (the lowpass,
+** highpass and bandpass types) and the clip, digi, tanh, sine and asym waveshapers.
+** GetFBOctPointer returns nullptr for any other combination and the scene stays on
+** the quad path.
+**
+** Check OctFilterChainSupported() before calling anything GetFBOctPointer returns; it asks the
+** CPU for AVX2 at runtime. On non-x86 builds it is false and GetFBOctPointer always returns
+** nullptr.
+*/
+
+#if !defined(ARM_NEON) &&                                                                         \
+    (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86))
+#define SURGE_OCT_FILTER_CHAIN 1
+#else
+#define SURGE_OCT_FILTER_CHAIN 0
+#endif
+
+struct fbo_global
+{
+   int FU1, FU2, WS; // indices into the 8 lane unit tables
+   int BlockSize;     // copied from the fbq_global
+};
+
+typedef void (*FBOFPtr)(QuadFilterChainState&, QuadFilterChainState&, fbo_global&, float*, float*);
+
+bool OctFilterChainSupported();
+FBOFPtr GetFBOctPointer(int config, const fbq_global& quad, fbo_global& g);
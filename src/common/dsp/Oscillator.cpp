@@ -29,38 +29,50 @@ using namespace std;
 #include "WavetableOscillator.h"
 #include "WindowOscillator.h"
 
-Oscillator*
-spawn_osc(int osctype, SurgeStorage* storage, OscillatorStorage* oscdata, pdata* localcopy)
+template <typename T>
+static Oscillator*
+make_osc(unsigned char* onto, SurgeStorage* storage, OscillatorStorage* oscdata, pdata* localcopy)
+{
+   static_assert(sizeof(T) <= oscillator_buffer_size, "Increase oscillator_buffer_size");
+   static_assert(alignof(T) <= 16, "Oscillator buffers are only 16 byte aligned");
+   if (onto)
+      return new (onto) T(storage, oscdata, localcopy);
+   return new T(storage, oscdata, localcopy);
+}
+
+Oscillator* spawn_osc(int osctype,
+                      SurgeStorage* storage,
+                      OscillatorStorage* oscdata,
+                      pdata* localcopy,
+                      unsigned char* onto)
 {
-   Oscillator* osc = 0;
    switch (osctype)
    {
    case ot_classic:
-      return new SurgeSuperOscillator(storage, oscdata, localcopy);
+      return make_osc<SurgeSuperOscillator>(onto, storage, oscdata, localcopy);
    case ot_wavetable:
-      return new WavetableOscillator(storage, oscdata, localcopy);
+      return make_osc<WavetableOscillator>(onto, storage, oscdata, localcopy);
    case ot_window:
    {
       // In the event we are misconfigured, window oscillator will segfault. If you still play
       // after clicking through 100 warnings, let's just give you a sine
       if( storage && storage->WindowWT.size == 0 )
-         return new SineOscillator( storage, oscdata, localcopy );
+         return make_osc<SineOscillator>(onto, storage, oscdata, localcopy);
  
-      return new WindowOscillator(storage, oscdata, localcopy);
+      return make_osc<WindowOscillator>(onto, storage, oscdata, localcopy);
    }
    case ot_shnoise:
-      return new SampleAndHoldOscillator(storage, oscdata, localcopy);
+      return make_osc<SampleAndHoldOscillator>(onto, storage, oscdata, localcopy);
    case ot_audioinput:
-      return new AudioInputOscillator(storage, oscdata, localcopy);
+      return make_osc<AudioInputOscillator>(onto, storage, oscdata, localcopy);
    case ot_FM3:
-      return new FM3Oscillator(storage, oscdata, localcopy);
+      return make_osc<FM3Oscillator>(onto, storage, oscdata, localcopy);
    case ot_FM2:
-      return new FM2Oscillator(storage, oscdata, localcopy);
+      return make_osc<FM2Oscillator>(onto, storage, oscdata, localcopy);
    case ot_sine:
    default:
-      return new SineOscillator(storage, oscdata, localcopy);
+      return make_osc<SineOscillator>(onto, storage, oscdata, localcopy);
    }
-   return osc;
 }
 
 Oscillator::Oscillator(SurgeStorage* storage, OscillatorStorage* oscdata, pdata* localcopy)
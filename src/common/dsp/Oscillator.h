@@ -8,5 +8,19 @@
 #include "OscillatorBase.h"
 
 
-Oscillator*
-spawn_osc(int osctype, SurgeStorage* storage, OscillatorStorage* oscdata, pdata* localcopy);
+/*
+** Every oscillator fits in oscillator_buffer_size bytes (Oscillator.cpp static_asserts this), so
+** a voice can keep a buffer per oscillator slot and have spawn_osc construct into it with no heap
+** allocation. Such an oscillator must be destroyed with an explicit ~Oscillator() call, not
+** deleted. Without a buffer (the GUI, patch setup) spawn_osc returns a heap allocated oscillator
+** as before. The oscillators hold a few blocks of output, so the buffer is sized for
+** BLOCK_SIZE_MAX whatever block size the synth runs at.
+*/
+const int oscillator_buffer_size =
+    (192 * BLOCK_SIZE_MAX > 16 * 1024) ? 192 * BLOCK_SIZE_MAX : 16 * 1024;
+
+Oscillator* spawn_osc(int osctype,
+                      SurgeStorage* storage,
+                      OscillatorStorage* oscdata,
+                      pdata* localcopy,
+                      unsigned char* onto = nullptr);
@@ -23,8 +23,8 @@ public:
    // The data blocks processed by the SIMD instructions (e.g. SSE2), which must
    // always be before any other variables in the class, in order to be properly
    // aligned to 16 bytes.
-   float output alignas(16)[BLOCK_SIZE_OS];
-   float outputR alignas(16)[BLOCK_SIZE_OS];
+   float output alignas(16)[BLOCK_SIZE_OS_MAX];
+   float outputR alignas(16)[BLOCK_SIZE_OS_MAX];
 
    Oscillator(SurgeStorage* storage, OscillatorStorage* oscdata, pdata* localcopy);
    virtual ~Oscillator();
@@ -35,6 +35,27 @@ public:
    virtual void process_block(
        float pitch, float drift = 0.f, bool stereo = false, bool FM = false, float FMdepth = 0.f)
    {}
+   /*
+   ** Called by the voice in place of process_block for a block whose output nobody will hear
+   ** (see SurgeVoice::update_osc_activity). It has to leave the oscillator where process_block
+   ** would have, so that when the oscillator is heard again it carries on in phase. Oscillators
+   ** whose state is cheap to move along do that without rendering; the rest render the block and
+   ** ignore it. output is left undefined.
+   */
+   virtual void skip_block(
+       float pitch, float drift = 0.f, bool stereo = false, bool FM = false, float FMdepth = 0.f)
+   {
+      process_block(pitch, drift, stereo, FM, FMdepth);
+   }
+   /*
+   ** Whether skip_block needs the FM input. Where FM changes the rate the phase depends on the
+   ** modulator, which then has to keep running; where it only offsets the phase (sine, FM2 and
+   ** FM3) the modulator can be skipped too.
+   */
+   virtual bool skip_needs_fm()
+   {
+      return true;
+   }
    virtual void assign_fm(float* master_osc)
    {
       this->master_osc = master_osc;
@@ -63,12 +84,49 @@ protected:
    int ticker;
 };
 
+/*
+** An impulse convolute has worked out but not yet added to the oscillator buffer: the windowed
+** sinc at sinctable offset m, interpolated by lipol, delay samples into the block, with gain gL
+** (and gR when stereo).
+*/
+struct BlitImpulse
+{
+   int delay;
+   unsigned int m;
+   float lipol, gL, gR;
+};
+
 class AbstractBlitOscillator : public Oscillator
 {
 public:
    AbstractBlitOscillator(SurgeStorage* storage, OscillatorStorage* oscdata, pdata* localcopy);
 
+   static constexpr int max_pending_impulses = 512;
+
 protected:
+   /*
+   ** The wavetable oscillator's convolute queues its impulse with queue_impulse rather than
+   ** adding it to oscbuffer itself (the classic one still adds its own, as batching them
+   ** doesn't pay there). With batch_impulses set, and more impulses queued than there are
+   ** samples in the block, flush_impulses counting-sorts the queue by delay and sums each
+   ** delay's kernels in registers (with AVX where the CPU has it) before touching the buffer
+   ** once. Otherwise it adds them one at a time in the order they came, which is exactly what
+   ** convolute used to do. render_block points pending at a buffer on its stack, flushes
+   ** before reading oscbuffer and then clears pending so nothing can use it once the buffer
+   ** is gone; queue_impulse flushes if it fills.
+   */
+   inline void queue_impulse(unsigned int delay, unsigned int m, unsigned int lipolui16, float g,
+                             float gR, bool stereo)
+   {
+      if (n_pending == max_pending_impulses)
+         flush_impulses(stereo);
+      pending[n_pending++] = {(int)delay, m, (float)lipolui16, g, gR};
+   }
+   void flush_impulses(bool stereo);
+   BlitImpulse* pending = nullptr;
+   int n_pending = 0;
+   bool batch_impulses = false;
+
    float oscbuffer alignas(16)[OB_LENGTH + FIRipol_N];
    float oscbufferR alignas(16)[OB_LENGTH + FIRipol_N];
    float dcbuffer alignas(16)[OB_LENGTH + FIRipol_N];
@@ -1,15 +1,35 @@
 #include "QuadFilterChain.h"
+#include "OctFilterChain.h"
 #include "SurgeStorage.h"
 #include <vt_dsp/basic_dsp.h>
 #include <vt_dsp/portable_intrinsics.h>
+#if defined(_MSC_VER) && SURGE_OCT_FILTER_CHAIN
+#include <intrin.h>
+#endif
+
+/*
+** Sum the lanes into the outputs. The split chains send the lanes in g.SplitMask to g.SplitL and
+** g.SplitR instead, for a quad whose voices come from two scenes.
+*/
+#define MWriteLanes(outL, outR)                                                                    \
+   if (Split)                                                                                      \
+   {                                                                                               \
+      _mm_store_ss(&g.SplitL[k], _mm_add_ss(_mm_load_ss(&g.SplitL[k]),                            \
+                                            sum_ps_to_ss(_mm_and_ps(g.SplitMask, outL))));        \
+      _mm_store_ss(&g.SplitR[k], _mm_add_ss(_mm_load_ss(&g.SplitR[k]),                            \
+                                            sum_ps_to_ss(_mm_and_ps(g.SplitMask, outR))));        \
+      outL = _mm_andnot_ps(g.SplitMask, outL);                                                     \
+      outR = _mm_andnot_ps(g.SplitMask, outR);                                                     \
+   }                                                                                               \
+   _mm_store_ss(&OutL[k], _mm_add_ss(_mm_load_ss(&OutL[k]), sum_ps_to_ss(outL)));                  \
+   _mm_store_ss(&OutR[k], _mm_add_ss(_mm_load_ss(&OutR[k]), sum_ps_to_ss(outR)));
 
 #define MWriteOutputs(x)                                                                           \
    d.OutL = _mm_add_ps(d.OutL, d.dOutL);                                                           \
    d.OutR = _mm_add_ps(d.OutR, d.dOutR);                                                           \
    __m128 outL = _mm_mul_ps(x, d.OutL);                                                            \
    __m128 outR = _mm_mul_ps(x, d.OutR);                                                            \
-   _mm_store_ss(&OutL[k], _mm_add_ss(_mm_load_ss(&OutL[k]), sum_ps_to_ss(outL)));                  \
-   _mm_store_ss(&OutR[k], _mm_add_ss(_mm_load_ss(&OutR[k]), sum_ps_to_ss(outR)));
+   MWriteLanes(outL, outR)
 
 #define MWriteOutputsDual(x, y)                                                                    \
    d.OutL = _mm_add_ps(d.OutL, d.dOutL);                                                           \
@@ -18,8 +38,7 @@
    d.Out2R = _mm_add_ps(d.Out2R, d.dOut2R);                                                        \
    __m128 outL = vMAdd(x, d.OutL, vMul(y, d.Out2L));                                               \
    __m128 outR = vMAdd(x, d.OutR, vMul(y, d.Out2R));                                               \
-   _mm_store_ss(&OutL[k], _mm_add_ss(_mm_load_ss(&OutL[k]), sum_ps_to_ss(outL)));                  \
-   _mm_store_ss(&OutR[k], _mm_add_ss(_mm_load_ss(&OutR[k]), sum_ps_to_ss(outR)));
+   MWriteLanes(outL, outR)
 
 #if 0 // DEBUG
 #define AssertReasonableAudioFloat(x) assert(x<32.f && x> - 32.f);
@@ -27,9 +46,10 @@
 #define AssertReasonableAudioFloat(x)
 #endif
 
-template <int config, bool A, bool WS, bool B>
+template <int config, bool A, bool WS, bool B, bool Split>
 void ProcessFBQuad(QuadFilterChainState& d, fbq_global& g, float* OutL, float* OutR)
 {
+   const int blockSize = g.BlockSize;
    const __m128 hb_c = _mm_set1_ps(0.5f); // If this is changed from 0.5, make sure to change
                                           // this in the code because it is assumed to be half
    const __m128 one = _mm_set1_ps(1.0f);
@@ -37,7 +57,7 @@ void ProcessFBQuad(QuadFilterChainState& d, fbq_global& g, float* OutL, float* O
    switch (config)
    {
    case fc_serial1: // no feedback at all  (saves CPU)
-      for (int k = 0; k < BLOCK_SIZE_OS; k++)
+      for (int k = 0; k < blockSize; k++)
       {
          __m128 input = d.DL[k];
          __m128 x = input, y = d.DR[k];
@@ -73,7 +93,7 @@ void ProcessFBQuad(QuadFilterChainState& d, fbq_global& g, float* OutL, float* O
       }
       break;
    case fc_serial2:
-      for (int k = 0; k < BLOCK_SIZE_OS; k++)
+      for (int k = 0; k < blockSize; k++)
       {
          d.FB = _mm_add_ps(d.FB, d.dFB);
          __m128 input = vMul(d.FB, d.FBlineL);
@@ -113,7 +133,7 @@ void ProcessFBQuad(QuadFilterChainState& d, fbq_global& g, float* OutL, float* O
       break;
    case fc_serial3: // filter 2 is only heard in the feedback path, good for physical modelling with
                     // comb as f2
-      for (int k = 0; k < BLOCK_SIZE_OS; k++)
+      for (int k = 0; k < blockSize; k++)
       {
          d.FB = _mm_add_ps(d.FB, d.dFB);
          __m128 input = vMul(d.FB, d.FBlineL);
@@ -154,7 +174,7 @@ void ProcessFBQuad(QuadFilterChainState& d, fbq_global& g, float* OutL, float* O
       }
       break;
    case fc_dual1:
-      for (int k = 0; k < BLOCK_SIZE_OS; k++)
+      for (int k = 0; k < blockSize; k++)
       {
          d.FB = _mm_add_ps(d.FB, d.dFB);
          __m128 fb = _mm_mul_ps(d.FB, d.FBlineL);
@@ -187,7 +207,7 @@ void ProcessFBQuad(QuadFilterChainState& d, fbq_global& g, float* OutL, float* O
       }
       break;
    case fc_dual2:
-      for (int k = 0; k < BLOCK_SIZE_OS; k++)
+      for (int k = 0; k < blockSize; k++)
       {
          d.FB = _mm_add_ps(d.FB, d.dFB);
          __m128 fb = _mm_mul_ps(d.FB, d.FBlineL);
@@ -220,7 +240,7 @@ void ProcessFBQuad(QuadFilterChainState& d, fbq_global& g, float* OutL, float* O
       }
       break;
    case fc_ring:
-      for (int k = 0; k < BLOCK_SIZE_OS; k++)
+      for (int k = 0; k < blockSize; k++)
       {
          d.FB = _mm_add_ps(d.FB, d.dFB);
          __m128 fb = _mm_mul_ps(d.FB, d.FBlineL);
@@ -255,7 +275,7 @@ void ProcessFBQuad(QuadFilterChainState& d, fbq_global& g, float* OutL, float* O
       }
       break;
    case fc_stereo:
-      for (int k = 0; k < BLOCK_SIZE_OS; k++)
+      for (int k = 0; k < blockSize; k++)
       {
          d.FB = _mm_add_ps(d.FB, d.dFB);
          __m128 fb = _mm_mul_ps(d.FB, d.FBlineL);
@@ -292,7 +312,7 @@ void ProcessFBQuad(QuadFilterChainState& d, fbq_global& g, float* OutL, float* O
       }
       break;
    case fc_wide:
-      for (int k = 0; k < BLOCK_SIZE_OS; k++)
+      for (int k = 0; k < blockSize; k++)
       {
          d.FB = _mm_add_ps(d.FB, d.dFB);
          __m128 fbL = _mm_mul_ps(d.FB, d.FBlineL);
@@ -350,23 +370,23 @@ void ProcessFBQuad(QuadFilterChainState& d, fbq_global& g, float* OutL, float* O
    }
 }
 
-template <int config> FBQFPtr GetFBQPointer2(bool A, bool WS, bool B)
+template <int config, bool Split> FBQFPtr GetFBQPointer2(bool A, bool WS, bool B)
 {
    if (A)
    {
       if (B)
       {
          if (WS)
-            return ProcessFBQuad<config, 1, 1, 1>;
+            return ProcessFBQuad<config, 1, 1, 1, Split>;
          else
-            return ProcessFBQuad<config, 1, 0, 1>;
+            return ProcessFBQuad<config, 1, 0, 1, Split>;
       }
       else
       {
          if (WS)
-            return ProcessFBQuad<config, 1, 1, 0>;
+            return ProcessFBQuad<config, 1, 1, 0, Split>;
          else
-            return ProcessFBQuad<config, 1, 0, 0>;
+            return ProcessFBQuad<config, 1, 0, 0, Split>;
       }
    }
    else
@@ -374,41 +394,46 @@ template <int config> FBQFPtr GetFBQPointer2(bool A, bool WS, bool B)
       if (B)
       {
          if (WS)
-            return ProcessFBQuad<config, 0, 1, 1>;
+            return ProcessFBQuad<config, 0, 1, 1, Split>;
          else
-            return ProcessFBQuad<config, 0, 0, 1>;
+            return ProcessFBQuad<config, 0, 0, 1, Split>;
       }
       else
       {
          if (WS)
-            return ProcessFBQuad<config, 0, 1, 0>;
+            return ProcessFBQuad<config, 0, 1, 0, Split>;
          else
-            return ProcessFBQuad<config, 0, 0, 0>;
+            return ProcessFBQuad<config, 0, 0, 0, Split>;
       }
    }
    return 0;
 }
 
-FBQFPtr GetFBQPointer(int config, bool A, bool WS, bool B)
+template <int config> FBQFPtr GetFBQPointer1(bool A, bool WS, bool B, bool split)
+{
+   return split ? GetFBQPointer2<config, true>(A, WS, B) : GetFBQPointer2<config, false>(A, WS, B);
+}
+
+FBQFPtr GetFBQPointer(int config, bool A, bool WS, bool B, bool split)
 {
    switch (config)
    {
    case fc_serial1:
-      return GetFBQPointer2<fc_serial1>(A, WS, B);
+      return GetFBQPointer1<fc_serial1>(A, WS, B, split);
    case fc_serial2:
-      return GetFBQPointer2<fc_serial2>(A, WS, B);
+      return GetFBQPointer1<fc_serial2>(A, WS, B, split);
    case fc_serial3:
-      return GetFBQPointer2<fc_serial3>(A, WS, B);
+      return GetFBQPointer1<fc_serial3>(A, WS, B, split);
    case fc_dual1:
-      return GetFBQPointer2<fc_dual1>(A, WS, B);
+      return GetFBQPointer1<fc_dual1>(A, WS, B, split);
    case fc_dual2:
-      return GetFBQPointer2<fc_dual2>(A, WS, B);
+      return GetFBQPointer1<fc_dual2>(A, WS, B, split);
    case fc_ring:
-      return GetFBQPointer2<fc_ring>(A, WS, B);
+      return GetFBQPointer1<fc_ring>(A, WS, B, split);
    case fc_stereo:
-      return GetFBQPointer2<fc_stereo>(A, WS, B);
+      return GetFBQPointer1<fc_stereo>(A, WS, B, split);
    case fc_wide:
-      return GetFBQPointer2<fc_wide>(A, WS, B);
+      return GetFBQPointer1<fc_wide>(A, WS, B, split);
    }
    return 0;
 }
@@ -430,7 +455,7 @@ void InitQuadFilterChainStateToZero(QuadFilterChainState *Q)
     Q->FBlineL = _mm_setzero_ps();
     Q->FBlineR = _mm_setzero_ps();
     
-    for(auto i=0; i<BLOCK_SIZE_OS; ++i)
+    for(auto i=0; i<BLOCK_SIZE_OS_MAX; ++i)
     {
         Q->DL[i] = _mm_setzero_ps();
         Q->DR[i] = _mm_setzero_ps();
@@ -445,3 +470,23 @@ void InitQuadFilterChainStateToZero(QuadFilterChainState *Q)
     Q->dOut2L = _mm_setzero_ps();
     Q->dOut2R = _mm_setzero_ps();
 }
+
+bool OctFilterChainSupported()
+{
+#if !SURGE_OCT_FILTER_CHAIN
+   return false;
+#elif defined(_MSC_VER)
+   int info[4];
+   __cpuid(info, 0);
+   if (info[0] < 7)
+      return false;
+   __cpuid(info, 1);
+   bool osxsave = (info[2] & (1 << 27)) != 0, avx = (info[2] & (1 << 28)) != 0;
+   if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) // the OS saves the ymm registers
+      return false;
+   __cpuidex(info, 7, 0);
+   return (info[1] & (1 << 5)) != 0;
+#else
+   return __builtin_cpu_supports("avx2");
+#endif
+}
@@ -105,7 +105,7 @@ struct QuadFilterChainState
 
    __m128 wsLPF, FBlineL, FBlineR;
 
-   __m128 DL[BLOCK_SIZE_OS], DR[BLOCK_SIZE_OS]; // wavedata
+   __m128 DL[BLOCK_SIZE_OS_MAX], DR[BLOCK_SIZE_OS_MAX]; // wavedata
 
    __m128 OutL, OutR, dOutL, dOutR;
    __m128 Out2L, Out2R, dOut2L, dOut2R; // fc_stereo only
@@ -123,8 +123,20 @@ struct fbq_global
 {
    FilterUnitQFPtr FU1ptr, FU2ptr;
    WaveshaperQFPtr WSptr;
+
+   // Only read by the split chains: the lanes set in SplitMask go to SplitL and SplitR
+   __m128 SplitMask;
+   float *SplitL, *SplitR;
+
+   // Samples per block the chain runs for, the synth's oversampled block size
+   int BlockSize;
 };
 
 typedef void (*FBQFPtr)(QuadFilterChainState&, fbq_global&, float*, float*);
 
-FBQFPtr GetFBQPointer(int config, bool A, bool WS, bool B);
+/*
+** With split set, the chain returned sums the lanes in g.SplitMask into g.SplitL and g.SplitR
+** and the rest into the outputs it is handed, so one quad can carry the voices of two scenes
+** whose filter blocks are set up the same (see FilterLaneScheduler.h).
+*/
+FBQFPtr GetFBQPointer(int config, bool A, bool WS, bool B, bool split = false);
@@ -712,10 +712,11 @@ __m128 ASYM_SSE2(__m128 in, __m128 drive)
    return x;
 }
 
-FilterUnitQFPtr GetQFPtrFilterUnit(int type, int subtype)
+FilterUnitQFPtr GetQFPtrFilterUnit(int type, int subtype, int quality)
 {
    // Force compiler to error out if I miss one
    fu_type fType = (fu_type)type;
+   bool economy = (quality == FILTER_QUALITY_ECONOMY);
 
    switch (fType)
    {
@@ -802,10 +803,10 @@ FilterUnitQFPtr GetQFPtrFilterUnit(int type, int subtype)
       {
       case 0:
       case 1:
-         return VintageLadder::RK::process;
+         return economy ? VintageLadder::RK::process_economy : VintageLadder::RK::process;
       case 2:
       case 3:
-         return VintageLadder::Huov::process;
+         return economy ? VintageLadder::Huov::process_economy : VintageLadder::Huov::process;
       }
       break;
    case fut_obxd_2pole_lp:
@@ -816,16 +817,16 @@ FilterUnitQFPtr GetQFPtrFilterUnit(int type, int subtype)
       return ObxdFilter::process_2_pole;
       break;
    case fut_obxd_4pole:
-      return ObxdFilter::process_4_pole;
+      return economy ? ObxdFilter::process_4_pole_economy : ObxdFilter::process_4_pole;
       break;
    case fut_k35_lp:
-      return K35Filter::process_lp;
+      return economy ? K35Filter::process_lp_economy : K35Filter::process_lp;
       break;
    case fut_k35_hp:
-      return K35Filter::process_hp;
+      return economy ? K35Filter::process_hp_economy : K35Filter::process_hp;
       break;
    case fut_diode:
-      return DiodeLadderFilter::process;
+      return economy ? DiodeLadderFilter::process_economy : DiodeLadderFilter::process;
       break;
    case fut_cutoffwarp_lp:
    case fut_cutoffwarp_hp:
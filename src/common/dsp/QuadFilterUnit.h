@@ -17,5 +17,9 @@ struct QuadFilterUnitState
 typedef __m128 (*FilterUnitQFPtr)(QuadFilterUnitState* __restrict, __m128 in);
 typedef __m128 (*WaveshaperQFPtr)(__m128 in, __m128 drive);
 
-FilterUnitQFPtr GetQFPtrFilterUnit(int type, int subtype);
+/*
+** quality is a FilterQuality. FILTER_QUALITY_ECONOMY picks the cheaper kernels of the nonlinear
+** filters which have them; the two kernels share a state layout, so it can change mid-note.
+*/
+FilterUnitQFPtr GetQFPtrFilterUnit(int type, int subtype, int quality = 0);
 WaveshaperQFPtr GetQFPtrWaveshaper(int type);
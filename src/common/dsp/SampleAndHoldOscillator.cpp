@@ -15,6 +15,7 @@
 
 #include "SampleAndHoldOscillator.h"
 #include "DspUtilities.h"
+#include "util/SceneRandom.h"
 
 using namespace std;
 
@@ -39,6 +40,9 @@ SampleAndHoldOscillator::~SampleAndHoldOscillator()
 void SampleAndHoldOscillator::init(float pitch, bool is_display)
 {
    assert(storage);
+   li_hpf.set_blocksize(storage->blockSizeOS);
+   li_DC.set_blocksize(storage->blockSizeOS);
+   li_integratormult.set_blocksize(storage->blockSizeOS);
    first_run = true;
    osc_out = _mm_set1_ps(0.f);
    osc_outR = _mm_set1_ps(0.f);
@@ -65,17 +69,14 @@ void SampleAndHoldOscillator::init(float pitch, bool is_display)
    {
       n_unison = 1;
 
-      auto gen = std::minstd_rand(2);
-      std::uniform_real_distribution<float> distro(-1.f, 1.f);
-      urng = std::bind(distro, gen);
+      urngGen.seed(2);
    }
    else
    {
-      std::random_device rd;
-      auto gen = std::minstd_rand(rd());
-      std::uniform_real_distribution<float> distro(-1.f, 1.f);
-      urng = std::bind(distro, gen);
+      // From the scene's generator, so the S&H renders the same on either thread
+      urngGen.seed(Surge::SceneRandom::rand());
    }
+   urngDistro.reset();
    prepare_unison(n_unison);
 
    memset(oscbuffer, 0, sizeof(float) * (OB_LENGTH + FIRipol_N));
@@ -97,10 +98,10 @@ void SampleAndHoldOscillator::init(float pitch, bool is_display)
       }
       else
       {
-         double drand = (double)rand() / RAND_MAX;
+         double drand = (double)Surge::SceneRandom::rand() / RAND_MAX;
          double detune = oscdata->p[shn_unison_detune].get_extended(localcopy[id_detune].f) * (detune_bias * float(i) + detune_offset);
          double st = drand * storage->note_to_pitch_tuningctr(detune) * 0.5;
-         drand = (double)rand() / RAND_MAX;
+         drand = (double)Surge::SceneRandom::rand() / RAND_MAX;
          double ot = drand * storage->note_to_pitch_tuningctr(detune);
          oscstate[i] = st;
          syncstate[i] = st;
@@ -197,7 +198,7 @@ void SampleAndHoldOscillator::convolute(int voice, bool FM, bool stereo)
    if (FM)
       delay = FMdelay;
    else
-      delay = ((ipos >> 24) & 0x3f);
+      delay = ((ipos >> 24) & (storage->blockSizeOS - 1));
 
    unsigned int m = ((ipos >> 16) & 0xff) * (FIRipol_N << 1);
    unsigned int lipolui16 = (ipos & 0xffff);
@@ -310,7 +311,7 @@ void SampleAndHoldOscillator::applyFilter()
       lp.coeff_LP2B(lp.calc_omega(pv / 12.0) / OSC_OVERSAMPLING, 0.707);
    }
 
-   for (int k = 0; k < BLOCK_SIZE_OS; k += BLOCK_SIZE)
+   for (int k = 0; k < storage->blockSizeOS; k += storage->blockSize)
    {
       if (!oscdata->p[shn_lowcut].deactivated)
          hp.process_block(&(output[k]), &(outputR[k]));
@@ -369,7 +370,7 @@ void SampleAndHoldOscillator::process_block(
          driftlfo[l] = drift_noise(driftlfo2[l]);
       }
 
-      for (int s = 0; s < BLOCK_SIZE_OS; s++)
+      for (int s = 0; s < storage->blockSizeOS; s++)
       {
          float fmmul = limit_range(1.f + depth * master_osc[s], 0.1f, 1.9f);
          float a = pitchmult * fmmul;
@@ -392,7 +393,7 @@ void SampleAndHoldOscillator::process_block(
    }
    else
    {
-      float a = (float)BLOCK_SIZE_OS * pitchmult;
+      float a = (float)storage->blockSizeOS * pitchmult;
 
       for (l = 0; l < n_unison; l++)
       {
@@ -409,14 +410,14 @@ void SampleAndHoldOscillator::process_block(
       }
    }
 
-   float hpfblock alignas(16)[BLOCK_SIZE_OS];
-   li_hpf.store_block(hpfblock, BLOCK_SIZE_OS_QUAD);
+   float hpfblock alignas(16)[BLOCK_SIZE_OS_MAX];
+   li_hpf.store_block(hpfblock, storage->blockSizeOSQuad);
 
    __m128 mdc = _mm_load_ss(&dc);
    __m128 oa = _mm_load_ss(&out_attenuation);
    oa = _mm_mul_ss(oa, _mm_load_ss(&pitchmult));
 
-   for (k = 0; k < BLOCK_SIZE_OS; k++)
+   for (k = 0; k < storage->blockSizeOS; k++)
    {
       __m128 hpf = _mm_load_ss(&hpfblock[k]);
       __m128 ob = _mm_load_ss(&oscbuffer[bufpos + k]);
@@ -437,12 +438,12 @@ void SampleAndHoldOscillator::process_block(
    }
    _mm_store_ss(&dc, mdc);
 
-   clear_block(&oscbuffer[bufpos], BLOCK_SIZE_OS_QUAD);
+   clear_block(&oscbuffer[bufpos], storage->blockSizeOSQuad);
    if (stereo)
-      clear_block(&oscbufferR[bufpos], BLOCK_SIZE_OS_QUAD);
-   clear_block(&dcbuffer[bufpos], BLOCK_SIZE_OS_QUAD);
+      clear_block(&oscbufferR[bufpos], storage->blockSizeOSQuad);
+   clear_block(&dcbuffer[bufpos], storage->blockSizeOSQuad);
 
-   bufpos = (bufpos + BLOCK_SIZE_OS) & (OB_LENGTH - 1);
+   bufpos = (bufpos + storage->blockSizeOS) & (OB_LENGTH - 1);
 
    // each block overlap FIRipol_N samples into the next (due to impulses not being wrapped around
    // the block edges copy the overlapping samples to the new block position
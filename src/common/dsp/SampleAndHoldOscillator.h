@@ -19,6 +19,7 @@
 #include "DspUtilities.h"
 #include <vt_dsp/lipol.h>
 #include "BiquadFilter.h"
+#include <random>
 
 
 class SampleAndHoldOscillator : public AbstractBlitOscillator
@@ -62,5 +63,8 @@ private:
    int id_pw, id_shape, id_smooth, id_sub, id_sync, id_detune;
    int FMdelay;
    float FMmul_inv;
-   std::function<float()> urng; // A uniform -1,1 RNG
+   // A uniform -1,1 RNG. Held by value rather than in a std::function so init doesn't allocate
+   std::minstd_rand urngGen;
+   std::uniform_real_distribution<float> urngDistro{-1.f, 1.f};
+   inline float urng() { return urngDistro(urngGen); }
 };
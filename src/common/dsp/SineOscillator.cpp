@@ -15,6 +15,7 @@
 
 #include "SineOscillator.h"
 #include "FastMath.h"
+#include "util/SceneRandom.h"
 #include <algorithm>
 
 SineOscillator::SineOscillator(SurgeStorage* storage, OscillatorStorage* oscdata, pdata* localcopy)
@@ -70,7 +71,7 @@ void SineOscillator::init(float pitch, bool is_display)
    for (int i = 0; i < n_unison; i++)
    {
       if (i > 0)
-         phase[i] = 2.0 * M_PI * rand() / RAND_MAX - M_PI; // phase in range -PI to PI
+         phase[i] = 2.0 * M_PI * Surge::SceneRandom::rand() / RAND_MAX - M_PI; // phase in range -PI to PI
       else
          phase[i] = 0.f;
       lastvalue[i] = 0.f;
@@ -96,6 +97,224 @@ void SineOscillator::init(float pitch, bool is_display)
 SineOscillator::~SineOscillator()
 {}
 
+namespace
+{
+inline __m128 select(__m128 mask, __m128 a, __m128 b)
+{
+   return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+inline __m128 absSSE(__m128 x)
+{
+   return _mm_andnot_ps(_mm_set_ps1(-0.f), x);
+}
+
+/*
+** valueFromSinAndCos for four unison voices at once. The quadrants are the same as the scalar
+** version's (sin > 0 picks 1 or 2, cos > 0 picks 1, cos < 0 picks 3) and each shape computes
+** the same expression per quadrant, selected with masks rather than branches.
+*/
+template <int mode> inline __m128 valueFromSinAndCosSSE(__m128 s, __m128 c)
+{
+   const auto zero = _mm_setzero_ps(), one = _mm_set_ps1(1.f), negone = _mm_set_ps1(-1.f),
+              two = _mm_set_ps1(2.f);
+
+   const auto sPos = _mm_cmpgt_ps(s, zero);
+   const auto cPos = _mm_cmpgt_ps(c, zero);
+   const auto cNeg = _mm_cmplt_ps(c, zero);
+   auto quadrant = [&](__m128 q1, __m128 q2, __m128 q3, __m128 q4) {
+      return select(sPos, select(cPos, q1, q2), select(cNeg, q3, q4));
+   };
+
+   auto sin2x = _mm_mul_ps(_mm_mul_ps(two, s), c);
+   auto cos2x = _mm_sub_ps(one, _mm_mul_ps(_mm_mul_ps(two, s), s));
+   auto onePlusC = _mm_add_ps(one, c), oneMinusC = _mm_sub_ps(one, c);
+
+   switch (mode)
+   {
+   case 1:
+      return quadrant(oneMinusC, onePlusC, _mm_sub_ps(negone, c), _mm_add_ps(negone, c));
+   case 2:
+      return _mm_and_ps(sPos, s);
+   case 3:
+      return quadrant(oneMinusC, onePlusC, zero, zero);
+   case 4:
+      return _mm_and_ps(sPos, sin2x);
+   case 5:
+   case 7:
+   {
+      auto s2Pos = _mm_cmpgt_ps(sin2x, zero);
+      auto c2Pos = _mm_cmpgt_ps(cos2x, zero);
+      auto c2Neg = _mm_cmplt_ps(cos2x, zero);
+      auto v = select(s2Pos,
+                      select(c2Pos, _mm_sub_ps(one, cos2x), _mm_add_ps(one, cos2x)),
+                      select(c2Neg, _mm_sub_ps(negone, cos2x), _mm_add_ps(negone, cos2x)));
+      if (mode == 7)
+         v = absSSE(v);
+      return _mm_and_ps(sPos, v);
+   }
+   case 6:
+      return _mm_and_ps(sPos, absSSE(sin2x));
+   case 8:
+      return _mm_sub_ps(_mm_mul_ps(two, _mm_and_ps(sPos, s)), one);
+   case 9:
+      return quadrant(zero, s, zero, s);
+   case 10:
+      return quadrant(s, zero, s, zero);
+   case 11:
+      return _mm_sub_ps(_mm_mul_ps(two, quadrant(oneMinusC, onePlusC, zero, zero)), one);
+   case 12:
+   {
+      auto n = _mm_sub_ps(zero, sin2x);
+      return quadrant(sin2x, n, n, sin2x);
+   }
+   case 13:
+      return quadrant(sin2x, zero, _mm_sub_ps(zero, sin2x), zero);
+   case 14:
+      return _mm_and_ps(sPos, absSSE(cos2x));
+   case 15:
+      return quadrant(_mm_sub_ps(one, s), zero, zero, _mm_sub_ps(negone, s));
+   case 16:
+      return quadrant(_mm_sub_ps(one, s), zero, zero, _mm_add_ps(negone, c));
+   case 17:
+      return _mm_mul_ps(quadrant(_mm_sub_ps(one, s), absSSE(_mm_add_ps(negone, s)),
+                                 _mm_sub_ps(negone, s),
+                                 _mm_mul_ps(negone, absSSE(_mm_add_ps(one, s)))),
+                        _mm_set_ps1(0.85f));
+   case 18:
+      return quadrant(sin2x, c, c, _mm_sub_ps(zero, sin2x));
+   case 19:
+   {
+      auto sin4x = _mm_mul_ps(_mm_mul_ps(two, sin2x), cos2x);
+      return quadrant(sin4x, _mm_sub_ps(zero, sin2x), s, s);
+   }
+   case 20:
+      return quadrant(s, one, s, negone);
+   case 21:
+      return quadrant(one, s, negone, s);
+   case 22:
+      return quadrant(s, zero, zero, s);
+   case 23:
+      return quadrant(zero, s, s, zero);
+   default:
+      return s;
+   }
+}
+} // namespace
+
+/*
+** The unison voices run four to an SSE register. Phase, omega, feedback, pan and the start-up
+** ramp for a group of four are loaded once and kept in registers for the whole block, with the
+** FM and feedback amounts (which are shared by the voices) precomputed per sample. Phase wraps
+** with a compare and masked subtract rather than a loop. Each group adds its contribution into
+** a per sample four wide accumulator, summed across the lanes at the end.
+**
+** The phase stays in double, two lanes to a register, and advances and wraps exactly as the
+** scalar loop's does; only its sum with the feedback and FM is in float. A float phase would
+** drift from the scalar one by a rounding a sample, building up over the block and so with
+** BLOCK_SIZE.
+*/
+template <int mode>
+void SineOscillator::process_block_unison(bool stereo, bool FM, const double* omega)
+{
+   float fmk alignas(16)[BLOCK_SIZE_OS_MAX], fbk alignas(16)[BLOCK_SIZE_OS_MAX];
+   for (int k = 0; k < storage->blockSizeOS; k++)
+   {
+      fmk[k] = FM ? FMdepth.v * master_osc[k] : 0.f;
+      fbk[k] = FB.v;
+      FMdepth.process();
+      FB.process();
+   }
+
+   // Lane packed state, zero padded so the unused lanes of the last group contribute nothing
+   double ph alignas(16)[MAX_UNISON], om alignas(16)[MAX_UNISON];
+   float lv alignas(16)[MAX_UNISON], pl alignas(16)[MAX_UNISON], pr alignas(16)[MAX_UNISON],
+       ramp alignas(16)[MAX_UNISON];
+   for (int u = 0; u < MAX_UNISON; u++)
+   {
+      bool on = u < n_unison;
+      ph[u] = on ? phase[u] : 0.0;
+      om[u] = on ? omega[u] : 0.0;
+      lv[u] = on ? lastvalue[u] : 0.f;
+      pl[u] = on ? panL[u] * out_attenuation : 0.f;
+      pr[u] = on ? panR[u] * out_attenuation : 0.f;
+      ramp[u] = on ? playingramp[u] : 0.f;
+   }
+
+   __m128 accL[BLOCK_SIZE_OS_MAX], accR[BLOCK_SIZE_OS_MAX];
+   for (int k = 0; k < storage->blockSizeOS; k++)
+   {
+      accL[k] = _mm_setzero_ps();
+      accR[k] = _mm_setzero_ps();
+   }
+
+   const auto one = _mm_set_ps1(1.f), dplay = _mm_set_ps1(dplaying);
+   const auto pi = _mm_set1_pd(M_PI), twopi = _mm_set1_pd(2.0 * M_PI);
+   const auto squareFeedback = (fb_val < 0) ? _mm_castsi128_ps(_mm_set1_epi32(-1)) : _mm_setzero_ps();
+
+   for (int g = 0; g < n_unison; g += 4)
+   {
+      auto phaseLo = _mm_load_pd(ph + g), phaseHi = _mm_load_pd(ph + g + 2),
+           omegaLo = _mm_load_pd(om + g), omegaHi = _mm_load_pd(om + g + 2);
+      auto last4 = _mm_load_ps(lv + g), panL4 = _mm_load_ps(pl + g), panR4 = _mm_load_ps(pr + g),
+           ramp4 = _mm_load_ps(ramp + g);
+
+      for (int k = 0; k < storage->blockSizeOS; k++)
+      {
+         auto p = _mm_movelh_ps(_mm_cvtpd_ps(phaseLo), _mm_cvtpd_ps(phaseHi));
+         p = _mm_add_ps(_mm_add_ps(p, last4), _mm_set_ps1(fmk[k]));
+         p = Surge::DSP::clampToPiRangeSSE(p);
+
+         auto out = valueFromSinAndCosSSE<mode>(Surge::DSP::fastsinSSE(p),
+                                                Surge::DSP::fastcosSSE(p));
+         auto outRamped = _mm_mul_ps(out, ramp4);
+         accL[k] = _mm_add_ps(accL[k], _mm_mul_ps(outRamped, panL4));
+         accR[k] = _mm_add_ps(accR[k], _mm_mul_ps(outRamped, panR4));
+
+         ramp4 = _mm_min_ps(_mm_add_ps(ramp4, _mm_and_ps(_mm_cmplt_ps(ramp4, one), dplay)), one);
+
+         phaseLo = _mm_add_pd(phaseLo, omegaLo);
+         phaseLo = _mm_sub_pd(phaseLo, _mm_and_pd(_mm_cmpgt_pd(phaseLo, pi), twopi));
+         phaseHi = _mm_add_pd(phaseHi, omegaHi);
+         phaseHi = _mm_sub_pd(phaseHi, _mm_and_pd(_mm_cmpgt_pd(phaseHi, pi), twopi));
+
+         last4 = _mm_mul_ps(_mm_mul_ps(out, select(squareFeedback, out, one)),
+                            _mm_set_ps1(fbk[k]));
+      }
+
+      _mm_store_pd(ph + g, phaseLo);
+      _mm_store_pd(ph + g + 2, phaseHi);
+      _mm_store_ps(lv + g, last4);
+      _mm_store_ps(ramp + g, ramp4);
+   }
+
+   for (int u = 0; u < n_unison; u++)
+   {
+      phase[u] = ph[u];
+      lastvalue[u] = lv[u];
+      playingramp[u] = ramp[u];
+   }
+
+   const auto half = _mm_set_ps1(0.5f);
+   for (int k = 0; k < storage->blockSizeOS; k += 4)
+   {
+      auto l0 = accL[k], l1 = accL[k + 1], l2 = accL[k + 2], l3 = accL[k + 3];
+      auto r0 = accR[k], r1 = accR[k + 1], r2 = accR[k + 2], r3 = accR[k + 3];
+      _MM_TRANSPOSE4_PS(l0, l1, l2, l3);
+      _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+      auto sumL = _mm_add_ps(_mm_add_ps(l0, l1), _mm_add_ps(l2, l3));
+      auto sumR = _mm_add_ps(_mm_add_ps(r0, r1), _mm_add_ps(r2, r3));
+
+      if (stereo)
+      {
+         _mm_store_ps(output + k, sumL);
+         _mm_store_ps(outputR + k, sumR);
+      }
+      else
+         _mm_store_ps(output + k, _mm_mul_ps(_mm_add_ps(sumL, sumR), half));
+   }
+}
+
 void SineOscillator::process_block(float pitch, float drift, bool stereo, bool FM, float fmdepth)
 {
    if (localcopy[id_fmlegacy].i == 0)
@@ -105,31 +324,107 @@ void SineOscillator::process_block(float pitch, float drift, bool stereo, bool F
       return;
    }
 
-   fb_val = oscdata->p[sin_feedback].get_extended(localcopy[id_fb].f);
+   double omega[MAX_UNISON];
+   prepare_block(pitch, drift, fmdepth, omega);
+
+   if (!storage->batchOscillatorUnison)
+   {
+      process_block_unison_scalar(stereo, FM, omega);
+      applyFilter();
+      return;
+   }
+
+#define SINE_UNISON_CASE(m)                                                                        \
+   case m:                                                                                         \
+      process_block_unison<m>(stereo, FM, omega);                                                  \
+      break;
+
+   switch (localcopy[id_mode].i)
+   {
+      SINE_UNISON_CASE(1)
+      SINE_UNISON_CASE(2)
+      SINE_UNISON_CASE(3)
+      SINE_UNISON_CASE(4)
+      SINE_UNISON_CASE(5)
+      SINE_UNISON_CASE(6)
+      SINE_UNISON_CASE(7)
+      SINE_UNISON_CASE(8)
+      SINE_UNISON_CASE(9)
+      SINE_UNISON_CASE(10)
+      SINE_UNISON_CASE(11)
+      SINE_UNISON_CASE(12)
+      SINE_UNISON_CASE(13)
+      SINE_UNISON_CASE(14)
+      SINE_UNISON_CASE(15)
+      SINE_UNISON_CASE(16)
+      SINE_UNISON_CASE(17)
+      SINE_UNISON_CASE(18)
+      SINE_UNISON_CASE(19)
+      SINE_UNISON_CASE(20)
+      SINE_UNISON_CASE(21)
+      SINE_UNISON_CASE(22)
+      SINE_UNISON_CASE(23)
+   default:
+      process_block_unison<0>(stereo, FM, omega);
+      break;
+   }
+#undef SINE_UNISON_CASE
+
+   applyFilter();
+}
+
+void SineOscillator::skip_block(float pitch, float drift, bool stereo, bool FM, float fmdepth)
+{
+   if (localcopy[id_fmlegacy].i == 0)
+   {
+      process_block(pitch, drift, stereo, FM, fmdepth);
+      return;
+   }
 
-   double detune;
    double omega[MAX_UNISON];
+   prepare_block(pitch, drift, fmdepth, omega);
 
-   for (int l = 0; l < n_unison; l++)
+   for (int k = 0; k < storage->blockSizeOS; k++)
    {
-      driftlfo[l] = drift_noise(driftlfo2[l]);
-      detune = drift * driftlfo[l];
+      FMdepth.process();
+      FB.process();
+   }
 
-      if (n_unison > 1)
-      {
-         if (oscdata->p[sin_unison_detune].absolute)
-         {
-            detune += oscdata->p[sin_unison_detune].get_extended(localcopy[oscdata->p[sin_unison_detune].param_id_in_scene].f) *
-                      storage->note_to_pitch_inv_ignoring_tuning(std::min(148.f, pitch)) * 16 / 0.9443 * (detune_bias * float(l) + detune_offset);
-         }
-         else
-         {
-            detune += oscdata->p[sin_unison_detune].get_extended(localcopy[id_detune].f) * (detune_bias * float(l) + detune_offset);
-         }
-      }
+   for (int u = 0; u < n_unison; u++)
+   {
+      // The block's worth of phase in one step; only the rounding differs from process_block
+      double p = phase[u] + storage->blockSizeOS * omega[u];
+      if (p > M_PI)
+         p -= 2.0 * M_PI * std::ceil((p - M_PI) / (2.0 * M_PI));
+      phase[u] = p;
+
+      playingramp[u] = std::min(playingramp[u] + storage->blockSizeOS * dplaying, 1.f);
+
+      // The feedback carries on from an estimate of the block's last sample
+      float lp = Surge::DSP::clampToPiRange(phase[u] - omega[u] + lastvalue[u]);
+      float out = valueFromSinAndCos(Surge::DSP::fastsin(lp), Surge::DSP::fastcos(lp));
+      lastvalue[u] = (fb_val < 0) ? out * out * FB.v : out * FB.v;
+   }
+}
+
+void SineOscillator::prepare_block(float pitch, float drift, float fmdepth, double* omega)
+{
+   fb_val = oscdata->p[sin_feedback].get_extended(localcopy[id_fb].f);
 
-      omega[l] = std::min(M_PI, (double)pitch_to_omega(pitch + detune));
+   float spread = 0.f;
+   if (n_unison > 1)
+   {
+      spread = oscdata->p[sin_unison_detune].get_extended(localcopy[id_detune].f);
+      if (oscdata->p[sin_unison_detune].absolute)
+         spread *= storage->note_to_pitch_inv_ignoring_tuning(std::min(148.f, pitch)) * 16 / 0.9443;
    }
+   unison.step(driftlfo, driftlfo2, n_unison, drift, spread, detune_bias, detune_offset);
+
+   // pitch_to_omega(pitch + detune), all the voices at once
+   float om alignas(16)[MAX_UNISON];
+   unison.lookup(storage->table_pitch, 1.f, pitch, (float)(M_PI * 16.35159783 * dsamplerate_os_inv), om);
+   for (int l = 0; l < n_unison; l++)
+      omega[l] = std::min(M_PI, (double)om[l]);
 
    float fv = 32.0 * M_PI * fmdepth * fmdepth * fmdepth;
 
@@ -142,8 +437,11 @@ void SineOscillator::process_block(float pitch, float drift, bool stereo, bool F
 
    FMdepth.newValue(fv);
    FB.newValue(abs(fb_val));
+}
 
-   for (int k = 0; k < BLOCK_SIZE_OS; k++)
+void SineOscillator::process_block_unison_scalar(bool stereo, bool FM, const double* omega)
+{
+   for (int k = 0; k < storage->blockSizeOS; k++)
    {
       float outL = 0.f, outR = 0.f;
 
@@ -189,7 +487,6 @@ void SineOscillator::process_block(float pitch, float drift, bool stereo, bool F
       else
          output[k] = (outL + outR) / 2;
    }
-   applyFilter();
 }
 
 void SineOscillator::applyFilter()
@@ -208,7 +505,7 @@ void SineOscillator::applyFilter()
       lp.coeff_LP2B(lp.calc_omega(pv / 12.0) / OSC_OVERSAMPLING, 0.707);
    }
 
-   for (int k = 0; k < BLOCK_SIZE_OS; k += BLOCK_SIZE)
+   for (int k = 0; k < storage->blockSizeOS; k += storage->blockSize)
    {
       if (!oscdata->p[sin_lowcut].deactivated)
          hp.process_block(&(output[k]), &(outputR[k]));
@@ -248,7 +545,7 @@ void SineOscillator::process_block_legacy(
 
       FMdepth.newValue(fmdepth);
 
-      for (int k = 0; k < BLOCK_SIZE_OS; k++)
+      for (int k = 0; k < storage->blockSizeOS; k++)
       {
          float outL = 0.f, outR = 0.f;
 
@@ -295,7 +592,7 @@ void SineOscillator::process_block_legacy(
          sinus[l].set_rate(omega[l]);
       }
 
-      for (int k = 0; k < BLOCK_SIZE_OS; k++)
+      for (int k = 0; k < storage->blockSizeOS; k++)
       {
          float outL = 0.f, outR = 0.f;
 
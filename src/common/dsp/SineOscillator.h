@@ -19,6 +19,7 @@
 #include "DspUtilities.h"
 #include <vt_dsp/lipol.h>
 #include "BiquadFilter.h"
+#include "UnisonFrame.h"
 
 class SineOscillator : public Oscillator
 {
@@ -40,6 +41,12 @@ public:
        float pitch, float drift = 0.f, bool stereo = false, bool FM = false, float FMdepth = 0.f) override;
    virtual void process_block_legacy(
        float pitch, float drift = 0.f, bool stereo = false, bool FM = false, float FMdepth = 0.f);
+   virtual void skip_block(
+       float pitch, float drift = 0.f, bool stereo = false, bool FM = false, float FMdepth = 0.f) override;
+   virtual bool skip_needs_fm() override
+   {
+      return false;
+   }
    virtual ~SineOscillator();
    virtual void init_ctrltypes() override;
    virtual void init_default_values() override;
@@ -47,6 +54,7 @@ public:
    quadr_osc sinus[MAX_UNISON];
    double phase[MAX_UNISON];
    float driftlfo[MAX_UNISON], driftlfo2[MAX_UNISON];
+   UnisonFrame unison;
    float fb_val;
    float playingramp[MAX_UNISON], dplaying;
    lag<double> FMdepth;
@@ -61,6 +69,11 @@ public:
 
    BiquadFilter lp, hp;
    void applyFilter();
+
+   void prepare_block(float pitch, float drift, float fmdepth, double* omega);
+   template <int mode> void process_block_unison(bool stereo, bool FM, const double* omega);
+   // One unison voice at a time, when SurgeStorage::batchOscillatorUnison is off
+   void process_block_unison_scalar(bool stereo, bool FM, const double* omega);
    
    inline float valueFromSinAndCos(float svalue, float cvalue ) {
       return valueFromSinAndCos(svalue, cvalue, localcopy[id_mode].i );
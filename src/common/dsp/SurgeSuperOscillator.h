@@ -19,6 +19,7 @@
 #include "DspUtilities.h"
 #include <vt_dsp/lipol.h>
 #include "BiquadFilter.h"
+#include "UnisonFrame.h"
 
 class SurgeSuperOscillator : public AbstractBlitOscillator
 {
@@ -44,6 +45,9 @@ public:
    virtual ~SurgeSuperOscillator();
 
 private:
+   void update_unison_rates();
+   UnisonFrame unison;
+   float unison_t[MAX_UNISON], unison_sync_t[MAX_UNISON];
    bool first_run;
    float dc, dc_uni[MAX_UNISON], elapsed_time[MAX_UNISON], last_level[MAX_UNISON], pwidth[MAX_UNISON], pwidth2[MAX_UNISON];
    template <bool is_init> void update_lagvals();
@@ -53,6 +57,6 @@ private:
    int id_pw, id_pw2, id_shape, id_smooth, id_sub, id_sync, id_detune;
    int FMdelay;
    float FMmul_inv;
-   float FMphase alignas(16)[BLOCK_SIZE_OS + 4];
+   float FMphase alignas(16)[BLOCK_SIZE_OS_MAX + 4];
    float CoefB0, CoefB1, CoefA1;
 };
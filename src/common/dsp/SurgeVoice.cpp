@@ -16,6 +16,8 @@
 #include "SurgeVoice.h"
 #include "DspUtilities.h"
 #include "QuadFilterChain.h"
+#include "FM2Oscillator.h"
+#include "FM3Oscillator.h"
 #include <math.h>
 
 using namespace std;
@@ -57,6 +59,8 @@ float SurgeVoiceState::getPitch()
 
 SurgeVoice::SurgeVoice()
 {
+   for (int i = 0; i < n_oscs; i++)
+      osc[i] = nullptr;
 }
 
 SurgeVoice::SurgeVoice(SurgeStorage* storage,
@@ -83,6 +87,9 @@ SurgeVoice::SurgeVoice(SurgeStorage* storage,
    assert(storage);
    assert(oscene);
 
+   for (auto& l : osclevels)
+      l.set_blocksize(storage->blockSizeOS);
+
    memcpy(localcopy, paramptr, sizeof(localcopy));
 
    // We want this on the keystate so it survives the voice for mono mode
@@ -108,6 +115,7 @@ SurgeVoice::SurgeVoice(SurgeStorage* storage,
 
    state.mpePitchBendRange = storage->mpePitchBendRange;
    state.mpePitchBend = ControllerModulationSource(storage->pitchSmoothingMode);
+   state.mpePitchBend.set_blocksize(storage->blockSize);
    state.mpePitchBend.init(voiceChannelState->pitchBend / 8192.f);
 
    if ((scene->polymode.val.i == pm_mono_st_fp) ||
@@ -132,12 +140,16 @@ SurgeVoice::SurgeVoice(SurgeStorage* storage,
    for (int i = 0; i < n_oscs; i++)
    {
       osctype[i] = -1;
+      osc[i] = nullptr;
    }
    memset(&FBP, 0, sizeof(FBP));
 
    polyAftertouchSource = ControllerModulationSource(storage->smoothingMode);
    monoAftertouchSource = ControllerModulationSource(storage->smoothingMode);
    timbreSource         = ControllerModulationSource(storage->smoothingMode);
+   polyAftertouchSource.set_blocksize(storage->blockSize);
+   monoAftertouchSource.set_blocksize(storage->blockSize);
+   timbreSource.set_blocksize(storage->blockSize);
 
    polyAftertouchSource.init(storage->poly_aftertouch[state.scene_id & 1][state.key & 127]);
    timbreSource.init(state.voiceChannelState->timbre);
@@ -258,6 +270,7 @@ SurgeVoice::SurgeVoice(SurgeStorage* storage,
 
 SurgeVoice::~SurgeVoice()
 {
+   freeAllocatedElements();
 }
 
 void SurgeVoice::legato(int key, int velocity, char detune)
@@ -322,9 +335,10 @@ void SurgeVoice::switch_toggled()
    /*
     * Since we have updated the keytrack output here we need to re-update the localcopy modulators
     */
-   vector<ModulationRouting>::iterator iter;
-   iter = scene->modulation_voice.begin();
-   while (iter != scene->modulation_voice.end())
+   auto& voiceRouting = modRouting()->voice[state.scene_id];
+   vector<ModulationRouting>::const_iterator iter;
+   iter = voiceRouting.begin();
+   while (iter != voiceRouting.end())
    {
       int src_id = iter->source_id;
       int dst_id = iter->destination_id;
@@ -340,7 +354,10 @@ void SurgeVoice::switch_toggled()
    {
       if (osctype[i] != scene->osc[i].type.val.i)
       {
-         osc[i].reset(spawn_osc(scene->osc[i].type.val.i, storage, &scene->osc[i], localcopy));
+         if (osc[i])
+            osc[i]->~Oscillator();
+         osc[i] = spawn_osc(scene->osc[i].type.val.i, storage, &scene->osc[i], localcopy,
+                            oscbuffer[i]);
          if (osc[i])
          {
             osc[i]->init(state.pitch);
@@ -410,6 +427,11 @@ void SurgeVoice::switch_toggled()
       set_path(use_osc1, use_osc2, use_osc3, FM, use_ring12, use_ring23, use_noise);
    }
 
+   // The filter state is about to be reset in FBP, so the registers the voice left in its lane
+   // have to come back first
+   if (qfbInLane)
+      GetQFB();
+
    // check the filtertype
    for (int u = 0; u < n_filterunits_per_scene; u++)
    {
@@ -463,7 +485,7 @@ void SurgeVoice::update_portamento()
    if (scene->portamento.porta_constrate)
       const_rate_factor = (1.f / ((1.f / quantStep) * fabs(state.getPitch() - state.portasrc_key) + 0.00001));
 
-   state.portaphase += envelope_rate_linear(localcopy[scene->portamento.param_id_in_scene].f) *
+   state.portaphase += storage->envelope_rate_linear(localcopy[scene->portamento.param_id_in_scene].f) *
                            (scene->portamento.temposync ? storage->temposyncratio : 1.f) * const_rate_factor;
 
    if (state.portaphase < 1)
@@ -514,7 +536,7 @@ int SurgeVoice::routefilter(int r)
    return r;
 }
 
-template <bool first> void SurgeVoice::calc_ctrldata(QuadFilterChainState* Q, int e)
+void SurgeVoice::process_lfos()
 {
    // Always process LFO1 so the gate retrigger always work
    lfo[0].process_block();
@@ -536,9 +558,35 @@ template <bool first> void SurgeVoice::calc_ctrldata(QuadFilterChainState* Q, in
          ((AdsrEnvelope*)modsources[ms_filtereg])->retrigger();
       }
    }
+}
+
+void SurgeVoice::prerenderModulators(SurgeVoice** voices, int n)
+{
+   AdsrEnvelope* eg[2][MAX_VOICES];
+   for (int i = 0; i < n; i++)
+   {
+      SurgeVoice* v = voices[i];
+      v->process_lfos();
+      eg[0][i] = &v->ampEGSource;
+      eg[1][i] = &v->filterEGSource;
+      v->modulatorsPrerendered = true;
+   }
+
+   for (int g = 0; g < 2; g++)
+      for (int i = 0; i < n; i += 4)
+         AdsrEnvelope::process_block_quad(&eg[g][i], std::min(4, n - i));
+}
+
+template <bool first> void SurgeVoice::calc_ctrldata(QuadFilterChainState* Q, int e)
+{
+   if (!modulatorsPrerendered)
+   {
+      process_lfos();
+      modsources[ms_ampeg]->process_block();
+      modsources[ms_filtereg]->process_block();
+   }
+   modulatorsPrerendered = false;
 
-   modsources[ms_ampeg]->process_block();
-   modsources[ms_filtereg]->process_block();
    if (((AdsrEnvelope*)modsources[ms_ampeg])->is_idle())
       state.keep_playing = false;
 
@@ -549,42 +597,16 @@ template <bool first> void SurgeVoice::calc_ctrldata(QuadFilterChainState* Q, in
    // same for FX & OSCs
    // also ignore int-parameters
 
-   vector<ModulationRouting>::iterator iter;
-   iter = scene->modulation_voice.begin();
-   while (iter != scene->modulation_voice.end())
-   {
-      int src_id = iter->source_id;
-      int dst_id = iter->destination_id;
-      float depth = iter->depth;
-
-      if (modsources[src_id])
-      {
-         localcopy[dst_id].f += depth * modsources[src_id]->output;
-      }
-      iter++;
-   }
+   // The routing snapshot for this block, compiled into ModulationMatrix form; see ModRoutingSnapshot
+   const ModRoutingSnapshot* routing = modRouting();
+   routing->voiceMatrix[state.scene_id].accumulate(localcopy, modsources.data());
 
    if( mpeEnabled )
    {
        // See github issue 1214. This basically compensates for
        // channel AT being per-voice in MPE mode (since it is per channel)
        // vs per-scene (since it is per keyboard in non MPE mode).
-       iter = scene->modulation_scene.begin();
-       while( iter != scene->modulation_scene.end() )
-       {
-           int src_id = iter->source_id;
-           if( src_id == ms_aftertouch && modsources[src_id] )
-           {
-               int dst_id = iter->destination_id;
-               // I don't THINK we need this but am not sure the global params are in my localcopy span
-               if( dst_id >= 0 && dst_id < n_scene_params )
-               {
-                   float depth = iter->depth;
-                   localcopy[dst_id].f += depth * modsources[src_id]->output;
-               }
-           }
-           iter++;
-       }
+       routing->mpeAftertouchMatrix[state.scene_id].accumulate(localcopy, modsources.data());
 
        monoAftertouchSource.set_target(state.voiceChannelState->pressure);
        timbreSource.set_target(state.voiceChannelState->timbre);
@@ -683,9 +705,9 @@ template <bool first> void SurgeVoice::calc_ctrldata(QuadFilterChainState* Q, in
       if (Q)
       {
          set1f(Q->Out2L, e, FBP.Out2L);
-         set1f(Q->dOut2L, e, (amp2L - FBP.Out2L) * BLOCK_SIZE_OS_INV);
+         set1f(Q->dOut2L, e, (amp2L - FBP.Out2L) * storage->blockSizeOSInv);
          set1f(Q->Out2R, e, FBP.Out2R);
-         set1f(Q->dOut2R, e, (amp2R - FBP.Out2R) * BLOCK_SIZE_OS_INV);
+         set1f(Q->dOut2R, e, (amp2R - FBP.Out2R) * storage->blockSizeOSInv);
       }
       FBP.Out2L = amp2L;
       FBP.Out2R = amp2R;
@@ -697,9 +719,9 @@ template <bool first> void SurgeVoice::calc_ctrldata(QuadFilterChainState* Q, in
    if (Q)
    {
       set1f(Q->OutL, e, FBP.OutL);
-      set1f(Q->dOutL, e, (ampL - FBP.OutL) * BLOCK_SIZE_OS_INV);
+      set1f(Q->dOutL, e, (ampL - FBP.OutL) * storage->blockSizeOSInv);
       set1f(Q->OutR, e, FBP.OutR);
-      set1f(Q->dOutR, e, (ampR - FBP.OutR) * BLOCK_SIZE_OS_INV);
+      set1f(Q->dOutR, e, (ampR - FBP.OutR) * storage->blockSizeOSInv);
    }
 
    FBP.OutL = ampL;
@@ -707,181 +729,317 @@ template <bool first> void SurgeVoice::calc_ctrldata(QuadFilterChainState* Q, in
 }
 
 bool SurgeVoice::process_block(QuadFilterChainState& Q, int Qe)
+{
+   prepare_block(Q, Qe);
+   return render_block(Q, Qe);
+}
+
+void SurgeVoice::prepare_block(QuadFilterChainState& Q, int Qe)
 {
    calc_ctrldata<0>(&Q, Qe);
+   update_osc_activity();
+}
 
-   bool is_wide = scene->filterblock_configuration.val.i == fc_wide;
-   float tblock alignas(16)[BLOCK_SIZE_OS],
-         tblock2 alignas(16)[BLOCK_SIZE_OS];
-   float* tblockR = is_wide ? tblock2 : tblock;
+/*
+** An output is heard when the path mixes it in and its level isn't zero at both ends of the
+** block. An oscillator has to be rendered when it's heard, when a heard ring modulator uses it, or
+** when it is the FM source of one which is rendered, or skipped but needs its FM to stay in
+** phase. The others the path uses get skip_block, which moves them along without (for most
+** types) rendering them.
+*/
+void SurgeVoice::update_osc_activity()
+{
+   bool skip = storage->skipSilentOscillators;
+   auto audible = [&](int le) {
+      float c, t;
+      _mm_store_ss(&c, osclevels[le].currentval);
+      _mm_store_ss(&t, osclevels[le].target);
+      return !skip || c != 0.f || t != 0.f;
+   };
+
+   oscHeard[0] = osc1 && audible(le_osc1);
+   oscHeard[1] = osc2 && audible(le_osc2);
+   oscHeard[2] = osc3 && audible(le_osc3);
+   ring12Heard = ring12 && audible(le_ring12);
+   ring23Heard = ring23 && audible(le_ring23);
+   noiseHeard = noise && audible(le_noise);
+
+   auto needsFM = [this](int i) {
+      return oscActive[i] || (oscRenders(i) && osc[i]->skip_needs_fm());
+   };
+
+   oscActive[0] = oscHeard[0] || ring12Heard;
+   oscActive[1] = oscHeard[1] || ring12Heard || ring23Heard || (FMmode != fm_off && needsFM(0));
+   oscActive[2] = oscHeard[2] || ring23Heard || (FMmode == fm_3to2to1 && needsFM(1)) ||
+                  (FMmode == fm_2and3to1 && needsFM(0));
+}
+
+bool SurgeVoice::oscRenders(int i) const
+{
+   switch (i)
+   {
+   case 2:
+      return osc3 || ring23 || ((osc1 || osc2) && (FMmode == fm_3to2to1)) ||
+             (osc1 && (FMmode == fm_2and3to1));
+   case 1:
+      return osc2 || ring12 || ring23 || (FMmode && osc1);
+   default:
+      return osc1 || ring12;
+   }
+}
 
+bool SurgeVoice::oscTakesFM(int i) const
+{
+   switch (i)
+   {
+   case 2:
+      return false;
+   case 1:
+      return FMmode == fm_3to2to1;
+   default:
+      return FMmode != fm_off;
+   }
+}
+
+float SurgeVoice::oscPitch(int i)
+{
    // float ktrkroot = (float)scene->keytrack_root.val.i;
    float ktrkroot = 60;
+   return noteShiftFromPitchParam((scene->osc[i].keytrack.val.b ? state.pitch : ktrkroot + state.scenepbpitch) +
+                                  octaveSize * scene->osc[i].octave.val.i, i);
+}
+
+void SurgeVoice::prerenderFMOscillators(SurgeVoice** voices, int n)
+{
+   for (int i = 0; i < n_oscs; i++)
+   {
+      for (int type : {ot_FM2, ot_FM3})
+      {
+         FMOperatorStack stacks[4];
+         SurgeVoice* owners[4];
+         int ns = 0;
+
+         auto flush = [&]() {
+            if (ns == 0)
+               return;
+            processFMOperatorStacksQuad(stacks, ns, voices[0]->storage->blockSizeOS);
+            for (int q = 0; q < ns; q++)
+               owners[q]->oscPrerendered[i] = true;
+            ns = 0;
+         };
+
+         for (int v = 0; v < n; v++)
+         {
+            SurgeVoice* sv = voices[v];
+            if (sv->osctype[i] != type || !sv->oscActive[i] || sv->oscTakesFM(i))
+               continue;
+
+            bool is_wide = sv->scene->filterblock_configuration.val.i == fc_wide;
+            float drift = sv->localcopy[sv->scene->drift.param_id_in_scene].f;
+            float pitch = sv->oscPitch(i);
+            if (type == ot_FM2)
+               stacks[ns] = ((FM2Oscillator*)sv->osc[i])->operator_stack(pitch, drift, is_wide);
+            else
+               stacks[ns] = ((FM3Oscillator*)sv->osc[i])->operator_stack(pitch, drift, is_wide);
+            owners[ns++] = sv;
+
+            if (ns == 4)
+               flush();
+         }
+         flush();
+      }
+   }
+}
+
+bool SurgeVoice::render_block(QuadFilterChainState& Q, int Qe)
+{
+   bool is_wide = scene->filterblock_configuration.val.i == fc_wide;
+   float tblock alignas(16)[BLOCK_SIZE_OS_MAX],
+         tblock2 alignas(16)[BLOCK_SIZE_OS_MAX];
+   float* tblockR = is_wide ? tblock2 : tblock;
+
    float drift = localcopy[scene->drift.param_id_in_scene].f;
+   float fmdepth = db_to_linear(localcopy[scene->fm_depth.param_id_in_scene].f);
+
+   // An oscillator which won't be heard is moved along instead of rendered, and left silent in
+   // case something it would have modulated is being moved along with FM too
+   auto skipOsc = [&](int i, bool FM) {
+      osc[i]->skip_block(oscPitch(i), drift, is_wide, FM, fmdepth);
+      clear_block(osc[i]->output, storage->blockSizeOSQuad);
+      clear_block(osc[i]->outputR, storage->blockSizeOSQuad);
+   };
 
    // clear output
-   clear_block(output[0], BLOCK_SIZE_OS_QUAD);
-   clear_block(output[1], BLOCK_SIZE_OS_QUAD);
+   clear_block(output[0], storage->blockSizeOSQuad);
+   clear_block(output[1], storage->blockSizeOSQuad);
 
-   if (osc3 || ring23 || ((osc1 || osc2) && (FMmode == fm_3to2to1)) || (osc1 && (FMmode == fm_2and3to1)))
+   if (oscActive[2])
    {
-       osc[2]->process_block(noteShiftFromPitchParam((scene->osc[2].keytrack.val.b ? state.pitch : ktrkroot + state.scenepbpitch) +
-                                                      octaveSize * scene->osc[2].octave.val.i, 2), drift, is_wide);
+      if (!oscPrerendered[2])
+         osc[2]->process_block(oscPitch(2), drift, is_wide);
 
-      if (osc3)
+      if (oscHeard[2])
       {
          if (is_wide)
          {
-             osclevels[le_osc3].multiply_2_blocks_to(osc[2]->output, osc[2]->outputR, tblock, tblockR, BLOCK_SIZE_OS_QUAD);
+             osclevels[le_osc3].multiply_2_blocks_to(osc[2]->output, osc[2]->outputR, tblock, tblockR, storage->blockSizeOSQuad);
          }
          else
          {
-            osclevels[le_osc3].multiply_block_to(osc[2]->output, tblock, BLOCK_SIZE_OS_QUAD);
+            osclevels[le_osc3].multiply_block_to(osc[2]->output, tblock, storage->blockSizeOSQuad);
          }
 
          if (route[2] < 2)
          {
-            accumulate_block(tblock, output[0], BLOCK_SIZE_OS_QUAD);
+            accumulate_block(tblock, output[0], storage->blockSizeOSQuad);
          }
          if (route[2] > 0)
          {
-            accumulate_block(tblockR, output[1], BLOCK_SIZE_OS_QUAD);
+            accumulate_block(tblockR, output[1], storage->blockSizeOSQuad);
          }
       }
    }
 
-   if (osc2 || ring12 || ring23 || (FMmode && osc1))
+   else if (oscRenders(2))
+   {
+      skipOsc(2, false);
+   }
+
+   if (oscActive[1])
    {
       if (FMmode == fm_3to2to1)
       {
-          osc[1]->process_block(noteShiftFromPitchParam((scene->osc[1].keytrack.val.b ? state.pitch : ktrkroot + state.scenepbpitch) +
-                                                        octaveSize * scene->osc[1].octave.val.i, 1), drift, is_wide, true,
-                                                        db_to_linear(localcopy[scene->fm_depth.param_id_in_scene].f));
+          osc[1]->process_block(oscPitch(1), drift, is_wide, true, fmdepth);
       }
-      else
+      else if (!oscPrerendered[1])
       {
-          osc[1]->process_block(noteShiftFromPitchParam((scene->osc[1].keytrack.val.b ? state.pitch : ktrkroot + state.scenepbpitch) +
-                                                        octaveSize * scene->osc[1].octave.val.i,
-                                                        1), drift, is_wide);
+          osc[1]->process_block(oscPitch(1), drift, is_wide);
       }
 
-      if (osc2)
+      if (oscHeard[1])
       {
          if (is_wide)
          {
-            osclevels[le_osc2].multiply_2_blocks_to(osc[1]->output, osc[1]->outputR, tblock, tblockR, BLOCK_SIZE_OS_QUAD);
+            osclevels[le_osc2].multiply_2_blocks_to(osc[1]->output, osc[1]->outputR, tblock, tblockR, storage->blockSizeOSQuad);
          }
          else
          {
-            osclevels[le_osc2].multiply_block_to(osc[1]->output, tblock, BLOCK_SIZE_OS_QUAD);
+            osclevels[le_osc2].multiply_block_to(osc[1]->output, tblock, storage->blockSizeOSQuad);
          }
 
          if (route[1] < 2)
          {
-            accumulate_block(tblock, output[0], BLOCK_SIZE_OS_QUAD);
+            accumulate_block(tblock, output[0], storage->blockSizeOSQuad);
          }
          if (route[1] > 0)
          {
-            accumulate_block(tblockR, output[1], BLOCK_SIZE_OS_QUAD);
+            accumulate_block(tblockR, output[1], storage->blockSizeOSQuad);
          }
       }
    }
 
-   if (osc1 || ring12)
+   else if (oscRenders(1))
+   {
+      skipOsc(1, FMmode == fm_3to2to1);
+   }
+
+   if (oscActive[0])
    {
       if (FMmode == fm_2and3to1)
       {
-         add_block(osc[1]->output, osc[2]->output, fmbuffer, BLOCK_SIZE_OS_QUAD);
-         osc[0]->process_block(noteShiftFromPitchParam((scene->osc[0].keytrack.val.b ? state.pitch : ktrkroot + state.scenepbpitch) +
-                                                       octaveSize * scene->osc[0].octave.val.i, 0), drift, is_wide, true,
-                                                       db_to_linear(localcopy[scene->fm_depth.param_id_in_scene].f));
+         add_block(osc[1]->output, osc[2]->output, fmbuffer, storage->blockSizeOSQuad);
+         osc[0]->process_block(oscPitch(0), drift, is_wide, true, fmdepth);
       }
       else if (FMmode)
       {
-          osc[0]->process_block(noteShiftFromPitchParam((scene->osc[0].keytrack.val.b ? state.pitch : ktrkroot + state.scenepbpitch) +
-                                                        octaveSize * scene->osc[0].octave.val.i, 0), drift, is_wide, true,
-                                                        db_to_linear(localcopy[scene->fm_depth.param_id_in_scene].f));
+          osc[0]->process_block(oscPitch(0), drift, is_wide, true, fmdepth);
       }
-      else
-      {        
-         osc[0]->process_block(noteShiftFromPitchParam((scene->osc[0].keytrack.val.b ? state.pitch : ktrkroot + state.scenepbpitch) +
-                                                       octaveSize * scene->osc[0].octave.val.i, 0), drift, is_wide);
+      else if (!oscPrerendered[0])
+      {
+         osc[0]->process_block(oscPitch(0), drift, is_wide);
       }
 
-      if (osc1)
+      if (oscHeard[0])
       {
          if (is_wide)
          {
-            osclevels[le_osc1].multiply_2_blocks_to(osc[0]->output, osc[0]->outputR, tblock, tblockR, BLOCK_SIZE_OS_QUAD);
+            osclevels[le_osc1].multiply_2_blocks_to(osc[0]->output, osc[0]->outputR, tblock, tblockR, storage->blockSizeOSQuad);
          }
          else
          {
-            osclevels[le_osc1].multiply_block_to(osc[0]->output, tblock, BLOCK_SIZE_OS_QUAD);
+            osclevels[le_osc1].multiply_block_to(osc[0]->output, tblock, storage->blockSizeOSQuad);
          }
 
          if (route[0] < 2)
          {
-            accumulate_block(tblock, output[0], BLOCK_SIZE_OS_QUAD);
+            accumulate_block(tblock, output[0], storage->blockSizeOSQuad);
          }
          if (route[0] > 0)
          {
-            accumulate_block(tblockR, output[1], BLOCK_SIZE_OS_QUAD);
+            accumulate_block(tblockR, output[1], storage->blockSizeOSQuad);
          }
       }
    }
 
-   if (ring12)
+   else if (oscRenders(0))
+   {
+      if (FMmode == fm_2and3to1)
+         add_block(osc[1]->output, osc[2]->output, fmbuffer, storage->blockSizeOSQuad);
+      skipOsc(0, FMmode != fm_off);
+   }
+
+   if (ring12Heard)
    {
       if (is_wide)
       {
-         mul_block(osc[0]->output, osc[1]->output, tblock, BLOCK_SIZE_OS_QUAD);
-         mul_block(osc[0]->outputR, osc[1]->outputR, tblockR, BLOCK_SIZE_OS_QUAD);
-         osclevels[le_ring12].multiply_2_blocks(tblock, tblockR, BLOCK_SIZE_OS_QUAD);
+         mul_block(osc[0]->output, osc[1]->output, tblock, storage->blockSizeOSQuad);
+         mul_block(osc[0]->outputR, osc[1]->outputR, tblockR, storage->blockSizeOSQuad);
+         osclevels[le_ring12].multiply_2_blocks(tblock, tblockR, storage->blockSizeOSQuad);
       }
       else
       {
-         mul_block(osc[0]->output, osc[1]->output, tblock, BLOCK_SIZE_OS_QUAD);
-         osclevels[le_ring12].multiply_block(tblock, BLOCK_SIZE_OS_QUAD);
+         mul_block(osc[0]->output, osc[1]->output, tblock, storage->blockSizeOSQuad);
+         osclevels[le_ring12].multiply_block(tblock, storage->blockSizeOSQuad);
       }
 
       if (route[3] < 2)
       {
-         accumulate_block(tblock, output[0], BLOCK_SIZE_OS_QUAD);
+         accumulate_block(tblock, output[0], storage->blockSizeOSQuad);
       }
       if (route[3] > 0)
       {
-         accumulate_block(tblockR, output[1], BLOCK_SIZE_OS_QUAD);
+         accumulate_block(tblockR, output[1], storage->blockSizeOSQuad);
       }
    }
 
-   if (ring23)
+   if (ring23Heard)
    {
       if (is_wide)
       {
-         mul_block(osc[1]->output, osc[2]->output, tblock, BLOCK_SIZE_OS_QUAD);
-         mul_block(osc[1]->outputR, osc[2]->outputR, tblockR, BLOCK_SIZE_OS_QUAD);
-         osclevels[le_ring23].multiply_2_blocks(tblock, tblockR, BLOCK_SIZE_OS_QUAD);
+         mul_block(osc[1]->output, osc[2]->output, tblock, storage->blockSizeOSQuad);
+         mul_block(osc[1]->outputR, osc[2]->outputR, tblockR, storage->blockSizeOSQuad);
+         osclevels[le_ring23].multiply_2_blocks(tblock, tblockR, storage->blockSizeOSQuad);
       }
       else
       {
-         mul_block(osc[1]->output, osc[2]->output, tblock, BLOCK_SIZE_OS_QUAD);
-         osclevels[le_ring23].multiply_block(tblock, BLOCK_SIZE_OS_QUAD);
+         mul_block(osc[1]->output, osc[2]->output, tblock, storage->blockSizeOSQuad);
+         osclevels[le_ring23].multiply_block(tblock, storage->blockSizeOSQuad);
       }
 
       if (route[4] < 2)
       {
-         accumulate_block(tblock, output[0], BLOCK_SIZE_OS_QUAD);
+         accumulate_block(tblock, output[0], storage->blockSizeOSQuad);
       }
       if (route[4] > 0)
       {
-         accumulate_block(tblockR, output[1], BLOCK_SIZE_OS_QUAD);
+         accumulate_block(tblockR, output[1], storage->blockSizeOSQuad);
       }
    }
 
-   if (noise)
+   if (noiseHeard)
    {
       float noisecol = limit_range(localcopy[scene->noise_colour.param_id_in_scene].f, -1.f, 1.f);
-      for (int i = 0; i < BLOCK_SIZE_OS; i += 2)
+      for (int i = 0; i < storage->blockSizeOS; i += 2)
       {
          ((float*)tblock)[i] = correlated_noise_o2mk2(noisegenL[0], noisegenL[1], noisecol);
          ((float*)tblock)[i + 1] = ((float*)tblock)[i];
@@ -894,33 +1052,36 @@ bool SurgeVoice::process_block(QuadFilterChainState& Q, int Qe)
 
       if (is_wide)
       {
-         osclevels[le_noise].multiply_2_blocks(tblock, tblockR, BLOCK_SIZE_OS_QUAD);
+         osclevels[le_noise].multiply_2_blocks(tblock, tblockR, storage->blockSizeOSQuad);
       }
       else
       {
-         osclevels[le_noise].multiply_block(tblock, BLOCK_SIZE_OS_QUAD);
+         osclevels[le_noise].multiply_block(tblock, storage->blockSizeOSQuad);
       }
 
       if (route[5] < 2)
       {
-         accumulate_block(tblock, output[0], BLOCK_SIZE_OS_QUAD);
+         accumulate_block(tblock, output[0], storage->blockSizeOSQuad);
       }
       if (route[5] > 0)
       {
-         accumulate_block(tblockR, output[1], BLOCK_SIZE_OS_QUAD);
+         accumulate_block(tblockR, output[1], storage->blockSizeOSQuad);
       }
    }
 
    // pre-filter gain
-   osclevels[le_pfg].multiply_2_blocks(output[0], output[1], BLOCK_SIZE_OS_QUAD);
+   osclevels[le_pfg].multiply_2_blocks(output[0], output[1], storage->blockSizeOSQuad);
 
-   for (int i = 0; i < BLOCK_SIZE_OS; i++)
+   for (int i = 0; i < storage->blockSizeOS; i++)
    {
       _mm_store_ss(((float*)&Q.DL[i] + Qe), _mm_load_ss(&output[0][i]));
       _mm_store_ss(((float*)&Q.DR[i] + Qe), _mm_load_ss(&output[1][i]));
    }
    SetQFB(&Q, Qe);
 
+   for (int i = 0; i < n_oscs; i++)
+      oscPrerendered[i] = false;
+
    age++;
    if (!state.gate)
       age_release++;
@@ -942,6 +1103,12 @@ void SurgeVoice::set_path(
 
 void SurgeVoice::SetQFB(QuadFilterChainState* Q, int e) // Q == 0 means init(ialise)
 {
+   // Left in this lane by GetQFB(true) and not touched since. The units 2 and 3 registers are
+   // only kept when the block was wide then too.
+   bool inLane = qfbInLane && Q && Q == fbq && e == fbqi;
+   bool wideInLane = inLane && qfbConfig == fc_wide;
+   qfbInLane = false;
+
    fbq = Q;
    fbqi = e;
 
@@ -971,15 +1138,15 @@ void SurgeVoice::SetQFB(QuadFilterChainState* Q, int e) // Q == 0 means init(ial
    if (Q)
    {
       set1f(Q->Gain, e, FBP.Gain);
-      set1f(Q->dGain, e, (Gain - FBP.Gain) * BLOCK_SIZE_OS_INV);
+      set1f(Q->dGain, e, (Gain - FBP.Gain) * storage->blockSizeOSInv);
       set1f(Q->Drive, e, FBP.Drive);
-      set1f(Q->dDrive, e, (Drive - FBP.Drive) * BLOCK_SIZE_OS_INV);
+      set1f(Q->dDrive, e, (Drive - FBP.Drive) * storage->blockSizeOSInv);
       set1f(Q->FB, e, FBP.FB);
-      set1f(Q->dFB, e, (FB - FBP.FB) * BLOCK_SIZE_OS_INV);
+      set1f(Q->dFB, e, (FB - FBP.FB) * storage->blockSizeOSInv);
       set1f(Q->Mix1, e, FBP.Mix1);
-      set1f(Q->dMix1, e, (FMix1 - FBP.Mix1) * BLOCK_SIZE_OS_INV);
+      set1f(Q->dMix1, e, (FMix1 - FBP.Mix1) * storage->blockSizeOSInv);
       set1f(Q->Mix2, e, FBP.Mix2);
-      set1f(Q->dMix2, e, (FMix2 - FBP.Mix2) * BLOCK_SIZE_OS_INV);
+      set1f(Q->dMix2, e, (FMix2 - FBP.Mix2) * storage->blockSizeOSInv);
    }
 
    FBP.Gain = Gain;
@@ -991,9 +1158,12 @@ void SurgeVoice::SetQFB(QuadFilterChainState* Q, int e) // Q == 0 means init(ial
    // filterunits
    if (Q)
    {
-      set1f(Q->wsLPF, e, FBP.wsLPF); // remember state
-      set1f(Q->FBlineL, e, FBP.FBlineL);
-      set1f(Q->FBlineR, e, FBP.FBlineR);
+      if (!inLane)
+      {
+         set1f(Q->wsLPF, e, FBP.wsLPF); // remember state
+         set1f(Q->FBlineL, e, FBP.FBlineL);
+         set1f(Q->FBlineR, e, FBP.FBlineR);
+      }
       Q->FU[0].active[e] = 0xffffffff;
       Q->FU[1].active[e] = 0xffffffff;
       Q->FU[2].active[e] = 0xffffffff;
@@ -1009,29 +1179,42 @@ void SurgeVoice::SetQFB(QuadFilterChainState* Q, int e) // Q == 0 means init(ial
       if (scene->f2_cutoff_is_offset.val.b)
          cutoffB += cutoffA;
 
-      CM[0].MakeCoeffs(cutoffA, localcopy[id_resoa].f, scene->filterunit[0].type.val.i,
-                       scene->filterunit[0].subtype.val.i, storage);
-      CM[1].MakeCoeffs(
-          cutoffB, scene->f2_link_resonance.val.b ? localcopy[id_resoa].f : localcopy[id_resob].f,
-          scene->filterunit[1].type.val.i, scene->filterunit[1].subtype.val.i, storage);
+      CMfreq[0] = cutoffA;
+      CMfreq[1] = cutoffB;
+      CMreso[0] = localcopy[id_resoa].f;
+      CMreso[1] = scene->f2_link_resonance.val.b ? localcopy[id_resoa].f : localcopy[id_resob].f;
+
+      // Otherwise makeQuadFilterCoefficients makes them
+      bool makeCoeffs = !storage->quadFilterCoefficients;
+      if (makeCoeffs)
+      {
+         auto memo = filterCoefficientMemo();
+         CM[0].MakeCoeffs(CMfreq[0], CMreso[0], scene->filterunit[0].type.val.i,
+                          scene->filterunit[0].subtype.val.i, storage, memo);
+         CM[1].MakeCoeffs(CMfreq[1], CMreso[1], scene->filterunit[1].type.val.i,
+                          scene->filterunit[1].subtype.val.i, storage, memo);
+      }
 
       for (int u = 0; u < n_filterunits_per_scene; u++)
       {
          if (scene->filterunit[u].type.val.i != 0)
          {
-            for (int i = 0; i < n_cm_coeffs; i++)
+            for (int i = 0; makeCoeffs && i < n_cm_coeffs; i++)
             {
                set1f(Q->FU[u].C[i], e, CM[u].C[i]);
                set1f(Q->FU[u].dC[i], e, CM[u].dC[i]);
             }
 
-            for (int i = 0; i < n_filter_registers; i++)
+            if (!inLane)
             {
-               set1f(Q->FU[u].R[i], e, FBP.FU[u].R[i]);
-            }
+               for (int i = 0; i < n_filter_registers; i++)
+               {
+                  set1f(Q->FU[u].R[i], e, FBP.FU[u].R[i]);
+               }
 
-            Q->FU[u].DB[e] = FBP.Delay[u];
-            Q->FU[u].WP[e] = FBP.FU[u].WP;
+               Q->FU[u].DB[e] = FBP.Delay[u];
+               Q->FU[u].WP[e] = FBP.FU[u].WP;
+            }
             switch(scene->filterunit[u].type.val.i){
                case fut_lpmoog:
                case fut_diode:
@@ -1057,19 +1240,22 @@ void SurgeVoice::SetQFB(QuadFilterChainState* Q, int e) // Q == 0 means init(ial
 
             if (scene->filterblock_configuration.val.i == fc_wide)
             {
-               for (int i = 0; i < n_cm_coeffs; i++)
+               for (int i = 0; makeCoeffs && i < n_cm_coeffs; i++)
                {
                   set1f(Q->FU[u + 2].C[i], e, CM[u].C[i]);
                   set1f(Q->FU[u + 2].dC[i], e, CM[u].dC[i]);
                }
 
-               for (int i = 0; i < n_filter_registers; i++)
+               if (!wideInLane)
                {
-                  set1f(Q->FU[u + 2].R[i], e, FBP.FU[u + 2].R[i]);
-               }
+                  for (int i = 0; i < n_filter_registers; i++)
+                  {
+                     set1f(Q->FU[u + 2].R[i], e, FBP.FU[u + 2].R[i]);
+                  }
 
-               Q->FU[u + 2].DB[e] = FBP.Delay[u + 2];
-               Q->FU[u + 2].WP[e] = FBP.FU[u].WP;
+                  Q->FU[u + 2].DB[e] = FBP.Delay[u + 2];
+                  Q->FU[u + 2].WP[e] = FBP.FU[u].WP;
+               }
 
                switch(scene->filterunit[u].type.val.i){
                   case fut_lpmoog:
@@ -1095,21 +1281,108 @@ void SurgeVoice::SetQFB(QuadFilterChainState* Q, int e) // Q == 0 means init(ial
    }
 }
 
-void SurgeVoice::GetQFB()
+FilterCoefficientMemo* SurgeVoice::filterCoefficientMemo()
 {
-   for (int u = 0; u < n_filterunits_per_scene; u++)
+   return storage->memoizeFilterCoefficients
+              ? storage->filterCoefficientMemo[state.scene_id].get()
+              : nullptr;
+}
+
+void SurgeVoice::makeQuadFilterCoefficients(QuadFilterChainState& Q, SurgeVoice** voices, int n)
+{
+   /*
+   ** With the scenes co-packed the quad where they meet holds voices of both. Each scene's lanes
+   ** are made with its own filter settings and memo, and only those lanes are kept.
+   */
+   int sceneA = voices[0]->state.scene_id, split = n;
+   for (int e = 1; e < n; e++)
    {
-      if (scene->filterunit[u].type.val.i != 0)
+      if (voices[e]->state.scene_id != sceneA)
       {
-         for (int i = 0; i < n_filter_registers; i++)
+         split = e;
+         break;
+      }
+   }
+
+   for (int from = 0; from < n; from = split, split = n)
+   {
+      bool whole = from == 0 && split == n;
+      SurgeVoice* first = voices[from];
+      SurgeSceneStorage* scene = first->scene;
+      FilterCoefficientMaker* cm[4];
+      float freq alignas(16)[4], reso alignas(16)[4];
+      uint32_t lane alignas(16)[4];
+      for (int e = 0; e < 4; e++)
+         lane[e] = (e >= from && e < split) ? 0xffffffff : 0;
+      __m128 keep = _mm_load_ps((float*)lane);
+
+      for (int u = 0; u < n_filterunits_per_scene; u++)
+      {
+         int type = scene->filterunit[u].type.val.i;
+         if (type == 0)
+            continue;
+
+         for (int e = 0; e < 4; e++)
          {
-            FBP.FU[u].R[i] = get1f(fbq->FU[u].R[i], fbqi);
+            // The other lanes are left out; give them a voice's values to keep the math tame
+            SurgeVoice* v = lane[e] ? voices[e] : first;
+            cm[e] = lane[e] ? &v->CM[u] : nullptr;
+            freq[e] = v->CMfreq[u];
+            reso[e] = v->CMreso[u];
          }
 
+         __m128 C[n_cm_coeffs], dC[n_cm_coeffs];
+         FilterCoefficientMaker::MakeQuadCoeffs(cm, split, _mm_load_ps(freq), _mm_load_ps(reso),
+                                                type, scene->filterunit[u].subtype.val.i,
+                                                first->storage, whole ? Q.FU[u].C : C,
+                                                whole ? Q.FU[u].dC : dC,
+                                                first->filterCoefficientMemo());
+
+         for (int i = 0; !whole && i < n_cm_coeffs; i++)
+         {
+            Q.FU[u].C[i] = _mm_or_ps(_mm_and_ps(keep, C[i]), _mm_andnot_ps(keep, Q.FU[u].C[i]));
+            Q.FU[u].dC[i] =
+                _mm_or_ps(_mm_and_ps(keep, dC[i]), _mm_andnot_ps(keep, Q.FU[u].dC[i]));
+         }
+
+         if (scene->filterblock_configuration.val.i == fc_wide)
+         {
+            for (int i = 0; i < n_cm_coeffs; i++)
+            {
+               if (whole)
+               {
+                  Q.FU[u + 2].C[i] = Q.FU[u].C[i];
+                  Q.FU[u + 2].dC[i] = Q.FU[u].dC[i];
+                  continue;
+               }
+               Q.FU[u + 2].C[i] = _mm_or_ps(_mm_and_ps(keep, C[i]),
+                                            _mm_andnot_ps(keep, Q.FU[u + 2].C[i]));
+               Q.FU[u + 2].dC[i] = _mm_or_ps(_mm_and_ps(keep, dC[i]),
+                                             _mm_andnot_ps(keep, Q.FU[u + 2].dC[i]));
+            }
+         }
+      }
+   }
+}
+
+void SurgeVoice::GetQFB(bool keepInLane)
+{
+   for (int u = 0; u < n_filterunits_per_scene; u++)
+   {
+      if (scene->filterunit[u].type.val.i != 0)
+      {
          for (int i = 0; i < n_cm_coeffs; i++)
          {
             CM[u].C[i] = get1f(fbq->FU[u].C[i], fbqi);
          }
+
+         if (keepInLane)
+            continue;
+
+         for (int i = 0; i < n_filter_registers; i++)
+         {
+            FBP.FU[u].R[i] = get1f(fbq->FU[u].R[i], fbqi);
+         }
          FBP.FU[u].WP = fbq->FU[u].WP[fbqi];
 
          if (scene->filterblock_configuration.val.i == fc_wide)
@@ -1121,6 +1394,12 @@ void SurgeVoice::GetQFB()
          }
       }
    }
+
+   qfbInLane = keepInLane;
+   qfbConfig = scene->filterblock_configuration.val.i;
+   if (keepInLane)
+      return;
+
    FBP.FBlineL = get1f(fbq->FBlineL, fbqi);
    FBP.FBlineR = get1f(fbq->FBlineR, fbqi);
    FBP.wsLPF = get1f(fbq->wsLPF, fbqi);
@@ -1128,9 +1407,11 @@ void SurgeVoice::GetQFB()
 
 void SurgeVoice::freeAllocatedElements()
 {
-   for(int i=0;i<3;++i)
+   for (int i = 0; i < n_oscs; ++i)
    {
-      osc[i].reset(nullptr);
+      if (osc[i])
+         osc[i]->~Oscillator();
+      osc[i] = nullptr;
       osctype[i] = -1;
    }
 }
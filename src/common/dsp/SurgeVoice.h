@@ -29,10 +29,10 @@ struct QuadFilterChainState;
 class alignas(16) SurgeVoice
 {
 public:
-   float output alignas(16)[2][BLOCK_SIZE_OS];
+   float output alignas(16)[2][BLOCK_SIZE_OS_MAX];
    lipol_ps osclevels alignas(16)[7];
    pdata localcopy alignas(16)[n_scene_params];
-   float fmbuffer alignas(16)[BLOCK_SIZE_OS];
+   float fmbuffer alignas(16)[BLOCK_SIZE_OS_MAX];
 
    // used for the 2>1<3 FM-mode (Needs the pointer earlier)
 
@@ -57,10 +57,55 @@ public:
    void uber_release();
 
    bool process_block(QuadFilterChainState&, int);
-   void GetQFB(); // Get the updated registers from the QuadFB
+
+   /*
+   ** process_block is prepare_block then render_block. The synth can instead prepare all of a
+   ** scene's voices, call prerenderFMOscillators to run their FM2 and FM3 oscillators four
+   ** voices at a time (see FMOperatorQuad.h), then render them. render_block skips the
+   ** oscillators which were prerendered. Oscillators which take FM from another one aren't.
+   */
+   void prepare_block(QuadFilterChainState&, int);
+   bool render_block(QuadFilterChainState&, int);
+   static void prerenderFMOscillators(SurgeVoice** voices, int n);
+
+   /*
+   ** Step the LFOs and envelopes of n of a scene's voices ahead of their prepare_block, the
+   ** envelopes four voices at a time (see AdsrEnvelope::process_block_quad). They only read the
+   ** previous block's modulated parameters, so calc_ctrldata then just skips them.
+   */
+   static void prerenderModulators(SurgeVoice** voices, int n);
+
+   /*
+   ** With SurgeStorage::quadFilterCoefficients set, calc_ctrldata leaves the filter units'
+   ** coefficients to this, which makes them for the n voices in a quad's lanes at once (see
+   ** FilterCoefficientMaker::MakeQuadCoeffs). Call it once the voices have been processed and
+   ** before the quad is.
+   */
+   static void makeQuadFilterCoefficients(QuadFilterChainState& Q, SurgeVoice** voices, int n);
+   /*
+   ** Get the updated registers from the QuadFB. With keepInLane the registers are left in the
+   ** voice's lane instead (only the coefficients come back), and SetQFB doesn't copy them in
+   ** again if the voice gets the same lane next block. A voice which then moves has to call
+   ** GetQFB() before its old lane is written; FilterLaneScheduler::schedule does.
+   */
+   void GetQFB(bool keepInLane = false);
+   bool filterStateInLane() const { return qfbInLane; }
+   const QuadFilterChainState* filterLaneQuad() const { return fbq; }
+   int filterLaneIndex() const { return fbqi; }
    void legato(int key, int velocity, char detune);
    void switch_toggled();
    void freeAllocatedElements();
+
+   /*
+   ** The routings modulating the voice: the ones the audio thread acquired for this block, unless
+   ** a gapless patch switch has left the voice playing out the patch it replaced, whose routings
+   ** it then keeps (see SurgeStorage::outgoingModRouting).
+   */
+   const ModRoutingSnapshot* modRouting() const
+   {
+      return outgoingRouting ? outgoingRouting : storage->audioModRouting();
+   }
+   const ModRoutingSnapshot* outgoingRouting = nullptr;
    int osctype[n_oscs];
    SurgeVoiceState state;
    int age, age_release;
@@ -141,6 +186,8 @@ public:
    
 private:
    template <bool first> void calc_ctrldata(QuadFilterChainState*, int);
+   void process_lfos();
+   bool modulatorsPrerendered = false;
    void update_portamento();
    void set_path(bool osc1, bool osc2, bool osc3, int FMmode, bool ring12, bool ring23, bool noise);
    int routefilter(int);
@@ -149,8 +196,10 @@ private:
 
    // Filterblock state storage
    void SetQFB(QuadFilterChainState*, int); // Set the parameters & registers
-   QuadFilterChainState* fbq;
-   int fbqi;
+   QuadFilterChainState* fbq = nullptr;
+   int fbqi = 0;
+   bool qfbInLane = false;
+   int qfbConfig = -1; // the filterblock configuration when the registers were left in the lane
 
    struct
    {
@@ -164,6 +213,9 @@ private:
       } FU[4];
    } FBP;
    FilterCoefficientMaker CM[2];
+   // The cutoff and resonance of this block, for makeQuadFilterCoefficients
+   float CMfreq[2], CMreso[2];
+   FilterCoefficientMemo* filterCoefficientMemo();
 
    // data
    int lag_id[8], pitch_id, octave_id, volume_id, pan_id, width_id;
@@ -178,7 +230,20 @@ private:
    int FMmode;
    float noisegenL[2], noisegenR[2];
 
-   std::unique_ptr<Oscillator> osc[3];
+   // The oscillators are constructed in oscbuffer (see spawn_osc) so starting a voice or
+   // switching oscillator type doesn't allocate
+   Oscillator* osc[n_oscs];
+   bool oscPrerendered[n_oscs] = {false};
+   bool oscRenders(int i) const;
+
+   // Which of the oscillators the path uses have to be rendered this block, and which of the
+   // outputs are mixed in, worked out by update_osc_activity once the levels are known
+   void update_osc_activity();
+   bool oscActive[n_oscs] = {false}, oscHeard[n_oscs] = {false};
+   bool ring12Heard = false, ring23Heard = false, noiseHeard = false;
+   bool oscTakesFM(int i) const;
+   float oscPitch(int i);
+   unsigned char oscbuffer alignas(16)[n_oscs][oscillator_buffer_size];
 
    std::array<ModulationSource*, n_modsources> modsources;
 
@@ -0,0 +1,194 @@
+/*
+** Surge Synthesizer is Free and Open Source Software
+**
+** Surge is made available under the Gnu General Public License, v3.0
+** https://www.gnu.org/licenses/gpl-3.0.en.html
+**
+** Copyright 2004-2020 by various individuals as described by the Git transaction log
+**
+** All source at: https://github.com/surge-synthesizer/surge.git
+**
+** Surge was a commercial product from 2004-2018, with Copyright and ownership
+** in that period held by Claes Johanson at Vember Audio. Claes made Surge
+** open source in September 2018.
+*/
+
+#pragma once
+
+#include "globals.h"
+#include "SurgeVoice.h"
+#include <cstdint>
+#include <cstring>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+static_assert(MAX_VOICES <= 64, "SurgeVoiceTable keeps one bit per voice in a uint64_t");
+
+/*
+** SurgeVoiceTable is the per-scene list of playing voices. It replaces a std::list<SurgeVoice*>
+** so that it behaves like one where the synth cares (iteration in the order voices were
+** started, erase-while-iterating, range-for over SurgeVoice*) but never allocates.
+**
+** The voices themselves live in a fixed array of MAX_VOICES slots owned by the synth and never
+** move. The table keeps
+**
+**  - activeMask, with a bit per slot in use, so finding a free slot is a single bit scan
+**  - releasedMask and uberReleasedMask, tracking voices which have been released or
+**    uber-released through release() and uberRelease() so the polyphony counts are popcounts
+**  - order, the slot indices of the active voices from oldest to newest. That's the order
+**    the quad filter lanes are packed in and the order polyphony limiting steals in.
+**  - voiceOrder per slot, the synth's voiceCounter at the time the voice started
+**  - reservedMask, slots this table mustn't hand out because the voice in them is held by
+**    another table over the same array (the voices a gapless patch switch is fading out)
+*/
+class SurgeVoiceTable
+{
+public:
+   class iterator
+   {
+   public:
+      iterator() : table(nullptr), pos(0) {}
+      iterator(const SurgeVoiceTable* t, int p) : table(t), pos(p) {}
+      SurgeVoice* operator*() const { return table->slotVoice(table->order[pos]); }
+      iterator& operator++()
+      {
+         ++pos;
+         return *this;
+      }
+      iterator operator++(int)
+      {
+         iterator r = *this;
+         ++pos;
+         return r;
+      }
+      bool operator==(const iterator& o) const { return pos == o.pos && table == o.table; }
+      bool operator!=(const iterator& o) const { return !(*this == o); }
+
+   private:
+      const SurgeVoiceTable* table;
+      int pos;
+      friend class SurgeVoiceTable;
+   };
+   typedef iterator const_iterator;
+
+   void assignSlots(SurgeVoice* s)
+   {
+      slots = s;
+      clear();
+   }
+
+   /*
+   ** Claim the lowest free slot and append it as the newest voice. The caller placement-news
+   ** the voice into the returned storage. Returns nullptr if every slot is in use.
+   */
+   SurgeVoice* allocate(int64_t voiceOrderValue)
+   {
+      uint64_t freeSlots = ~(activeMask | reservedMask) & allSlots;
+      if (count >= MAX_VOICES || !freeSlots)
+         return nullptr;
+
+      int slot = lowestBit(freeSlots);
+      uint64_t bit = (uint64_t)1 << slot;
+      activeMask |= bit;
+      releasedMask &= ~bit;
+      uberReleasedMask &= ~bit;
+      voiceOrder[slot] = voiceOrderValue;
+      order[count++] = (uint8_t)slot;
+      return slotVoice(slot);
+   }
+
+   iterator erase(iterator it)
+   {
+      int slot = order[it.pos];
+      uint64_t bit = (uint64_t)1 << slot;
+      activeMask &= ~bit;
+      releasedMask &= ~bit;
+      uberReleasedMask &= ~bit;
+      memmove(&order[it.pos], &order[it.pos + 1], count - it.pos - 1);
+      count--;
+      return it; // the next voice has moved into this position
+   }
+
+   void clear()
+   {
+      activeMask = 0;
+      releasedMask = 0;
+      uberReleasedMask = 0;
+      count = 0;
+   }
+
+   /*
+   ** Release voices through the table rather than on the voice directly so the masks stay
+   ** in sync with the voice state
+   */
+   void release(SurgeVoice* v)
+   {
+      v->release();
+      releasedMask |= (uint64_t)1 << slotOf(v);
+   }
+
+   void uberRelease(SurgeVoice* v)
+   {
+      v->uber_release();
+      uint64_t bit = (uint64_t)1 << slotOf(v);
+      releasedMask |= bit;
+      uberReleasedMask |= bit;
+   }
+
+   iterator begin() const { return iterator(this, 0); }
+   iterator end() const { return iterator(this, count); }
+   bool empty() const { return count == 0; }
+   int size() const { return count; }
+
+   int slotOf(const SurgeVoice* v) const { return (int)(v - slots); }
+   int64_t voiceOrderOf(const SurgeVoice* v) const { return voiceOrder[slotOf(v)]; }
+
+   int nonReleasedCount() const { return popcount(activeMask & ~releasedMask); }
+   int nonUberReleasedCount() const { return popcount(activeMask & ~uberReleasedMask); }
+
+   uint64_t activeMask = 0, releasedMask = 0, uberReleasedMask = 0, reservedMask = 0;
+
+private:
+   static constexpr uint64_t allSlots = ~(uint64_t)0 >> (64 - MAX_VOICES);
+
+   SurgeVoice* slotVoice(int slot) const { return &slots[slot]; }
+
+   static inline int lowestBit(uint64_t m)
+   {
+#if defined(_MSC_VER) && defined(_WIN64)
+      unsigned long idx;
+      _BitScanForward64(&idx, m);
+      return (int)idx;
+#elif defined(_MSC_VER)
+      unsigned long idx;
+      if (_BitScanForward(&idx, (unsigned long)(m & 0xFFFFFFFF)))
+         return (int)idx;
+      _BitScanForward(&idx, (unsigned long)(m >> 32));
+      return (int)idx + 32;
+#else
+      return __builtin_ctzll(m);
+#endif
+   }
+
+   static inline int popcount(uint64_t m)
+   {
+#if defined(_MSC_VER)
+      int c = 0;
+      while (m)
+      {
+         m &= m - 1;
+         c++;
+      }
+      return c;
+#else
+      return __builtin_popcountll(m);
+#endif
+   }
+
+   SurgeVoice* slots = nullptr;
+   int count = 0;
+   uint8_t order[MAX_VOICES];
+   int64_t voiceOrder[MAX_VOICES];
+};
@@ -0,0 +1,89 @@
+/*
+** Surge Synthesizer is Free and Open Source Software
+**
+** Surge is made available under the Gnu General Public License, v3.0
+** https://www.gnu.org/licenses/gpl-3.0.en.html
+**
+** Copyright 2004-2020 by various individuals as described by the Git transaction log
+**
+** All source at: https://github.com/surge-synthesizer/surge.git
+**
+** Surge was a commercial product from 2004-2018, with Copyright and ownership
+** in that period held by Claes Johanson at Vember Audio. Claes made Surge
+** open source in September 2018.
+*/
+
+#include "UnisonFrame.h"
+#include "util/SceneRandom.h"
+#include <cmath>
+#include <cstdlib>
+
+void UnisonFrame::step(float* lfo, float* lfo2, int n, float drift, float spread, float bias,
+                       float offset)
+{
+   this->n = n;
+
+   // As drift_noise
+   const float filter = 0.00001f;
+   const float m = 1.f / sqrt(filter);
+
+   float r alignas(16)[MAX_UNISON], l2 alignas(16)[MAX_UNISON];
+   for (int v = 0; v < MAX_UNISON; v++)
+   {
+      r[v] = v < n ? (((float)Surge::SceneRandom::rand() / (float)RAND_MAX) * 2.f - 1.f) : 0.f;
+      l2[v] = v < n ? lfo2[v] : 0.f;
+   }
+
+   const auto keep = _mm_set_ps1(1.f - filter), f = _mm_set_ps1(filter), mm = _mm_set_ps1(m),
+              md = _mm_set_ps1(drift), ms = _mm_set_ps1(spread), mb = _mm_set_ps1(bias),
+              mo = _mm_set_ps1(offset);
+   auto voice = _mm_set_ps(3.f, 2.f, 1.f, 0.f);
+
+   float l1 alignas(16)[MAX_UNISON];
+   for (int v = 0; v < n; v += 4)
+   {
+      auto s = _mm_add_ps(_mm_mul_ps(_mm_load_ps(l2 + v), keep), _mm_mul_ps(_mm_load_ps(r + v), f));
+      auto d = _mm_mul_ps(s, mm);
+      _mm_store_ps(l2 + v, s);
+      _mm_store_ps(l1 + v, d);
+      _mm_store_ps(detune + v, _mm_add_ps(_mm_mul_ps(md, d),
+                                          _mm_mul_ps(ms, _mm_add_ps(_mm_mul_ps(mb, voice), mo))));
+      voice = _mm_add_ps(voice, _mm_set_ps1(4.f));
+   }
+
+   for (int v = 0; v < n; v++)
+   {
+      lfo[v] = l1[v];
+      lfo2[v] = l2[v];
+   }
+}
+
+void UnisonFrame::lookup(const float* table, float mul, float add, float scale, float* out) const
+{
+   const auto mmul = _mm_set_ps1(mul), madd = _mm_set_ps1(add + 256.f), one = _mm_set_ps1(1.f),
+              mscale = _mm_set_ps1(scale);
+   const auto top = _mm_set1_epi32(0x1fe), wrap = _mm_set1_epi32(0x1ff);
+
+   for (int v = 0; v < n; v += 4)
+   {
+      auto x = _mm_add_ps(_mm_mul_ps(_mm_load_ps(detune + v), mmul), madd);
+      auto e = _mm_cvttps_epi32(x);
+      auto a = _mm_sub_ps(x, _mm_cvtepi32_ps(e));
+
+      // e = min(e, 0x1fe), without SSE4.1
+      auto over = _mm_cmpgt_epi32(e, top);
+      e = _mm_or_si128(_mm_and_si128(over, top), _mm_andnot_si128(over, e));
+
+      int e0 alignas(16)[4], e1 alignas(16)[4];
+      _mm_store_si128((__m128i*)e0, _mm_and_si128(e, wrap));
+      _mm_store_si128((__m128i*)e1, _mm_and_si128(_mm_add_epi32(e, _mm_set1_epi32(1)), wrap));
+      auto t0 = _mm_set_ps(table[e0[3]], table[e0[2]], table[e0[1]], table[e0[0]]);
+      auto t1 = _mm_set_ps(table[e1[3]], table[e1[2]], table[e1[1]], table[e1[0]]);
+
+      auto p = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(one, a), t0), _mm_mul_ps(a, t1));
+      float res alignas(16)[4];
+      _mm_store_ps(res, _mm_mul_ps(p, mscale));
+      for (int k = 0; k < 4 && v + k < n; k++)
+         out[v + k] = res[k];
+   }
+}
@@ -0,0 +1,45 @@
+/*
+** Surge Synthesizer is Free and Open Source Software
+**
+** Surge is made available under the Gnu General Public License, v3.0
+** https://www.gnu.org/licenses/gpl-3.0.en.html
+**
+** Copyright 2004-2020 by various individuals as described by the Git transaction log
+**
+** All source at: https://github.com/surge-synthesizer/surge.git
+**
+** Surge was a commercial product from 2004-2018, with Copyright and ownership
+** in that period held by Claes Johanson at Vember Audio. Claes made Surge
+** open source in September 2018.
+*/
+
+#pragma once
+
+#include "globals.h"
+
+/*
+** The classic, sine and wavetable oscillators set up their unison voices the same way each
+** block: every voice's drift LFO takes a step, the voice detunes by its drift plus its share of
+** the unison spread, and the detune goes through one of SurgeStorage's pitch tables to give an
+** omega or a time per cycle. UnisonFrame does that for all of an oscillator's voices in one pass,
+** four at a time. The random numbers for the drift LFOs are drawn in voice order, as the
+** drift_noise calls drew them, and the LFOs are stepped with the same arithmetic, so they don't
+** change; the detune and the table lookups are the same as the scalar code's up to rounding.
+*/
+struct UnisonFrame
+{
+   float detune alignas(16)[MAX_UNISON];
+   int n = 0;
+
+   /*
+   ** Step the n drift LFOs in lfo / lfo2 (the oscillator's driftlfo and driftlfo2) and set
+   ** detune[v] = drift * lfo[v] + spread * (bias * v + offset).
+   */
+   void step(float* lfo, float* lfo2, int n, float drift, float spread, float bias, float offset);
+
+   /*
+   ** out[v] = scale * table(detune[v] * mul + add), with table looked up and interpolated as
+   ** SurgeStorage::note_to_pitch does with its 512 entry tables.
+   */
+   void lookup(const float* table, float mul, float add, float scale, float* out) const;
+};
@@ -4,6 +4,14 @@
 #include <vt_dsp/basic_dsp.h>
 #include <vt_dsp/vt_dsp_endian.h>
 #include "SurgeStorage.h"
+#include "util/MappedFile.h"
+#include "util/WorkerSemaphore.h"
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 #if WINDOWS
 #include <intrin.h>
@@ -76,13 +84,518 @@ int GetWTIndex(int WaveIdx, int WaveSize, int NumWaves, int MipMap, int Padding
    return Index;
 }
 
+
+struct WavetableData
+{
+   WavetableData()
+   {
+      for (int i = 0; i < max_mipmap_levels; i++)
+         for (int j = 0; j < max_subtables; j++)
+            mipState[i][j].store(mip_missing, std::memory_order_relaxed);
+      memset(f32Tables, 0, sizeof(f32Tables));
+      memset(i16Tables, 0, sizeof(i16Tables));
+   }
+   ~WavetableData()
+   {
+      if (ownsSamples)
+      {
+         free(f32);
+         free(i16);
+      }
+   }
+
+   // calloc'ed, so the pages of mip levels which are never built, and of a float base level
+   // which is read straight from a mapped file, are never touched. Or, for a table found in the
+   // on-disk cache, the blocks in that file's mapping.
+   float* f32 = nullptr;
+   short* i16 = nullptr;
+   size_t samples = 0;
+   bool ownsSamples = true;
+
+   // The mapped file the tables point into: a .wt whose float base level is used in place, or
+   // an on-disk cache file
+   std::shared_ptr<void> mapping;
+
+   int size, size_po2, flags;
+   unsigned int n_tables;
+   float dt;
+   int levels;
+   bool lazy = false;
+
+   float* f32Tables[max_mipmap_levels][max_subtables];
+   short* i16Tables[max_mipmap_levels][max_subtables];
+
+   /*
+   ** The mip levels built so far. A lazily built table starts with only level 0; readers ask for
+   ** the level they want, which marks it requested, and use the nearest ready one below it until
+   ** the mipmap worker has built it. Levels are built in order, so the ready levels of a table
+   ** are always 0..k.
+   */
+   enum MipState : unsigned char
+   {
+      mip_missing = 0,
+      mip_requested,
+      mip_ready
+   };
+   std::atomic<unsigned char> mipState[max_mipmap_levels][max_subtables];
+   std::atomic<bool> hasRequests{false};
+   std::mutex buildMutex;
+
+   // Set for the worker to complete the levels and write them to the on-disk cache
+   std::atomic<bool> persist{false};
+   std::string persistTo;
+
+   uint64_t key[2];
+};
+
+namespace
+{
+struct WavetableKeyHash
+{
+   size_t operator()(const std::pair<uint64_t, uint64_t>& k) const
+   {
+      return (size_t)(k.first ^ (k.second * 0x9e3779b97f4a7c15ULL));
+   }
+};
+
+struct WavetableCache
+{
+   std::mutex mutex;
+   std::unordered_map<std::pair<uint64_t, uint64_t>, std::weak_ptr<WavetableData>,
+                      WavetableKeyHash>
+       tables;
+   WavetableCacheStats stats;
+   std::string mipmapCacheDirectory;
+};
+
+WavetableCache& wavetableCache()
+{
+   static WavetableCache cache;
+   return cache;
+}
+
+/*
+** Two independent 64 bit hashes over the source bytes, eight at a time. Not cryptographic,
+** but 128 bits of a decent mix makes a false match vanishingly unlikely for the few hundred
+** tables a process loads.
+*/
+inline uint64_t mix64(uint64_t x)
+{
+   x ^= x >> 33;
+   x *= 0xff51afd7ed558ccdULL;
+   x ^= x >> 33;
+   x *= 0xc4ceb9fe1a85ec53ULL;
+   x ^= x >> 33;
+   return x;
+}
+
+void contentKey(const void* wdata, size_t bytes, const wt_header& wh, bool AppendSilence,
+                uint64_t key[2])
+{
+   uint64_t h1 = 0x243f6a8885a308d3ULL, h2 = 0x13198a2e03707344ULL;
+   auto add = [&](uint64_t w) {
+      h1 = (h1 ^ w) * 0x100000001b3ULL;
+      h2 = mix64(h2 + w);
+   };
+
+   add(((uint64_t)vt_read_int32LE(wh.n_samples) << 32) | ((uint64_t)vt_read_int16LE(wh.n_tables) << 16) |
+       vt_read_int16LE(wh.flags));
+   add(AppendSilence ? 1 : 0);
+   add(bytes);
+
+   const unsigned char* p = (const unsigned char*)wdata;
+   size_t i = 0;
+   for (; i + 8 <= bytes; i += 8)
+   {
+      uint64_t w;
+      memcpy(&w, p + i, 8);
+      add(w);
+   }
+   uint64_t tail = 0;
+   memcpy(&tail, p + i, bytes - i);
+   add(tail);
+
+   key[0] = mix64(h1);
+   key[1] = h2;
+}
+
+void releaseWavetableData(WavetableData* d)
+{
+   {
+      auto& cache = wavetableCache();
+      std::lock_guard<std::mutex> g(cache.mutex);
+      auto it = cache.tables.find({d->key[0], d->key[1]});
+      if (it != cache.tables.end() && it->second.expired())
+         cache.tables.erase(it);
+      cache.stats.bytes -= d->samples * (sizeof(float) + sizeof(short));
+      cache.stats.tables--;
+   }
+   delete d;
+}
+
+void registerWavetableData(const std::shared_ptr<WavetableData>& d)
+{
+   auto& cache = wavetableCache();
+   std::lock_guard<std::mutex> g(cache.mutex);
+   cache.tables[{d->key[0], d->key[1]}] = d;
+   cache.stats.bytes += d->samples * (sizeof(float) + sizeof(short));
+   cache.stats.tables++;
+}
+
+//! Point every table at every level into the sample blocks, laid out by GetWTIndex
+void assignTablePointers(WavetableData& d)
+{
+   for (int j = 0; j < (int)d.n_tables; j++)
+   {
+      for (int l = 0; l < d.levels; l++)
+      {
+         d.f32Tables[l][j] = d.f32 + GetWTIndex(j, d.size, d.n_tables, l);
+         d.i16Tables[l][j] = d.i16 + GetWTIndex(j, d.size, d.n_tables, l,
+                                                FIRipolI16_N); // + padding for a "non-wrapping" interpolator
+      }
+      d.mipState[0][j].store(WavetableData::mip_ready, std::memory_order_relaxed);
+   }
+   for (int j = d.n_tables; j < min_F32_tables; j++) // W-TABLE need at least 3 tables to work properly
+   {
+      // These stay silent, and the blocks start out zeroed
+      unsigned int s = d.size;
+      int l = 0;
+      while (s && (l < max_mipmap_levels))
+      {
+         d.f32Tables[l][j] = d.f32 + GetWTIndex(j, d.size, d.n_tables, l);
+         d.mipState[l][j].store(WavetableData::mip_ready, std::memory_order_relaxed);
+         s = s >> 1;
+         l++;
+      }
+   }
+}
+
+/*
+** The on-disk mipmap cache. Each file is this header followed by the float and int16 sample
+** blocks exactly as they are laid out in memory, each 64 byte aligned, so a file is mapped and
+** pointed into as it is. The file name carries the content key and version, and the header has
+** to match what we expect byte for byte, down to the file size, or the file is ignored (and
+** rewritten). Bump mipmapCacheVersion whenever the mipmapping or the layout changes.
+*/
+const uint32_t mipmapCacheVersion = 1;
+
+struct MipmapCacheHeader
+{
+   char tag[4];
+   uint32_t version;
+   uint64_t key[2];
+   int32_t size, n_tables, flags, levels;
+   int32_t layout, reserved;
+   uint64_t samples, f32Offset, i16Offset, fileSize;
+};
+
+MipmapCacheHeader mipmapCacheHeader(const WavetableData& d)
+{
+   auto align = [](uint64_t x) { return (x + 63) & ~(uint64_t)63; };
+
+   MipmapCacheHeader h;
+   memset(&h, 0, sizeof(h));
+   memcpy(h.tag, "wtmc", 4);
+   h.version = mipmapCacheVersion;
+   h.key[0] = d.key[0];
+   h.key[1] = d.key[1];
+   h.size = d.size;
+   h.n_tables = d.n_tables;
+   h.flags = d.flags;
+   h.levels = d.levels;
+   h.layout = (FIRoffsetI16 << 16) | FIRipolI16_N;
+   h.samples = d.samples;
+   h.f32Offset = align(sizeof(MipmapCacheHeader));
+   h.i16Offset = align(h.f32Offset + d.samples * sizeof(float));
+   h.fileSize = h.i16Offset + d.samples * sizeof(short);
+   return h;
+}
+
+std::string mipmapCacheFile(const std::string& directory, const uint64_t key[2])
+{
+   char name[64];
+   snprintf(name, sizeof(name), "%016llx%016llx-%u.wtmip", (unsigned long long)key[0],
+            (unsigned long long)key[1], mipmapCacheVersion);
+   return directory + name;
+}
+
+//! Fill in d's samples from its cache file, if there is a good one
+bool loadCachedMipmaps(WavetableData& d, const std::string& file)
+{
+   size_t bytes = 0;
+   auto mapping = Surge::Util::mapFileReadOnly(file, bytes);
+   if (!mapping || bytes < sizeof(MipmapCacheHeader))
+      return false;
+
+   auto expected = mipmapCacheHeader(d);
+   if (memcmp(mapping.get(), &expected, sizeof(expected)) != 0 || bytes != expected.fileSize)
+      return false;
+
+   d.mapping = mapping;
+   d.ownsSamples = false;
+   d.f32 = (float*)((char*)mapping.get() + expected.f32Offset);
+   d.i16 = (short*)((char*)mapping.get() + expected.i16Offset);
+   assignTablePointers(d);
+   for (int l = 1; l < d.levels; l++)
+      for (int j = 0; j < (int)d.n_tables; j++)
+         d.mipState[l][j].store(WavetableData::mip_ready, std::memory_order_relaxed);
+   return true;
+}
+
+//! Write a table whose levels are all built. The file appears complete or not at all.
+bool writeCachedMipmaps(const WavetableData& d, const std::string& file)
+{
+   auto h = mipmapCacheHeader(d);
+   char suffix[32];
+   snprintf(suffix, sizeof(suffix), ".%p.tmp", (const void*)&d);
+   std::string tmp = file + suffix;
+
+   FILE* f = fopen(tmp.c_str(), "wb");
+   if (!f)
+      return false;
+
+   std::vector<char> zeros(64, 0);
+   fwrite(&h, sizeof(h), 1, f);
+   fwrite(zeros.data(), 1, h.f32Offset - sizeof(h), f);
+   fwrite(d.f32, sizeof(float), d.samples, f);
+   fwrite(zeros.data(), 1, h.i16Offset - h.f32Offset - d.samples * sizeof(float), f);
+   fwrite(d.i16, sizeof(short), d.samples, f);
+
+   // A float base level read in place from the .wt isn't in the block, so put it where it goes
+   for (int j = 0; j < (int)d.n_tables; j++)
+   {
+      auto* t = d.f32Tables[0][j];
+      if (t < d.f32 || t >= d.f32 + d.samples)
+      {
+         fseek(f, h.f32Offset + GetWTIndex(j, d.size, d.n_tables, 0) * sizeof(float), SEEK_SET);
+         fwrite(t, sizeof(float), d.size, f);
+      }
+   }
+
+   bool ok = !ferror(f);
+   ok = (fclose(f) == 0) && ok;
+   if (ok && std::rename(tmp.c_str(), file.c_str()) != 0)
+   {
+      // Windows won't rename over a file which is there already
+      std::remove(file.c_str());
+      ok = std::rename(tmp.c_str(), file.c_str()) == 0;
+   }
+   if (!ok)
+      std::remove(tmp.c_str());
+   return ok;
+}
+
+//! Decimate mip level l-1 of table s into level l
+void buildMipmap(WavetableData& d, int l, int s)
+{
+   const int filter_size = 63;
+   const int filter_id_of = (filter_size - 1) >> 1;
+
+   int ns = d.n_tables;
+   int psize = d.size >> (l - 1);
+   int lsize = d.size >> l;
+
+   float* f32 = d.f32Tables[l][s];
+   short* i16 = d.i16Tables[l][s];
+
+   if (d.flags & wtf_is_sample)
+   {
+      for (int i = 0; i < lsize; i++)
+      {
+         f32[i] = 0;
+         for (int a = 0; a < filter_size; a++)
+         {
+            int srcindex = (i << 1) + a - filter_id_of;
+            int srctable = max(0, s + (srcindex / psize));
+            srcindex = srcindex & (psize - 1);
+            if (srctable < ns)
+               f32[i] += hrfilter[a] * d.f32Tables[l - 1][srctable][srcindex];
+         }
+         i16[i + FIRoffsetI16] = 0; // not supported in int16 atm
+      }
+   }
+   else
+   {
+      for (int i = 0; i < lsize; i++)
+      {
+         f32[i] = 0;
+         for (int a = 0; a < filter_size; a++)
+         {
+            f32[i] += hrfilter[a] *
+                      d.f32Tables[l - 1][s][(((i << 1) + a - filter_id_of) & (psize - 1))];
+         }
+         int ival = 0;
+         for (int a = 0; a < filter_size; a++)
+         {
+            ival += HRFilterI16[a] *
+                    d.i16Tables[l - 1][s][(((i << 1) + a - 31) & (psize - 1)) + FIRoffsetI16];
+         }
+         i16[i + FIRoffsetI16] = ival >> 16;
+      }
+   }
+   // float2i16_block(f32,i16,lsize);
+   memcpy(&i16[lsize + FIRoffsetI16], &i16[FIRoffsetI16], FIRoffsetI16 * sizeof(short));
+   memcpy(&i16[0], &i16[lsize], FIRoffsetI16 * sizeof(short));
+
+   // TODO I16 mipmaps end up out of phase
+   // The click/knot/bug probably results from the fact that there is no padding in the beginning,
+   // so it becomes out of phase at mipmap switch - makes sense because as they were off by a whole
+   // sample at the mipmap switch, which can not be explained by the halfrate filter
+}
+
+//! Build level l of table s, and whatever it is decimated from, if it isn't there yet. Call
+//! with buildMutex held.
+void ensureMipmap(WavetableData& d, int l, int s)
+{
+   if (d.mipState[l][s].load(std::memory_order_acquire) == WavetableData::mip_ready)
+      return;
+
+   ensureMipmap(d, l - 1, s);
+   if ((d.flags & wtf_is_sample) && (s + 1 < (int)d.n_tables))
+      ensureMipmap(d, l - 1, s + 1);
+
+   buildMipmap(d, l, s);
+   d.mipState[l][s].store(WavetableData::mip_ready, std::memory_order_release);
+}
+
+struct MipmapWorker
+{
+   MipmapWorker()
+   {
+      worker = std::thread([this]() { run(); });
+   }
+   ~MipmapWorker()
+   {
+      keepRunning = false;
+      wakeup.signal();
+      if (worker.joinable())
+         worker.join();
+   }
+
+   // Set without a lock; only the request which finds the flag clear signals
+   void request()
+   {
+      if (!requestsPending.exchange(true, std::memory_order_acq_rel))
+         wakeup.signal();
+   }
+
+   void run()
+   {
+      while (true)
+      {
+         wakeup.wait();
+         if (!keepRunning.load(std::memory_order_acquire))
+            break;
+         if (!requestsPending.exchange(false, std::memory_order_acq_rel))
+            continue;
+
+         std::vector<std::shared_ptr<WavetableData>> resident;
+         {
+            auto& cache = wavetableCache();
+            std::lock_guard<std::mutex> g(cache.mutex);
+            for (auto& e : cache.tables)
+               resident.push_back(e.second.lock());
+         }
+
+         // We may hold the last reference now, so this all happens outside the cache lock
+         for (auto& d : resident)
+         {
+            if (!d)
+               continue;
+
+            bool requests = d->hasRequests.exchange(false, std::memory_order_acq_rel);
+            bool persist = d->persist.exchange(false, std::memory_order_acq_rel);
+            if (!requests && !persist)
+               continue;
+
+            {
+               std::lock_guard<std::mutex> g(d->buildMutex);
+               for (int l = 1; l < d->levels; l++)
+                  for (int s = 0; s < (int)d->n_tables; s++)
+                     if (persist || d->mipState[l][s].load(std::memory_order_acquire) ==
+                                        WavetableData::mip_requested)
+                        ensureMipmap(*d, l, s);
+            }
+
+            if (persist && writeCachedMipmaps(*d, d->persistTo))
+            {
+               auto& cache = wavetableCache();
+               std::lock_guard<std::mutex> g(cache.mutex);
+               cache.stats.diskWrites++;
+            }
+         }
+      }
+   }
+
+   std::atomic<bool> keepRunning{true};
+   std::atomic<bool> requestsPending{false};
+   WorkerSemaphore wakeup;
+   std::thread worker;
+};
+
+/*
+** The worker runs while any SurgeStorage holds it (see acquireWavetableMipmapWorker), so it
+** is stopped and joined when the last instance goes, never by a static destructor. The audio
+** thread reads the pointer without the lock; it is only cleared once no storage is left to
+** play anything.
+*/
+std::mutex mipmapWorkerMutex;
+int mipmapWorkerUsers = 0;
+std::atomic<MipmapWorker*> mipmapWorker{nullptr};
+
+void requestMipmaps()
+{
+   if (auto w = mipmapWorker.load(std::memory_order_acquire))
+      w->request();
+}
+} // namespace
+
+void acquireWavetableMipmapWorker()
+{
+   std::lock_guard<std::mutex> g(mipmapWorkerMutex);
+   if (mipmapWorkerUsers++ == 0)
+   {
+      // The worker uses the cache, so make sure that is constructed first
+      wavetableCache();
+      mipmapWorker.store(new MipmapWorker(), std::memory_order_release);
+   }
+}
+
+void releaseWavetableMipmapWorker()
+{
+   std::lock_guard<std::mutex> g(mipmapWorkerMutex);
+   if (--mipmapWorkerUsers == 0)
+   {
+      delete mipmapWorker.exchange(nullptr, std::memory_order_acq_rel);
+   }
+}
+
+bool wavetableMipmapWorkerRunning()
+{
+   return mipmapWorker.load(std::memory_order_acquire) != nullptr;
+}
+
+void setWavetableMipmapCacheDirectory(const std::string& directory)
+{
+   auto& cache = wavetableCache();
+   std::lock_guard<std::mutex> g(cache.mutex);
+   cache.mipmapCacheDirectory = directory;
+   if (!directory.empty() && directory.back() != '/' && directory.back() != '\\')
+      cache.mipmapCacheDirectory += "/";
+}
+
+WavetableCacheStats getWavetableCacheStats()
+{
+   auto& cache = wavetableCache();
+   std::lock_guard<std::mutex> g(cache.mutex);
+   return cache.stats;
+}
+
 Wavetable::Wavetable()
 {
-   dataSizes = 35000;
-   TableF32Data = (float *)malloc(dataSizes * sizeof(float));
-   TableI16Data = (short *)malloc(dataSizes * sizeof(short));
-   memset(TableF32Data, 0, dataSizes * sizeof(float));
-   memset(TableI16Data, 0, dataSizes * sizeof(short));
+   TableF32Data = nullptr;
+   TableI16Data = nullptr;
+   lazyMips = nullptr;
    memset(TableF32WeakPointers, 0, sizeof(TableF32WeakPointers));
    memset(TableI16WeakPointers, 0, sizeof(TableI16WeakPointers));
    current_id = -1;
@@ -92,19 +605,6 @@ Wavetable::Wavetable()
 
 Wavetable::~Wavetable()
 {
-    free(TableF32Data);
-    free(TableI16Data);
-}
-
-void Wavetable::allocPointers(size_t newSize)
-{
-   free(TableF32Data);
-   free(TableI16Data);
-   dataSizes = newSize;
-   TableF32Data = (float *)malloc(dataSizes * sizeof(float));
-   TableI16Data = (short *)malloc(dataSizes * sizeof(short));
-   memset(TableF32Data, 0, dataSizes * sizeof(float));
-   memset(TableI16Data, 0, dataSizes * sizeof(short));
 }
 
 void Wavetable::Copy(Wavetable* wt)
@@ -118,38 +618,65 @@ void Wavetable::Copy(Wavetable* wt)
    current_id = -1;
    queue_id = -1;
 
-   if( dataSizes < wt->dataSizes )
+   // The data is immutable so sharing it is as good as a copy
+   data = wt->data;
+   lazyMips = wt->lazyMips;
+   TableF32Data = wt->TableF32Data;
+   TableI16Data = wt->TableI16Data;
+   memcpy(TableF32WeakPointers, wt->TableF32WeakPointers, sizeof(TableF32WeakPointers));
+   memcpy(TableI16WeakPointers, wt->TableI16WeakPointers, sizeof(TableI16WeakPointers));
+}
+
+void Wavetable::adopt(const std::shared_ptr<WavetableData>& d)
+{
+   data = d;
+   lazyMips = d->lazy ? d.get() : nullptr;
+   TableF32Data = d->f32;
+   TableI16Data = d->i16;
+
+   size = d->size;
+   size_po2 = d->size_po2;
+   flags = d->flags;
+   n_tables = d->n_tables;
+   dt = d->dt;
+
+   memcpy(TableF32WeakPointers, d->f32Tables, sizeof(TableF32WeakPointers));
+   memcpy(TableI16WeakPointers, d->i16Tables, sizeof(TableI16WeakPointers));
+}
+
+int Wavetable::nearestReadyMipmap(int level, int table)
+{
+   auto& state = lazyMips->mipState;
+   if (state[level][table].load(std::memory_order_acquire) == WavetableData::mip_ready)
+      return level;
+
+   unsigned char expected = WavetableData::mip_missing;
+   if (state[level][table].compare_exchange_strong(expected, WavetableData::mip_requested,
+                                                   std::memory_order_acq_rel))
    {
-       allocPointers(wt->dataSizes);
+      lazyMips->hasRequests.store(true, std::memory_order_release);
+      requestMipmaps();
    }
 
-   memcpy(TableF32Data, wt->TableF32Data, dataSizes * sizeof(float));
-   memcpy(TableI16Data, wt->TableI16Data, dataSizes * sizeof(short));
+   while (level > 0 &&
+          state[level][table].load(std::memory_order_acquire) != WavetableData::mip_ready)
+      level--;
+   return level;
+}
 
-   for (int i = 0; i < max_mipmap_levels; i++)
-   {
-      for (int j = 0; j < max_subtables; j++)
-      {
-         if (wt->TableF32WeakPointers[i][j])
-         {
-            size_t Offset = wt->TableF32WeakPointers[i][j] - wt->TableF32Data;
-            TableF32WeakPointers[i][j] = TableF32Data + Offset;
-         }
-         else
-            TableF32WeakPointers[i][j] = NULL;
+void Wavetable::completeMipmaps()
+{
+   if (!lazyMips)
+      return;
 
-         if (wt->TableI16WeakPointers[i][j])
-         {
-            size_t Offset = wt->TableI16WeakPointers[i][j] - wt->TableI16Data;
-            TableI16WeakPointers[i][j] = TableI16Data + Offset;
-         }
-         else
-            TableI16WeakPointers[i][j] = NULL;
-      }
-   }
+   std::lock_guard<std::mutex> g(lazyMips->buildMutex);
+   for (int l = 1; l < lazyMips->levels; l++)
+      for (int s = 0; s < (int)n_tables; s++)
+         ensureMipmap(*lazyMips, l, s);
 }
 
-bool Wavetable::BuildWT(void* wdata, wt_header& wh, bool AppendSilence)
+bool Wavetable::BuildWT(void* wdata, wt_header& wh, bool AppendSilence,
+                        std::shared_ptr<void> mapping, bool lazyMipmaps)
 {
    assert(wdata);
 
@@ -157,13 +684,35 @@ bool Wavetable::BuildWT(void* wdata, wt_header& wh, bool AppendSilence)
    n_tables = vt_read_int16LE(wh.n_tables);
    size = vt_read_int32LE(wh.n_samples);
 
-   size_t req_size = RequiredWTSize(size, n_tables);
-   
-   if (req_size > dataSizes)
+   // Already resident somewhere in the process? Then that's all there is to do
+   uint64_t key[2];
+   contentKey(wdata, (size_t)size * n_tables * ((flags & wtf_int16) ? sizeof(short) : sizeof(float)),
+              wh, AppendSilence, key);
+   std::string cacheDirectory;
    {
-       allocPointers(req_size);
+      auto& cache = wavetableCache();
+      std::shared_ptr<WavetableData> resident;
+      {
+         std::lock_guard<std::mutex> g(cache.mutex);
+         auto it = cache.tables.find({key[0], key[1]});
+         if (it != cache.tables.end())
+            resident = it->second.lock();
+         if (resident)
+            cache.stats.hits++;
+         else
+            cache.stats.misses++;
+         cacheDirectory = cache.mipmapCacheDirectory;
+      }
+      if (resident)
+      {
+         // Outside the cache lock, since this may drop the last reference to the old data
+         adopt(resident);
+         return true;
+      }
    }
 
+   size_t req_size = RequiredWTSize(size, n_tables);
+
    int wdata_tables = n_tables;
 
    if (AppendSilence)
@@ -183,159 +732,125 @@ bool Wavetable::BuildWT(void* wdata, wt_header& wh, bool AppendSilence)
 
    dt = 1.0f / size;
 
-   for (int i = 0; i < max_mipmap_levels; i++)
+   int levels = 1;
+   while (((1 << levels) < size) & (levels < max_mipmap_levels))
+      levels++;
+
+   auto built = std::shared_ptr<WavetableData>(new WavetableData, releaseWavetableData);
+   auto& d = *built;
+   d.key[0] = key[0];
+   d.key[1] = key[1];
+   d.samples = req_size;
+   d.size = size;
+   d.size_po2 = size_po2;
+   d.flags = flags;
+   d.n_tables = n_tables;
+   d.dt = dt;
+   d.levels = levels;
+
+   // Or in the on-disk cache?
+   if (!cacheDirectory.empty())
    {
-      for (int j = 0; j < max_subtables; j++)
+      auto file = mipmapCacheFile(cacheDirectory, key);
+      if (loadCachedMipmaps(d, file))
       {
-         // TODO WARNING: Crashes here with patchbyte!
-         /*free(wt->TableF32WeakPointers[i][j]);
-         free(wt->TableI16WeakPointers[i][j]);
-         wt->TableF32WeakPointers[i][j] = 0;
-         wt->TableI16WeakPointers[i][j] = 0;*/
+         registerWavetableData(built);
+         {
+            auto& cache = wavetableCache();
+            std::lock_guard<std::mutex> g(cache.mutex);
+            cache.stats.diskHits++;
+         }
+         adopt(built);
+         return true;
       }
+      d.persistTo = file;
    }
-   for (int j = 0; j < this->n_tables; j++)
-   {
-      TableF32WeakPointers[0][j] = TableF32Data + GetWTIndex(j, size, n_tables, 0);
-      TableI16WeakPointers[0][j] =
-          TableI16Data + GetWTIndex(j, size, n_tables, 0,
-                                    FIRipolI16_N); // + padding for a "non-wrapping" interpolator
-   }
-   for (int j = this->n_tables; j < min_F32_tables;
-        j++) // W-TABLE need at least 3 tables to work properly
+
+   d.f32 = (float*)calloc(req_size, sizeof(float));
+   d.i16 = (short*)calloc(req_size, sizeof(short));
+   assignTablePointers(d);
+
+   auto& f32Tables = d.f32Tables;
+   auto& i16Tables = d.i16Tables;
+
+   // A float table in a mapping which outlives us can be read in place, since the file is
+   // little endian like every platform we build for. The data follows the 12 byte header so
+   // is only 4 byte aligned, which is fine as the float tables are only read a sample at a time
+   bool inPlace = mapping && !(flags & wtf_int16);
+   if (inPlace)
    {
-      unsigned int s = this->size;
-      int l = 0;
-      while (s && (l < max_mipmap_levels))
-      {
-         TableF32WeakPointers[l][j] = TableF32Data + GetWTIndex(j, size, n_tables, l);
-         memset(TableF32WeakPointers[l][j], 0, s * sizeof(float));
-         s = s >> 1;
-         l++;
-      }
+      d.mapping = mapping;
+      for (int j = 0; j < wdata_tables; j++)
+         f32Tables[0][j] = (float*)wdata + (size_t)size * j;
    }
 
    if (this->flags & wtf_int16)
    {
       for (int j = 0; j < wdata_tables; j++)
       {
-         vt_copyblock_W_LE(&this->TableI16WeakPointers[0][j][FIRoffsetI16],
-                           &((short*)wdata)[this->size * j], this->size);
+         vt_copyblock_W_LE(&i16Tables[0][j][FIRoffsetI16], &((short*)wdata)[this->size * j],
+                           this->size);
          if( this->flags & wtf_int16_is_16 )
          {
-            i16toi15_block(&this->TableI16WeakPointers[0][j][FIRoffsetI16],
-                           &this->TableI16WeakPointers[0][j][FIRoffsetI16],
+            i16toi15_block(&i16Tables[0][j][FIRoffsetI16], &i16Tables[0][j][FIRoffsetI16],
                            this->size);
          }
-         i152float_block(&this->TableI16WeakPointers[0][j][FIRoffsetI16],
-                         this->TableF32WeakPointers[0][j], this->size);
+         i152float_block(&i16Tables[0][j][FIRoffsetI16], f32Tables[0][j], this->size);
       }
    }
    else
    {
       for (int j = 0; j < wdata_tables; j++)
       {
-         vt_copyblock_DW_LE((int*)this->TableF32WeakPointers[0][j], &((int*)wdata)[this->size * j],
-                            this->size);
-         float2i15_block(this->TableF32WeakPointers[0][j],
-                         &this->TableI16WeakPointers[0][j][FIRoffsetI16], this->size);
+         if (!inPlace)
+            vt_copyblock_DW_LE((int*)f32Tables[0][j], &((int*)wdata)[this->size * j],
+                               this->size);
+         float2i15_block(f32Tables[0][j], &i16Tables[0][j][FIRoffsetI16], this->size);
       }
    }
 
    // clear any appended tables (not read, but included in table for post-silence)
    for (int j = wdata_tables; j < this->n_tables; j++)
    {
-      memset(this->TableF32WeakPointers[0][j], 0, this->size * sizeof(float));
-      memset(this->TableI16WeakPointers[0][j], 0, this->size * sizeof(short));
+      memset(f32Tables[0][j], 0, this->size * sizeof(float));
+      memset(i16Tables[0][j], 0, this->size * sizeof(short));
    }
 
    for (int j = 0; j < wdata_tables; j++)
    {
-      memcpy(&this->TableI16WeakPointers[0][j][this->size + FIRoffsetI16],
-             &this->TableI16WeakPointers[0][j][FIRoffsetI16], FIRoffsetI16 * sizeof(short));
-      memcpy(&this->TableI16WeakPointers[0][j][0], &this->TableI16WeakPointers[0][j][this->size],
+      memcpy(&i16Tables[0][j][this->size + FIRoffsetI16], &i16Tables[0][j][FIRoffsetI16],
              FIRoffsetI16 * sizeof(short));
+      memcpy(&i16Tables[0][j][0], &i16Tables[0][j][this->size], FIRoffsetI16 * sizeof(short));
    }
 
-   MipMapWT();
-   return true;
-}
-
-void Wavetable::MipMapWT()
-{
-   int levels = 1;
-   while (((1 << levels) < size) & (levels < max_mipmap_levels))
-      levels++;
-   int ns = this->n_tables;
-
-   const int filter_size = 63;
-   const int filter_id_of = (filter_size - 1) >> 1;
-
-   /*FILE *F;
-   F = fopen("d:\\sdump.lala","wb");*/
-
-   // fwrite(this->TableI16WeakPointers[0][0],size*sizeof(short),1,F);
-   for (int l = 1; l < levels; l++)
+   // Without a storage holding the worker nothing would build the rest, so build it all now
+   if (!wavetableMipmapWorkerRunning())
    {
-      int psize = size >> (l - 1);
-      int lsize = size >> l;
-
-      for (int s = 0; s < ns; s++)
-      {
-         this->TableF32WeakPointers[l][s] = TableF32Data + GetWTIndex(s, size, n_tables, l);
-         this->TableI16WeakPointers[l][s] =
-             TableI16Data + GetWTIndex(s, size, n_tables, l, FIRipolI16_N);
+      lazyMipmaps = false;
+      d.persistTo.clear();
+   }
+   d.lazy = lazyMipmaps;
 
-         if (this->flags & wtf_is_sample)
-         {
-            for (int i = 0; i < lsize; i++)
-            {
-               this->TableF32WeakPointers[l][s][i] = 0;
-               for (int a = 0; a < filter_size; a++)
-               {
-                  int srcindex = (i << 1) + a - filter_id_of;
-                  int srctable = max(0, s + (srcindex / psize));
-                  srcindex = srcindex & (psize - 1);
-                  if (srctable < ns)
-                     this->TableF32WeakPointers[l][s][i] +=
-                         hrfilter[a] * this->TableF32WeakPointers[l - 1][srctable][srcindex];
-               }
-               this->TableI16WeakPointers[l][s][i + FIRoffsetI16] = 0; // not supported in int16 atm
-            }
-         }
-         else
+   if (!lazyMipmaps)
+   {
+      for (int l = 1; l < levels; l++)
+         for (int s = 0; s < (int)n_tables; s++)
          {
-            for (int i = 0; i < lsize; i++)
-            {
-               this->TableF32WeakPointers[l][s][i] = 0;
-               for (int a = 0; a < filter_size; a++)
-               {
-                  this->TableF32WeakPointers[l][s][i] +=
-                      hrfilter[a] * this->TableF32WeakPointers[l - 1][s][(
-                                        ((i << 1) + a - filter_id_of) & (psize - 1))];
-               }
-               int ival = 0;
-               for (int a = 0; a < filter_size; a++)
-               {
-                  ival += HRFilterI16[a] *
-                          this->TableI16WeakPointers[l - 1][s][(((i << 1) + a - 31) & (psize - 1)) +
-                                                               FIRoffsetI16];
-               }
-               this->TableI16WeakPointers[l][s][i + FIRoffsetI16] = ival >> 16;
-            }
+            buildMipmap(d, l, s);
+            d.mipState[l][s].store(WavetableData::mip_ready, std::memory_order_relaxed);
          }
-         // float2i16_block(this->TableF32WeakPointers[l][s],this->TableI16WeakPointers[l][s],lsize);
-         memcpy(&this->TableI16WeakPointers[l][s][lsize + FIRoffsetI16],
-                &this->TableI16WeakPointers[l][s][FIRoffsetI16], FIRoffsetI16 * sizeof(short));
-         memcpy(&this->TableI16WeakPointers[l][s][0], &this->TableI16WeakPointers[l][s][lsize],
-                FIRoffsetI16 * sizeof(short));
-      }
-      // fwrite(this->TableI16WeakPointers[l][0],lsize*sizeof(short),1,F);
    }
-   // fclose(F);
 
-   // TODO I16 mipmaps end up out of phase
-   // The click/knot/bug probably results from the fact that there is no padding in the beginning,
-   // so it becomes out of phase at mipmap switch - makes sense because as they were off by a whole
-   // sample at the mipmap switch, which can not be explained by the halfrate filter
+   registerWavetableData(built);
+
+   if (!d.persistTo.empty())
+   {
+      // The worker completes the levels (if we were lazy) and writes them out
+      d.persist.store(true, std::memory_order_release);
+      requestMipmaps();
+   }
+
+   // Outside the cache lock, since this may drop the last reference to the old data
+   adopt(built);
+   return true;
 }
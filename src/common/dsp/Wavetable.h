@@ -1,5 +1,7 @@
 #pragma once
 #include <string>
+#include <memory>
+#include <cstdint>
 const int max_wtable_size = 4096;
 const int max_subtables = 512;
 const int max_mipmap_levels = 16;
@@ -18,16 +20,76 @@ struct wt_header
 };
 #pragma pack(pop)
 
+/*
+** The sample data of a built wavetable (every mipmap level, float and int16) is immutable and
+** shared. BuildWT looks its source up in a process wide cache keyed by the content (header and
+** samples), so building a table which is already resident anywhere in the process - another
+** oscillator or scene, or another Surge instance - costs a hash and a lookup, and Copy just
+** takes another reference. The data is freed when the last Wavetable using it is rebuilt or
+** destroyed.
+*/
+struct WavetableData;
+
+struct WavetableCacheStats
+{
+   size_t bytes = 0;  // sample data resident in the cache
+   size_t tables = 0; // distinct resident tables
+   uint64_t hits = 0, misses = 0;
+   uint64_t diskHits = 0, diskWrites = 0; // misses found in, and tables written to, the disk cache
+};
+WavetableCacheStats getWavetableCacheStats();
+
+/*
+** Opt in to keeping built mip levels on disk, keyed like the cache above, so a table which has
+** been loaded before is mapped in ready to play instead of being mipmapped again. Files are
+** written in the background once a table is fully built. An empty directory turns it off.
+*/
+void setWavetableMipmapCacheDirectory(const std::string& directory);
+
+/*
+** The background thread which builds lazily requested mip levels and writes the disk cache is
+** shared by the process. Each SurgeStorage holds it from construction to destruction; it starts
+** with the first and is stopped and joined with the last. Without it BuildWT builds every
+** level up front.
+*/
+void acquireWavetableMipmapWorker();
+void releaseWavetableMipmapWorker();
+bool wavetableMipmapWorkerRunning();
+
 class Wavetable
 {
 public:
    Wavetable();
    ~Wavetable();
    void Copy(Wavetable* wt);
-   bool BuildWT(void* wdata, wt_header& wh, bool AppendSilence);
-   void MipMapWT();
 
-   void allocPointers(size_t newSize);
+   /*
+   ** If wdata lies in a read-only file mapping, pass the mapping and a float table is read in
+   ** place rather than copied. With lazyMipmaps only the base level is built here; the others
+   ** are built in the background as readyMipmap asks for them.
+   */
+   bool BuildWT(void* wdata, wt_header& wh, bool AppendSilence,
+                std::shared_ptr<void> mapping = nullptr, bool lazyMipmaps = false);
+
+   /*
+   ** The mip level to read 'table' at when 'level' is wanted. For a lazily mipmapped table that
+   ** is the nearest built level at or below it, and asking queues 'level' to be built. It never
+   ** blocks, so is safe on the audio thread.
+   */
+   inline int readyMipmap(int level, int table)
+   {
+      if (level == 0 || !lazyMips)
+         return level;
+      return nearestReadyMipmap(level, table);
+   }
+
+   // Build any mip levels which a lazy build left out, here and now
+   void completeMipmaps();
+
+private:
+   void adopt(const std::shared_ptr<WavetableData>& d);
+   int nearestReadyMipmap(int level, int table);
+   WavetableData* lazyMips;
 
 public:
    int size;
@@ -38,7 +100,8 @@ public:
    float* TableF32WeakPointers[max_mipmap_levels][max_subtables];
    short* TableI16WeakPointers[max_mipmap_levels][max_subtables];
 
-   size_t dataSizes;
+   // The shared data, and its float and int16 blocks which the pointers above point into
+   std::shared_ptr<WavetableData> data;
    float *TableF32Data;
    short *TableI16Data;
    
@@ -15,6 +15,7 @@
 
 #include "WavetableOscillator.h"
 #include "DspUtilities.h"
+#include "util/SceneRandom.h"
 
 using namespace std;
 
@@ -29,6 +30,9 @@ WavetableOscillator::~WavetableOscillator()
 
 void WavetableOscillator::init(float pitch, bool is_display)
 {
+   li_hpf.set_blocksize(storage->blockSizeOS);
+   li_DC.set_blocksize(storage->blockSizeOS);
+   li_integratormult.set_blocksize(storage->blockSizeOS);
    assert(storage);
    first_run = true;
    osc_out = _mm_set1_ps(0.f);
@@ -94,7 +98,7 @@ void WavetableOscillator::init(float pitch, bool is_display)
          }
          else
          {
-            float drand = (float)rand() / (float)RAND_MAX;
+            float drand = (float)Surge::SceneRandom::rand() / (float)RAND_MAX;
             oscstate[i] = drand;
          }
 
@@ -153,12 +157,7 @@ float WavetableOscillator::distort_level(float x)
 
 void WavetableOscillator::convolute(int voice, bool FM, bool stereo)
 {
-   float block_pos = oscstate[voice] * BLOCK_SIZE_OS_INV * pitchmult_inv;
-
-   double detune = drift * driftlfo[voice];
-   if (n_unison > 1)
-      detune += oscdata->p[wt_unison_detune].get_extended(localcopy[id_detune].f) *
-                (detune_bias * float(voice) + detune_offset);
+   float block_pos = oscstate[voice] * storage->blockSizeOSInv * pitchmult_inv;
 
    const float p24 = (1 << 24);
    unsigned int ipos;
@@ -195,58 +194,29 @@ void WavetableOscillator::convolute(int voice, bool FM, bool stereo)
          }
       }
 
-      int ts = oscdata->wt.size;
-      float a = oscdata->wt.dt * pitchmult_inv;
-
-      const float wtbias = 1.8f;
-
-      mipmap[voice] = 0;
-
-      if ((a < 0.015625 * wtbias) && (ts >= 128))
-         mipmap[voice] = 6;
-      else if ((a < 0.03125 * wtbias) && (ts >= 64))
-         mipmap[voice] = 5;
-      else if ((a < 0.0625 * wtbias) && (ts >= 32))
-         mipmap[voice] = 4;
-      else if ((a < 0.125 * wtbias) && (ts >= 16))
-         mipmap[voice] = 3;
-      else if ((a < 0.25 * wtbias) && (ts >= 8))
-         mipmap[voice] = 2;
-      else if ((a < 0.5 * wtbias) && (ts >= 4))
-         mipmap[voice] = 1;
-
-      mipmap_ofs[voice] = 0;
-      for (int i = 0; i < mipmap[voice]; i++)
-         mipmap_ofs[voice] += (ts >> i);
+      // A lazily mipmapped table may not have this level yet, in which case play the one below
+      mipmap[voice] = min(oscdata->wt.readyMipmap(block_mipmap, tableid),
+                          oscdata->wt.readyMipmap(block_mipmap, tableid + 1));
+      mipmap_ofs[voice] = block_mipmap_ofs;
+      for (int i = mipmap[voice]; i < block_mipmap; i++)
+         mipmap_ofs[voice] -= (oscdata->wt.size >> i);
    }
 
    // generate pulse
-   unsigned int delay = ((ipos >> 24) & 0x3f);
+   unsigned int delay = ((ipos >> 24) & (storage->blockSizeOS - 1));
 
    if (FM)
       delay = FMdelay;
 
    unsigned int m = ((ipos >> 16) & 0xff) * (FIRipol_N << 1);
    unsigned int lipolui16 = (ipos & 0xffff);
-   __m128 lipol128 = _mm_cvtsi32_ss(lipol128, lipolui16);
-   lipol128 = _mm_shuffle_ps(lipol128, lipol128, _MM_SHUFFLE(0, 0, 0, 0));
 
-   float g, gR;
+   float g, gR = 0.f;
    int wt_inc = (1 << mipmap[voice]);
    float dt = (oscdata->wt.dt) * wt_inc;
 
    // add time until next statechange
-   float tempt;
-   if (oscdata->p[wt_unison_detune].absolute)
-   {
-      // See the comment in SurgeSuperOscillator.cpp at the absolute treatment
-      tempt = storage->note_to_pitch_inv_ignoring_tuning( detune * storage->note_to_pitch_inv_ignoring_tuning( pitch_t ) * 16 / 0.9443 );
-      if( tempt < 0.1 ) tempt = 0.1;
-   }
-   else
-   {
-      tempt = storage->note_to_pitch_inv_tuningctr(detune);
-   }
+   float tempt = unison_tempt[voice];
 
    float t;
    float xt = ((float)state[voice] + 0.5f) * dt;
@@ -289,47 +259,7 @@ void WavetableOscillator::convolute(int voice, bool FM, bool stereo)
       g *= panL[voice];
    }
 
-   if (stereo)
-   {
-      __m128 g128L = _mm_load_ss(&g);
-      g128L = _mm_shuffle_ps(g128L, g128L, _MM_SHUFFLE(0, 0, 0, 0));
-      __m128 g128R = _mm_load_ss(&gR);
-      g128R = _mm_shuffle_ps(g128R, g128R, _MM_SHUFFLE(0, 0, 0, 0));
-
-      for (int k = 0; k < FIRipol_N; k += 4)
-      {
-         float* obfL = &oscbuffer[bufpos + k + delay];
-         float* obfR = &oscbufferR[bufpos + k + delay];
-         __m128 obL = _mm_loadu_ps(obfL);
-         __m128 obR = _mm_loadu_ps(obfR);
-         __m128 st = _mm_load_ps(&sinctable[m + k]);
-         __m128 so = _mm_load_ps(&sinctable[m + k + FIRipol_N]);
-         so = _mm_mul_ps(so, lipol128);
-         st = _mm_add_ps(st, so);
-         obL = _mm_add_ps(obL, _mm_mul_ps(st, g128L));
-         _mm_storeu_ps(obfL, obL);
-         obR = _mm_add_ps(obR, _mm_mul_ps(st, g128R));
-         _mm_storeu_ps(obfR, obR);
-      }
-   }
-   else
-   {
-      __m128 g128 = _mm_load_ss(&g);
-      g128 = _mm_shuffle_ps(g128, g128, _MM_SHUFFLE(0, 0, 0, 0));
-
-      for (int k = 0; k < FIRipol_N; k += 4)
-      {
-         float* obf = &oscbuffer[bufpos + k + delay];
-         __m128 ob = _mm_loadu_ps(obf);
-         __m128 st = _mm_load_ps(&sinctable[m + k]);
-         __m128 so = _mm_load_ps(&sinctable[m + k + FIRipol_N]);
-         so = _mm_mul_ps(so, lipol128);
-         st = _mm_add_ps(st, so);
-         st = _mm_mul_ps(st, g128);
-         ob = _mm_add_ps(ob, st);
-         _mm_storeu_ps(obf, ob);
-      }
-   }
+   queue_impulse(delay, m, lipolui16, g, gR, stereo);
 
    rate[voice] = t;
 
@@ -338,6 +268,30 @@ void WavetableOscillator::convolute(int voice, bool FM, bool stereo)
    state[voice] = (state[voice] + 1) & ((oscdata->wt.size >> mipmap[voice]) - 1);
 }
 
+void WavetableOscillator::update_unison_tempt()
+{
+   float spread = 0.f;
+   if (n_unison > 1)
+      spread = oscdata->p[wt_unison_detune].get_extended(localcopy[id_detune].f);
+   unison.step(driftlfo, driftlfo2, n_unison, drift, spread, detune_bias, detune_offset);
+
+   if (oscdata->p[wt_unison_detune].absolute)
+   {
+      // See the comment in SurgeSuperOscillator.cpp at the absolute treatment
+      float scale = storage->note_to_pitch_inv_ignoring_tuning(pitch_t) * 16 / 0.9443;
+      unison.lookup(storage->table_pitch_inv_ignoring_tuning, scale, 0.f, 1.f, unison_tempt);
+      for (int voice = 0; voice < n_unison; voice++)
+         if (unison_tempt[voice] < 0.1)
+            unison_tempt[voice] = 0.1;
+   }
+   else
+   {
+      // note_to_pitch_inv_tuningctr
+      unison.lookup(storage->table_pitch_inv, 1.f, storage->scaleConstantNote(),
+                    storage->scaleConstantPitch(), unison_tempt);
+   }
+}
+
 template <bool is_init> void WavetableOscillator::update_lagvals()
 {
    l_vskew.newValue(limit_range(localcopy[id_vskew].f, -1.f, 1.f));
@@ -371,12 +325,51 @@ template <bool is_init> void WavetableOscillator::update_lagvals()
 void WavetableOscillator::process_block(
     float pitch0, float drift, bool stereo, bool FM, float depth)
 {
+   batch_impulses = storage->batchOscillatorUnison && n_unison > 1;
+   render_block(pitch0, drift, stereo, FM, depth);
+}
+
+void WavetableOscillator::render_block(
+    float pitch0, float drift, bool stereo, bool FM, float depth)
+{
+   BlitImpulse pendingbuf[max_pending_impulses];
+   pending = pendingbuf;
+   n_pending = 0;
+
    pitch_last = pitch_t;
    pitch_t = min(148.f, pitch0);
    pitchmult_inv = max(1.0, dsamplerate_os * (1 / 8.175798915) * storage->note_to_pitch_inv(pitch_t));
    pitchmult = 1.f / pitchmult_inv; // This must be a real division, reciprocal-approximation is not precise enough
    this->drift = drift;
 
+   // The mipmap a voice picks when it starts a new cycle only depends on the pitch, so work
+   // it out once for the block rather than in convolute
+   {
+      int ts = oscdata->wt.size;
+      float a = oscdata->wt.dt * pitchmult_inv;
+
+      const float wtbias = 1.8f;
+
+      block_mipmap = 0;
+
+      if ((a < 0.015625 * wtbias) && (ts >= 128))
+         block_mipmap = 6;
+      else if ((a < 0.03125 * wtbias) && (ts >= 64))
+         block_mipmap = 5;
+      else if ((a < 0.0625 * wtbias) && (ts >= 32))
+         block_mipmap = 4;
+      else if ((a < 0.125 * wtbias) && (ts >= 16))
+         block_mipmap = 3;
+      else if ((a < 0.25 * wtbias) && (ts >= 8))
+         block_mipmap = 2;
+      else if ((a < 0.5 * wtbias) && (ts >= 4))
+         block_mipmap = 1;
+
+      block_mipmap_ofs = 0;
+      for (int i = 0; i < block_mipmap; i++)
+         block_mipmap_ofs += (ts >> i);
+   }
+
    update_lagvals<false>();
    l_shape.process();
    l_vskew.process();
@@ -430,10 +423,9 @@ void WavetableOscillator::process_block(
 
    if (FM)
    {
-      for (int l = 0; l < n_unison; l++)
-         driftlfo[l] = drift_noise(driftlfo2[l]);
+      update_unison_tempt();
 
-      for (int s = 0; s < BLOCK_SIZE_OS; s++)
+      for (int s = 0; s < storage->blockSizeOS; s++)
       {
          float fmmul = limit_range(1.f + depth * master_osc[s], 0.1f, 1.9f);
          float a = pitchmult * fmmul;
@@ -453,20 +445,23 @@ void WavetableOscillator::process_block(
    }
    else
    {
-      float a = (float)BLOCK_SIZE_OS * pitchmult;
+      float a = (float)storage->blockSizeOS * pitchmult;
+      update_unison_tempt();
       for (int l = 0; l < n_unison; l++)
       {
-         driftlfo[l] = drift_noise(driftlfo2[l]);
          while (oscstate[l] < a)
             convolute(l, false, stereo);
          oscstate[l] -= a;
       }
    }
 
-   float hpfblock alignas(16)[BLOCK_SIZE_OS];
-   li_hpf.store_block(hpfblock, BLOCK_SIZE_OS_QUAD);
+   flush_impulses(stereo);
+   pending = nullptr; // pendingbuf goes with this frame
+
+   float hpfblock alignas(16)[BLOCK_SIZE_OS_MAX];
+   li_hpf.store_block(hpfblock, storage->blockSizeOSQuad);
 
-   for (int k = 0; k < BLOCK_SIZE_OS; k++)
+   for (int k = 0; k < storage->blockSizeOS; k++)
    {
       __m128 hpf = _mm_load_ss(&hpfblock[k]);
       __m128 ob = _mm_load_ss(&oscbuffer[bufpos + k]);
@@ -483,11 +478,11 @@ void WavetableOscillator::process_block(
       }
    }
 
-   clear_block(&oscbuffer[bufpos], BLOCK_SIZE_OS_QUAD);
+   clear_block(&oscbuffer[bufpos], storage->blockSizeOSQuad);
    if (stereo)
-      clear_block(&oscbufferR[bufpos], BLOCK_SIZE_OS_QUAD);
+      clear_block(&oscbufferR[bufpos], storage->blockSizeOSQuad);
 
-   bufpos = (bufpos + BLOCK_SIZE_OS) & (OB_LENGTH - 1);
+   bufpos = (bufpos + storage->blockSizeOS) & (OB_LENGTH - 1);
 
    // each block overlap FIRipol_N samples into the next (due to impulses not being wrapped around
    // the block edges copy the overlapping samples to the new block position
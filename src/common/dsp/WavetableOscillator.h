@@ -19,6 +19,7 @@
 #include "DspUtilities.h"
 #include <vt_dsp/lipol.h>
 #include "BiquadFilter.h"
+#include "UnisonFrame.h"
 
 
 class WavetableOscillator : public AbstractBlitOscillator
@@ -45,7 +46,14 @@ public:
    virtual ~WavetableOscillator();
 
 private:
+   void render_block(float pitch, float drift, bool stereo, bool FM, float FMdepth);
    void convolute(int voice, bool FM, bool stereo);
+   int block_mipmap, block_mipmap_ofs;
+   // The time to the next state change for each voice's detune; it only changes per block, so
+   // step the drift and work it out for all the voices at once (see UnisonFrame)
+   void update_unison_tempt();
+   float unison_tempt[MAX_UNISON];
+   UnisonFrame unison;
    template <bool is_init> void update_lagvals();
    inline float distort_level(float);
    bool first_run;
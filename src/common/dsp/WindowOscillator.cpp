@@ -15,6 +15,7 @@
 
 #include "WindowOscillator.h"
 #include "DspUtilities.h"
+#include "util/SceneRandom.h"
 
 #include <cstdint>
 
@@ -78,7 +79,7 @@ void WindowOscillator::init(float pitch, bool is_display)
          if (oscdata->retrigger.val.b)
             Window.Pos[i] = (storage->WindowWT.size + ((storage->WindowWT.size * i) / NumUnison)) << 16;
          else
-            Window.Pos[i] = (storage->WindowWT.size + (rand() & (storage->WindowWT.size - 1))) << 16;
+            Window.Pos[i] = (storage->WindowWT.size + (Surge::SceneRandom::rand() & (storage->WindowWT.size - 1))) << 16;
       }
    }
 
@@ -140,7 +141,31 @@ inline unsigned int BigMULr16(unsigned int a, unsigned int b)
    return c >> 16u;
 }
 
-void WindowOscillator::ProcessWindowOscs(bool stereo, bool FM)
+// The low 32 bits of a * b in each lane; SSE2 has no pmulld
+inline __m128i mullo_epi32_sse2(__m128i a, __m128i b)
+{
+   __m128i even = _mm_mul_epu32(a, b);
+   __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+   return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                             _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+// { sum(a), sum(b), sum(c), sum(d) }
+inline __m128i sum4x4_epi32(__m128i a, __m128i b, __m128i c, __m128i d)
+{
+   __m128i ab = _mm_add_epi32(_mm_unpacklo_epi32(a, b), _mm_unpackhi_epi32(a, b));
+   __m128i cd = _mm_add_epi32(_mm_unpacklo_epi32(c, d), _mm_unpackhi_epi32(c, d));
+   return _mm_add_epi32(_mm_unpacklo_epi64(ab, cd), _mm_unpackhi_epi64(ab, cd));
+}
+
+inline int hsum_epi32(__m128i a)
+{
+   a = _mm_add_epi32(a, _mm_shuffle_epi32(a, _MM_SHUFFLE(1, 0, 3, 2)));
+   a = _mm_add_epi32(a, _mm_shuffle_epi32(a, _MM_SHUFFLE(2, 3, 0, 1)));
+   return _mm_cvtsi128_si32(a);
+}
+
+void WindowOscillator::ProcessWindowOscs(bool stereo, bool FM, bool skip)
 {
    const unsigned int M0Mask = 0x07f8;
    unsigned int SizeMask = (oscdata->wt.size << 16) - 1;
@@ -163,65 +188,165 @@ void WindowOscillator::ProcessWindowOscs(bool stereo, bool FM)
       FormantMul = std::max(FormantMul >> WindowVsWavePO2, 1);
    }
 
+   struct Grain
    {
-      // SSE2 path
-      for (int so = 0; so < NumUnison; so++)
+      unsigned int Pos, RatioA, MipMapA, MipMapB;
+      short *WaveAdr, *WinAdr;
+   };
+
+   auto startGrain = [&](int so, Grain& g) {
+      g.Pos = Window.Pos[so];
+      g.RatioA = Window.Ratio[so];
+
+      if (FM)
+         g.RatioA = Window.FMRatio[so][0];
+
+      g.MipMapA = 0;
+      g.MipMapB = 0;
+
+      if (Window.Table[so] >= oscdata->wt.n_tables)
+         Window.Table[so] = Table;
+      // TableID may not be valid anymore if a new wavetable is loaded
+
+      unsigned long MSBpos;
+      unsigned int bs = BigMULr16(g.RatioA, 3 * FormantMul);
+
+      if (_BitScanReverse(&MSBpos, bs))
+         g.MipMapB = limit_range((int)MSBpos - 17, 0, oscdata->wt.size_po2 - 1);
+
+      if (_BitScanReverse(&MSBpos, 3 * g.RatioA))
+         g.MipMapA = limit_range((int)MSBpos - 17, 0, storage->WindowWT.size_po2 - 1);
+
+      // A lazily mipmapped table may not have this level yet, in which case play the one below
+      g.MipMapB = std::min(oscdata->wt.readyMipmap(g.MipMapB, Window.Table[so]),
+                           oscdata->wt.readyMipmap(g.MipMapB, Table));
+
+      g.WaveAdr = oscdata->wt.TableI16WeakPointers[g.MipMapB][Window.Table[so]];
+      g.WinAdr = storage->WindowWT.TableI16WeakPointers[g.MipMapA][SelWindow];
+   };
+
+   // Advance a grain by one sample and return its (wave, window) products with the sinc taps,
+   // four partial sums each
+   auto stepGrain = [&](int so, int i, Grain& g, __m128i& Wave, __m128i& Win) {
+      if (FM)
       {
-         unsigned int Pos = Window.Pos[so];
-         unsigned int RatioA = Window.Ratio[so];
+         g.Pos += Window.FMRatio[so][i];
+      }
+      else
+      {
+         g.Pos += g.RatioA;
+      }
 
-         if (FM)
-            RatioA = Window.FMRatio[so][0];
+      if (g.Pos & ~SizeMaskWin)
+      {
+         Window.FormantMul[so] = FormantMul;
+         Window.Table[so] = Table;
+         g.WaveAdr = oscdata->wt.TableI16WeakPointers[g.MipMapB][Table];
+         g.Pos = g.Pos & SizeMaskWin;
+      }
 
-         unsigned int MipMapA = 0;
-         unsigned int MipMapB = 0;
+      unsigned int WinPos = g.Pos >> (16 + g.MipMapA);
+      unsigned int WinSPos = (g.Pos >> (8 + g.MipMapA)) & 0xFF;
 
-         if (Window.Table[so] >= oscdata->wt.n_tables)
-            Window.Table[so] = Table;
-         // TableID may not be valid anymore if a new wavetable is loaded
+      unsigned int FPos = BigMULr16(Window.FormantMul[so], g.Pos) & SizeMask;
 
-         unsigned long MSBpos;
-         unsigned int bs = BigMULr16(RatioA, 3 * FormantMul);
+      unsigned int MPos = FPos >> (16 + g.MipMapB);
+      unsigned int MSPos = ((FPos >> (8 + g.MipMapB)) & 0xFF);
 
-         if (_BitScanReverse(&MSBpos, bs))
-            MipMapB = limit_range((int)MSBpos - 17, 0, oscdata->wt.size_po2 - 1);
+      Wave = _mm_madd_epi16(_mm_load_si128(((__m128i*)sinctableI16 + MSPos)), _mm_loadu_si128((__m128i*)&g.WaveAdr[MPos]));
 
-         if (_BitScanReverse(&MSBpos, 3 * RatioA))
-            MipMapA = limit_range((int)MSBpos - 17, 0, storage->WindowWT.size_po2 - 1);
+      Win = _mm_madd_epi16(_mm_load_si128(((__m128i*)sinctableI16 + WinSPos)), _mm_loadu_si128((__m128i*)&g.WinAdr[WinPos]));
+   };
 
-         short* WaveAdr = oscdata->wt.TableI16WeakPointers[MipMapB][Window.Table[so]];
-         short* WinAdr = storage->WindowWT.TableI16WeakPointers[MipMapA][SelWindow];
+   if (skip)
+   {
+      // Move the grains along as stepGrain would, without reading the tables
+      for (int so = 0; so < NumUnison; so++)
+      {
+         if (Window.Table[so] >= oscdata->wt.n_tables)
+            Window.Table[so] = Table;
 
-         for (int i = 0; i < BLOCK_SIZE_OS; i++)
+         unsigned int Pos = Window.Pos[so];
+         for (int i = 0; i < storage->blockSizeOS; i++)
          {
-            if (FM)
-            {
-               Pos += Window.FMRatio[so][i];
-            }
-            else
-            {
-               Pos += RatioA;
-            }
-
+            Pos += FM ? Window.FMRatio[so][i] : Window.Ratio[so];
             if (Pos & ~SizeMaskWin)
             {
                Window.FormantMul[so] = FormantMul;
                Window.Table[so] = Table;
-               WaveAdr = oscdata->wt.TableI16WeakPointers[MipMapB][Table];
                Pos = Pos & SizeMaskWin;
             }
+         }
+         Window.Pos[so] = Pos;
+      }
+      return;
+   }
 
-            unsigned int WinPos = Pos >> (16 + MipMapA);
-            unsigned int WinSPos = (Pos >> (8 + MipMapA)) & 0xFF;
+   if (quad_grains && NumUnison > 1)
+   {
+      /*
+      ** Four grains at a time. The position arithmetic and the madds are the same as below, but
+      ** the horizontal sums, the window * wave products and the gains are done for all four
+      ** grains together, and their contributions are summed before they are added to the
+      ** output. It's all integer arithmetic so the result is identical.
+      */
+      for (int so0 = 0; so0 < NumUnison; so0 += 4)
+      {
+         int n = std::min(4, NumUnison - so0);
 
-            unsigned int FPos = BigMULr16(Window.FormantMul[so], Pos) & SizeMask;
+         Grain g[4];
+         int gain alignas(16)[2][4] = {{0, 0, 0, 0}, {0, 0, 0, 0}};
+         for (int k = 0; k < n; k++)
+         {
+            startGrain(so0 + k, g[k]);
+            gain[0][k] = Window.Gain[so0 + k][0];
+            gain[1][k] = Window.Gain[so0 + k][1];
+         }
+         __m128i gainL = _mm_load_si128((__m128i*)gain[0]);
+         __m128i gainR = _mm_load_si128((__m128i*)gain[1]);
 
-            unsigned int MPos = FPos >> (16 + MipMapB);
-            unsigned int MSPos = ((FPos >> (8 + MipMapB)) & 0xFF);
+         for (int i = 0; i < storage->blockSizeOS; i++)
+         {
+            __m128i Wave[4], Win[4];
+            for (int k = 0; k < 4; k++)
+            {
+               if (k < n)
+                  stepGrain(so0 + k, i, g[k], Wave[k], Win[k]);
+               else
+                  Wave[k] = Win[k] = _mm_setzero_si128();
+            }
 
-            __m128i Wave = _mm_madd_epi16(_mm_load_si128(((__m128i*)sinctableI16 + MSPos)), _mm_loadu_si128((__m128i*)&WaveAdr[MPos]));
+            __m128i iWin = _mm_srai_epi32(sum4x4_epi32(Win[0], Win[1], Win[2], Win[3]), 13);
+            __m128i iWave = _mm_srai_epi32(sum4x4_epi32(Wave[0], Wave[1], Wave[2], Wave[3]), 13);
+            __m128i Out = mullo_epi32_sse2(iWin, iWave);
 
-            __m128i Win = _mm_madd_epi16(_mm_load_si128(((__m128i*)sinctableI16 + WinSPos)), _mm_loadu_si128((__m128i*)&WinAdr[WinPos]));
+            if (stereo)
+            {
+               Out = _mm_srai_epi32(Out, 7);
+               IOutputL[i] += hsum_epi32(_mm_srai_epi32(mullo_epi32_sse2(Out, gainL), 6));
+               IOutputR[i] += hsum_epi32(_mm_srai_epi32(mullo_epi32_sse2(Out, gainR), 6));
+            }
+            else
+               IOutputL[i] += hsum_epi32(_mm_srai_epi32(Out, 6));
+         }
+
+         for (int k = 0; k < n; k++)
+            Window.Pos[so0 + k] = g[k].Pos;
+      }
+      return;
+   }
+
+   {
+      // SSE2 path
+      for (int so = 0; so < NumUnison; so++)
+      {
+         Grain g;
+         startGrain(so, g);
+
+         for (int i = 0; i < storage->blockSizeOS; i++)
+         {
+            __m128i Wave, Win;
+            stepGrain(so, i, g, Wave, Win);
 
             // Sum
             int iWin alignas(16)[4], iWave alignas(16)[4];
@@ -253,16 +378,27 @@ void WindowOscillator::ProcessWindowOscs(bool stereo, bool FM)
                IOutputL[i] += (iWin[0] * iWave[0]) >> 6;
          }
 
-         Window.Pos[so] = Pos;
+         Window.Pos[so] = g.Pos;
       }
    }
 }
 
 void WindowOscillator::process_block(float pitch, float drift, bool stereo, bool FM, float fmdepth)
 {
-   memset(IOutputL, 0, BLOCK_SIZE_OS * sizeof(int));
+   quad_grains = storage->batchOscillatorUnison;
+   render_block(pitch, drift, stereo, FM, fmdepth);
+}
+
+void WindowOscillator::skip_block(float pitch, float drift, bool stereo, bool FM, float fmdepth)
+{
+   render_block(pitch, drift, stereo, FM, fmdepth, true);
+}
+
+void WindowOscillator::render_block(float pitch, float drift, bool stereo, bool FM, float fmdepth, bool skip)
+{
+   memset(IOutputL, 0, storage->blockSizeOS * sizeof(int));
    if (stereo)
-      memset(IOutputR, 0, BLOCK_SIZE_OS * sizeof(int));
+      memset(IOutputR, 0, storage->blockSizeOS * sizeof(int));
 
    float Detune;
 
@@ -295,7 +431,7 @@ void WindowOscillator::process_block(float pitch, float drift, bool stereo, bool
       {
          FMdepth[l].newValue(fmstrength);
 
-         for (int i = 0; i < BLOCK_SIZE_OS; ++i)
+         for (int i = 0; i < storage->blockSizeOS; ++i)
          {
             float fmadj = (1.0 + FMdepth[l].v * master_osc[i]);
             float f = storage->note_to_pitch(pitch + drift * Window.DriftLFO[l][0] + Detune * (DetuneOffset + DetuneBias * (float)l));
@@ -307,7 +443,9 @@ void WindowOscillator::process_block(float pitch, float drift, bool stereo, bool
       }
    }
 
-   ProcessWindowOscs(stereo, FM);
+   ProcessWindowOscs(stereo, FM, skip);
+   if (skip)
+      return;
 
    // int32 -> float conversion
    __m128 scale = _mm_load1_ps(&OutAttenuation);
@@ -315,7 +453,7 @@ void WindowOscillator::process_block(float pitch, float drift, bool stereo, bool
       // SSE2 path
       if (stereo)
       {
-         for (int i = 0; i < BLOCK_SIZE_OS; i += 4)
+         for (int i = 0; i < storage->blockSizeOS; i += 4)
          {
             _mm_store_ps(&output[i], _mm_mul_ps(_mm_cvtepi32_ps(*(__m128i*)&IOutputL[i]), scale));
             _mm_store_ps(&outputR[i], _mm_mul_ps(_mm_cvtepi32_ps(*(__m128i*)&IOutputR[i]), scale));
@@ -323,7 +461,7 @@ void WindowOscillator::process_block(float pitch, float drift, bool stereo, bool
       }
       else
       {
-         for (int i = 0; i < BLOCK_SIZE_OS; i += 4)
+         for (int i = 0; i < storage->blockSizeOS; i += 4)
          {
             _mm_store_ps(&output[i], _mm_mul_ps(_mm_cvtepi32_ps(*(__m128i*)&IOutputL[i]), scale));
          }
@@ -349,7 +487,7 @@ void WindowOscillator::applyFilter()
       lp.coeff_LP2B(lp.calc_omega(pv / 12.0) / OSC_OVERSAMPLING, 0.707);
    }
 
-   for (int k = 0; k < BLOCK_SIZE_OS; k += BLOCK_SIZE)
+   for (int k = 0; k < storage->blockSizeOS; k += storage->blockSize)
    {
       if (!oscdata->p[win_lowcut].deactivated)
          hp.process_block(&(output[k]), &(outputR[k]));
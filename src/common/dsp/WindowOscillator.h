@@ -40,11 +40,13 @@ public:
    virtual void init_default_values() override;
    virtual void process_block(float pitch, float drift = 0.f, bool stereo = false, bool FM = false, float FMdepth = 0.f) override;
    virtual ~WindowOscillator();
+
+   virtual void skip_block(float pitch, float drift = 0.f, bool stereo = false, bool FM = false, float FMdepth = 0.f) override;
    virtual void handleStreamingMismatches(int streamingRevision, int currentSynthStreamingRevision) override;
 
 private:
-   int IOutputL alignas(16)[BLOCK_SIZE_OS];
-   int IOutputR alignas(16)[BLOCK_SIZE_OS];
+   int IOutputL alignas(16)[BLOCK_SIZE_OS_MAX];
+   int IOutputR alignas(16)[BLOCK_SIZE_OS_MAX];
    struct
    {
       unsigned int Pos[MAX_UNISON];
@@ -57,13 +59,15 @@ private:
       unsigned char Gain[MAX_UNISON][2];
       float DriftLFO[MAX_UNISON][2];
 
-      int FMRatio[MAX_UNISON][BLOCK_SIZE_OS];
+      int FMRatio[MAX_UNISON][BLOCK_SIZE_OS_MAX];
    } Window alignas(16);
 
    BiquadFilter lp, hp;
    void applyFilter();
 
-   void ProcessWindowOscs(bool stereo, bool FM);
+   void render_block(float pitch, float drift, bool stereo, bool FM, float FMdepth, bool skip = false);
+   void ProcessWindowOscs(bool stereo, bool FM, bool skip = false);
+   bool quad_grains = true;
    lag<double> FMdepth[MAX_UNISON];
 
    float OutAttenuation;
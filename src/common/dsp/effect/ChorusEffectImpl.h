@@ -12,8 +12,6 @@ template <int v>
 ChorusEffect<v>::ChorusEffect(SurgeStorage* storage, FxStorage* fxdata, pdata* pd)
     : Effect(storage, fxdata, pd), lp(storage), hp(storage)
 {
-   mix.set_blocksize(BLOCK_SIZE);
-   feedback.set_blocksize(BLOCK_SIZE);
 }
 
 template <int v> ChorusEffect<v>::~ChorusEffect()
@@ -21,6 +19,13 @@ template <int v> ChorusEffect<v>::~ChorusEffect()
 
 template <int v> void ChorusEffect<v>::init()
 {
+   mix.set_blocksize(storage->blockSize);
+   feedback.set_blocksize(storage->blockSize);
+   // width has always ramped over 64 samples, the old default, rather than one block
+   width.set_blocksize(storage->blockSizeOS);
+   mix.set_smoothing_blocksize(storage->blockSize);
+   feedback.set_smoothing_blocksize(storage->blockSize);
+   width.set_smoothing_blocksize(storage->blockSize);
    memset(buffer, 0, (max_delay_length + FIRipol_N) * sizeof(float));
    wpos = 0;
    envf = 0;
@@ -55,7 +60,7 @@ template <int v> void ChorusEffect<v>::setvars(bool init)
    else
    {
       feedback.set_target_smoothed(0.5f * amp_to_linear(*f[ch_feedback]));
-      float rate = envelope_rate_linear(-*f[1]) *
+      float rate = storage->envelope_rate_linear(-*f[1]) *
                    (fxdata->p[ch_rate].temposync ? storage->temposyncratio : 1.f);
       float tm = storage->note_to_pitch_ignoring_tuning(12 * *f[0]) *
                  (fxdata->p[ch_time].temposync ? storage->temposyncratio_inv : 1.f);
@@ -81,14 +86,14 @@ template <int v> void ChorusEffect<v>::process(float* dataL, float* dataR)
 {
    setvars(false);
 
-   float tbufferL alignas(16)[BLOCK_SIZE];
-   float tbufferR alignas(16)[BLOCK_SIZE];
-   float fbblock alignas(16)[BLOCK_SIZE];
+   float tbufferL alignas(16)[BLOCK_SIZE_MAX];
+   float tbufferR alignas(16)[BLOCK_SIZE_MAX];
+   float fbblock alignas(16)[BLOCK_SIZE_MAX];
 
-   clear_block(tbufferL, BLOCK_SIZE_QUAD);
-   clear_block(tbufferR, BLOCK_SIZE_QUAD);
+   clear_block(tbufferL, storage->blockSizeQuad);
+   clear_block(tbufferR, storage->blockSizeQuad);
 
-   for (int k = 0; k < BLOCK_SIZE; k++)
+   for (int k = 0; k < storage->blockSize; k++)
    {
       __m128 L = _mm_setzero_ps(), R = _mm_setzero_ps();
 
@@ -96,7 +101,7 @@ template <int v> void ChorusEffect<v>::process(float* dataL, float* dataR)
       {
          time[j].process();
          float vtime = time[j].v;
-         int i_dtime = max(BLOCK_SIZE, min((int)vtime, max_delay_length - FIRipol_N - 1));
+         int i_dtime = max(storage->blockSize, min((int)vtime, max_delay_length - FIRipol_N - 1));
          int rp = ((wpos - i_dtime + k) - FIRipol_N) & (max_delay_length - 1);
          int sinc = FIRipol_N *
                     limit_range((int)(FIRipol_M * (float(i_dtime + 1) - vtime)), 0, FIRipol_M - 1);
@@ -119,22 +124,22 @@ template <int v> void ChorusEffect<v>::process(float* dataL, float* dataR)
 
    lp.process_block(tbufferL, tbufferR);
    hp.process_block(tbufferL, tbufferR);
-   add_block(tbufferL, tbufferR, fbblock, BLOCK_SIZE_QUAD);
-   feedback.multiply_block(fbblock, BLOCK_SIZE_QUAD);
-   hardclip_block(fbblock, BLOCK_SIZE_QUAD);
-   accumulate_block(dataL, fbblock, BLOCK_SIZE_QUAD);
-   accumulate_block(dataR, fbblock, BLOCK_SIZE_QUAD);
+   add_block(tbufferL, tbufferR, fbblock, storage->blockSizeQuad);
+   feedback.multiply_block(fbblock, storage->blockSizeQuad);
+   hardclip_block(fbblock, storage->blockSizeQuad);
+   accumulate_block(dataL, fbblock, storage->blockSizeQuad);
+   accumulate_block(dataR, fbblock, storage->blockSizeQuad);
 
-   if (wpos + BLOCK_SIZE >= max_delay_length)
+   if (wpos + storage->blockSize >= max_delay_length)
    {
-      for (int k = 0; k < BLOCK_SIZE; k++)
+      for (int k = 0; k < storage->blockSize; k++)
       {
          buffer[(wpos + k) & (max_delay_length - 1)] = fbblock[k];
       }
    }
    else
    {
-      copy_block(fbblock, &buffer[wpos], BLOCK_SIZE_QUAD);
+      copy_block(fbblock, &buffer[wpos], storage->blockSizeQuad);
    }
 
    if (wpos == 0)
@@ -142,14 +147,14 @@ template <int v> void ChorusEffect<v>::process(float* dataL, float* dataR)
          buffer[k + max_delay_length] = buffer[k]; // copy buffer so FIR-core doesn't have to wrap
 
    // scale width
-   float M alignas(16)[BLOCK_SIZE], S alignas(16)[BLOCK_SIZE];
-   encodeMS(tbufferL, tbufferR, M, S, BLOCK_SIZE_QUAD);
-   width.multiply_block(S, BLOCK_SIZE_QUAD);
-   decodeMS(M, S, tbufferL, tbufferR, BLOCK_SIZE_QUAD);
+   float M alignas(16)[BLOCK_SIZE_MAX], S alignas(16)[BLOCK_SIZE_MAX];
+   encodeMS(tbufferL, tbufferR, M, S, storage->blockSizeQuad);
+   width.multiply_block(S, storage->blockSizeQuad);
+   decodeMS(M, S, tbufferL, tbufferR, storage->blockSizeQuad);
 
-   mix.fade_2_blocks_to(dataL, tbufferL, dataR, tbufferR, dataL, dataR, BLOCK_SIZE_QUAD);
+   mix.fade_2_blocks_to(dataL, tbufferL, dataR, tbufferR, dataL, dataR, storage->blockSizeQuad);
 
-   wpos += BLOCK_SIZE;
+   wpos += storage->blockSize;
    wpos = wpos & (max_delay_length - 1);
 }
 
@@ -10,11 +10,6 @@ ConditionerEffect::ConditionerEffect(SurgeStorage* storage, FxStorage* fxdata, p
     : Effect(storage, fxdata, pd), band1(storage), band2(storage)
 {
    bufpos = 0;
-
-   ampL.set_blocksize(BLOCK_SIZE);
-   ampR.set_blocksize(BLOCK_SIZE);
-   width.set_blocksize(BLOCK_SIZE);
-   postamp.set_blocksize(BLOCK_SIZE);
 }
 
 ConditionerEffect::~ConditionerEffect()
@@ -22,6 +17,16 @@ ConditionerEffect::~ConditionerEffect()
 
 void ConditionerEffect::init()
 {
+   ampL.set_blocksize(storage->blockSize);
+   ampR.set_blocksize(storage->blockSize);
+   width.set_blocksize(storage->blockSize);
+   postamp.set_blocksize(storage->blockSize);
+   ampL.set_smoothing_blocksize(storage->blockSize);
+   ampR.set_smoothing_blocksize(storage->blockSize);
+   width.set_smoothing_blocksize(storage->blockSize);
+   postamp.set_smoothing_blocksize(storage->blockSize);
+   a_rate.setBlockSize(storage->blockSize);
+   r_rate.setBlockSize(storage->blockSize);
    setvars(true);
    ef = 0;
    bufpos = 0;
@@ -62,7 +67,7 @@ void ConditionerEffect::process_only_control()
    vu[4] = min(8.f, a * vu[4]);
    vu[5] = min(8.f, a * vu[5]);
 
-   for (int k = 0; k < BLOCK_SIZE; k++)
+   for (int k = 0; k < storage->blockSize; k++)
    {
       filtered_lamax = (1 - attack) * filtered_lamax + attack;
       filtered_lamax2 = (1 - release) * filtered_lamax2 + (release)*filtered_lamax;
@@ -97,18 +102,18 @@ void ConditionerEffect::process(float* dataL, float* dataR)
    width.set_target_smoothed(clamp1bp(*f[cond_width]));
    postamp.set_target_smoothed(db_to_linear(*f[cond_gain]));
 
-   float M alignas(16)[BLOCK_SIZE],
-         S alignas(16)[BLOCK_SIZE]; // wb = write-buffer
-   encodeMS(dataL, dataR, M, S, BLOCK_SIZE_QUAD);
-   width.multiply_block(S, BLOCK_SIZE_QUAD);
-   decodeMS(M, S, dataL, dataR, BLOCK_SIZE_QUAD);
-   ampL.multiply_block(dataL, BLOCK_SIZE_QUAD);
-   ampR.multiply_block(dataR, BLOCK_SIZE_QUAD);
+   float M alignas(16)[BLOCK_SIZE_MAX],
+         S alignas(16)[BLOCK_SIZE_MAX]; // wb = write-buffer
+   encodeMS(dataL, dataR, M, S, storage->blockSizeQuad);
+   width.multiply_block(S, storage->blockSizeQuad);
+   decodeMS(M, S, dataL, dataR, storage->blockSizeQuad);
+   ampL.multiply_block(dataL, storage->blockSizeQuad);
+   ampR.multiply_block(dataR, storage->blockSizeQuad);
 
-   vu[0] = max(vu[0], get_absmax(dataL, BLOCK_SIZE_QUAD));
-   vu[1] = max(vu[1], get_absmax(dataR, BLOCK_SIZE_QUAD));
+   vu[0] = max(vu[0], get_absmax(dataL, storage->blockSizeQuad));
+   vu[1] = max(vu[1], get_absmax(dataR, storage->blockSizeQuad));
 
-   for (int k = 0; k < BLOCK_SIZE; k++)
+   for (int k = 0; k < storage->blockSize; k++)
    {
       float dL = delayed[0][bufpos];
       float dR = delayed[1][bufpos];
@@ -145,12 +150,12 @@ void ConditionerEffect::process(float* dataL, float* dataR)
       bufpos = (bufpos + 1) & (lookahead - 1);
    }
 
-   postamp.multiply_2_blocks(dataL, dataR, BLOCK_SIZE_QUAD);
+   postamp.multiply_2_blocks(dataL, dataR, storage->blockSizeQuad);
 
    vu[2] = gain;
 
-   vu[4] = max(vu[4], get_absmax(dataL, BLOCK_SIZE_QUAD));
-   vu[5] = max(vu[5], get_absmax(dataR, BLOCK_SIZE_QUAD));
+   vu[4] = max(vu[4], get_absmax(dataL, storage->blockSizeQuad));
+   vu[5] = max(vu[5], get_absmax(dataR, storage->blockSizeQuad));
 }
 
 int ConditionerEffect::vu_type(int id)
@@ -9,10 +9,6 @@ const int distortion_OS = 1 << dist_OS_bits;
 DistortionEffect::DistortionEffect(SurgeStorage* storage, FxStorage* fxdata, pdata* pd)
     : Effect(storage, fxdata, pd), band1(storage), band2(storage), lp1(storage), lp2(storage), hr_a(3, false), hr_b(3, true)
 {
-   lp1.setBlockSize(BLOCK_SIZE * distortion_OS);
-   lp2.setBlockSize(BLOCK_SIZE * distortion_OS);
-   drive.set_blocksize(BLOCK_SIZE);
-   outgain.set_blocksize(BLOCK_SIZE);
 }
 
 DistortionEffect::~DistortionEffect()
@@ -20,6 +16,12 @@ DistortionEffect::~DistortionEffect()
 
 void DistortionEffect::init()
 {
+   lp1.setBlockSize(storage->blockSize * distortion_OS);
+   lp2.setBlockSize(storage->blockSize * distortion_OS);
+   drive.set_blocksize(storage->blockSize);
+   outgain.set_blocksize(storage->blockSize);
+   drive.set_smoothing_blocksize(storage->blockSize);
+   outgain.set_smoothing_blocksize(storage->blockSize);
    setvars(true);
    band1.suspend();
    band2.suspend();
@@ -70,13 +72,13 @@ void DistortionEffect::process(float* dataL, float* dataR)
    if (ws < 0 || ws >= n_ws_types)
       ws = 0;
 
-   float bL alignas(16)[BLOCK_SIZE << dist_OS_bits];
-   float bR alignas(16)[BLOCK_SIZE << dist_OS_bits];
+   float bL alignas(16)[BLOCK_SIZE_MAX << dist_OS_bits];
+   float bR alignas(16)[BLOCK_SIZE_MAX << dist_OS_bits];
    assert(dist_OS_bits == 2);
 
-   drive.multiply_2_blocks(dataL, dataR, BLOCK_SIZE_QUAD);
+   drive.multiply_2_blocks(dataL, dataR, storage->blockSizeQuad);
 
-   for (int k = 0; k < BLOCK_SIZE; k++)
+   for (int k = 0; k < storage->blockSize; k++)
    {
       float a = (k & 16) ? 0.00000001 : -0.00000001; // denormal thingy
       float Lin = dataL[k];
@@ -96,10 +98,10 @@ void DistortionEffect::process(float* dataL, float* dataR)
       }
    }
 
-   hr_a.process_block_D2(bL, bR, 128);
-   hr_b.process_block_D2(bL, bR, 64);
+   hr_a.process_block_D2(bL, bR, storage->blockSize << dist_OS_bits);
+   hr_b.process_block_D2(bL, bR, storage->blockSize << (dist_OS_bits - 1));
 
-   outgain.multiply_2_blocks_to(bL, bR, dataL, dataR, BLOCK_SIZE_QUAD);
+   outgain.multiply_2_blocks_to(bL, bR, dataL, dataR, storage->blockSizeQuad);
 
    band2.process_block(dataL, dataR);
 }
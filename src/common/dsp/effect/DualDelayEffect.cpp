@@ -5,10 +5,6 @@ using namespace std;
 DualDelayEffect::DualDelayEffect(SurgeStorage* storage, FxStorage* fxdata, pdata* pd)
     : Effect(storage, fxdata, pd), timeL(0.0001), timeR(0.0001), lp(storage), hp(storage)
 {
-   mix.set_blocksize(BLOCK_SIZE);
-   pan.set_blocksize(BLOCK_SIZE);
-   feedback.set_blocksize(BLOCK_SIZE);
-   crossfeed.set_blocksize(BLOCK_SIZE);
 }
 
 DualDelayEffect::~DualDelayEffect()
@@ -16,6 +12,17 @@ DualDelayEffect::~DualDelayEffect()
 
 void DualDelayEffect::init()
 {
+   mix.set_blocksize(storage->blockSize);
+   pan.set_blocksize(storage->blockSize);
+   feedback.set_blocksize(storage->blockSize);
+   crossfeed.set_blocksize(storage->blockSize);
+   // width kept the old 64 sample default, twice the default block, so keep that ratio
+   width.set_blocksize(storage->blockSizeOS);
+   mix.set_smoothing_blocksize(storage->blockSize);
+   pan.set_smoothing_blocksize(storage->blockSize);
+   feedback.set_smoothing_blocksize(storage->blockSize);
+   crossfeed.set_smoothing_blocksize(storage->blockSize);
+   width.set_smoothing_blocksize(storage->blockSize);
    memset(buffer[0], 0, (max_delay_length + FIRipol_N) * sizeof(float));
    memset(buffer[1], 0, (max_delay_length + FIRipol_N) * sizeof(float));
    wpos = 0;
@@ -46,7 +53,7 @@ void DualDelayEffect::setvars(bool init)
    feedback.set_target_smoothed(fb);
    crossfeed.set_target_smoothed(cf);
 
-   float lforate = envelope_rate_linear(-*f[dly_mod_rate]) * (fxdata->p[dly_mod_rate].temposync ? storage->temposyncratio : 1.f);
+   float lforate = storage->envelope_rate_linear(-*f[dly_mod_rate]) * (fxdata->p[dly_mod_rate].temposync ? storage->temposyncratio : 1.f);
    lfophase += lforate;
 
    if (lfophase > 0.5)
@@ -55,7 +62,7 @@ void DualDelayEffect::setvars(bool init)
       LFOdirection = !LFOdirection;
    }
 
-   float lfo_increment = (0.00000000001f + powf(2, *f[dly_mod_depth] * (1.f / 12.f)) - 1.f) * BLOCK_SIZE;
+   float lfo_increment = (0.00000000001f + powf(2, *f[dly_mod_depth] * (1.f / 12.f)) - 1.f) * storage->blockSize;
    // small bias to avoid denormals
 
    const float ca = 0.99f;
@@ -84,7 +91,7 @@ void DualDelayEffect::setvars(bool init)
 
    if (maxfb < 1.f)
    {
-      float f = BLOCK_SIZE_INV * max(timeL.v, timeR.v) * (1.f + log(db96) / log(maxfb));
+      float f = storage->blockSizeInv * max(timeL.v, timeR.v) * (1.f + log(db96) / log(maxfb));
       ringout_time = (int)f;
    }
    else
@@ -119,16 +126,16 @@ void DualDelayEffect::process(float* dataL, float* dataR)
    setvars(false);
 
    int k;
-   float tbufferL alignas(16)[BLOCK_SIZE], wbL alignas(16)[BLOCK_SIZE]; // wb = write-buffer
-   float tbufferR alignas(16)[BLOCK_SIZE], wbR alignas(16)[BLOCK_SIZE];
+   float tbufferL alignas(16)[BLOCK_SIZE_MAX], wbL alignas(16)[BLOCK_SIZE_MAX]; // wb = write-buffer
+   float tbufferR alignas(16)[BLOCK_SIZE_MAX], wbR alignas(16)[BLOCK_SIZE_MAX];
 
-   for (k = 0; k < BLOCK_SIZE; k++)
+   for (k = 0; k < storage->blockSize; k++)
    {
       timeL.process();
       timeR.process();
 
-      int i_dtimeL = max(BLOCK_SIZE, min((int)timeL.v, max_delay_length - FIRipol_N - 1));
-      int i_dtimeR = max(BLOCK_SIZE, min((int)timeR.v, max_delay_length - FIRipol_N - 1));
+      int i_dtimeL = max(storage->blockSize, min((int)timeL.v, max_delay_length - FIRipol_N - 1));
+      int i_dtimeR = max(storage->blockSize, min((int)timeR.v, max_delay_length - FIRipol_N - 1));
 
       int rpL = ((wpos - i_dtimeL + k) - FIRipol_N) & (max_delay_length - 1);
       int rpR = ((wpos - i_dtimeR + k) - FIRipol_N) & (max_delay_length - 1);
@@ -149,20 +156,20 @@ void DualDelayEffect::process(float* dataL, float* dataR)
       _mm_store_ss(&tbufferR[k], R);
    }
 
-   softclip_block(tbufferL, BLOCK_SIZE_QUAD);
-   softclip_block(tbufferR, BLOCK_SIZE_QUAD);
+   softclip_block(tbufferL, storage->blockSizeQuad);
+   softclip_block(tbufferR, storage->blockSizeQuad);
 
    lp.process_block(tbufferL, tbufferR);
    hp.process_block(tbufferL, tbufferR);
 
-   pan.trixpan_blocks(dataL, dataR, wbL, wbR, BLOCK_SIZE_QUAD);
+   pan.trixpan_blocks(dataL, dataR, wbL, wbR, storage->blockSizeQuad);
 
-   feedback.MAC_2_blocks_to(tbufferL, tbufferR, wbL, wbR, BLOCK_SIZE_QUAD);
-   crossfeed.MAC_2_blocks_to(tbufferL, tbufferR, wbR, wbL, BLOCK_SIZE_QUAD);
+   feedback.MAC_2_blocks_to(tbufferL, tbufferR, wbL, wbR, storage->blockSizeQuad);
+   crossfeed.MAC_2_blocks_to(tbufferL, tbufferR, wbR, wbL, storage->blockSizeQuad);
 
-   if (wpos + BLOCK_SIZE >= max_delay_length)
+   if (wpos + storage->blockSize >= max_delay_length)
    {
-      for (k = 0; k < BLOCK_SIZE; k++)
+      for (k = 0; k < storage->blockSize; k++)
       {
          buffer[0][(wpos + k) & (max_delay_length - 1)] = wbL[k];
          buffer[1][(wpos + k) & (max_delay_length - 1)] = wbR[k];
@@ -170,8 +177,8 @@ void DualDelayEffect::process(float* dataL, float* dataR)
    }
    else
    {
-      copy_block(wbL, &buffer[0][wpos], BLOCK_SIZE_QUAD);
-      copy_block(wbR, &buffer[1][wpos], BLOCK_SIZE_QUAD);
+      copy_block(wbL, &buffer[0][wpos], storage->blockSizeQuad);
+      copy_block(wbR, &buffer[1][wpos], storage->blockSizeQuad);
    }
 
    if (wpos == 0)
@@ -184,14 +191,14 @@ void DualDelayEffect::process(float* dataL, float* dataR)
    }
 
    // scale width
-   float M alignas(16)[BLOCK_SIZE], S alignas(16)[BLOCK_SIZE];
-   encodeMS(tbufferL, tbufferR, M, S, BLOCK_SIZE_QUAD);
-   width.multiply_block(S, BLOCK_SIZE_QUAD);
-   decodeMS(M, S, tbufferL, tbufferR, BLOCK_SIZE_QUAD);
+   float M alignas(16)[BLOCK_SIZE_MAX], S alignas(16)[BLOCK_SIZE_MAX];
+   encodeMS(tbufferL, tbufferR, M, S, storage->blockSizeQuad);
+   width.multiply_block(S, storage->blockSizeQuad);
+   decodeMS(M, S, tbufferL, tbufferR, storage->blockSizeQuad);
 
-   mix.fade_2_blocks_to(dataL, tbufferL, dataR, tbufferR, dataL, dataR, BLOCK_SIZE_QUAD);
+   mix.fade_2_blocks_to(dataL, tbufferL, dataR, tbufferR, dataL, dataR, storage->blockSizeQuad);
 
-   wpos += BLOCK_SIZE;
+   wpos += storage->blockSize;
    wpos = wpos & (max_delay_length - 1);
 }
 
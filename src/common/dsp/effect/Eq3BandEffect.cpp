@@ -18,12 +18,6 @@
 Eq3BandEffect::Eq3BandEffect(SurgeStorage* storage, FxStorage* fxdata, pdata* pd)
     : Effect(storage, fxdata, pd), band1(storage), band2(storage), band3(storage)
 {
-   band1.setBlockSize(BLOCK_SIZE * slowrate); // does not matter ATM as they're smoothed
-   band2.setBlockSize(BLOCK_SIZE * slowrate);
-   band3.setBlockSize(BLOCK_SIZE * slowrate);
-
-   gain.set_blocksize(BLOCK_SIZE);
-   mix.set_blocksize(BLOCK_SIZE);
 }
 
 Eq3BandEffect::~Eq3BandEffect()
@@ -31,6 +25,13 @@ Eq3BandEffect::~Eq3BandEffect()
 
 void Eq3BandEffect::init()
 {
+   band1.setBlockSize(storage->blockSize * slowrate); // does not matter ATM as they're smoothed
+   band2.setBlockSize(storage->blockSize * slowrate);
+   band3.setBlockSize(storage->blockSize * slowrate);
+   gain.set_blocksize(storage->blockSize);
+   mix.set_blocksize(storage->blockSize);
+   gain.set_smoothing_blocksize(storage->blockSize);
+   mix.set_smoothing_blocksize(storage->blockSize);
    setvars(true);
    band1.suspend();
    band2.suspend();
@@ -71,8 +72,8 @@ void Eq3BandEffect::process(float* dataL, float* dataR)
       setvars(false);
    bi = (bi + 1) & slowrate_m1;
 
-   copy_block(dataL, L, BLOCK_SIZE_QUAD);
-   copy_block(dataR, R, BLOCK_SIZE_QUAD);
+   copy_block(dataL, L, storage->blockSizeQuad);
+   copy_block(dataR, R, storage->blockSizeQuad);
 
    if( ! fxdata->p[eq3_gain1].deactivated )
       band1.process_block(L, R);
@@ -82,10 +83,10 @@ void Eq3BandEffect::process(float* dataL, float* dataR)
       band3.process_block(L, R);
 
    gain.set_target_smoothed(db_to_linear(*f[eq3_gain]));
-   gain.multiply_2_blocks(L, R, BLOCK_SIZE_QUAD);
+   gain.multiply_2_blocks(L, R, storage->blockSizeQuad);
 
    mix.set_target_smoothed(limit_range(*f[eq3_mix], -1.f, 1.f));
-   mix.fade_2_blocks_to(dataL, L, dataR, R, dataL, dataR, BLOCK_SIZE_QUAD);
+   mix.fade_2_blocks_to(dataL, L, dataR, R, dataL, dataR, storage->blockSizeQuad);
 }
 
 void Eq3BandEffect::suspend()
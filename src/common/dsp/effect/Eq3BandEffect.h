@@ -30,8 +30,8 @@ class Eq3BandEffect : public Effect
    lipol_ps gain alignas(16);
    lipol_ps mix alignas(16);
 
-   float L alignas(16)[BLOCK_SIZE],
-         R alignas(16)[BLOCK_SIZE];
+   float L alignas(16)[BLOCK_SIZE_MAX],
+         R alignas(16)[BLOCK_SIZE_MAX];
 
 public:
    enum eq3_params
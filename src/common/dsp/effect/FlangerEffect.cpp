@@ -1,6 +1,7 @@
 #include "FlangerEffect.h"
 #include "Tunings.h"
 #include "DebugHelpers.h"
+#include "util/SceneRandom.h"
 #include <algorithm>
 
 FlangerEffect::FlangerEffect(SurgeStorage* storage, FxStorage* fxdata, pdata* pd)
@@ -15,6 +16,17 @@ FlangerEffect::~FlangerEffect()
 
 void FlangerEffect::init()
 {
+   width.set_blocksize(storage->blockSizeOS); // two blocks, as with the old 64 sample default
+   width.set_smoothing_blocksize(storage->blockSize);
+   for (int c = 0; c < 2; ++c)
+      for (int i = 0; i < COMBS_PER_CHANNEL; ++i)
+      {
+         lfoval[c][i].setBlockSize(storage->blockSize);
+         delaybase[c][i].setBlockSize(storage->blockSize);
+      }
+   for (auto* l : {&depth, &mix, &voices, &voice_detune, &voice_chord, &feedback, &fb_lf_damping})
+      l->setBlockSize(storage->blockSize);
+
    for( int c=0;c<2;++c )
       for( int i=0; i<COMBS_PER_CHANNEL; ++i )
       {
@@ -55,7 +67,7 @@ void FlangerEffect::process(float* dataL, float* dataR)
    }
    // So here is a flanger with everything fixed
 
-   float rate = envelope_rate_linear(-limit_range( *f[fl_rate], -8.f, 10.f ) ) * (fxdata->p[fl_rate].temposync ? storage->temposyncratio : 1.f);
+   float rate = storage->envelope_rate_linear(-limit_range( *f[fl_rate], -8.f, 10.f ) ) * (fxdata->p[fl_rate].temposync ? storage->temposyncratio : 1.f);
 
    for( int c=0; c<2; ++c )
    {
@@ -128,7 +140,7 @@ void FlangerEffect::process(float* dataL, float* dataR)
          {
             if( lforeset )
             {
-               lfosandhtarget[c][i] = 1.f * rand() / (float)RAND_MAX  - 1.f;
+               lfosandhtarget[c][i] = 1.f * Surge::SceneRandom::rand() / (float)RAND_MAX  - 1.f;
             }
             // FIXME - exponential creep up. We want to get there in a time related to our rate
             auto cv = lfoval[c][i].v;
@@ -156,7 +168,7 @@ void FlangerEffect::process(float* dataL, float* dataR)
    averageDelayBase /= ( 2 * COMBS_PER_CHANNEL );
    vzeropitch.process();
    
-   float dApprox = rate * samplerate / BLOCK_SIZE * averageDelayBase * *f[fl_depth];
+   float dApprox = rate * samplerate / storage->blockSize * averageDelayBase * *f[fl_depth];
    
    depth.newValue( limit_range( *f[fl_depth], 0.f, 2.f ) );
    mix.newValue( *f[fl_mix] );
@@ -207,7 +219,7 @@ void FlangerEffect::process(float* dataL, float* dataR)
 
    feedback.newValue( feedbackScale * fbv ); 
    fb_lf_damping.newValue( 0.4 * *f[fl_damping] );
-   float combs alignas(16)[2][BLOCK_SIZE];
+   float combs alignas(16)[2][BLOCK_SIZE_MAX];
 
    // Obviously when we implement stereo spread this will be different
    for( int c=0; c<2; ++c )
@@ -256,7 +268,7 @@ void FlangerEffect::process(float* dataL, float* dataR)
       }
    }
 
-   for( int b=0; b<BLOCK_SIZE; ++b )
+   for( int b=0; b<storage->blockSize; ++b )
    {
       for( int c=0; c<2; ++c ) {
          combs[c][b] = 0;
@@ -346,11 +358,11 @@ void FlangerEffect::process(float* dataL, float* dataR)
 
    width.set_target_smoothed(db_to_linear(*f[fl_width]) / 3);
 
-   float M alignas(16)[BLOCK_SIZE],
-         S alignas(16)[BLOCK_SIZE];
-   encodeMS(dataL, dataR, M, S, BLOCK_SIZE_QUAD);
-   width.multiply_block(S, BLOCK_SIZE_QUAD);
-   decodeMS(M, S, dataL, dataR, BLOCK_SIZE_QUAD);
+   float M alignas(16)[BLOCK_SIZE_MAX],
+         S alignas(16)[BLOCK_SIZE_MAX];
+   encodeMS(dataL, dataR, M, S, storage->blockSizeQuad);
+   width.multiply_block(S, storage->blockSizeQuad);
+   decodeMS(M, S, dataL, dataR, storage->blockSizeQuad);
 
 }
 
@@ -13,6 +13,9 @@ FreqshiftEffect::~FreqshiftEffect()
 
 void FreqshiftEffect::init()
 {
+   feedback.setBlockSize(storage->blockSize);
+   mix.set_blocksize(storage->blockSizeOS); // two blocks, as with the old 64 sample default
+   mix.set_smoothing_blocksize(storage->blockSize);
    memset(buffer, 0, 2 * max_delay_length * sizeof(float));
    wpos = 0;
    fr.reset();
@@ -68,7 +71,7 @@ void FreqshiftEffect::setvars(bool init)
 
    if (maxfb < 1.f)
    {
-      float f = BLOCK_SIZE_INV * time.v * (1.f + log(db96) / log(maxfb));
+      float f = storage->blockSizeInv * time.v * (1.f + log(db96) / log(maxfb));
       ringout_time = (int)f;
    }
    else
@@ -83,18 +86,18 @@ void FreqshiftEffect::process(float* dataL, float* dataR)
    setvars(false);
 
    int k;
-   float L alignas(16)[BLOCK_SIZE],
-         R alignas(16)[BLOCK_SIZE],
-         Li alignas(16)[BLOCK_SIZE],
-         Ri alignas(16)[BLOCK_SIZE],
-         Lr alignas(16)[BLOCK_SIZE],
-         Rr alignas(16)[BLOCK_SIZE];
-
-   for (k = 0; k < BLOCK_SIZE; k++)
+   float L alignas(16)[BLOCK_SIZE_MAX],
+         R alignas(16)[BLOCK_SIZE_MAX],
+         Li alignas(16)[BLOCK_SIZE_MAX],
+         Ri alignas(16)[BLOCK_SIZE_MAX],
+         Lr alignas(16)[BLOCK_SIZE_MAX],
+         Rr alignas(16)[BLOCK_SIZE_MAX];
+
+   for (k = 0; k < storage->blockSize; k++)
    {
       time.process();
 
-      int i_dtime = max(FIRipol_N + BLOCK_SIZE, min((int)time.v, max_delay_length - FIRipol_N - 1));
+      int i_dtime = max(FIRipol_N + storage->blockSize, min((int)time.v, max_delay_length - FIRipol_N - 1));
       int rp = (wpos - i_dtime + k);
       int sinc = FIRipol_N * limit_range((int)(FIRipol_M * (float(i_dtime + 1) - time.v)), 0, FIRipol_M - 1);
 
@@ -116,10 +119,10 @@ void FreqshiftEffect::process(float* dataL, float* dataR)
       Ri[k] = R[k] * o1R.i;
    }
 
-   fr.process_block(Lr, Rr, BLOCK_SIZE);
-   fi.process_block(Li, Ri, BLOCK_SIZE);
+   fr.process_block(Lr, Rr, storage->blockSize);
+   fi.process_block(Li, Ri, storage->blockSize);
 
-   for (k = 0; k < BLOCK_SIZE; k++)
+   for (k = 0; k < storage->blockSize; k++)
    {
       o2L.process();
       Lr[k] *= o2L.r;
@@ -139,9 +142,9 @@ void FreqshiftEffect::process(float* dataL, float* dataR)
       buffer[1][wp] = dataR[k] + (float)lookup_waveshape(wst_soft, (R[k] * feedback.v));
    }
 
-   mix.fade_2_blocks_to(dataL, L, dataR, R, dataL, dataR, BLOCK_SIZE_QUAD);
+   mix.fade_2_blocks_to(dataL, L, dataR, R, dataL, dataR, storage->blockSizeQuad);
 
-   wpos += BLOCK_SIZE;
+   wpos += storage->blockSize;
    wpos = wpos & (max_delay_length - 1);
 }
 
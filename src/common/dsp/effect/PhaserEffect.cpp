@@ -17,9 +17,6 @@ PhaserEffect::PhaserEffect(SurgeStorage* storage, FxStorage* fxdata, pdata* pd)
       new (biquad[i]) BiquadFilter(storage);
    }
    n_bq_units_initialised = n_bq_units;
-   feedback.setBlockSize(BLOCK_SIZE * slowrate);
-   width.set_blocksize(BLOCK_SIZE);
-   mix.set_blocksize(BLOCK_SIZE);
    bi = 0;
 }
 
@@ -31,6 +28,11 @@ PhaserEffect::~PhaserEffect()
 
 void PhaserEffect::init()
 {
+   feedback.setBlockSize(storage->blockSize * slowrate);
+   width.set_blocksize(storage->blockSize);
+   mix.set_blocksize(storage->blockSize);
+   width.set_smoothing_blocksize(storage->blockSize);
+   mix.set_smoothing_blocksize(storage->blockSize);
    bi = 0;
    dL = 0;
    dR = 0;
@@ -40,8 +42,8 @@ void PhaserEffect::init()
    {
       biquad[i]->suspend();
    }
-   clear_block(L, BLOCK_SIZE_QUAD);
-   clear_block(R, BLOCK_SIZE_QUAD);
+   clear_block(L, storage->blockSizeQuad);
+   clear_block(R, storage->blockSizeQuad);
    mix.set_target(1.f);
    width.instantize();
    mix.instantize();
@@ -69,7 +71,7 @@ void PhaserEffect::process_only_control()
 {
    init_stages();
    
-   float rate = envelope_rate_linear(-*f[ph_mod_rate]) *
+   float rate = storage->envelope_rate_linear(-*f[ph_mod_rate]) *
                 (fxdata->p[ph_mod_rate].temposync ? storage->temposyncratio : 1.f);
 
    lfophase += (float)slowrate * rate;
@@ -100,7 +102,7 @@ void PhaserEffect::setvars()
 {
    init_stages();
    
-   double rate = envelope_rate_linear(-*f[ph_mod_rate]) *
+   double rate = storage->envelope_rate_linear(-*f[ph_mod_rate]) *
                  (fxdata->p[ph_mod_rate].temposync ? storage->temposyncratio : 1.f);
 
    lfophase += (float)slowrate * rate;
@@ -148,7 +150,7 @@ void PhaserEffect::process(float* dataL, float* dataR)
       setvars();
    bi = (bi + 1) & slowrate_m1;
 
-   for (int i = 0; i < BLOCK_SIZE; i++)
+   for (int i = 0; i < storage->blockSize; i++)
    {
       feedback.process();
       dL = dataL[i] + dL * feedback.v;
@@ -166,13 +168,13 @@ void PhaserEffect::process(float* dataL, float* dataR)
    }
 
    // scale width
-   float M alignas(16)[BLOCK_SIZE], S alignas(16)[BLOCK_SIZE];
-   encodeMS(L, R, M, S, BLOCK_SIZE_QUAD);
-   width.multiply_block(S, BLOCK_SIZE_QUAD);
-   decodeMS(M, S, L, R, BLOCK_SIZE_QUAD);
+   float M alignas(16)[BLOCK_SIZE_MAX], S alignas(16)[BLOCK_SIZE_MAX];
+   encodeMS(L, R, M, S, storage->blockSizeQuad);
+   width.multiply_block(S, storage->blockSizeQuad);
+   decodeMS(M, S, L, R, storage->blockSizeQuad);
 
    mix.set_target_smoothed(limit_range(*f[ph_mix], 0.f, 1.f));
-   mix.fade_2_blocks_to(dataL, L, dataR, R, dataL, dataR, BLOCK_SIZE_QUAD);
+   mix.fade_2_blocks_to(dataL, L, dataR, R, dataL, dataR, storage->blockSizeQuad);
 }
 
 void PhaserEffect::suspend()
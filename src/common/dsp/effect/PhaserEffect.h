@@ -27,8 +27,8 @@
 class PhaserEffect : public Effect
 {
    lipol_ps width alignas(16), mix alignas(16);
-   float L alignas(16)[BLOCK_SIZE],
-         R alignas(16)[BLOCK_SIZE];
+   float L alignas(16)[BLOCK_SIZE_MAX],
+         R alignas(16)[BLOCK_SIZE_MAX];
 
 public:
    PhaserEffect(SurgeStorage* storage, FxStorage* fxdata, pdata* pd);
@@ -15,6 +15,11 @@ Reverb1Effect::~Reverb1Effect()
 
 void Reverb1Effect::init()
 {
+   // mix and width ramp over two blocks, as they did with the old fixed 64 sample default
+   mix.set_blocksize(storage->blockSizeOS);
+   width.set_blocksize(storage->blockSizeOS);
+   mix.set_smoothing_blocksize(storage->blockSize);
+   width.set_smoothing_blocksize(storage->blockSize);
    setvars(true);
 
    band1.coeff_peakEQ(band1.calc_omega(fxdata->p[rev1_freq1].val.f / 12.f), 2, fxdata->p[rev1_gain1].val.f);
@@ -163,7 +168,7 @@ void Reverb1Effect::update_rtime()
       max_dt = max(max_dt, delay_time[t]);
    }
    lastf[rev1_decaytime] = *f[rev1_decaytime];
-   float t = BLOCK_SIZE_INV * ((float)(max_dt >> 8) + samplerate * powf(2.f, *f[rev1_decaytime]) * 2.f); // * 2.f is to get the db120 time
+   float t = storage->blockSizeInv * ((float)(max_dt >> 8) + samplerate * powf(2.f, *f[rev1_decaytime]) * 2.f); // * 2.f is to get the db120 time
    ringout_time = (int)t;
 }
 
@@ -179,8 +184,8 @@ void Reverb1Effect::update_rsize()
 
 void Reverb1Effect::process(float* dataL, float* dataR)
 {
-   float wetL alignas(16)[BLOCK_SIZE],
-         wetR alignas(16)[BLOCK_SIZE];
+   float wetL alignas(16)[BLOCK_SIZE_MAX],
+         wetR alignas(16)[BLOCK_SIZE_MAX];
 
    if (fxdata->p[rev1_shape].val.i != shape)
       loadpreset(fxdata->p[rev1_shape].val.i);
@@ -212,7 +217,7 @@ void Reverb1Effect::process(float* dataL, float* dataR)
    __m128 damp4 = _mm_load1_ps(&dv);
    __m128 damp4m1 = _mm_sub_ps(one4, damp4);
 
-   for (int k = 0; k < BLOCK_SIZE; k++)
+   for (int k = 0; k < storage->blockSize; k++)
    {
       for (int t = 0; t < rev_taps; t += 4)
       {
@@ -274,13 +279,13 @@ void Reverb1Effect::process(float* dataL, float* dataR)
    hicut.process_block_slowlag(wetL, wetR);
 
    // scale width
-   float M alignas(16)[BLOCK_SIZE],
-         S alignas(16)[BLOCK_SIZE];
-   encodeMS(wetL, wetR, M, S, BLOCK_SIZE_QUAD);
-   width.multiply_block(S, BLOCK_SIZE_QUAD);
-   decodeMS(M, S, wetL, wetR, BLOCK_SIZE_QUAD);
+   float M alignas(16)[BLOCK_SIZE_MAX],
+         S alignas(16)[BLOCK_SIZE_MAX];
+   encodeMS(wetL, wetR, M, S, storage->blockSizeQuad);
+   width.multiply_block(S, storage->blockSizeQuad);
+   decodeMS(M, S, wetL, wetR, storage->blockSizeQuad);
 
-   mix.fade_2_blocks_to(dataL, wetL, dataR, wetR, dataL, dataR, BLOCK_SIZE_QUAD);
+   mix.fade_2_blocks_to(dataL, wetL, dataR, wetR, dataL, dataR, storage->blockSizeQuad);
 }
 
 void Reverb1Effect::suspend()
@@ -87,6 +87,13 @@ Reverb2Effect::~Reverb2Effect()
 
 void Reverb2Effect::init()
 {
+   mix.set_blocksize(storage->blockSizeOS); // two blocks, as with the old 64 sample default
+   width.set_blocksize(storage->blockSizeOS);
+   mix.set_smoothing_blocksize(storage->blockSize);
+   width.set_smoothing_blocksize(storage->blockSize);
+   for (auto* l : {&_decay_multiply, &_diffusion, &_buildup, &_hf_damp_coefficent,
+                   &_lf_damp_coefficent, &_modulation})
+      l->setBlockSize(storage->blockSize);
    setvars(true);
 }
 
@@ -150,7 +157,7 @@ void Reverb2Effect::setvars(bool init)
 
 void Reverb2Effect::update_rtime()
 {
-   float t = BLOCK_SIZE_INV * (samplerate * (std::max( 1.0f, powf(2.f, *f[rev2_decay_time])) * 2.f + std::max( 0.1f, powf(2.f, *f[rev2_predelay]) *
+   float t = storage->blockSizeInv * (samplerate * (std::max( 1.0f, powf(2.f, *f[rev2_decay_time])) * 2.f + std::max( 0.1f, powf(2.f, *f[rev2_predelay]) *
                                             (fxdata->p[rev2_predelay].temposync ? storage->temposyncratio_inv : 1.f)) * 2.f)); // * 2.f is to get the db120 time
    ringout_time = (int)t;
 }
@@ -165,8 +172,8 @@ void Reverb2Effect::process(float* dataL, float* dataR)
 
    last_decay_time = *f[rev2_decay_time];
 
-   float wetL alignas(16)[BLOCK_SIZE],
-         wetR alignas(16)[BLOCK_SIZE];
+   float wetL alignas(16)[BLOCK_SIZE_MAX],
+         wetR alignas(16)[BLOCK_SIZE_MAX];
 
    float loop_time_s = 0.5508 * scale;
    float decay = powf(db60, loop_time_s / (4.f * (powf(2.f, *f[rev2_decay_time]))));
@@ -185,7 +192,7 @@ void Reverb2Effect::process(float* dataL, float* dataR)
 
    int pdt = limit_range((int)(samplerate * pow(2.f, *f[rev2_predelay]) * (fxdata->p[rev2_predelay].temposync ? storage->temposyncratio_inv : 1.f)), 1, PREDELAY_BUFFER_SIZE_LIMIT - 1);
 
-   for (int k = 0; k < BLOCK_SIZE; k++)
+   for (int k = 0; k < storage->blockSize; k++)
    {
       float in = (dataL[k] + dataR[k]) * 0.5f;
 
@@ -241,13 +248,13 @@ void Reverb2Effect::process(float* dataL, float* dataR)
    }
 
    // scale width
-   float M alignas(16)[BLOCK_SIZE],
-         S alignas(16)[BLOCK_SIZE];
-   encodeMS(wetL, wetR, M, S, BLOCK_SIZE_QUAD);
-   width.multiply_block(S, BLOCK_SIZE_QUAD);
-   decodeMS(M, S, wetL, wetR, BLOCK_SIZE_QUAD);
+   float M alignas(16)[BLOCK_SIZE_MAX],
+         S alignas(16)[BLOCK_SIZE_MAX];
+   encodeMS(wetL, wetR, M, S, storage->blockSizeQuad);
+   width.multiply_block(S, storage->blockSizeQuad);
+   decodeMS(M, S, wetL, wetR, storage->blockSizeQuad);
 
-   mix.fade_2_blocks_to(dataL, wetL, dataR, wetR, dataL, dataR, BLOCK_SIZE_QUAD);
+   mix.fade_2_blocks_to(dataL, wetL, dataR, wetR, dataL, dataR, storage->blockSizeQuad);
 }
 
 void Reverb2Effect::suspend()
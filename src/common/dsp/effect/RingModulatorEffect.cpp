@@ -78,8 +78,8 @@ void RingModulatorEffect::process(float* dataL, float* dataR)
 
 #if OVERSAMPLE
    // Now upsample
-   float dataOS alignas(16)[2][BLOCK_SIZE_OS];
-   halfbandIN.process_block_U2(dataL, dataR, dataOS[0], dataOS[1] );
+   float dataOS alignas(16)[2][BLOCK_SIZE_OS_MAX];
+   halfbandIN.process_block_U2(dataL, dataR, dataOS[0], dataOS[1], storage->blockSizeOS);
 #else
    float *dataOS[2];
    dataOS[0] = dataL;
@@ -97,9 +97,9 @@ void RingModulatorEffect::process(float* dataL, float* dataR)
          Tunings::MIDI_0_FREQ * sri;
    }
 
-   int ub = BLOCK_SIZE;
+   int ub = storage->blockSize;
 #if OVERSAMPLE
-   ub = BLOCK_SIZE_OS;
+   ub = storage->blockSizeOS;
 #endif
    
    for( int i=0; i<ub; ++i )
@@ -145,9 +145,9 @@ void RingModulatorEffect::process(float* dataL, float* dataR)
    }
 
 #if OVERSAMPLE   
-   halfbandOUT.process_block_D2(dataOS[0], dataOS[1]);
-   copy_block(dataOS[0], dataL, BLOCK_SIZE_QUAD);
-   copy_block(dataOS[1], dataR, BLOCK_SIZE_QUAD);
+   halfbandOUT.process_block_D2(dataOS[0], dataOS[1], storage->blockSizeOS);
+   copy_block(dataOS[0], dataL, storage->blockSizeQuad);
+   copy_block(dataOS[1], dataR, storage->blockSizeQuad);
 #endif
 
    // Apply the filters
@@ -5,8 +5,6 @@ using namespace std;
 RotarySpeakerEffect::RotarySpeakerEffect(SurgeStorage* storage, FxStorage* fxdata, pdata* pd)
     : Effect(storage, fxdata, pd), xover(storage), lowbass(storage)
 {
-   mix.set_blocksize(BLOCK_SIZE);
-   width.set_blocksize(BLOCK_SIZE);
 }
 
 RotarySpeakerEffect::~RotarySpeakerEffect()
@@ -14,6 +12,15 @@ RotarySpeakerEffect::~RotarySpeakerEffect()
 
 void RotarySpeakerEffect::init()
 {
+   mix.set_blocksize(storage->blockSize);
+   width.set_blocksize(storage->blockSize);
+   mix.set_smoothing_blocksize(storage->blockSize);
+   width.set_smoothing_blocksize(storage->blockSize);
+   dL.setBlockSize(storage->blockSize);
+   dR.setBlockSize(storage->blockSize);
+   hornamp[0].setBlockSize(storage->blockSize);
+   hornamp[1].setBlockSize(storage->blockSize);
+
    memset(buffer, 0, max_delay_length * sizeof(float));
 
    wpos = 0;
@@ -132,8 +139,8 @@ void RotarySpeakerEffect::process_only_control()
 {
    float frate = *f[rot_horn_rate] * (fxdata->p[rot_horn_rate].temposync ? storage->temposyncratio : 1.f);
 
-   lfo.set_rate(2 * M_PI * powf(2, frate) * dsamplerate_inv * BLOCK_SIZE);
-   lf_lfo.set_rate(*f[rot_rotor_rate] * 2 * M_PI * powf(2, frate) * dsamplerate_inv * BLOCK_SIZE);
+   lfo.set_rate(2 * M_PI * powf(2, frate) * dsamplerate_inv * storage->blockSize);
+   lf_lfo.set_rate(*f[rot_rotor_rate] * 2 * M_PI * powf(2, frate) * dsamplerate_inv * storage->blockSize);
 
    lfo.process();
    lf_lfo.process();
@@ -151,7 +158,7 @@ void RotarySpeakerEffect::process(float* dataL, float* dataR)
     ** therefore lf_lfo processes BLOCK_SIZE more times
     ** hence the lack of BLOCK_SIZE here
     */
-   lfo.set_rate(2 * M_PI * powf(2, frate) * dsamplerate_inv * BLOCK_SIZE);
+   lfo.set_rate(2 * M_PI * powf(2, frate) * dsamplerate_inv * storage->blockSize);
    lf_lfo.set_rate(*f[rot_rotor_rate] * 2 * M_PI * powf(2, frate) * dsamplerate_inv);
 
    float precalc0 = (-2 - (float)lfo.i);
@@ -175,13 +182,13 @@ void RotarySpeakerEffect::process(float* dataL, float* dataR)
 
    lfo.process();
 
-   float upper alignas(16)[BLOCK_SIZE];
-   float lower alignas(16)[BLOCK_SIZE];
-   float lower_sub alignas(16)[BLOCK_SIZE];
-   float tbufferL alignas(16)[BLOCK_SIZE];
-   float tbufferR alignas(16)[BLOCK_SIZE];
-   float wbL alignas(16)[BLOCK_SIZE];
-   float wbR alignas(16)[BLOCK_SIZE];
+   float upper alignas(16)[BLOCK_SIZE_MAX];
+   float lower alignas(16)[BLOCK_SIZE_MAX];
+   float lower_sub alignas(16)[BLOCK_SIZE_MAX];
+   float tbufferL alignas(16)[BLOCK_SIZE_MAX];
+   float tbufferR alignas(16)[BLOCK_SIZE_MAX];
+   float wbL alignas(16)[BLOCK_SIZE_MAX];
+   float wbR alignas(16)[BLOCK_SIZE_MAX];
 
    int k;
 
@@ -247,7 +254,7 @@ void RotarySpeakerEffect::process(float* dataL, float* dataR)
          gain_comp_factor = 1.f + ((drive.v - compensateStartsAt) * compensate);
    }
 
-   for (k = 0; k < BLOCK_SIZE; k++)
+   for (k = 0; k < storage->blockSize; k++)
    {
       float input;
 
@@ -269,7 +276,7 @@ void RotarySpeakerEffect::process(float* dataL, float* dataR)
 
    xover.process_block(lower);
 
-   for (k = 0; k < BLOCK_SIZE; k++)
+   for (k = 0; k < storage->blockSize; k++)
    {
       // feed delay input
       int wp = (wpos + k) & (max_delay_length - 1);
@@ -277,8 +284,8 @@ void RotarySpeakerEffect::process(float* dataL, float* dataR)
       upper[k] -= lower[k];
       buffer[wp] = upper[k];
 
-      int i_dtimeL = max(BLOCK_SIZE, min((int)dL.v, max_delay_length - FIRipol_N - 1));
-      int i_dtimeR = max(BLOCK_SIZE, min((int)dR.v, max_delay_length - FIRipol_N - 1));
+      int i_dtimeL = max(storage->blockSize, min((int)dL.v, max_delay_length - FIRipol_N - 1));
+      int i_dtimeR = max(storage->blockSize, min((int)dR.v, max_delay_length - FIRipol_N - 1));
 
       int rpL = (wpos - i_dtimeL + k);
       int rpR = (wpos - i_dtimeR + k);
@@ -304,7 +311,7 @@ void RotarySpeakerEffect::process(float* dataL, float* dataR)
 
    lowbass.process_block(lower_sub);
 
-   for (k = 0; k < BLOCK_SIZE; k++)
+   for (k = 0; k < storage->blockSize; k++)
    {
       lower[k] -= lower_sub[k];
 
@@ -319,15 +326,15 @@ void RotarySpeakerEffect::process(float* dataL, float* dataR)
    }
 
    // scale width
-   float M alignas(16)[BLOCK_SIZE],
-         S alignas(16)[BLOCK_SIZE];
-   encodeMS(wbL, wbR, M, S, BLOCK_SIZE_QUAD);
-   width.multiply_block(S, BLOCK_SIZE_QUAD);
-   decodeMS(M, S, wbL, wbR, BLOCK_SIZE_QUAD);
+   float M alignas(16)[BLOCK_SIZE_MAX],
+         S alignas(16)[BLOCK_SIZE_MAX];
+   encodeMS(wbL, wbR, M, S, storage->blockSizeQuad);
+   width.multiply_block(S, storage->blockSizeQuad);
+   decodeMS(M, S, wbL, wbR, storage->blockSizeQuad);
 
-   mix.fade_2_blocks_to(dataL, wbL, dataR, wbR, dataL, dataR, BLOCK_SIZE_QUAD);
+   mix.fade_2_blocks_to(dataL, wbL, dataR, wbR, dataL, dataR, storage->blockSizeQuad);
 
-   wpos += BLOCK_SIZE;
+   wpos += storage->blockSize;
    wpos = wpos & (max_delay_length - 1);
 }
 
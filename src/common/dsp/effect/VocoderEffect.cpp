@@ -24,8 +24,6 @@ VocoderEffect::VocoderEffect(SurgeStorage* storage, FxStorage* fxdata, pdata* pd
    mUnvoicedLevel = 0.f;*/
 
    active_bands = n_vocoder_bands;
-   mGain.set_blocksize(BLOCK_SIZE);
-   mGainR.set_blocksize(BLOCK_SIZE);
    for (int i = 0; i < voc_vector_size; i++)
    {
       mEnvF[i] = vZero;
@@ -42,6 +40,10 @@ VocoderEffect::~VocoderEffect()
 
 void VocoderEffect::init()
 {
+   mGain.set_blocksize(storage->blockSize);
+   mGainR.set_blocksize(storage->blockSize);
+   mGain.set_smoothing_blocksize(storage->blockSize);
+   mGainR.set_smoothing_blocksize(storage->blockSize);
    setvars(true);
 }
 
@@ -162,26 +164,26 @@ void VocoderEffect::process(float* dataL, float* dataR)
    float EnvFRate = 0.001f * powf(2.f, 4.f * *f[voc_envfollow]);
 
    // the left channel variables are used for mono when stereo is disabled
-   float modulator_in alignas(16)[BLOCK_SIZE];
-   float modulator_inR alignas(16)[BLOCK_SIZE];
+   float modulator_in alignas(16)[BLOCK_SIZE_MAX];
+   float modulator_inR alignas(16)[BLOCK_SIZE_MAX];
 
    if (modulator_mode == vim_mono)
    {
       add_block(storage->audio_in_nonOS[0], storage->audio_in_nonOS[1], modulator_in,
-                BLOCK_SIZE_QUAD);
+                storage->blockSizeQuad);
    }
    else
    {
-      copy_block(storage->audio_in_nonOS[0], modulator_in, BLOCK_SIZE_QUAD);
-      copy_block(storage->audio_in_nonOS[1], modulator_inR, BLOCK_SIZE_QUAD);
+      copy_block(storage->audio_in_nonOS[0], modulator_in, storage->blockSizeQuad);
+      copy_block(storage->audio_in_nonOS[1], modulator_inR, storage->blockSizeQuad);
    }
 
    float Gain = *f[voc_input_gain] + 24.f;
    mGain.set_target_smoothed(db_to_linear(Gain));
-   mGain.multiply_block(modulator_in, BLOCK_SIZE_QUAD);
+   mGain.multiply_block(modulator_in, storage->blockSizeQuad);
 
    mGainR.set_target_smoothed(db_to_linear(Gain));
-   mGainR.multiply_block(modulator_inR, BLOCK_SIZE_QUAD);
+   mGainR.multiply_block(modulator_inR, storage->blockSizeQuad);
 
    vFloat Rate = vLoad1(EnvFRate);
    vFloat Ratem1 = vLoad1(1.f - EnvFRate);
@@ -225,7 +227,7 @@ void VocoderEffect::process(float* dataL, float* dataR)
          input = modulator_inR;
       }
 
-      for (int k = 0; k < BLOCK_SIZE; k++)
+      for (int k = 0; k < storage->blockSize; k++)
       {
          vFloat In = vLoad1(input[k]);
 
@@ -254,7 +256,7 @@ void VocoderEffect::process(float* dataL, float* dataR)
    }
    else if (modulator_mode == vim_stereo)
    {
-       for (int k = 0; k < BLOCK_SIZE; k++)
+       for (int k = 0; k < storage->blockSize; k++)
        {
           vFloat InL = vLoad1(modulator_in[k]);
           vFloat InR = vLoad1(modulator_inR[k]);
@@ -1,6 +1,7 @@
 #include "AirWindowsEffect.h"
 #include "UserDefaults.h"
 #include "DebugHelpers.h"
+#include "util/AllocationCheck.h"
 
 constexpr int subblock_factor = 3; // divide block by 2^this
 
@@ -11,7 +12,6 @@ AirWindowsEffect::AirWindowsEffect( SurgeStorage *storage, FxStorage *fxdata, pd
    {
       param_lags[i].newValue(0);
       param_lags[i].instantize();
-      param_lags[i].setRate( 0.004 * ( BLOCK_SIZE >> subblock_factor ) );
    }
 
    mapper = std::make_unique<AWFxSelectorMapper>(this);
@@ -23,6 +23,8 @@ AirWindowsEffect::~AirWindowsEffect()
 
 void AirWindowsEffect::init()
 {
+   for( int i=0; i<n_fx_params-1; i++ )
+      param_lags[i].setRate( 0.004 * ( storage->blockSize >> subblock_factor ) );
 
    //std::cout << "AirWindows init " << std::endl;
    //for( int i=1;i<n_fx_params;++i)
@@ -200,13 +202,15 @@ void AirWindowsEffect::process( float *dataL, float *dataR )
       {
          useStreamedValues = true;
       }
+      // Switching the Airwindows effect constructs the new one, like any effect type change
+      Surge::Debug::AllowAllocationScope switchingEffect;
       setupSubFX( fxdata->p[0].val.i, useStreamedValues );
    }
 
    if( ! airwin ) return;
 
-   constexpr int QBLOCK = BLOCK_SIZE >> subblock_factor;
-   float outL alignas(16)[BLOCK_SIZE], outR alignas(16)[BLOCK_SIZE];
+   const int QBLOCK = storage->blockSize >> subblock_factor;
+   float outL alignas(16)[BLOCK_SIZE_MAX], outR alignas(16)[BLOCK_SIZE_MAX];
 
    for( int subb = 0; subb < 1 << subblock_factor; ++subb )
    {
@@ -235,8 +239,8 @@ void AirWindowsEffect::process( float *dataL, float *dataR )
       airwin->processReplacing(in, out, QBLOCK);
    }
 
-   copy_block( outL, dataL, BLOCK_SIZE_QUAD );
-   copy_block( outR, dataR, BLOCK_SIZE_QUAD );
+   copy_block( outL, dataL, storage->blockSizeQuad );
+   copy_block( outR, dataR, storage->blockSizeQuad );
 }
 
 void AirWindowsEffect::setupSubFX( int sfx, bool useStreamedValues )
@@ -78,7 +78,7 @@ namespace DiodeLadderFilter
 
    void makeCoefficients( FilterCoefficientMaker *cm, float freq, float reso, SurgeStorage *storage )
    {
-      float C[n_cm_coeffs];
+      float C[n_cm_coeffs] = {0};
 
       const float wd = clampedFrequency( freq, storage ) * 2.0f * M_PI;
       const float wa = (2.0f * dsamplerate_os) * Surge::DSP::fasttan(wd * dsamplerate_os_inv * 0.5);
@@ -108,7 +108,12 @@ namespace DiodeLadderFilter
       cm->FromDirect(C);
    }
 
-   __m128 process( QuadFilterUnitState * __restrict f, __m128 input )
+   /*
+   ** The ladder is solved in closed form, so there are no iterations to trade away. The
+   ** economy quality resolves the feedback with the approximate reciprocal (the denominator
+   ** is at least 1, so its 12 bits are plenty) rather than a full divide.
+   */
+   template <bool economy> inline __m128 process_t( QuadFilterUnitState * __restrict f, __m128 input )
    {
       for(int i=0; i < n_cm_coeffs; ++i){ \
          f->C[i] = A(f->C[i], f->dC[i]); \
@@ -172,7 +177,9 @@ namespace DiodeLadderFilter
       const __m128 comp = M(A(M(F(0.3), f->C[dlf_km]), one), input);
 
       // (comp - km * sigma) / (km * gamma + 1.0)
-      const __m128 u = D(S(comp, M(f->C[dlf_km], sigma)), A(M(f->C[dlf_km], f->C[dlf_gamma]), one));
+      const __m128 u = economy
+         ? M(S(comp, M(f->C[dlf_km], sigma)), reci(A(M(f->C[dlf_km], f->C[dlf_gamma]), one)))
+         : D(S(comp, M(f->C[dlf_km], sigma)), A(M(f->C[dlf_km], f->C[dlf_gamma]), one));
 
       const __m128 result1 = doLpf(      u, f->C[dlf_alpha], beta1, gamma1,    g, f->C[dlf_G2],  one, feedback1,
             getFO(beta1,    g, feedback1, f->R[dlf_z1]), f->R[dlf_z1]);
@@ -197,4 +204,14 @@ namespace DiodeLadderFilter
             return M(result4, F(1.2));   // 24dB/oct
       }
    }
+
+   __m128 process( QuadFilterUnitState * __restrict f, __m128 input )
+   {
+      return process_t<false>( f, input );
+   }
+
+   __m128 process_economy( QuadFilterUnitState * __restrict f, __m128 input )
+   {
+      return process_t<true>( f, input );
+   }
 }
@@ -8,4 +8,5 @@ namespace DiodeLadderFilter
 {
    void makeCoefficients( FilterCoefficientMaker *cm, float freq, float reso, SurgeStorage *storage );
    __m128 process( QuadFilterUnitState * __restrict f, __m128 in );
+   __m128 process_economy( QuadFilterUnitState * __restrict f, __m128 in );
 }
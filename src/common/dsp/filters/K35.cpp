@@ -61,7 +61,7 @@ namespace K35Filter
 
    void makeCoefficients( FilterCoefficientMaker *cm, float freq, float reso, bool is_lowpass, float saturation, SurgeStorage *storage )
    {
-      float C[n_cm_coeffs];
+      float C[n_cm_coeffs] = {0};
 
       const float wd = clampedFrequency( freq, storage ) * 2.0f * M_PI;
       const float wa = (2.0f * dsamplerate_os) * Surge::DSP::fasttan(wd * dsamplerate_os_inv * 0.5);
@@ -100,7 +100,15 @@ namespace K35Filter
       f->C[i] = A(f->C[i], f->dC[i]); \
    }
 
-   __m128 process_lp( QuadFilterUnitState * __restrict f, __m128 input )
+   /*
+   ** The economy quality drives the saturator with Surge::DSP::fasttanhSSEeconomy.
+   */
+   template <bool economy> inline __m128 saturate( __m128 x )
+   {
+      return economy ? Surge::DSP::fasttanhSSEeconomy(x) : Surge::DSP::fasttanhSSEclamped(x);
+   }
+
+   template <bool economy> inline __m128 process_lp_t( QuadFilterUnitState * __restrict f, __m128 input )
    {
       process_coeffs();
 
@@ -109,7 +117,7 @@ namespace K35Filter
       const __m128 s35 = A(M(f->C[k35_lb], f->R[k35_2z]), M(f->C[k35_hb], f->R[k35_hz]));
       // alpha * (y1 + s35)
       const __m128 u_clean = M(f->C[k35_alpha], A(y1, s35));
-      const __m128 u_driven = Surge::DSP::fasttanhSSEclamped(M(u_clean, f->C[k35_saturation]));
+      const __m128 u_driven = saturate<economy>(M(u_clean, f->C[k35_saturation]));
       const __m128 u = A(M(u_clean, f->C[k35_saturation_blend_inv]), M(u_driven, f->C[k35_saturation_blend]));
 
       // mk * lpf2(u)
@@ -121,7 +129,7 @@ namespace K35Filter
       return result;
    }
 
-   __m128 process_hp( QuadFilterUnitState * __restrict f, __m128 input )
+   template <bool economy> inline __m128 process_hp_t( QuadFilterUnitState * __restrict f, __m128 input )
    {
       process_coeffs();
 
@@ -133,7 +141,7 @@ namespace K35Filter
 
       // mk * lpf2(u)
       const __m128 y_clean = M(f->C[k35_k], u);
-      const __m128 y_driven = Surge::DSP::fasttanhSSEclamped(M(y_clean, f->C[k35_saturation]));
+      const __m128 y_driven = saturate<economy>(M(y_clean, f->C[k35_saturation]));
       const __m128 y = A(M(y_clean, f->C[k35_saturation_blend_inv]), M(y_driven, f->C[k35_saturation_blend]));
 
       doLpf(f->C[k35_G], doHpf(f->C[k35_G], y, f->R[k35_2z]), f->R[k35_lz]);
@@ -142,6 +150,26 @@ namespace K35Filter
 
       return result;
    }
+   __m128 process_lp( QuadFilterUnitState * __restrict f, __m128 input )
+   {
+      return process_lp_t<false>(f, input);
+   }
+
+   __m128 process_hp( QuadFilterUnitState * __restrict f, __m128 input )
+   {
+      return process_hp_t<false>(f, input);
+   }
+
+   __m128 process_lp_economy( QuadFilterUnitState * __restrict f, __m128 input )
+   {
+      return process_lp_t<true>(f, input);
+   }
+
+   __m128 process_hp_economy( QuadFilterUnitState * __restrict f, __m128 input )
+   {
+      return process_hp_t<true>(f, input);
+   }
+
 #undef F
 #undef M
 #undef D
@@ -9,4 +9,6 @@ namespace K35Filter
    void makeCoefficients( FilterCoefficientMaker *cm, float freq, float reso, bool is_lowpass, float saturation, SurgeStorage *storage );
    __m128 process_lp( QuadFilterUnitState * __restrict f, __m128 in );
    __m128 process_hp( QuadFilterUnitState * __restrict f, __m128 in );
+   __m128 process_lp_economy( QuadFilterUnitState * __restrict f, __m128 in );
+   __m128 process_hp_economy( QuadFilterUnitState * __restrict f, __m128 in );
 }
@@ -139,7 +139,7 @@ namespace NonlinearFeedbackFilter
 
    void makeCoefficients( FilterCoefficientMaker *cm, float freq, float reso, int type, int subtype, SurgeStorage *storage )
    {
-      float C[n_cm_coeffs];
+      float C[n_cm_coeffs] = {0};
 
       reso = limit_range(reso, 0.f, 1.f);
 
@@ -90,7 +90,7 @@ namespace NonlinearStatesFilter
 
    void makeCoefficients( FilterCoefficientMaker *cm, float freq, float reso, int type, SurgeStorage *storage )
    {
-      float C[n_cm_coeffs];
+      float C[n_cm_coeffs] = {0};
 
       reso = limit_range(reso, 0.f, 1.f);
 
@@ -23,6 +23,7 @@
 #include "SurgeStorage.h"
 #include "DebugHelpers.h"
 #include "FilterCoefficientMaker.h"
+#include "FastMath.h"
 
 namespace ObxdFilter {
 
@@ -75,7 +76,7 @@ namespace ObxdFilter {
 
    void makeCoefficients(FilterCoefficientMaker* cm, Poles p, float freq, float reso, int sub, SurgeStorage* storage)
    {
-      float lC[n_cm_coeffs];
+      float lC[n_cm_coeffs] = {0};
       float rcrate = sqrt((44000 * dsamplerate_os_inv));
       float rcor = (500.0 / 44000) * rcrate;
       float cutoff = fmin(storage->note_to_pitch(freq + 69) * Tunings::MIDI_0_FREQ, 22000.0) * dsamplerate_os_inv * M_PI;
@@ -199,7 +200,11 @@ namespace ObxdFilter {
       return res;
    }
 
-   __m128 process_4_pole(QuadFilterUnitState * __restrict f, __m128 sample)
+   /*
+   ** The damping in the first pole takes an atan per lane through libm. The economy quality
+   ** uses Surge::DSP::fastatanSSE for all four at once instead.
+   */
+   template <bool economy> inline __m128 process_4_pole_t(QuadFilterUnitState * __restrict f, __m128 sample)
    {
       for (int i = 0; i < n_obxd24_coeff; i++)
       {
@@ -226,18 +231,26 @@ namespace ObxdFilter {
       // f->R[s1] =atan(s1*rcor24)*rcor24inv;
       __m128 s1_rcor24 = _mm_mul_ps(f->R[s1], f->C[rcor24]);
 
-      float s1_rcor24_arr[ssew];
-      _mm_store_ps(s1_rcor24_arr, s1_rcor24);
-      
-      for (int i = 0; i < ssew; i++)
+      if (economy)
       {
-         if( f->active[i] )
-            s1_rcor24_arr[i] = atan(s1_rcor24_arr[i]);
-         else
-            s1_rcor24_arr[i] = 0.f;
+         auto activeMask = _mm_loadu_ps((float*)f->active);
+         s1_rcor24 = _mm_and_ps(activeMask, Surge::DSP::fastatanSSE(s1_rcor24));
+      }
+      else
+      {
+         float s1_rcor24_arr[ssew];
+         _mm_store_ps(s1_rcor24_arr, s1_rcor24);
+
+         for (int i = 0; i < ssew; i++)
+         {
+            if( f->active[i] )
+               s1_rcor24_arr[i] = atan(s1_rcor24_arr[i]);
+            else
+               s1_rcor24_arr[i] = 0.f;
+         }
+
+         s1_rcor24 = _mm_load_ps(s1_rcor24_arr);
       }
-      
-      s1_rcor24 = _mm_load_ps(s1_rcor24_arr);
       f->R[s1] = _mm_mul_ps(s1_rcor24, f->C[rcor24inv]);
 
       // float y1 = res;
@@ -269,4 +282,14 @@ namespace ObxdFilter {
       auto out = _mm_mul_ps(mc, _mm_add_ps(one, _mm_mul_ps(f->C[R24], zero_four_five)));
       return _mm_mul_ps( out, gainAdjustment4Pole );
    }
+
+   __m128 process_4_pole(QuadFilterUnitState * __restrict f, __m128 sample)
+   {
+      return process_4_pole_t<false>(f, sample);
+   }
+
+   __m128 process_4_pole_economy(QuadFilterUnitState * __restrict f, __m128 sample)
+   {
+      return process_4_pole_t<true>(f, sample);
+   }
 }
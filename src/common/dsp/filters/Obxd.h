@@ -11,6 +11,7 @@ namespace ObxdFilter {
    void makeCoefficients(FilterCoefficientMaker *cm, Poles p, float freq, float reso, int sub, SurgeStorage* storage);
    __m128 process_2_pole(QuadFilterUnitState * __restrict f, __m128 sample);
    __m128 process_4_pole(QuadFilterUnitState * __restrict f, __m128 sample);
+   __m128 process_4_pole_economy(QuadFilterUnitState * __restrict f, __m128 sample);
 }
 
 #endif
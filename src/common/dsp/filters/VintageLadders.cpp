@@ -106,7 +106,7 @@ namespace VintageLadder
       void makeCoefficients( FilterCoefficientMaker *cm, float freq, float reso, bool applyGainCompensation, SurgeStorage *storage )
       {
          // Consideration: Do we want tuning aware or not?
-         float lc[n_cm_coeffs];
+         float lc[n_cm_coeffs] = {0};
          auto pitch = VintageLadder::Common::clampedFrequency( freq, storage );
 
          lc[rkm_cutoff] = pitch * 2.0 * M_PI;
@@ -161,7 +161,13 @@ namespace VintageLadder
          dstate[3] = M( cutoff, S( satstate2, clip( state[3], saturation, saturationInv)));
       }
       
-      __m128 process( QuadFilterUnitState * __restrict f, __m128 input )
+      /*
+      ** The economy quality takes each oversampled step with the midpoint method, which needs two
+      ** derivatives rather than RK4's four. The cutoff is clamped to 0.3 of the oversampled rate
+      ** so the cutoff times the step stays below 0.5, where the clipped states keep it stable;
+      ** what it gives up is a little accuracy in the resonant peak at high cutoffs.
+      */
+      template <bool economy> inline __m128 processT( QuadFilterUnitState * __restrict f, __m128 input )
       {
          int i;
          __m128 deriv1[4], deriv2[4], deriv3[4], deriv4[4], tempState[4];
@@ -177,6 +183,8 @@ namespace VintageLadder
                              sat = F(saturation),
                              satInv = F(saturationInverse);
 
+         auto maxCutoff = F(0.3 * dsamplerate_os * extraOversample);
+
          __m128 outputOS[extraOversample];
 
          for (int osi = 0; osi < extraOversample; ++osi)
@@ -187,6 +195,8 @@ namespace VintageLadder
             }
 
             __m128 cutoff = f->C[rkm_cutoff];
+            if (economy)
+               cutoff = _mm_min_ps(cutoff, maxCutoff);
             __m128 resonance = f->C[rkm_reso];
             __m128 gComp = f->C[rkm_gComp];
 
@@ -197,22 +207,33 @@ namespace VintageLadder
             }
             
             calculateDerivatives(input, deriv2, tempState, cutoff, resonance, sat, satInv, gComp);
-            for (i = 0; i < 4; i++)
-            {
-               tempState[i] = A( state[i], M( halfStepSize, deriv2[i] ) );
-            }
 
-            calculateDerivatives(input, deriv3, tempState, cutoff, resonance, sat, satInv, gComp);
-            for (i = 0; i < 4; i++)
+            if (economy)
             {
-               tempState[i] = A( state[i], M( halfStepSize, deriv3[i] ) );
+               for (i = 0; i < 4; i++)
+               {
+                  state[i] = A( state[i], M( stepSize, deriv2[i] ) );
+               }
             }
-            
-            calculateDerivatives(input, deriv4, tempState, cutoff, resonance, sat, satInv, gComp);
-            for (i = 0; i < 4; i++)
+            else
             {
-               // state[i] += (1.0 / 6.0) * stepSize * (deriv1[i] + 2.0 * deriv2[i] + 2.0 * deriv3[i] + deriv4[i]);
-               state[i] = A(state[i], M( oneoversix, M( stepSize, A( deriv1[i], A( M( two, deriv2[i] ), A( M( two, deriv3[i] ), deriv4[i] ) ) ) ) ) );
+               for (i = 0; i < 4; i++)
+               {
+                  tempState[i] = A( state[i], M( halfStepSize, deriv2[i] ) );
+               }
+
+               calculateDerivatives(input, deriv3, tempState, cutoff, resonance, sat, satInv, gComp);
+               for (i = 0; i < 4; i++)
+               {
+                  tempState[i] = A( state[i], M( halfStepSize, deriv3[i] ) );
+               }
+
+               calculateDerivatives(input, deriv4, tempState, cutoff, resonance, sat, satInv, gComp);
+               for (i = 0; i < 4; i++)
+               {
+                  // state[i] += (1.0 / 6.0) * stepSize * (deriv1[i] + 2.0 * deriv2[i] + 2.0 * deriv3[i] + deriv4[i]);
+                  state[i] = A(state[i], M( oneoversix, M( stepSize, A( deriv1[i], A( M( two, deriv2[i] ), A( M( two, deriv3[i] ), deriv4[i] ) ) ) ) ) );
+               }
             }
 
             outputOS[osi] = state[3];
@@ -247,6 +268,16 @@ namespace VintageLadder
          return M( F(1.5), ov );
       }
 
+      __m128 process( QuadFilterUnitState * __restrict f, __m128 input )
+      {
+         return processT<false>( f, input );
+      }
+
+      __m128 process_economy( QuadFilterUnitState * __restrict f, __m128 input )
+      {
+         return processT<true>( f, input );
+      }
+
 #undef F
 #undef M
 #undef A
@@ -298,7 +329,7 @@ namespace VintageLadder
       float gainCompensation = 0.5;
       
       void makeCoefficients( FilterCoefficientMaker *cm, float freq, float reso,  bool applyGainCompensation, SurgeStorage *storage ) {
-         float lC[n_cm_coeffs];
+         float lC[n_cm_coeffs] = {0};
          auto cutoff = VintageLadder::Common::clampedFrequency( freq, storage );
          lC[h_cutoff] = cutoff;
 
@@ -322,7 +353,16 @@ namespace VintageLadder
          cm->FromDirect(lC);
       }
 
-      __m128 process( QuadFilterUnitState * __restrict f, __m128 in )
+      /*
+      ** The economy quality swaps in Surge::DSP::fasttanhSSEeconomy for the five tanhs in each of
+      ** the two oversampled steps.
+      */
+      template <bool economy> inline __m128 tanhT( __m128 x )
+      {
+         return economy ? Surge::DSP::fasttanhSSEeconomy( x ) : Surge::DSP::fasttanhSSEclamped( x );
+      }
+
+      template <bool economy> inline __m128 processT( QuadFilterUnitState * __restrict f, __m128 in )
       {
 #define F(a) _mm_set_ps1( a )         
 #define M(a,b) _mm_mul_ps( a, b )
@@ -375,7 +415,7 @@ namespace VintageLadder
             auto input = _mm_sub_ps( in,  _mm_mul_ps( resquad, S( f->R[h_delay + 5], M( f->C[h_gComp], in ) ) ) );
 
             // delay[0] = stage[0] = delay[0] + tune * (tanh(input * thermal) - stageTanh[0]);
-            f->R[h_stage + 0] = A( f->R[h_delay + 0], M( tune, S( Surge::DSP::fasttanhSSEclamped( M( input, thermal ) ), f->R[h_stageTanh + 0] ) ) );
+            f->R[h_stage + 0] = A( f->R[h_delay + 0], M( tune, S( tanhT<economy>( M( input, thermal ) ), f->R[h_stageTanh + 0] ) ) );
             f->R[h_delay + 0 ] = f->R[h_stage + 0 ];
             
             for (int k = 1; k < 4; k++) 
@@ -384,9 +424,9 @@ namespace VintageLadder
                input = f->R[h_stage + k - 1 ];
                
                // stage[k] = delay[k] + tune * ((stageTanh[k-1] = tanh(input * thermal)) - (k != 3 ? stageTanh[k] : tanh(delay[k] * thermal)));
-               f->R[h_stageTanh + k - 1 ] = Surge::DSP::fasttanhSSEclamped( M( input, thermal ) );
+               f->R[h_stageTanh + k - 1 ] = tanhT<economy>( M( input, thermal ) );
                f->R[h_stage + k ] = A( f->R[ h_delay + k ], M( tune, S( f->R[h_stageTanh + k - 1 ],
-                                     ( k != 3 ? f->R[h_stageTanh + k ] : Surge::DSP::fasttanhSSEclamped( M( f->R[h_delay + k ], thermal ) ) ) ) ) );
+                                     ( k != 3 ? f->R[h_stageTanh + k ] : tanhT<economy>( M( f->R[h_delay + k ], thermal ) ) ) ) ) );
 
                // delay[k] = stage[k];
                f->R[h_delay + k ] = f->R[h_stage + k];
@@ -408,5 +448,15 @@ namespace VintageLadder
 #undef S
 #undef F
       }
+
+      __m128 process( QuadFilterUnitState * __restrict f, __m128 in )
+      {
+         return processT<false>( f, in );
+      }
+
+      __m128 process_economy( QuadFilterUnitState * __restrict f, __m128 in )
+      {
+         return processT<true>( f, in );
+      }
    }
 }
\ No newline at end of file
@@ -9,10 +9,12 @@ namespace VintageLadder
    namespace RK {
       void makeCoefficients( FilterCoefficientMaker *cm, float freq, float reso, bool applyGainCompensation, SurgeStorage *storage );
       __m128 process( QuadFilterUnitState * __restrict f, __m128 in );
+      __m128 process_economy( QuadFilterUnitState * __restrict f, __m128 in );
    }
 
    namespace Huov {
       void makeCoefficients( FilterCoefficientMaker *cm, float freq, float reso, bool applyGainCompensation, SurgeStorage *storage );
       __m128 process( QuadFilterUnitState * __restrict f, __m128 in );
+      __m128 process_economy( QuadFilterUnitState * __restrict f, __m128 in );
    }
 }
@@ -69,15 +69,27 @@ FILE* surge_win_fopen_utf8(const char* pathname, const char* mode);
 const int BASE_WINDOW_SIZE_X = 904;
 const int BASE_WINDOW_SIZE_Y = 569;
 const int NAMECHARS = 64;
-const int BLOCK_SIZE = 32;
+/*
+** The engine block size is chosen per instance, at runtime, from 16, 32 (the default), 64 and
+** 128 samples (SurgeSynthesizer::setBlockSize). Control rate work (processControl, the
+** modulators, filter coefficients and FX parameter updates) happens once per block, so a larger
+** block amortises it over more samples for offline rendering and a smaller one reduces latency
+** for live use.
+**
+** Buffers are sized for the largest block with the _MAX constants here. Loops and per block time
+** constants use the instance's size, which SurgeStorage holds (blockSize, blockSizeOS and so on).
+** The limit comes from the BLIT oscillators, which place impulses up to a block ahead in the 8
+** integer bits of an 8.24 fixed point position.
+*/
+const int BLOCK_SIZE_MIN = 16;
+const int BLOCK_SIZE_DEFAULT = 32;
+const int BLOCK_SIZE_MAX = 128;
 const int OSC_OVERSAMPLING = 2;
-const int BLOCK_SIZE_OS = OSC_OVERSAMPLING * BLOCK_SIZE;
-const int BLOCK_SIZE_QUAD = BLOCK_SIZE >> 2;
-const int BLOCK_SIZE_OS_QUAD = BLOCK_SIZE_OS >> 2;
-const int OB_LENGTH = BLOCK_SIZE_OS << 1;
+const int BLOCK_SIZE_OS_MAX = OSC_OVERSAMPLING * BLOCK_SIZE_MAX;
+const int BLOCK_SIZE_QUAD_MAX = BLOCK_SIZE_MAX >> 2;
+const int BLOCK_SIZE_OS_QUAD_MAX = BLOCK_SIZE_OS_MAX >> 2;
+const int OB_LENGTH = BLOCK_SIZE_OS_MAX << 1;
 const int OB_LENGTH_QUAD = OB_LENGTH >> 2;
-const float BLOCK_SIZE_INV = (1.f / BLOCK_SIZE);
-const float BLOCK_SIZE_OS_INV = (1.f / BLOCK_SIZE_OS);
 const int MAX_FB_COMB = 2048; // must be 2^n
 const int MAX_VOICES = 64;
 const int MAX_UNISON = 16;
@@ -181,8 +181,8 @@ void CLFOGui::draw(CDrawContext* dc)
       }
 
       int minSamples = ( 1 << 3 ) * (int)( boxo.right - boxo.left );
-      int totalSamples = std::max( (int)minSamples, (int)(totalEnvTime * samplerate / BLOCK_SIZE) );
-      float drawnTime = totalSamples * samplerate_inv * BLOCK_SIZE;
+      int totalSamples = std::max( (int)minSamples, (int)(totalEnvTime * samplerate / storage->blockSize) );
+      float drawnTime = totalSamples * samplerate_inv * storage->blockSize;
 
       // OK so let's assume we want about 1000 pixels worth tops in
       int averagingWindow = (int)(totalSamples/1000.0) + 1;
@@ -206,7 +206,7 @@ void CLFOGui::draw(CDrawContext* dc)
             if( tFullWave ) tFullWave->process_block();
             if( susCountdown < 0 && tlfo->env_state == lenv_stuck )
             {
-                susCountdown = susTime * samplerate / BLOCK_SIZE;
+                susCountdown = susTime * samplerate / storage->blockSize;
             }
             else if( susCountdown == 0 && tlfo->env_state == lenv_stuck ) {
                 tlfo->release();
@@ -900,8 +900,8 @@ void CLFOGui::drawStepSeq(VSTGUI::CDrawContext *dc, VSTGUI::CRect &maindisp, VST
    CRect boxo(rect_steps);
 
    int minSamples = ( 1 << 3 ) * (int)( boxo.right - boxo.left );
-   int totalSamples = std::max( (int)minSamples, (int)(totalSampleTime * samplerate / BLOCK_SIZE) );
-   float cycleSamples = cyclesec * samplerate / BLOCK_SIZE;
+   int totalSamples = std::max( (int)minSamples, (int)(totalSampleTime * samplerate / storage->blockSize) );
+   float cycleSamples = cyclesec * samplerate / storage->blockSize;
 
 
    // OK so lets assume we want about 1000 pixels worth tops in
@@ -931,7 +931,7 @@ void CLFOGui::drawStepSeq(VSTGUI::CDrawContext *dc, VSTGUI::CRect &maindisp, VST
          tlfo->process_block();
          if( susCountdown < 0 && tlfo->env_state == lenv_stuck )
          {
-            susCountdown = susTime * samplerate / BLOCK_SIZE;
+            susCountdown = susTime * samplerate / storage->blockSize;
          }
          else if( susCountdown == 0 && tlfo->env_state == lenv_stuck ) {
             tlfo->release();
@@ -180,10 +180,10 @@ void COscillatorDisplay::draw(CDrawContext* dc)
          if (use_display)
             osc->init(disp_pitch_rs, true);
 
-         int block_pos = BLOCK_SIZE_OS;
+         int block_pos = storage->blockSizeOS;
          for (int i = 0; i < totalSamples; i += averagingWindow)
          {
-            if (use_display && (block_pos >= BLOCK_SIZE_OS))
+            if (use_display && (block_pos >= storage->blockSizeOS))
             {
                if (uses_wavetabledata(oscdata->type.val.i))
                {
@@ -4892,6 +4892,11 @@ void SurgeGUIEditor::showSettingsMenu(CRect &menuRect)
     eid++;
     midiSubMenu->forget();
 
+    auto filterQualitySubMenu = makeFilterQualityMenu(menuRect);
+    settingsMenu->addEntry(filterQualitySubMenu, Surge::UI::toOSCaseForMenu("Filter Quality"));
+    eid++;
+    filterQualitySubMenu->forget();
+
     if (useDevMenu)
     {
         auto devSubMenu = makeDevMenu(menuRect);
@@ -5122,6 +5127,43 @@ VSTGUI::COptionMenu *SurgeGUIEditor::makeMonoModeOptionsMenu(VSTGUI::CRect& menu
    return monoSubMenu;
 }
 
+/*
+** The quality applies to this instance and is saved with its state; it also becomes the default
+** for new instances.
+*/
+VSTGUI::COptionMenu *SurgeGUIEditor::makeFilterQualityMenu(VSTGUI::CRect& menuRect)
+{
+   COptionMenu* fqSubMenu =
+       new COptionMenu(menuRect,
+                       0, 0, 0, 0,
+                       VSTGUI::COptionMenu::kNoDrawStyle | VSTGUI::COptionMenu::kMultipleCheckStyle);
+
+   auto quality = synth->storage.filterQuality;
+
+   auto cb = addCallbackMenu(fqSubMenu, "Standard",
+                   [this]() {
+                      this->synth->storage.filterQuality = FILTER_QUALITY_STANDARD;
+                      Surge::Storage::updateUserDefaultValue(&(this->synth->storage),
+                                                             "filterQuality",
+                                                             (int)FILTER_QUALITY_STANDARD);
+                   });
+   if( quality == FILTER_QUALITY_STANDARD )
+      cb->setChecked( true );
+
+   cb = addCallbackMenu(fqSubMenu,
+                        Surge::UI::toOSCaseForMenu("Economy (Cheaper Nonlinear Filters)"),
+                   [this]() {
+                      this->synth->storage.filterQuality = FILTER_QUALITY_ECONOMY;
+                      Surge::Storage::updateUserDefaultValue(&(this->synth->storage),
+                                                             "filterQuality",
+                                                             (int)FILTER_QUALITY_ECONOMY);
+                   });
+   if( quality == FILTER_QUALITY_ECONOMY )
+      cb->setChecked( true );
+
+   return fqSubMenu;
+}
+
 VSTGUI::COptionMenu* SurgeGUIEditor::makeTuningMenu(VSTGUI::CRect& menuRect, bool showhelp)
 {
     int tid=0;
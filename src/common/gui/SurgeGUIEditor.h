@@ -502,6 +502,7 @@ private:
    VSTGUI::COptionMenu* makeDevMenu(VSTGUI::CRect &rect);
    VSTGUI::COptionMenu* makeLfoMenu(VSTGUI::CRect &rect);
    VSTGUI::COptionMenu* makeMonoModeOptionsMenu(VSTGUI::CRect &rect, bool updateDefaults );
+   VSTGUI::COptionMenu* makeFilterQualityMenu(VSTGUI::CRect &rect);
    bool scannedForMidiPresets = false;
 
    void resetSmoothing( ControllerModulationSource::SmoothingMode t );
@@ -0,0 +1,181 @@
+/*
+** Surge Synthesizer is Free and Open Source Software
+**
+** Surge is made available under the Gnu General Public License, v3.0
+** https://www.gnu.org/licenses/gpl-3.0.en.html
+**
+** Copyright 2004-2020 by various individuals as described by the Git transaction log
+**
+** All source at: https://github.com/surge-synthesizer/surge.git
+**
+** Surge was a commercial product from 2004-2018, with Copyright and ownership
+** in that period held by Claes Johanson at Vember Audio. Claes made Surge
+** open source in September 2018.
+*/
+
+#include "AllocationCheck.h"
+
+#if SURGE_ASSERT_NO_ALLOC_IN_PROCESS
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#if WINDOWS
+#include <malloc.h>
+#endif
+#if MAC || LINUX
+#include <execinfo.h>
+#endif
+
+namespace
+{
+thread_local int noAllocationDepth = 0;
+thread_local int allowAllocationDepth = 0;
+
+void checkAllocation(std::size_t sz)
+{
+   if (noAllocationDepth > 0 && allowAllocationDepth == 0)
+   {
+      // No iostreams here; they may allocate
+      fprintf(stderr, "Surge: heap allocation of %zu bytes on the audio thread\n", sz);
+#if MAC || LINUX
+      void* frames[64];
+      int n = backtrace(frames, 64);
+      backtrace_symbols_fd(frames, n, 2);
+#endif
+      abort();
+   }
+}
+
+void* checkedAlloc(std::size_t sz)
+{
+   checkAllocation(sz);
+   void* p = malloc(sz ? sz : 1);
+   if (!p)
+      throw std::bad_alloc();
+   return p;
+}
+
+void* checkedAlignedAlloc(std::size_t sz, std::align_val_t al)
+{
+   checkAllocation(sz);
+   std::size_t a = static_cast<std::size_t>(al);
+   if (a < sizeof(void*))
+      a = sizeof(void*);
+   void* p = nullptr;
+#if WINDOWS
+   p = _aligned_malloc(sz ? sz : 1, a);
+#else
+   if (posix_memalign(&p, a, sz ? sz : 1) != 0)
+      p = nullptr;
+#endif
+   return p;
+}
+
+void alignedFree(void* p)
+{
+#if WINDOWS
+   _aligned_free(p);
+#else
+   free(p);
+#endif
+}
+} // namespace
+
+namespace Surge
+{
+namespace Debug
+{
+NoAllocationScope::NoAllocationScope()
+{
+   noAllocationDepth++;
+}
+NoAllocationScope::~NoAllocationScope()
+{
+   noAllocationDepth--;
+}
+AllowAllocationScope::AllowAllocationScope()
+{
+   allowAllocationDepth++;
+}
+AllowAllocationScope::~AllowAllocationScope()
+{
+   allowAllocationDepth--;
+}
+} // namespace Debug
+} // namespace Surge
+
+void* operator new(std::size_t sz)
+{
+   return checkedAlloc(sz);
+}
+void* operator new[](std::size_t sz)
+{
+   return checkedAlloc(sz);
+}
+void* operator new(std::size_t sz, const std::nothrow_t&) noexcept
+{
+   checkAllocation(sz);
+   return malloc(sz ? sz : 1);
+}
+void* operator new[](std::size_t sz, const std::nothrow_t&) noexcept
+{
+   checkAllocation(sz);
+   return malloc(sz ? sz : 1);
+}
+void operator delete(void* p) noexcept
+{
+   free(p);
+}
+void operator delete[](void* p) noexcept
+{
+   free(p);
+}
+void operator delete(void* p, std::size_t) noexcept
+{
+   free(p);
+}
+void operator delete[](void* p, std::size_t) noexcept
+{
+   free(p);
+}
+
+// The over-aligned forms, which the compiler uses for types declared with a large alignas
+void* operator new(std::size_t sz, std::align_val_t al)
+{
+   void* p = checkedAlignedAlloc(sz, al);
+   if (!p)
+      throw std::bad_alloc();
+   return p;
+}
+void* operator new[](std::size_t sz, std::align_val_t al)
+{
+   void* p = checkedAlignedAlloc(sz, al);
+   if (!p)
+      throw std::bad_alloc();
+   return p;
+}
+void* operator new(std::size_t sz, std::align_val_t al, const std::nothrow_t&) noexcept
+{
+   return checkedAlignedAlloc(sz, al);
+}
+void* operator new[](std::size_t sz, std::align_val_t al, const std::nothrow_t&) noexcept
+{
+   return checkedAlignedAlloc(sz, al);
+}
+void operator delete(void* p, std::align_val_t) noexcept
+{
+   alignedFree(p);
+}
+void operator delete[](void* p, std::align_val_t) noexcept
+{
+   alignedFree(p);
+}
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept
+{
+   alignedFree(p);
+}
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept
+{
+   alignedFree(p);
+}
+#endif
@@ -0,0 +1,58 @@
+/*
+** Surge Synthesizer is Free and Open Source Software
+**
+** Surge is made available under the Gnu General Public License, v3.0
+** https://www.gnu.org/licenses/gpl-3.0.en.html
+**
+** Copyright 2004-2020 by various individuals as described by the Git transaction log
+**
+** All source at: https://github.com/surge-synthesizer/surge.git
+**
+** Surge was a commercial product from 2004-2018, with Copyright and ownership
+** in that period held by Claes Johanson at Vember Audio. Claes made Surge
+** open source in September 2018.
+*/
+
+#pragma once
+
+/*
+** A debugging aid to check that the realtime paths don't allocate. Configure with
+** -DSURGE_ASSERT_NO_ALLOC_IN_PROCESS=ON and the global operator new is replaced with one which
+** aborts when it is called on a thread inside a NoAllocationScope (SurgeSynthesizer::process,
+** playNote and the scene worker), unless an AllowAllocationScope has been opened inside it for
+** one of the operations which are known to allocate (patch and FX loads, wavetable loads).
+**
+** Without the option both scopes are empty and cost nothing.
+*/
+namespace Surge
+{
+namespace Debug
+{
+#if SURGE_ASSERT_NO_ALLOC_IN_PROCESS
+struct NoAllocationScope
+{
+   NoAllocationScope();
+   ~NoAllocationScope();
+};
+
+struct AllowAllocationScope
+{
+   AllowAllocationScope();
+   ~AllowAllocationScope();
+};
+#else
+// The empty constructor and destructor keep the guards from warning as unused variables
+struct NoAllocationScope
+{
+   NoAllocationScope() {}
+   ~NoAllocationScope() {}
+};
+
+struct AllowAllocationScope
+{
+   AllowAllocationScope() {}
+   ~AllowAllocationScope() {}
+};
+#endif
+} // namespace Debug
+} // namespace Surge
@@ -0,0 +1,74 @@
+/*
+** Surge Synthesizer is Free and Open Source Software
+**
+** Surge is made available under the Gnu General Public License, v3.0
+** https://www.gnu.org/licenses/gpl-3.0.en.html
+**
+** Copyright 2004-2020 by various individuals as described by the Git transaction log
+**
+** All source at: https://github.com/surge-synthesizer/surge.git
+**
+** Surge was a commercial product from 2004-2018, with Copyright and ownership
+** in that period held by Claes Johanson at Vember Audio. Claes made Surge
+** open source in September 2018.
+*/
+
+#include "MappedFile.h"
+
+#if WINDOWS
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Surge
+{
+namespace Util
+{
+std::shared_ptr<void> mapFileReadOnly(const std::string& filename, size_t& bytes)
+{
+#if WINDOWS
+   HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                             OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+   if (file == INVALID_HANDLE_VALUE)
+      return nullptr;
+   LARGE_INTEGER sz;
+   if (!GetFileSizeEx(file, &sz) || sz.QuadPart == 0)
+   {
+      CloseHandle(file);
+      return nullptr;
+   }
+   HANDLE map = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+   CloseHandle(file);
+   if (!map)
+      return nullptr;
+   void* p = MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0);
+   CloseHandle(map);
+   if (!p)
+      return nullptr;
+   bytes = (size_t)sz.QuadPart;
+   return std::shared_ptr<void>(p, [](void* p) { UnmapViewOfFile(p); });
+#else
+   int fd = open(filename.c_str(), O_RDONLY);
+   if (fd < 0)
+      return nullptr;
+   struct stat st;
+   if (fstat(fd, &st) != 0 || st.st_size <= 0)
+   {
+      close(fd);
+      return nullptr;
+   }
+   size_t sz = st.st_size;
+   void* p = mmap(nullptr, sz, PROT_READ, MAP_PRIVATE, fd, 0);
+   close(fd);
+   if (p == MAP_FAILED)
+      return nullptr;
+   bytes = sz;
+   return std::shared_ptr<void>(p, [sz](void* p) { munmap(p, sz); });
+#endif
+}
+} // namespace Util
+} // namespace Surge
@@ -0,0 +1,31 @@
+/*
+** Surge Synthesizer is Free and Open Source Software
+**
+** Surge is made available under the Gnu General Public License, v3.0
+** https://www.gnu.org/licenses/gpl-3.0.en.html
+**
+** Copyright 2004-2020 by various individuals as described by the Git transaction log
+**
+** All source at: https://github.com/surge-synthesizer/surge.git
+**
+** Surge was a commercial product from 2004-2018, with Copyright and ownership
+** in that period held by Claes Johanson at Vember Audio. Claes made Surge
+** open source in September 2018.
+*/
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+namespace Surge
+{
+namespace Util
+{
+/*
+** Map a whole file read-only. The mapping lasts as long as the returned pointer (and any copies)
+** and the file size is returned in bytes; null if the file is missing, empty or can't be mapped.
+*/
+std::shared_ptr<void> mapFileReadOnly(const std::string& filename, size_t& bytes);
+} // namespace Util
+} // namespace Surge
@@ -0,0 +1,116 @@
+/*
+** Surge Synthesizer is Free and Open Source Software
+**
+** Surge is made available under the Gnu General Public License, v3.0
+** https://www.gnu.org/licenses/gpl-3.0.en.html
+**
+** Copyright 2004-2020 by various individuals as described by the Git transaction log
+**
+** All source at: https://github.com/surge-synthesizer/surge.git
+**
+** Surge was a commercial product from 2004-2018, with Copyright and ownership
+** in that period held by Claes Johanson at Vember Audio. Claes made Surge
+** open source in September 2018.
+*/
+
+#include "globals.h"
+#include "RealtimeWorker.h"
+#include <chrono>
+
+#if ARM_NEON
+#define SURGE_SPIN_PAUSE() \
+   do                      \
+   {                       \
+   } while (0)
+#else
+#define SURGE_SPIN_PAUSE() _mm_pause()
+#endif
+
+RealtimeWorker::RealtimeWorker(std::function<void()> j) : job(j), state(IDLE), keepRunning(true)
+{
+   worker = std::thread([this]() { run(); });
+}
+
+RealtimeWorker::~RealtimeWorker()
+{
+   keepRunning = false;
+   if (worker.joinable())
+      worker.join();
+}
+
+void RealtimeWorker::dispatch()
+{
+#if !ARM_NEON
+   dispatchCSR = _mm_getcsr();
+#endif
+   state.store(PENDING, std::memory_order_release);
+}
+
+void RealtimeWorker::join()
+{
+   int expected = PENDING;
+   if (state.compare_exchange_strong(expected, RUNNING, std::memory_order_acq_rel))
+   {
+      // The worker never got to it; run it here rather than wait for the scheduler
+      job();
+   }
+   else
+   {
+      while (state.load(std::memory_order_acquire) != DONE)
+         SURGE_SPIN_PAUSE();
+   }
+   state.store(IDLE, std::memory_order_release);
+}
+
+void RealtimeWorker::runJob()
+{
+#if !ARM_NEON
+   unsigned int priorCSR = _mm_getcsr();
+   _mm_setcsr(dispatchCSR);
+#endif
+   job();
+#if !ARM_NEON
+   _mm_setcsr(priorCSR);
+#endif
+   state.store(DONE, std::memory_order_release);
+}
+
+void RealtimeWorker::run()
+{
+   /*
+   ** Spin hard for a few blocks worth of time after each job since the next dispatch is
+   ** usually less than a block away, then yield, then back off to short sleeps so an
+   ** instance which has gone quiet doesn't keep a core busy. join() covers any latency
+   ** we pick up by sleeping.
+   */
+   const int spinIterations = 1 << 14;
+   const int yieldIterations = 1 << 10;
+   int idleCount = 0;
+
+   while (keepRunning.load(std::memory_order_relaxed))
+   {
+      int expected = PENDING;
+      if (state.load(std::memory_order_acquire) == PENDING &&
+          state.compare_exchange_strong(expected, RUNNING, std::memory_order_acq_rel))
+      {
+         runJob();
+         idleCount = 0;
+         continue;
+      }
+
+      if (idleCount < spinIterations)
+      {
+         SURGE_SPIN_PAUSE();
+      }
+      else if (idleCount < spinIterations + yieldIterations)
+      {
+         std::this_thread::yield();
+      }
+      else
+      {
+         std::this_thread::sleep_for(std::chrono::microseconds(100));
+      }
+      if (idleCount < spinIterations + yieldIterations)
+         idleCount++;
+   }
+}
@@ -0,0 +1,64 @@
+/*
+** Surge Synthesizer is Free and Open Source Software
+**
+** Surge is made available under the Gnu General Public License, v3.0
+** https://www.gnu.org/licenses/gpl-3.0.en.html
+**
+** Copyright 2004-2020 by various individuals as described by the Git transaction log
+**
+** All source at: https://github.com/surge-synthesizer/surge.git
+**
+** Surge was a commercial product from 2004-2018, with Copyright and ownership
+** in that period held by Claes Johanson at Vember Audio. Claes made Surge
+** open source in September 2018.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <thread>
+
+/*
+** RealtimeWorker owns one pre-spawned thread which runs a single job, once per
+** dispatch(), alongside the audio thread. The audio thread meets it again in join().
+**
+** Neither side ever takes a lock. The handoff is a small state machine on one atomic:
+**
+**   idle -> pending (dispatch) -> running (worker or join claims it) -> done -> idle (join)
+**
+** If the worker hasn't claimed a pending job by the time the audio thread reaches join()
+** (because it was descheduled or had backed off to sleep), join() claims it and runs it
+** inline. So the audio thread only ever waits for a job which is actually executing on the
+** other core, never on the OS waking a thread up.
+**
+** The worker copies the MXCSR of the dispatching thread before running the job so FTZ/DAZ
+** and rounding match the audio thread and the results are the same as running inline.
+*/
+class RealtimeWorker
+{
+public:
+   explicit RealtimeWorker(std::function<void()> job);
+   ~RealtimeWorker();
+
+   void dispatch();
+   void join();
+
+private:
+   enum State
+   {
+      IDLE = 0,
+      PENDING,
+      RUNNING,
+      DONE
+   };
+
+   void run();
+   void runJob();
+
+   std::function<void()> job;
+   std::atomic<int> state;
+   std::atomic<bool> keepRunning;
+   unsigned int dispatchCSR = 0;
+   std::thread worker;
+};
@@ -0,0 +1,57 @@
+/*
+** Surge Synthesizer is Free and Open Source Software
+**
+** Surge is made available under the Gnu General Public License, v3.0
+** https://www.gnu.org/licenses/gpl-3.0.en.html
+**
+** Copyright 2004-2020 by various individuals as described by the Git transaction log
+**
+** All source at: https://github.com/surge-synthesizer/surge.git
+**
+** Surge was a commercial product from 2004-2018, with Copyright and ownership
+** in that period held by Claes Johanson at Vember Audio. Claes made Surge
+** open source in September 2018.
+*/
+
+#include "SceneRandom.h"
+
+#include <cstdlib>
+
+namespace Surge
+{
+namespace SceneRandom
+{
+namespace
+{
+thread_local Generator* current = nullptr;
+}
+
+void Generator::seed(unsigned int s)
+{
+   state = s % 2147483647u;
+   if (state == 0)
+      state = 1;
+}
+
+int Generator::next()
+{
+   state = (uint32_t)(((uint64_t)state * 48271u) % 2147483647u);
+   return (int)(state % ((uint32_t)RAND_MAX + 1u));
+}
+
+Scope::Scope(Generator& g) : previous(current)
+{
+   current = &g;
+}
+
+Scope::~Scope()
+{
+   current = previous;
+}
+
+int rand()
+{
+   return current ? current->next() : ::rand();
+}
+} // namespace SceneRandom
+} // namespace Surge
@@ -0,0 +1,54 @@
+/*
+** Surge Synthesizer is Free and Open Source Software
+**
+** Surge is made available under the Gnu General Public License, v3.0
+** https://www.gnu.org/licenses/gpl-3.0.en.html
+**
+** Copyright 2004-2020 by various individuals as described by the Git transaction log
+**
+** All source at: https://github.com/surge-synthesizer/surge.git
+**
+** Surge was a commercial product from 2004-2018, with Copyright and ownership
+** in that period held by Claes Johanson at Vember Audio. Claes made Surge
+** open source in September 2018.
+*/
+
+#pragma once
+
+#include <cstdint>
+
+/*
+** The random numbers drawn while a scene renders (oscillator drift and unison, noise, the S&H
+** oscillator, LFO random phases, insert FX) come from the scene's own generator rather than
+** the C library's rand(). So a scene draws the same sequence whichever thread renders it and
+** whatever the other scene is doing, and rendering scene B on the scene worker sounds exactly
+** as rendering it inline does.
+**
+** SurgeSynthesizer opens a Scope with the scene's generator around each scene's render.
+** Outside one, rand() is just ::rand(), so note-ons and the tests' srand() work as they
+** always have.
+*/
+namespace Surge
+{
+namespace SceneRandom
+{
+// A minimal standard LCG; its state is one word so it never allocates and copies freely
+struct Generator
+{
+   void seed(unsigned int s);
+   int next(); // on [0, RAND_MAX], like ::rand()
+
+   uint32_t state = 1;
+};
+
+struct Scope
+{
+   explicit Scope(Generator& g);
+   ~Scope();
+
+   Generator* previous;
+};
+
+int rand();
+} // namespace SceneRandom
+} // namespace Surge
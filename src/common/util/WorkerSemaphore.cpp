@@ -0,0 +1,67 @@
+/*
+** Surge Synthesizer is Free and Open Source Software
+**
+** Surge is made available under the Gnu General Public License, v3.0
+** https://www.gnu.org/licenses/gpl-3.0.en.html
+**
+** Copyright 2004-2020 by various individuals as described by the Git transaction log
+**
+** All source at: https://github.com/surge-synthesizer/surge.git
+**
+** Surge was a commercial product from 2004-2018, with Copyright and ownership
+** in that period held by Claes Johanson at Vember Audio. Claes made Surge
+** open source in September 2018.
+*/
+
+#include "globals.h"
+#include "WorkerSemaphore.h"
+#include <climits>
+
+#if WINDOWS
+#include <windows.h>
+#endif
+
+WorkerSemaphore::WorkerSemaphore()
+{
+#if WINDOWS
+   sem = CreateSemaphore(nullptr, 0, LONG_MAX, nullptr);
+#elif MAC
+   sem = dispatch_semaphore_create(0);
+#else
+   sem_init(&sem, 0, 0);
+#endif
+}
+
+WorkerSemaphore::~WorkerSemaphore()
+{
+#if WINDOWS
+   CloseHandle(sem);
+#elif MAC
+   dispatch_release(sem);
+#else
+   sem_destroy(&sem);
+#endif
+}
+
+void WorkerSemaphore::signal()
+{
+#if WINDOWS
+   ReleaseSemaphore(sem, 1, nullptr);
+#elif MAC
+   dispatch_semaphore_signal(sem);
+#else
+   sem_post(&sem);
+#endif
+}
+
+void WorkerSemaphore::wait()
+{
+#if WINDOWS
+   WaitForSingleObject(sem, INFINITE);
+#elif MAC
+   dispatch_semaphore_wait(sem, DISPATCH_TIME_FOREVER);
+#else
+   while (sem_wait(&sem) != 0)
+      ; // interrupted by a signal
+#endif
+}
@@ -0,0 +1,46 @@
+/*
+** Surge Synthesizer is Free and Open Source Software
+**
+** Surge is made available under the Gnu General Public License, v3.0
+** https://www.gnu.org/licenses/gpl-3.0.en.html
+**
+** Copyright 2004-2020 by various individuals as described by the Git transaction log
+**
+** All source at: https://github.com/surge-synthesizer/surge.git
+**
+** Surge was a commercial product from 2004-2018, with Copyright and ownership
+** in that period held by Claes Johanson at Vember Audio. Claes made Surge
+** open source in September 2018.
+*/
+
+#pragma once
+
+#if MAC
+#include <dispatch/dispatch.h>
+#elif !WINDOWS
+#include <semaphore.h>
+#endif
+
+/*
+** A counting semaphore on the OS primitive, for waking the long-lived background threads (the
+** wavetable mipmap worker and the patch staging thread). signal() never takes a lock, so the
+** audio thread can wake a worker with it.
+*/
+class WorkerSemaphore
+{
+public:
+   WorkerSemaphore();
+   ~WorkerSemaphore();
+
+   void signal();
+   void wait();
+
+private:
+#if WINDOWS
+   void* sem;
+#elif MAC
+   dispatch_semaphore_t sem;
+#else
+   sem_t sem;
+#endif
+};
@@ -1,7 +1,9 @@
 #include "halfratefilter.h"
 #include "assert.h"
 
-const unsigned int hr_BLOCK_SIZE = 256;
+// The most samples (per channel) a single call can process: the distortion's 4x oversampled
+// block at the largest engine block size
+const unsigned int hr_BLOCK_SIZE = 1024;
 const __m128 half = _mm_set_ps1(0.5f);
 
 HalfRateFilter::HalfRateFilter(int M, bool steep)
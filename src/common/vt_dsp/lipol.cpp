@@ -19,6 +19,12 @@ void lipol_ps::set_blocksize(int bs)
    m128_bs4_inv = _mm_div_ss(m128_four, lipol_BLOCK_SIZE);
 }
 
+void lipol_ps::set_smoothing_blocksize(int bs)
+{
+   coef = _mm_set1_ps(1.f - powf(0.75f, bs / 32.f));
+   coef_m1 = _mm_sub_ss(m128_one, coef);
+}
+
 void lipol_ps::multiply_block(float* src, unsigned int nquads)
 {
    __m128 y1, y2, dy;
@@ -62,6 +62,8 @@ public:
       target = _mm_add_ss(p1, p2);
    }
    void set_blocksize(int bs);
+   // set_target_smoothed moves a quarter of the way per 32 samples of an engine block of bs
+   void set_smoothing_blocksize(int bs);
 
    // inline void set_target(__m128 t) { currentval = target; target = t; }
    inline void instantize()
@@ -12,6 +12,9 @@ void statsFromPlayingEveryPatch();
 void playSomeBach();
 void filterAnalyzer( int ft, int fst, std::ostream &os );
 void generateNLFeedbackNorms();
+void blockSizeBenchmark();
+void fmBenchmark();
+void unisonBenchmark();
 }
 }
 }
@@ -82,12 +82,13 @@ void playAsConfigured(std::shared_ptr<SurgeSynthesizer> surge,
    if (events.size() == 0)
       return;
 
+   const int blockSize = surge->getBlockSize();
    int desiredSamples = events.back().atSample;
-   int blockCount = desiredSamples / BLOCK_SIZE + 1;
+   int blockCount = desiredSamples / blockSize + 1;
    int currEvt = 0;
 
    *nChannels = 2;
-   *nSamples = blockCount * BLOCK_SIZE;
+   *nSamples = blockCount * blockSize;
    size_t dataSize = *nChannels * *nSamples;
    float* ldata = new float[dataSize];
    memset(ldata, 0, dataSize);
@@ -99,8 +100,8 @@ void playAsConfigured(std::shared_ptr<SurgeSynthesizer> surge,
    
    for (auto i = 0; i < blockCount; ++i)
    {
-      int cs = i * BLOCK_SIZE;
-      while (currEvt < events.size() && events[currEvt].atSample <= cs + BLOCK_SIZE - 1)
+      int cs = i * blockSize;
+      while (currEvt < events.size() && events[currEvt].atSample <= cs + blockSize - 1)
       {
          Event e = events[currEvt];
          switch( e.type )
@@ -122,7 +123,7 @@ void playAsConfigured(std::shared_ptr<SurgeSynthesizer> surge,
       }
 
       surge->process();
-      for (int sm = 0; sm < BLOCK_SIZE; ++sm)
+      for (int sm = 0; sm < blockSize; ++sm)
       {
          for (int oi = 0; oi < surge->getNumOutputs(); ++oi)
          {
@@ -227,15 +228,16 @@ void playMidiFile(std::shared_ptr<SurgeSynthesizer> synth,
    int currentEvent = 0;
    double currentTime = mf[0][currentEvent].seconds;
 
-   if ((callBackEvery) % (BLOCK_SIZE * 2) != 0)
+   const int blockSize = synth->getBlockSize();
+   if ((callBackEvery) % (blockSize * 2) != 0)
    {
-      std::cerr << "Please make callBackEvery a multiple of " << BLOCK_SIZE << "*2" << std::endl;
+      std::cerr << "Please make callBackEvery a multiple of " << blockSize << "*2" << std::endl;
       return;
    }
 
    float* ldata = new float[callBackEvery * 2];
    long flidx = 0;
-   double deltaT = BLOCK_SIZE / sampleRate;
+   double deltaT = blockSize / sampleRate;
 
    while (currentEvent < mf[0].size() ||
           (synth->getNonUltrareleaseVoices(0) > 0 || synth->getNonUltrareleaseVoices(1) > 0))
@@ -253,7 +255,7 @@ void playMidiFile(std::shared_ptr<SurgeSynthesizer> synth,
       currentTime += deltaT;
 
       synth->process();
-      for (int sm = 0; sm < BLOCK_SIZE; ++sm)
+      for (int sm = 0; sm < blockSize; ++sm)
       {
          for (int oi = 0; oi < synth->getNumOutputs(); ++oi)
          {
@@ -1,6 +1,7 @@
 #include <memory>
 #include "SurgeSynthesizer.h"
 #include "Player.h"
+#include "Oscillator.h"
 #include "catch2/catch2.hpp"
 #include <iostream>
 #include <cstdio>
@@ -83,7 +84,7 @@ double frequencyForNote( std::shared_ptr<SurgeSynthesizer> surge, int note,
    
    REQUIRE( nC == 2 );
    REQUIRE( nS >= samplerate * seconds );
-   REQUIRE( nS <= samplerate * seconds + 4 * BLOCK_SIZE );
+   REQUIRE( nS <= samplerate * seconds + 64 + surge->storage.blockSize ); // the 64 sample tail, rounded up to a block
 
    // Trim off the leading and trailing
    int nSTrim = (int)(nS / 2 * 0.8);
@@ -107,7 +108,7 @@ std::pair<double,double> frequencyAndRMSForNote( std::shared_ptr<SurgeSynthesize
    
    REQUIRE( nC == 2 );
    REQUIRE( nS >= samplerate * seconds );
-   REQUIRE( nS <= samplerate * seconds + 4 * BLOCK_SIZE );
+   REQUIRE( nS <= samplerate * seconds + 64 + surge->storage.blockSize ); // the 64 sample tail, rounded up to a block
 
    // Trim off the leading and trailing
    int nSTrim = (int)(nS / 2 * 0.8);
@@ -222,5 +223,56 @@ void makePlotPNGFromData( std::string pngFileName,
 }
 
 
+std::pair<float,float> batchedOscillatorDifference( std::shared_ptr<SurgeSynthesizer> surge,
+                                                    int blocks,
+                                                    std::function<float(int)> pitchForBlock,
+                                                    float drift, bool stereo, bool fm )
+{
+   auto &patch = surge->storage.getPatch();
+   auto &osc = patch.scene[0].osc[0];
+   patch.copy_scenedata( patch.scenedata[0], 0 );
+
+   float fmsource alignas(16)[BLOCK_SIZE_OS_MAX];
+   unsigned char bufS alignas(16)[oscillator_buffer_size];
+   unsigned char bufB alignas(16)[oscillator_buffer_size];
+   auto *scalar = spawn_osc( osc.type.val.i, &surge->storage, &osc, patch.scenedata[0], bufS );
+   auto *batched = spawn_osc( osc.type.val.i, &surge->storage, &osc, patch.scenedata[0], bufB );
+   srand( 42 );
+   scalar->init( 60 );
+   srand( 42 );
+   batched->init( 60 );
+   scalar->assign_fm( fmsource );
+   batched->assign_fm( fmsource );
+
+   bool wasBatched = surge->storage.batchOscillatorUnison;
+   float maxerr = 0, maxabs = 0;
+   for( int b=0; b<blocks; ++b )
+   {
+      for( int i=0; i<surge->storage.blockSizeOS; ++i )
+         fmsource[i] = sin( ( b * surge->storage.blockSizeOS + i ) * 0.013 );
+
+      float pitch = pitchForBlock( b );
+      surge->storage.batchOscillatorUnison = false;
+      srand( b );
+      scalar->process_block( pitch, drift, stereo, fm, 0.3 );
+      surge->storage.batchOscillatorUnison = true;
+      srand( b );
+      batched->process_block( pitch, drift, stereo, fm, 0.3 );
+
+      for( int i=0; i<surge->storage.blockSizeOS; ++i )
+      {
+         maxerr = std::max( maxerr, fabs( batched->output[i] - scalar->output[i] ) );
+         if( stereo )
+            maxerr = std::max( maxerr, fabs( batched->outputR[i] - scalar->outputR[i] ) );
+         maxabs = std::max( maxabs, fabs( scalar->output[i] ) );
+      }
+   }
+   surge->storage.batchOscillatorUnison = wasBatched;
+
+   scalar->~Oscillator();
+   batched->~Oscillator();
+   return std::make_pair( maxerr, maxabs );
+}
+
 }
 }
@@ -4,6 +4,7 @@
 // the includer so we can set CATCH_CONFIG_RUNNER properly
 
 #include "SurgeSynthesizer.h"
+#include <functional>
 
 namespace Surge {
 namespace Test {
@@ -41,5 +42,16 @@ void makePlotPNGFromData( std::string pngFileName,
                           int startSample = -1, int endSample = -1 );
 
 std::shared_ptr<SurgeSynthesizer> surgeOnSine();
+
+/*
+** Render scene A's first oscillator twice side by side, once with the unison batching off
+** (SurgeStorage::batchOscillatorUnison) and once with it on, from the same random seeds and
+** with a sine as the FM source. Returns the largest difference between the two renders and
+** the largest output of the unbatched one.
+*/
+std::pair<float,float> batchedOscillatorDifference( std::shared_ptr<SurgeSynthesizer> surge,
+                                                    int blocks,
+                                                    std::function<float(int)> pitchForBlock,
+                                                    float drift, bool stereo, bool fm );
 }
 }
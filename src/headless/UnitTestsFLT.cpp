@@ -39,7 +39,7 @@ TEST_CASE( "Run Every Filter", "[flt]" )
 
             Surge::Headless::playAsConfigured(surge, heldC, &data, &nSamples, &nChannels);
             REQUIRE(data);
-            REQUIRE(std::abs(nSamples - len) <= BLOCK_SIZE);
+            REQUIRE(std::abs(nSamples - len) <= surge->storage.blockSize);
             REQUIRE(nChannels == 2);
 
             if (data)
@@ -72,7 +72,7 @@ TEST_CASE( "Run Every Waveshaper", "[flt]" )
 
             Surge::Headless::playAsConfigured(surge, heldC, &data, &nSamples, &nChannels);
             REQUIRE(data);
-            REQUIRE(std::abs(nSamples - len) <= BLOCK_SIZE);
+            REQUIRE(std::abs(nSamples - len) <= surge->storage.blockSize);
             REQUIRE(nChannels == 2);
 
             if (data)
@@ -44,7 +44,7 @@ TEST_CASE( "Airwindows Loud", "[fx]" )
          for (int s = 0; s < 100; ++s)
          {
             surge->process();
-            for (int p = 0; p < BLOCK_SIZE; ++p)
+            for (int p = 0; p < surge->storage.blockSize; ++p)
             {
                soo += surge->output[0][p] + surge->output[1][p];
                REQUIRE( fabs( surge->output[0][p] ) < 1e-5 );
@@ -12,6 +12,9 @@
 #include "UnitTestUtilities.h"
 
 #include <unordered_map>
+#include <thread>
+#include <chrono>
+#include <cstring>
 
 using namespace Surge::Test;
 
@@ -57,6 +60,239 @@ TEST_CASE( "We can read a collection of wavetables", "[io]" )
    
 }
 
+
+TEST_CASE( "Wavetables Are Shared Through The Cache", "[io]" )
+{
+   auto s1 = Surge::Headless::createSurge(44100);
+   auto s2 = Surge::Headless::createSurge(44100);
+   REQUIRE( s1.get() );
+   REQUIRE( s2.get() );
+
+   auto w1 = &(s1->storage.getPatch().scene[0].osc[0].wt);
+   auto w2 = &(s2->storage.getPatch().scene[1].osc[2].wt);
+
+   // Other tests share the cache so only look at the changes
+   auto before = getWavetableCacheStats();
+   s1->storage.load_wt_wav_portable("test-data/wav/Wavetable.wav", w1 );
+   auto loaded = getWavetableCacheStats();
+   s2->storage.load_wt_wav_portable("test-data/wav/Wavetable.wav", w2 );
+   auto shared = getWavetableCacheStats();
+
+   REQUIRE( w1->n_tables == 256 );
+   REQUIRE( w2->n_tables == 256 );
+   REQUIRE( w1->TableF32WeakPointers[0][0] == w2->TableF32WeakPointers[0][0] );
+   REQUIRE( w1->TableI16WeakPointers[3][17] == w2->TableI16WeakPointers[3][17] );
+   REQUIRE( shared.hits == loaded.hits + 1 );
+   REQUIRE( shared.misses == loaded.misses );
+   REQUIRE( shared.bytes == loaded.bytes );
+   REQUIRE( loaded.hits + loaded.misses == before.hits + before.misses + 1 );
+
+   // Copies share too
+   Wavetable w3;
+   w3.Copy( w1 );
+   REQUIRE( w3.TableF32WeakPointers[5][100] == w1->TableF32WeakPointers[5][100] );
+
+   // and the data goes when the last reference does
+   s1->storage.load_wt_wav_portable("test-data/wav/05_BELL.WAV", w1 );
+   s2->storage.load_wt_wav_portable("test-data/wav/05_BELL.WAV", w2 );
+   REQUIRE( getWavetableCacheStats().tables == shared.tables + 1 );
+   w3.Copy( w1 );
+   auto released = getWavetableCacheStats();
+   REQUIRE( released.tables == shared.tables );
+   REQUIRE( released.bytes < shared.bytes );
+}
+
+TEST_CASE( "Lazily Mipmapped .wt Tables Match Eager Ones", "[io]" )
+{
+   auto surge = Surge::Headless::createSurge(44100);
+   REQUIRE( surge.get() );
+
+   // One float and one int16 .wt, other than the default table the synth is holding
+   std::vector<std::string> files;
+   bool haveFloat = false, haveInt16 = false;
+   for( int i = 1; i < (int)surge->storage.wt_list.size(); ++i )
+   {
+      auto path = path_to_string(surge->storage.wt_list[i].path);
+      if( path.substr(path.size() - 3) != ".wt" )
+         continue;
+
+      FILE* f = fopen(path.c_str(), "rb");
+      wt_header wh;
+      REQUIRE( fread(&wh, sizeof(wh), 1, f) == 1 );
+      fclose(f);
+
+      bool isInt16 = wh.flags & wtf_int16;
+      if( ( isInt16 && !haveInt16 ) || ( !isInt16 && !haveFloat ) )
+      {
+         files.push_back(path);
+         haveInt16 |= isInt16;
+         haveFloat |= !isInt16;
+      }
+   }
+   REQUIRE( haveFloat );
+
+   for( auto path : files )
+   {
+      INFO( "Loading " << path );
+
+      // Build it eagerly from a copy of the file, keep the levels, then let it go
+      std::vector<std::vector<float>> eagerF32;
+      std::vector<std::vector<short>> eagerI16;
+      int levels = 0, tables = 0, size = 0;
+      {
+         FILE* f = fopen(path.c_str(), "rb");
+         fseek(f, 0, SEEK_END);
+         std::vector<char> file(ftell(f));
+         fseek(f, 0, SEEK_SET);
+         REQUIRE( fread(file.data(), 1, file.size(), f) == file.size() );
+         fclose(f);
+
+         wt_header wh;
+         memcpy(&wh, file.data(), sizeof(wh));
+         Wavetable eager;
+         REQUIRE( eager.BuildWT(file.data() + sizeof(wh), wh, false) );
+         size = eager.size;
+         tables = eager.n_tables;
+         while( ( 1 << levels ) < size )
+            levels++;
+         for( int l = 0; l < levels; ++l )
+            for( int t = 0; t < tables; ++t )
+            {
+               auto *f32 = eager.TableF32WeakPointers[l][t];
+               auto *i16 = eager.TableI16WeakPointers[l][t];
+               eagerF32.push_back( std::vector<float>(f32, f32 + (size >> l)) );
+               eagerI16.push_back( std::vector<short>(i16, i16 + (size >> l) + 2 * FIRoffsetI16) );
+            }
+      }
+
+      auto before = getWavetableCacheStats();
+      Wavetable lazy;
+      REQUIRE( surge->storage.load_wt_wt(path, &lazy) );
+      REQUIRE( getWavetableCacheStats().misses == before.misses + 1 );
+      REQUIRE( lazy.size == size );
+      REQUIRE( (int)lazy.n_tables == tables );
+
+      if( !( lazy.flags & wtf_int16 ) )
+      {
+         // read in place from the mapped file
+         REQUIRE( lazy.TableF32WeakPointers[0][0] != lazy.TableF32Data );
+      }
+
+      // Nothing is built above the base level until it is asked for, and asking doesn't wait,
+      // though the worker wakes at once so may have built it by the time we look
+      int want = std::min(3, levels - 1);
+      int first = lazy.readyMipmap(want, 0);
+      REQUIRE( ( first == 0 || first == want ) );
+
+      auto start = std::chrono::steady_clock::now();
+      while( lazy.readyMipmap(want, 0) != want &&
+             std::chrono::steady_clock::now() - start < std::chrono::seconds(10) )
+         std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      REQUIRE( lazy.readyMipmap(want, 0) == want );
+      for( int i = 0; i < (size >> want); ++i )
+         REQUIRE( lazy.TableF32WeakPointers[want][0][i] == eagerF32[want * tables][i] );
+
+      lazy.completeMipmaps();
+      int idx = 0;
+      for( int l = 0; l < levels; ++l )
+         for( int t = 0; t < tables; ++t, ++idx )
+         {
+            INFO( "Level " << l << " table " << t );
+            REQUIRE( lazy.readyMipmap(l, t) == l );
+            REQUIRE( memcmp( lazy.TableF32WeakPointers[l][t], eagerF32[idx].data(),
+                             eagerF32[idx].size() * sizeof(float) ) == 0 );
+            REQUIRE( memcmp( lazy.TableI16WeakPointers[l][t], eagerI16[idx].data(),
+                             eagerI16[idx].size() * sizeof(short) ) == 0 );
+         }
+   }
+}
+
+TEST_CASE( "Wavetable Mipmaps Round Trip Through The Disk Cache", "[io]" )
+{
+   auto surge = Surge::Headless::createSurge(44100);
+   REQUIRE( surge.get() );
+
+   auto dir = fs::temp_directory_path() / "surge-wavetable-cache-test";
+   std::error_code ec;
+   fs::remove_all(dir, ec);
+   fs::create_directories(dir);
+   setWavetableMipmapCacheDirectory(path_to_string(dir));
+
+   auto waitFor = [](std::function<bool()> f) {
+      auto start = std::chrono::steady_clock::now();
+      while( !f() && std::chrono::steady_clock::now() - start < std::chrono::seconds(10) )
+         std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      return f();
+   };
+
+   auto levelsOf = [](Wavetable& wt) {
+      std::vector<std::vector<float>> res;
+      for( int l = 0; l < max_mipmap_levels && ( wt.size >> l ) > 1; ++l )
+         for( int t = 0; t < (int)wt.n_tables; ++t )
+         {
+            auto* f32 = wt.TableF32WeakPointers[l][t];
+            auto* i16 = wt.TableI16WeakPointers[l][t];
+            res.push_back( std::vector<float>(f32, f32 + (wt.size >> l)) );
+            std::vector<float> i16f;
+            for( int i = 0; i < ( wt.size >> l ) + 2 * FIRoffsetI16; ++i )
+               i16f.push_back(i16[i]);
+            res.push_back(i16f);
+         }
+      return res;
+   };
+
+   auto base = getWavetableCacheStats();
+   std::vector<std::vector<float>> built;
+   {
+      Wavetable a;
+      surge->storage.load_wt_wav_portable("test-data/wav/05_BELL.WAV", &a);
+      REQUIRE( a.n_tables == 33 );
+      built = levelsOf(a);
+      REQUIRE( waitFor( [&]() { return getWavetableCacheStats().diskWrites == base.diskWrites + 1; } ) );
+   }
+   REQUIRE( waitFor( [&]() { return getWavetableCacheStats().tables == base.tables; } ) );
+
+   std::vector<fs::path> files;
+   for( auto& e : fs::directory_iterator(dir) )
+      files.push_back(e.path());
+   REQUIRE( files.size() == 1 );
+   REQUIRE( path_to_string(files[0].extension()) == ".wtmip" );
+
+   {
+      Wavetable b;
+      surge->storage.load_wt_wav_portable("test-data/wav/05_BELL.WAV", &b);
+      REQUIRE( getWavetableCacheStats().diskHits == base.diskHits + 1 );
+      REQUIRE( levelsOf(b) == built );
+   }
+   REQUIRE( waitFor( [&]() { return getWavetableCacheStats().tables == base.tables; } ) );
+
+   // A damaged file is ignored, and replaced
+   {
+      FILE* f = fopen(path_to_string(files[0]).c_str(), "r+b");
+      REQUIRE( f );
+      fseek(f, 8, SEEK_SET);
+      fputc(0x5a, f);
+      fclose(f);
+   }
+   {
+      Wavetable c;
+      surge->storage.load_wt_wav_portable("test-data/wav/05_BELL.WAV", &c);
+      REQUIRE( getWavetableCacheStats().diskHits == base.diskHits + 1 );
+      REQUIRE( levelsOf(c) == built );
+      REQUIRE( waitFor( [&]() { return getWavetableCacheStats().diskWrites == base.diskWrites + 2; } ) );
+   }
+   REQUIRE( waitFor( [&]() { return getWavetableCacheStats().tables == base.tables; } ) );
+   {
+      Wavetable d;
+      surge->storage.load_wt_wav_portable("test-data/wav/05_BELL.WAV", &d);
+      REQUIRE( getWavetableCacheStats().diskHits == base.diskHits + 2 );
+      REQUIRE( levelsOf(d) == built );
+   }
+
+   setWavetableMipmapCacheDirectory("");
+   fs::remove_all(dir, ec);
+}
+
 TEST_CASE( "All .wt and .wav factory assets load", "[io]" )
 {
    auto surge = Surge::Headless::createSurge(44100);
@@ -309,6 +545,21 @@ TEST_CASE( "DAW Streaming and Unstreaming", "[io][mpe][tun]" )
       REQUIRE( surgeDest->storage.controllers[4] == 79 );
    }
 
+   SECTION( "Filter Quality Saves" )
+   {
+      auto surgeSrc = Surge::Headless::createSurge(44100);
+      auto surgeDest = Surge::Headless::createSurge(44100);
+
+      surgeSrc->storage.filterQuality = FILTER_QUALITY_ECONOMY;
+      surgeDest->storage.filterQuality = FILTER_QUALITY_STANDARD;
+      fromto( surgeSrc, surgeDest );
+      REQUIRE( surgeDest->storage.filterQuality == FILTER_QUALITY_ECONOMY );
+
+      surgeSrc->storage.filterQuality = FILTER_QUALITY_STANDARD;
+      fromto( surgeSrc, surgeDest );
+      REQUIRE( surgeDest->storage.filterQuality == FILTER_QUALITY_STANDARD );
+   }
+
 }
 
 TEST_CASE( "Stream WaveTable Names", "[io]" )
@@ -728,6 +979,144 @@ TEST_CASE( "Patch Version Builder", "[io]")
    }
 }
 
+TEST_CASE( "Gapless Patch Switching", "[io]" )
+{
+   auto surge = Surge::Headless::createSurge(44100);
+   REQUIRE( surge );
+   surge->setGaplessPatchSwitching(true);
+
+   // The warm up counts towards the blocks before the commit, in case staging is quick
+   std::vector<float> peaks;
+   auto blockPeak = [surge]() {
+      float peak = 0;
+      for (int s = 0; s < surge->storage.blockSize; ++s)
+         peak = std::max(peak, std::fabs(surge->output[0][s]));
+      return peak;
+   };
+
+   surge->playNote(0, 60, 127, 0);
+   for (int i = 0; i < 20; ++i)
+   {
+      surge->process();
+      peaks.push_back(blockPeak());
+   }
+
+   strncpy(surge->patchid_file, "test-data/patches/Church.fxp", FILENAME_MAX - 1);
+   surge->has_patchid_file = true;
+
+   bool playedWhileStaging = false;
+   int commitBlock = -1;
+   for (int i = 0; i < 20000 && (surge->has_patchid_file || surge->isPatchStagingInFlight()); ++i)
+   {
+      bool staging = surge->isPatchStagingInFlight() && surge->storage.getPatch().name == "Init";
+      surge->process();
+      REQUIRE( !surge->halt_engine );
+      if (commitBlock < 0 && surge->storage.getPatch().name == "Church")
+         commitBlock = peaks.size();
+
+      float peak = blockPeak();
+      peaks.push_back(peak);
+      if (staging && peak > 1e-3)
+         playedWhileStaging = true;
+
+      if (commitBlock < 0)
+         std::this_thread::sleep_for(std::chrono::microseconds(100));
+   }
+   REQUIRE( !surge->isPatchStagingInFlight() );
+   REQUIRE( playedWhileStaging );
+   REQUIRE( surge->storage.getPatch().name == "Church" );
+
+   // The held note fades out with the old patch rather than dropping out at the commit
+   int window = 256 / surge->storage.blockSize + 1; // more than a period of the note
+   REQUIRE( commitBlock >= window );
+   REQUIRE( (int)peaks.size() - commitBlock > window );
+   float before = 0, after = 0;
+   for (int i = 0; i < window; ++i)
+   {
+      before = std::max(before, peaks[commitBlock - window + i]);
+      after = std::max(after, peaks[commitBlock + i]);
+   }
+   INFO( "Peak before the commit " << before << ", after " << after );
+   REQUIRE( before > 1e-3 );
+   REQUIRE( after > 0.5 * before );
+   // and then goes with it
+   REQUIRE( surge->voices[0].empty() );
+   REQUIRE( peaks.back() < 1e-3 );
+
+   // The staged patch matches an ordinary load of the same file
+   auto ref = Surge::Headless::createSurge(44100);
+   REQUIRE( ref->loadPatchByPath( "test-data/patches/Church.fxp", -1, "Church" ) );
+   auto &sp = surge->storage.getPatch(), &rp = ref->storage.getPatch();
+   REQUIRE( sp.param_ptr.size() == rp.param_ptr.size() );
+   for (int i = 0; i < sp.param_ptr.size(); ++i)
+   {
+      INFO( "Parameter " << sp.param_ptr[i]->get_storage_name() );
+      REQUIRE( sp.param_ptr[i]->val.i == rp.param_ptr[i]->val.i );
+   }
+   for (int i = 0; i < n_fx_slots; ++i)
+   {
+      REQUIRE( (bool)surge->fx[i] == (bool)ref->fx[i] );
+      REQUIRE( surge->fxsync[i].type.val.i == sp.fx[i].type.val.i );
+   }
+   for (int sc = 0; sc < n_scenes; ++sc)
+      REQUIRE( sp.scene[sc].modulation_voice.size() == rp.scene[sc].modulation_voice.size() );
+
+   // and the new patch plays
+   surge->playNote(0, 60, 127, 0);
+   float peak = 0;
+   for (int i = 0; i < 100; ++i)
+   {
+      surge->process();
+      for (int s = 0; s < surge->storage.blockSize; ++s)
+         peak = std::max(peak, std::fabs(surge->output[0][s]));
+   }
+   REQUIRE( peak > 1e-3 );
+}
+
+TEST_CASE( "Gapless Patch Switching Carries The Tuning", "[io]" )
+{
+   auto surge = Surge::Headless::createSurge(44100);
+   REQUIRE( surge );
+   surge->setGaplessPatchSwitching(true);
+   auto ref = Surge::Headless::createSurge(44100);
+
+   auto switchTo = [surge](const char *path) {
+      strncpy(surge->patchid_file, path, FILENAME_MAX - 1);
+      surge->has_patchid_file = true;
+      for (int i = 0; i < 20000 && (surge->has_patchid_file || surge->isPatchStagingInFlight()); ++i)
+      {
+         surge->process();
+         std::this_thread::sleep_for(std::chrono::microseconds(100));
+      }
+      REQUIRE( !surge->isPatchStagingInFlight() );
+   };
+
+   auto sameTuning = [surge, ref]() {
+      REQUIRE( surge->storage.isStandardTuning == ref->storage.isStandardTuning );
+      REQUIRE( surge->storage.isStandardMapping == ref->storage.isStandardMapping );
+      for (int i = 0; i < 512; ++i)
+      {
+         INFO( "Table entry " << i );
+         REQUIRE( surge->storage.table_pitch[i] == ref->storage.table_pitch[i] );
+         REQUIRE( surge->storage.table_pitch_inv[i] == ref->storage.table_pitch_inv[i] );
+         REQUIRE( surge->storage.table_note_omega[0][i] == ref->storage.table_note_omega[0][i] );
+         REQUIRE( surge->storage.table_note_omega[1][i] == ref->storage.table_note_omega[1][i] );
+      }
+   };
+
+   // The tables are built on the staging thread and only swapped in at the commit
+   switchTo("test-data/patches/HasSCLandKBM.fxp");
+   REQUIRE( ref->loadPatchByPath("test-data/patches/HasSCLandKBM.fxp", -1, "Test") );
+   REQUIRE( !surge->storage.isStandardTuning );
+   sameTuning();
+
+   // and the same staging thread picks up the next switch, which keeps the tuning
+   switchTo("test-data/patches/Church.fxp");
+   REQUIRE( ref->loadPatchByPath("test-data/patches/Church.fxp", -1, "Church") );
+   REQUIRE( surge->storage.getPatch().name == "Church" );
+   sameTuning();
+}
+
 TEST_CASE( "MonoVoicePriority Streams", "[io]" )
 {
    auto fromto = [](std::shared_ptr<SurgeSynthesizer> src,
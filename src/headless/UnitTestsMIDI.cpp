@@ -1291,4 +1291,66 @@ TEST_CASE( "Priority Modes with Keysplit", "[midi]" )
          }
       }
    }
-}
\ No newline at end of file
+}
+TEST_CASE( "Voice Table Order and Release Counts", "[midi]" )
+{
+   auto surge = Surge::Headless::createSurge(44100);
+   REQUIRE( surge );
+   for( int i=0; i<5; ++i ) surge->process();
+
+   SECTION( "Voices Iterate In Start Order" )
+   {
+      int keys[] = { 64, 48, 72, 55 };
+      for( auto k : keys )
+         surge->playNote(0, k, 127, 0);
+      surge->process();
+
+      REQUIRE( surge->voices[0].size() == 4 );
+      REQUIRE( surge->getNonReleasedVoices(0) == 4 );
+      REQUIRE( surge->getNonUltrareleaseVoices(0) == 4 );
+      int idx = 0;
+      for( auto v : surge->voices[0] )
+      {
+         REQUIRE( v->state.key == keys[idx] );
+         idx++;
+      }
+
+      surge->releaseNote(0, 48, 0);
+      surge->process();
+      REQUIRE( surge->voices[0].size() == 4 );
+      REQUIRE( surge->getNonReleasedVoices(0) == 3 );
+      REQUIRE( surge->getNonUltrareleaseVoices(0) == 4 );
+
+      // A freed slot is reused but the new voice still goes to the back of the order
+      surge->allNotesOff();
+      surge->playNote(0, 60, 127, 0);
+      surge->playNote(0, 62, 127, 0);
+      surge->process();
+      REQUIRE( surge->voices[0].size() == 2 );
+      idx = 0;
+      for( auto v : surge->voices[0] )
+      {
+         REQUIRE( v->state.key == 60 + 2 * idx );
+         REQUIRE( surge->voices[0].slotOf(v) == idx );
+         idx++;
+      }
+   }
+
+   SECTION( "Polyphony Limit Steals Through The Table" )
+   {
+      surge->storage.getPatch().polylimit.val.i = 4;
+      for( int k=40; k<52; ++k )
+      {
+         surge->playNote(0, k, 127, 0);
+         surge->process();
+      }
+      for( int i=0; i<100; ++i ) surge->process();
+
+      REQUIRE( surge->getNonUltrareleaseVoices(0) <= 4 );
+      int gated = 0;
+      for( auto v : surge->voices[0] )
+         if( v->state.gate )
+            gated++;
+      REQUIRE( gated == surge->getNonReleasedVoices(0) );
+   }
+}
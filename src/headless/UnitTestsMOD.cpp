@@ -2,6 +2,8 @@
 #include <iomanip>
 #include <sstream>
 #include <algorithm>
+#include <thread>
+#include <atomic>
 
 #include "HeadlessUtils.h"
 #include "Player.h"
@@ -81,7 +83,7 @@ TEST_CASE( "ADSR Envelope Behaviour", "[mod]" )
                         
                         while( true )
                         {
-                           auto t = 1.0 * (i+1) * BLOCK_SIZE * dsamplerate_inv;
+                           auto t = 1.0 * (i+1) * surge->storage.blockSize * dsamplerate_inv;
                            i++;
                            if( t > runUntil || runUntil < 0 )
                               break;
@@ -343,7 +345,7 @@ TEST_CASE( "ADSR Envelope Behaviour", "[mod]" )
    /*
    ** This section recreates the somewhat painful SSE code in readable stuff
    */
-   auto analogClone = [](float a_sec, float d_sec, float s, float r_sec, float releaseAfter, float runUntil, float pushSusAt = -1, float pushSusTo = 0 )
+   auto analogClone = [surge](float a_sec, float d_sec, float s, float r_sec, float releaseAfter, float runUntil, float pushSusAt = -1, float pushSusTo = 0 )
                          {
                             float a = limit_range((float)( log(a_sec)/log(2.0) ), -8.f, 5.f);
                             float d = limit_range((float)( log(d_sec)/log(2.0) ), -8.f, 5.f);
@@ -361,7 +363,7 @@ TEST_CASE( "ADSR Envelope Behaviour", "[mod]" )
                                
                             while( true )
                             {
-                               float t = 1.0 * (i+1) * BLOCK_SIZE * dsamplerate_inv;
+                               float t = 1.0 * (i+1) * surge->storage.blockSize * dsamplerate_inv;
                                i++;
                                if( t > runUntil || runUntil < 0 )
                                   break;
@@ -407,7 +409,7 @@ TEST_CASE( "ADSR Envelope Behaviour", "[mod]" )
 
                                const float shortest = 6.f;
                                const float longest = -2.f;
-                               const float coeff_offset = 2.f - log( samplerate / BLOCK_SIZE ) / log( 2.f );
+                               const float coeff_offset = 2.f - log( samplerate / surge->storage.blockSize ) / log( 2.f );
 
                                float coef_A = pow( 2.f, std::min( 0.f, coeff_offset - a ) );
                                float coef_D = pow( 2.f, std::min( 0.f, coeff_offset - d ) );
@@ -511,6 +513,176 @@ TEST_CASE( "ADSR Envelope Behaviour", "[mod]" )
    }
 }
 
+TEST_CASE( "ADSR Envelope Quad Matches Scalar", "[mod]" )
+{
+   std::shared_ptr<SurgeSynthesizer> surge( Surge::Headless::createSurge(44100) );
+   REQUIRE( surge.get() );
+
+   auto* adsrstorage = &(surge->storage.getPatch().scene[0].adsr[0]);
+   auto id = [](Parameter &p) { return p.param_id_in_scene; };
+
+   for( auto analog : { false, true } )
+   {
+      for( int d_s = 0; d_s < 3; ++d_s )
+      {
+         INFO( "analog " << analog << " decay shape " << d_s );
+
+         // Each lane gets its own times, sustain, shapes and release point
+         pdata lc[4][n_scene_params];
+         AdsrEnvelope scalar[4], quad[4];
+         AdsrEnvelope* quadp[4];
+         int releaseAt[4];
+         for( int i = 0; i < 4; ++i )
+         {
+            memcpy( lc[i], surge->storage.getPatch().scenedata[0], sizeof( lc[i] ) );
+            lc[i][id( adsrstorage->a )].f = -6.f + 2.5f * i;
+            lc[i][id( adsrstorage->d )].f = -5.f + 1.5f * i;
+            lc[i][id( adsrstorage->s )].f = ( i == 3 ) ? 0.f : 0.2f + 0.25f * i;
+            lc[i][id( adsrstorage->r )].f = -4.f + i;
+            lc[i][id( adsrstorage->a_s )].i = i % 3;
+            lc[i][id( adsrstorage->d_s )].i = ( d_s + i ) % 3;
+            lc[i][id( adsrstorage->r_s )].i = ( i + 1 ) % 3;
+            lc[i][id( adsrstorage->mode )].b = analog;
+            releaseAt[i] = 100 + 150 * i;
+
+            scalar[i].init( &(surge->storage), adsrstorage, lc[i], nullptr );
+            quad[i].init( &(surge->storage), adsrstorage, lc[i], nullptr );
+            scalar[i].attack();
+            quad[i].attack();
+            quadp[i] = &quad[i];
+         }
+
+         for( int b = 0; b < 2000; ++b )
+         {
+            for( int i = 0; i < 4; ++i )
+            {
+               if( b == releaseAt[i] )
+               {
+                  scalar[i].release();
+                  quad[i].release();
+               }
+               if( b == 1500 && i == 2 )
+               {
+                  scalar[i].uber_release();
+                  quad[i].uber_release();
+               }
+               scalar[i].process_block();
+            }
+            AdsrEnvelope::process_block_quad( quadp, 4 );
+
+            for( int i = 0; i < 4; ++i )
+            {
+               INFO( "block " << b << " lane " << i );
+               REQUIRE( quad[i].getEnvState() == scalar[i].getEnvState() );
+               REQUIRE( quad[i].is_idle() == scalar[i].is_idle() );
+               if( analog || lc[i][id( adsrstorage->d_s )].i == 2 )
+                  REQUIRE( quad[i].output == Approx( scalar[i].output ).margin( 1e-5 ) );
+               else
+                  REQUIRE( quad[i].output == scalar[i].output );
+            }
+         }
+      }
+   }
+}
+
+TEST_CASE( "ADSR Decays To A Low Sustain At Any Block Size", "[mod]" )
+{
+   for( int bs = BLOCK_SIZE_MIN; bs <= BLOCK_SIZE_MAX; bs *= 2 )
+   {
+      // Short decays take big per block steps, which is where the low sustain bounce shows up
+      for( auto dec : { -4.f, -3.f, -2.f } )
+      {
+         for( auto sus : { 0.f, 2e-4f, 5e-4f } )
+         {
+            std::shared_ptr<SurgeSynthesizer> surge( Surge::Headless::createSurge(44100) );
+            REQUIRE( surge.get() );
+            REQUIRE( surge->setBlockSize( bs ) );
+
+            auto* adsrstorage = &(surge->storage.getPatch().scene[0].adsr[0]);
+            auto id = [](Parameter &p) { return p.param_id_in_scene; };
+            pdata lc[n_scene_params];
+            memcpy( lc, surge->storage.getPatch().scenedata[0], sizeof( lc ) );
+            lc[id( adsrstorage->a )].f = -8.f;
+            lc[id( adsrstorage->d )].f = dec;
+            lc[id( adsrstorage->s )].f = sus;
+            lc[id( adsrstorage->d_s )].i = 1;
+            lc[id( adsrstorage->mode )].b = false;
+
+            AdsrEnvelope scalar, quad;
+            AdsrEnvelope* quadp[1] = { &quad };
+            scalar.init( &(surge->storage), adsrstorage, lc, nullptr );
+            quad.init( &(surge->storage), adsrstorage, lc, nullptr );
+            scalar.attack();
+            quad.attack();
+
+            // Every decay here is well done after a second
+            for( int b = 0; b < 44100 / bs; ++b )
+            {
+               scalar.process_block();
+               AdsrEnvelope::process_block_quad( quadp, 1 );
+            }
+
+            INFO( "block size " << bs << " decay " << dec << " sustain " << sus << " output "
+                  << scalar.output << " / " << quad.output );
+            REQUIRE( scalar.output == Approx( sus ).margin( 1e-5 ) );
+            REQUIRE( quad.output == scalar.output );
+         }
+      }
+   }
+}
+
+TEST_CASE( "Voice Modulators Batched Match Scalar", "[mod]" )
+{
+   auto scalar = Surge::Headless::createSurge(44100);
+   auto batched = Surge::Headless::createSurge(44100);
+   REQUIRE( scalar );
+   REQUIRE( batched );
+
+   scalar->setBatchVoiceModulators( false );
+   REQUIRE( batched->getBatchVoiceModulators() );
+
+   for( auto s : { scalar, batched } )
+   {
+      auto &sc = s->storage.getPatch().scene[0];
+      sc.adsr[0].d_s.val.i = 1;
+      sc.adsr[1].mode.val.b = true;
+      sc.lfo[0].shape.val.i = lt_tri;
+      sc.filterunit[0].type.val.i = fut_lp24;
+      // so the filter envelope and the voice LFO are heard
+      s->setModulation( sc.filterunit[0].cutoff.id, ms_filtereg, 0.5 );
+      s->setModulation( sc.osc[0].pitch.id, ms_lfo1, 0.1 );
+      for( int i = 0; i < 10; ++i )
+         s->process();
+   }
+
+   int notes[] = { 48, 52, 55, 60, 64, 67 };
+   srand( 31 );
+   for( auto n : notes )
+      scalar->playNote( 0, n, 100, 0 );
+   srand( 31 );
+   for( auto n : notes )
+      batched->playNote( 0, n, 100, 0 );
+
+   for( int b = 0; b < 1500; ++b )
+   {
+      if( b >= 300 && b < 300 + 6 * 100 && b % 100 == 0 )
+      {
+         auto n = notes[ ( b - 300 ) / 100 ];
+         scalar->releaseNote( 0, n, 0 );
+         batched->releaseNote( 0, n, 0 );
+      }
+
+      scalar->process();
+      batched->process();
+
+      INFO( "Comparing block " << b );
+      REQUIRE( scalar->polydisplay == batched->polydisplay );
+      for( int c = 0; c < N_OUTPUTS; ++c )
+         for( int i = 0; i < scalar->storage.blockSize; ++i )
+            REQUIRE( batched->output[c][i] == Approx( scalar->output[c][i] ).margin( 1e-4 ) );
+   }
+}
+
 TEST_CASE( "Non-MPE pitch bend", "[mod]" )
 {
    SECTION( "Simple Bend Distances" )
@@ -737,7 +909,7 @@ TEST_CASE( "LfoTempoSync Latch Drift", "[mod]" )
       {
          if( lfo->output > p )
          {
-            double time = i * dsamplerate_inv * BLOCK_SIZE;
+            double time = i * dsamplerate_inv * surge->storage.blockSize;
             double beats = time * bpm / 60;
             int bt2 = round( beats * 2 );
             double drift = fabs( beats * 2- bt2 );
@@ -850,6 +1022,41 @@ TEST_CASE( "CModulationSources", "[mod]" )
          REQUIRE( a.output == r );
       }
    }
+
+   SECTION( "Smoothing takes the same time at any block size" )
+   {
+      auto surge = Surge::Headless::createSurge(44100);
+      REQUIRE( surge );
+
+      for( auto mode : { ControllerModulationSource::SmoothingMode::SLOW_EXP,
+                         ControllerModulationSource::SmoothingMode::FAST_EXP,
+                         ControllerModulationSource::SmoothingMode::FAST_LINE } )
+      {
+         auto samplesToArrive = [mode]( int bs ) {
+            ControllerModulationSource a(mode);
+            a.set_blocksize( bs );
+            a.init( 0.2f );
+            a.set_target( 0.8f );
+            int samples = 0;
+            while( a.output != 0.8f && samples < 44100 )
+            {
+               a.process_block();
+               samples += bs;
+            }
+            return samples;
+         };
+
+         int ref = samplesToArrive( 32 );
+         REQUIRE( ref < 44100 );
+         for( int bs = BLOCK_SIZE_MIN; bs <= BLOCK_SIZE_MAX; bs *= 2 )
+         {
+            int samples = samplesToArrive( bs );
+            INFO( "mode " << mode << " block size " << bs << " samples " << samples << " vs " << ref );
+            REQUIRE( samples > ref * 0.95 - bs );
+            REQUIRE( samples < ref * 1.05 + bs );
+         }
+      }
+   }
 }
 
 TEST_CASE( "Keytrack Morph", "[mod]" )
@@ -967,4 +1174,104 @@ TEST_CASE( "KeyTrack in Play Modes", "[mod]" )
          }
       }
    }
-}
\ No newline at end of file
+}
+TEST_CASE( "Modulation Routing Snapshots", "[mod]" )
+{
+   auto surge = Surge::Headless::createSurge(44100);
+   REQUIRE( surge );
+   for( int i=0; i<10; ++i ) surge->process();
+
+   auto ptag = surge->storage.getPatch().scene[0].filterunit[0].cutoff.id;
+
+   SECTION( "Edits Are Published To The Audio Thread" )
+   {
+      auto before = surge->storage.audioModRouting();
+      REQUIRE( before->voice[0].empty() );
+
+      surge->setModulation( ptag, ms_lfo1, 0.7 );
+      // The audio thread keeps the block's snapshot until the next block
+      REQUIRE( surge->storage.audioModRouting() == before );
+
+      surge->process();
+      auto after = surge->storage.audioModRouting();
+      REQUIRE( after != before );
+      REQUIRE( after->voice[0].size() == 1 );
+      REQUIRE( after->voice[0][0].source_id == ms_lfo1 );
+
+      surge->clearModulation( ptag, ms_lfo1 );
+      surge->process();
+      REQUIRE( surge->storage.audioModRouting()->voice[0].empty() );
+   }
+
+   SECTION( "Editing While Playing" )
+   {
+      surge->playNote( 0, 60, 127, 0 );
+
+      std::atomic<bool> done( false );
+      std::thread editor( [&]() {
+         int i = 0;
+         while( ! done )
+         {
+            surge->setModulation( ptag, ms_lfo1, 0.1 + 0.8 * ( i % 10 ) / 10.0 );
+            surge->setModulation( ptag, ms_ampeg, ( i % 2 ) ? 0.5 : 0 );
+            i++;
+         }
+      } );
+      for( int i=0; i<2000; ++i )
+         surge->process();
+      done = true;
+      editor.join();
+
+      surge->process();
+      REQUIRE( surge->storage.audioModRouting()->voice[0].size() >= 1 );
+   }
+}
+
+TEST_CASE( "Modulation Matrix Matches Routing Loop", "[mod]" )
+{
+   std::vector<ModulationSource> sources( n_modsources );
+   ModulationSource* ptrs[n_modsources];
+   for( int i=0; i<n_modsources; ++i )
+   {
+      sources[i].output = 1.3f * sin( i * 0.71 );
+      ptrs[i] = &sources[i];
+   }
+   ptrs[ms_lfo3] = nullptr;
+
+   srand( 42 );
+   for( int trial = 0; trial < 50; ++trial )
+   {
+      std::vector<ModulationRouting> routings;
+      int nr = rand() % 40;
+      for( int i=0; i<nr; ++i )
+      {
+         ModulationRouting r;
+         r.source_id = 1 + rand() % ( n_modsources - 1 );
+         r.destination_id = rand() % 20; // Plenty of repeated destinations
+         r.depth = 2.f * rand() / (float)RAND_MAX - 1.f;
+         routings.push_back( r );
+      }
+
+      ModulationMatrix m;
+      m.compile( routings );
+      REQUIRE( m.size() == nr );
+
+      pdata expected[20], actual[20];
+      for( int i=0; i<20; ++i )
+      {
+         expected[i].f = 0.1f * i;
+         actual[i].f = 0.1f * i;
+      }
+
+      for( auto &r : routings )
+         if( ptrs[r.source_id] )
+            expected[r.destination_id].f += r.depth * ptrs[r.source_id]->output;
+      m.accumulate( actual, ptrs );
+
+      for( int i=0; i<20; ++i )
+      {
+         INFO( "Trial " << trial << " destination " << i );
+         REQUIRE( actual[i].f == expected[i].f );
+      }
+   }
+}
@@ -36,6 +36,18 @@ int main(int argc, char** argv)
          {
             Surge::Headless::NonTest::generateNLFeedbackNorms();
          }
+         if( strcmp( argv[2], "--block-size-benchmark" ) == 0 )
+         {
+            Surge::Headless::NonTest::blockSizeBenchmark();
+         }
+         if( strcmp( argv[2], "--fm-benchmark" ) == 0 )
+         {
+            Surge::Headless::NonTest::fmBenchmark();
+         }
+         if( strcmp( argv[2], "--unison-benchmark" ) == 0 )
+         {
+            Surge::Headless::NonTest::unisonBenchmark();
+         }
          if( strcmp( argv[2], "--filter-analyzer" ) == 0 )
          {
             if( argc < 4 )
@@ -67,6 +79,8 @@ int main(int argc, char** argv)
              << "then use the options below\n\n"
              << "   --non-test --stats-from-every-patch    # play every patch and show RMS\n"
              << "   --non-test --filter-analyzer ft fst    # analyze filter type/subtype for response\n"
+             << "   --non-test --block-size-benchmark      # control work per sample at each block size\n"
+             << "   --non-test --fm-benchmark              # FM2/FM3 at 64 voices, libm vs the quad kernel\n"
              << "\n"
              << "If you exlude the `--non-test` argument, standard catch2 arguments, below, apply\n\n";
       }
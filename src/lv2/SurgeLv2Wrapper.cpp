@@ -160,12 +160,13 @@ void SurgeLv2Wrapper::run(LV2_Handle instance, uint32_t sample_count)
 
    s->process_input = (/*!plug_is_synth ||*/ input_connected);
 
+   const int blockSize = s->getBlockSize();
    for (uint32_t i = 0; i < sample_count; ++i)
    {
       if (self->_blockPos == 0)
       {
          // move clock
-         s->time_data.ppqPos += (double)BLOCK_SIZE * s->time_data.tempo / (60. * sampleRate);
+         s->time_data.ppqPos += (double)blockSize * s->time_data.tempo / (60. * sampleRate);
 
          // process events for the current block
          while (event && i >= event->time.frames)
@@ -194,7 +195,7 @@ void SurgeLv2Wrapper::run(LV2_Handle instance, uint32_t sample_count)
       }
 
       self->_blockPos++;
-      if (self->_blockPos >= BLOCK_SIZE)
+      if (self->_blockPos >= blockSize)
          self->_blockPos = 0;
    }
 
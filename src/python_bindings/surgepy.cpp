@@ -343,8 +343,8 @@ public:
 
    py::array_t<float> getOutput( )
    {
-      return py::array_t<float> ({ 2, BLOCK_SIZE },
-                                { 2* sizeof(float), sizeof(float)},
+      return py::array_t<float> ({ 2, getBlockSize() },
+                                { BLOCK_SIZE_MAX * sizeof(float), sizeof(float)},
                                  (const float*)( & output[0][0] ) );
    }
 
@@ -371,10 +371,11 @@ public:
 
    py::array_t<float> createMultiBlock( int nBlocks )
    {
-      auto res = py::array_t<float>({ 2, nBlocks * BLOCK_SIZE },
-                                { nBlocks * BLOCK_SIZE * sizeof(float), sizeof(float)} );
+      const int blockSize = getBlockSize();
+      auto res = py::array_t<float>({ 2, nBlocks * blockSize },
+                                { nBlocks * blockSize * sizeof(float), sizeof(float)} );
       auto buf = res.request(true);
-      memset( buf.ptr, 0, 2 * BLOCK_SIZE * nBlocks * sizeof(float));
+      memset( buf.ptr, 0, 2 * blockSize * nBlocks * sizeof(float));
       return res;
    }
    void processMultiBlock(const py::array_t<float> &arr,
@@ -382,6 +383,7 @@ public:
                           int nBlocks = -1)
    {
       auto buf = arr.request(true);
+      const int blockSize = getBlockSize();
 
       /*
        * Error condition checks
@@ -395,20 +397,20 @@ public:
       if( buf.ndim != 2 )
       {
          std::ostringstream oss;
-         oss << "Input numpy array must have 2 dimensions (2, m*BLOCK_SIZE); you provided an array with "
+         oss << "Input numpy array must have 2 dimensions (2, m*blockSize); you provided an array with "
              << buf.ndim << " dimensions";
          throw std::invalid_argument(oss.str().c_str());
 
       }
-      if( buf.shape[0] != 2 || buf.shape[1] % BLOCK_SIZE != 0 )
+      if( buf.shape[0] != 2 || buf.shape[1] % blockSize != 0 )
       {
          std::ostringstream oss;
-         oss << "Input numpy array must have dimensions (2, m*BLOCK_SIZE); you provided an array with "
+         oss << "Input numpy array must have dimensions (2, m*blockSize); you provided an array with "
              << buf.shape[0] << "x" << buf.shape[1];
          throw std::invalid_argument(oss.str().c_str());
       }
 
-      size_t maxBlockStorage = buf.shape[1] / BLOCK_SIZE;
+      size_t maxBlockStorage = buf.shape[1] / blockSize;
       if( startBlock >= maxBlockStorage )
       {
          std::ostringstream oss;
@@ -429,17 +431,17 @@ public:
       }
 
       auto ptr = static_cast<float*>(buf.ptr);
-      float *dL = ptr + startBlock * BLOCK_SIZE;
-      float *dR = ptr + buf.shape[1] + startBlock * BLOCK_SIZE;
+      float *dL = ptr + startBlock * blockSize;
+      float *dR = ptr + buf.shape[1] + startBlock * blockSize;
 
       for( auto i=0; i<blockIterations; ++i )
       {
          process();
-         memcpy( (void*)dL, (void*)( output[0] ), BLOCK_SIZE * sizeof(float ));
-         memcpy( (void*)dR, (void*)( output[1] ), BLOCK_SIZE * sizeof(float ));
+         memcpy( (void*)dL, (void*)( output[0] ), blockSize * sizeof(float ));
+         memcpy( (void*)dR, (void*)( output[1] ), blockSize * sizeof(float ));
 
-         dL += BLOCK_SIZE;
-         dR += BLOCK_SIZE;
+         dL += blockSize;
+         dR += blockSize;
       }
    }
 };
@@ -482,6 +484,10 @@ PYBIND11_MODULE(surgepy, m) {
        .def( "getNumInputs", &SurgeSynthesizer::getNumInputs )
        .def( "getNumOutputs", &SurgeSynthesizer::getNumOutputs )
        .def( "getBlockSize", &SurgeSynthesizer::getBlockSize )
+       .def( "setBlockSize", &SurgeSynthesizer::setBlockSize,
+            "Set the engine block size to 16, 32, 64 or 128 samples. Stops any playing notes; returns false "
+            "and leaves the size alone for any other value.",
+            py::arg( "blockSize" ) )
        .def( "getFactoryDataPath", &SurgeSynthesizerWithPythonExtensions::factoryDataPath)
        .def( "getUserDataPath", &SurgeSynthesizerWithPythonExtensions::userDataPath)
        .def( "getSampleRate", [](SurgeSynthesizerWithPythonExtensions &s) { return samplerate; })
@@ -569,7 +575,7 @@ PYBIND11_MODULE(surgepy, m) {
        .def( "process", &SurgeSynthesizer::process,
             "Run surge for one block and update the internal output buffer.")
        .def( "getOutput", &SurgeSynthesizerWithPythonExtensions::getOutput,
-            "Retrieve the internal output buffer as a 2xBLOCK_SIZE numpy array.")
+            "Retrieve the internal output buffer as a 2 x getBlockSize() numpy array.")
 
        .def( "createMultiBlock", &SurgeSynthesizerWithPythonExtensions::createMultiBlock,
             "Create a numpy array suitable to hold up to b blocks of Surge processing in processMultiBlock",
@@ -198,7 +198,7 @@ void SurgefxAudioProcessor::processBlock (AudioBuffer<float>& buffer, MidiBuffer
     }
     
 
-    for(int outPos = 0; outPos < buffer.getNumSamples() && ! resettingFx; outPos += BLOCK_SIZE )
+    for(int outPos = 0; outPos < buffer.getNumSamples() && ! resettingFx; outPos += storage->blockSize )
     {
         auto outL = mainInputOutput.getWritePointer(0, outPos);
         auto outR = mainInputOutput.getWritePointer(1, outPos);
@@ -209,8 +209,8 @@ void SurgefxAudioProcessor::processBlock (AudioBuffer<float>& buffer, MidiBuffer
             auto sideL = sideChainInput.getReadPointer(0, outPos);
             auto sideR = sideChainInput.getReadPointer(1, outPos);
             
-            memcpy(storage->audio_in_nonOS[0], sideL, BLOCK_SIZE * sizeof(float));
-            memcpy(storage->audio_in_nonOS[1], sideR, BLOCK_SIZE * sizeof(float));
+            memcpy(storage->audio_in_nonOS[0], sideL, storage->blockSize * sizeof(float));
+            memcpy(storage->audio_in_nonOS[1], sideR, storage->blockSize * sizeof(float));
         }
         
         for( int i=0; i<n_fx_params; ++i )
@@ -226,18 +226,18 @@ void SurgefxAudioProcessor::processBlock (AudioBuffer<float>& buffer, MidiBuffer
         }
         else
         {
-            float bufferL alignas(16)[BLOCK_SIZE], bufferR alignas(16)[BLOCK_SIZE];
+            float bufferL alignas(16)[BLOCK_SIZE_MAX], bufferR alignas(16)[BLOCK_SIZE_MAX];
 
             auto inL = mainInputOutput.getReadPointer(0, outPos);
             auto inR = mainInputOutput.getReadPointer(1, outPos);
 
-            memcpy(bufferL, inL, BLOCK_SIZE * sizeof(float));
-            memcpy(bufferR, inR, BLOCK_SIZE * sizeof(float));
+            memcpy(bufferL, inL, storage->blockSize * sizeof(float));
+            memcpy(bufferR, inR, storage->blockSize * sizeof(float));
             
             audio_thread_surge_effect->process(bufferL, bufferR);
             
-            memcpy(outL, bufferL, BLOCK_SIZE * sizeof(float));
-            memcpy(outR, bufferR, BLOCK_SIZE * sizeof(float));
+            memcpy(outL, bufferL, storage->blockSize * sizeof(float));
+            memcpy(outR, bufferR, storage->blockSize * sizeof(float));
         }
     }
 }
@@ -462,6 +462,7 @@ void Vst2PluginInstance::processT(float** inputs, float** outputs, VstInt32 samp
    int i;
    int n_outputs = _instance->getNumOutputs();
    int n_inputs = _instance->getNumInputs();
+   const int blockSize = _instance->getBlockSize();
    for (i = 0; i < sampleFrames; i++)
    {
       if (blockpos == 0)
@@ -469,7 +470,7 @@ void Vst2PluginInstance::processT(float** inputs, float** outputs, VstInt32 samp
          // move clock
          timedata* td = &(_instance->time_data);
          _instance->time_data.ppqPos +=
-             (double)BLOCK_SIZE * _instance->time_data.tempo / (60. * sampleRate);
+             (double)blockSize * _instance->time_data.tempo / (60. * sampleRate);
 
          // process events for the current block
          while (events_processed < events_this_block)
@@ -525,7 +526,7 @@ void Vst2PluginInstance::processT(float** inputs, float** outputs, VstInt32 samp
       }
 
       blockpos++;
-      if (blockpos >= BLOCK_SIZE)
+      if (blockpos >= blockSize)
          blockpos = 0;
    }
 
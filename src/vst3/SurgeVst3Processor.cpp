@@ -467,14 +467,21 @@ tresult PLUGIN_API SurgeVst3Processor::process(ProcessData& data)
    surgeInstance->time_data.tempo = tempo;
    surgeInstance->resetStateFromTimeData();
 
-   for (i = 0; i < numSamples; i++)
+   /*
+   ** Walk the host buffer a run at a time, where a run ends at the end of the host buffer or at the
+   ** end of the engine block, whichever is first. Events are dispatched as a batch when a block
+   ** starts, exactly as if we went sample by sample: everything before that sample goes in.
+   */
+   const int blockSize = surgeInstance->getBlockSize();
+   i = 0;
+   while (i < numSamples)
    {
       if (blockpos == 0)
       {
          if (data.processContext)
          {
             surgeInstance->time_data.ppqPos +=
-                (double)BLOCK_SIZE * tempo / (60. * data.processContext->sampleRate);
+                (double)blockSize * tempo / (60. * data.processContext->sampleRate);
          }
 
          processEvents(i, data.inputEvents, noteEventIndex);
@@ -483,45 +490,41 @@ tresult PLUGIN_API SurgeVst3Processor::process(ProcessData& data)
          surgeInstance->process();
       }
 
+      int run = std::min(blockSize - blockpos, numSamples - i);
+      size_t runBytes = run * sizeof(float);
+
       if (surgeInstance->process_input && in)
       {
-         int inp;
-         for (inp = 0; inp < N_INPUTS; inp++)
-         {
-            surgeInstance->input[inp][blockpos] = in[inp][i];
-         }
+         for (int inp = 0; inp < N_INPUTS; inp++)
+            memcpy(&surgeInstance->input[inp][blockpos], &in[inp][i], runBytes);
       }
 
-      int outp;
-      for (outp = 0; outp < N_OUTPUTS; outp++)
-      {
-         out[outp][i] = (float)surgeInstance->output[outp][blockpos];
-      }
+      for (int outp = 0; outp < N_OUTPUTS; outp++)
+         memcpy(&out[outp][i], &surgeInstance->output[outp][blockpos], runBytes);
+
       // TODO: FIX SCENE ASSUMPTION, if we have more scenes, each should get its own additional output eventually!
       if( numOutputs == 3 )
       {
          float** outA = data.outputs[1].channelBuffers32;
          float** outB = data.outputs[2].channelBuffers32;
-         if (surgeInstance->activateExtraOutputs)
+         for (int ch = 0; ch < 2; ++ch)
          {
-            for (int ch = 0; ch < 2; ++ch)
+            if (surgeInstance->activateExtraOutputs)
             {
-               outA[ch][i] = (float)surgeInstance->sceneout[0][ch][blockpos];
-               outB[ch][i] = (float)surgeInstance->sceneout[1][ch][blockpos];
+               memcpy(&outA[ch][i], &surgeInstance->sceneout[0][ch][blockpos], runBytes);
+               memcpy(&outB[ch][i], &surgeInstance->sceneout[1][ch][blockpos], runBytes);
             }
-         }
-         else
-         {
-            for (int ch = 0; ch < 2; ++ch)
+            else
             {
-               outA[ch][i] = 0.f;
-               outB[ch][i] = 0.f;
+               memset(&outA[ch][i], 0, runBytes);
+               memset(&outB[ch][i], 0, runBytes);
             }
          }
       }
 
-      blockpos++;
-      if (blockpos >= BLOCK_SIZE)
+      i += run;
+      blockpos += run;
+      if (blockpos >= blockSize)
          blockpos = 0;
    }
 